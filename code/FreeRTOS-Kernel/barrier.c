@@ -0,0 +1,296 @@
+/*
+ * FreeRTOS Kernel V10.5.1
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Standard includes. */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "barrier.h"
+
+/* Lint e961, e750 and e9021 are suppressed as a MISRA exception justified
+ * because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+ * for the header files above, but not in this file, in order to generate the
+ * correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021 See comment above. */
+
+/* This entire source file will be skipped if the application is not configured
+ * to include barriers.  This #if is closed at the very bottom of this file. */
+#if ( configUSE_BARRIERS == 1 )
+
+/* Set in a waiting task's event list item value when the barrier opens, so
+ * that on waking it can tell that from a timeout.  It must not clash with the
+ * taskEVENT_LIST_ITEM_VALUE_IN_USE definition. */
+    #if configUSE_16_BIT_TICKS == 1
+        #define barrierUNBLOCKED_BY_OPENING    0x0200U
+    #else
+        #define barrierUNBLOCKED_BY_OPENING    0x02000000UL
+    #endif
+
+    typedef struct BarrierDef_t
+    {
+        UBaseType_t uxParties;    /*< The number of tasks that must arrive to open the barrier. */
+        UBaseType_t uxArrived;    /*< The number that have arrived in the current generation. */
+        UBaseType_t uxGeneration; /*< Incremented each time the barrier opens. */
+        List_t xTasksWaiting;     /*< Tasks that have arrived and are blocked. */
+
+        #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+            uint8_t ucStaticallyAllocated; /*< Set to pdTRUE if the barrier is statically allocated to ensure no attempt is made to free the memory. */
+        #endif
+    } Barrier_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Put the barrier at the start of its first generation.
+ */
+    static void prvInitialiseBarrier( Barrier_t * pxBarrier,
+                                      UBaseType_t uxParties ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+        BarrierHandle_t xBarrierCreateStatic( UBaseType_t uxParties,
+                                              StaticBarrier_t * pxBarrierBuffer )
+        {
+            Barrier_t * pxBarrier;
+
+            configASSERT( pxBarrierBuffer );
+
+            #if ( configASSERT_DEFINED == 1 )
+            {
+                /* Sanity check that the size of the structure used to declare a
+                 * variable of type StaticBarrier_t equals the size of the real
+                 * barrier structure. */
+                volatile size_t xSize = sizeof( StaticBarrier_t );
+                configASSERT( xSize == sizeof( Barrier_t ) );
+            } /*lint !e529 xSize is referenced if configASSERT() is defined. */
+            #endif /* configASSERT_DEFINED */
+
+            /* Barrier_t and StaticBarrier_t are deliberately aliased for data
+             * hiding purposes. */
+            pxBarrier = ( Barrier_t * ) pxBarrierBuffer; /*lint !e740 !e9087 */
+
+            if( pxBarrier != NULL )
+            {
+                prvInitialiseBarrier( pxBarrier, uxParties );
+
+                #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+                {
+                    /* Both static and dynamic allocation can be used, so note
+                     * that this barrier was created statically in case it is
+                     * later deleted. */
+                    pxBarrier->ucStaticallyAllocated = pdTRUE;
+                }
+                #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+            }
+
+            return pxBarrier;
+        }
+
+    #endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+    #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+        BarrierHandle_t xBarrierCreate( UBaseType_t uxParties )
+        {
+            Barrier_t * pxBarrier;
+
+            pxBarrier = ( Barrier_t * ) pvPortMalloc( sizeof( Barrier_t ) ); /*lint !e9087 !e9079 pvPortMalloc() returns memory aligned for any type. */
+
+            if( pxBarrier != NULL )
+            {
+                prvInitialiseBarrier( pxBarrier, uxParties );
+
+                #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                {
+                    /* Both static and dynamic allocation can be used, so note
+                     * this barrier was allocated dynamically in case it is
+                     * later deleted. */
+                    pxBarrier->ucStaticallyAllocated = pdFALSE;
+                }
+                #endif /* configSUPPORT_STATIC_ALLOCATION */
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            return pxBarrier;
+        }
+
+    #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+    BaseType_t xBarrierWait( BarrierHandle_t xBarrier,
+                             TickType_t xTicksToWait )
+    {
+        Barrier_t * pxBarrier = xBarrier;
+        BaseType_t xReturn = pdFALSE;
+        BaseType_t xBlocked = pdFALSE;
+        BaseType_t xAlreadyYielded;
+        UBaseType_t uxGeneration;
+
+        configASSERT( pxBarrier );
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+        }
+        #endif
+
+        vTaskSuspendAll();
+        {
+            uxGeneration = pxBarrier->uxGeneration;
+            ( pxBarrier->uxArrived )++;
+
+            if( pxBarrier->uxArrived == pxBarrier->uxParties )
+            {
+                /* The last party to arrive opens the barrier, waking every
+                 * waiting task once, and starts the next generation. */
+                while( listLIST_IS_EMPTY( &( pxBarrier->xTasksWaiting ) ) == pdFALSE )
+                {
+                    vTaskRemoveFromUnorderedEventList( listGET_HEAD_ENTRY( &( pxBarrier->xTasksWaiting ) ), barrierUNBLOCKED_BY_OPENING );
+                }
+
+                pxBarrier->uxArrived = ( UBaseType_t ) 0;
+                ( pxBarrier->uxGeneration )++;
+                xReturn = pdTRUE;
+            }
+            else if( xTicksToWait != ( TickType_t ) 0 )
+            {
+                vTaskPlaceOnUnorderedEventList( &( pxBarrier->xTasksWaiting ), ( TickType_t ) 0, xTicksToWait );
+                xBlocked = pdTRUE;
+            }
+            else
+            {
+                /* Not waiting, so the arrival does not count. */
+                ( pxBarrier->uxArrived )--;
+            }
+        }
+        xAlreadyYielded = xTaskResumeAll();
+
+        if( xBlocked != pdFALSE )
+        {
+            if( xAlreadyYielded == pdFALSE )
+            {
+                portYIELD_WITHIN_API();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            if( ( uxTaskResetEventItemValue() & barrierUNBLOCKED_BY_OPENING ) != ( TickType_t ) 0 )
+            {
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                vTaskSuspendAll();
+                {
+                    /* The block time expired.  If the barrier opened anyway
+                     * before this task ran again, its arrival was counted and
+                     * it passed; otherwise withdraw the arrival. */
+                    if( pxBarrier->uxGeneration == uxGeneration )
+                    {
+                        ( pxBarrier->uxArrived )--;
+                    }
+                    else
+                    {
+                        xReturn = pdTRUE;
+                    }
+                }
+                ( void ) xTaskResumeAll();
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxBarrierGetGeneration( BarrierHandle_t xBarrier )
+    {
+        configASSERT( xBarrier );
+        return xBarrier->uxGeneration;
+    }
+/*-----------------------------------------------------------*/
+
+    void vBarrierDelete( BarrierHandle_t xBarrier )
+    {
+        Barrier_t * pxBarrier = xBarrier;
+
+        configASSERT( pxBarrier );
+        configASSERT( listLIST_IS_EMPTY( &( pxBarrier->xTasksWaiting ) ) != pdFALSE );
+
+        #if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+        {
+            /* The barrier can only have been allocated dynamically - free it
+             * again. */
+            vPortFree( pxBarrier );
+        }
+        #elif ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+        {
+            /* The barrier could have been allocated statically or
+             * dynamically, so check before attempting to free the memory. */
+            if( pxBarrier->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+            {
+                vPortFree( pxBarrier );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvInitialiseBarrier( Barrier_t * pxBarrier,
+                                      UBaseType_t uxParties )
+    {
+        configASSERT( uxParties > ( UBaseType_t ) 0 );
+
+        pxBarrier->uxParties = uxParties;
+        pxBarrier->uxArrived = ( UBaseType_t ) 0;
+        pxBarrier->uxGeneration = ( UBaseType_t ) 0;
+        vListInitialise( &( pxBarrier->xTasksWaiting ) );
+    }
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+ * to include barriers.  If you want to include them then ensure
+ * configUSE_BARRIERS is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_BARRIERS == 1 */
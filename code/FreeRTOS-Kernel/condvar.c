@@ -0,0 +1,289 @@
+/*
+ * FreeRTOS Kernel V10.5.1
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Standard includes. */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "condvar.h"
+
+/* Lint e961, e750 and e9021 are suppressed as a MISRA exception justified
+ * because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+ * for the header files above, but not in this file, in order to generate the
+ * correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021 See comment above. */
+
+/* This entire source file will be skipped if the application is not configured
+ * to include condition variables.  This #if is closed at the very bottom of this
+ * file. */
+#if ( configUSE_CONDVARS == 1 )
+
+/* Kept in a waiting task's event list item value until a signal moves the task
+ * onto the mutex, so that on waking it can tell that from a timeout.  It must
+ * not clash with the taskEVENT_LIST_ITEM_VALUE_IN_USE definition. */
+    #if configUSE_16_BIT_TICKS == 1
+        #define condvarWAITING_FOR_SIGNAL    0x0200U
+    #else
+        #define condvarWAITING_FOR_SIGNAL    0x02000000UL
+    #endif
+
+    typedef struct CondVarDef_t
+    {
+        SemaphoreHandle_t xMutex; /*< The mutex waiting tasks release and take again. */
+        List_t xTasksWaiting;     /*< Tasks blocked in xCondVarWait(), in priority order. */
+
+        #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+            uint8_t ucStaticallyAllocated; /*< Set to pdTRUE if the condition variable is statically allocated to ensure no attempt is made to free the memory. */
+        #endif
+    } CondVar_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Move up to uxMaxTasks waiting tasks, highest priority first, onto the
+ * mutex's list of waiting tasks.
+ */
+    static void prvWakeWaiters( CondVar_t * pxCondVar,
+                                UBaseType_t uxMaxTasks ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+        CondVarHandle_t xCondVarCreateStatic( SemaphoreHandle_t xMutex,
+                                              StaticCondVar_t * pxCondVarBuffer )
+        {
+            CondVar_t * pxCondVar;
+
+            configASSERT( xMutex );
+            configASSERT( pxCondVarBuffer );
+
+            #if ( configASSERT_DEFINED == 1 )
+            {
+                /* Sanity check that the size of the structure used to declare a
+                 * variable of type StaticCondVar_t equals the size of the real
+                 * condition variable structure. */
+                volatile size_t xSize = sizeof( StaticCondVar_t );
+                configASSERT( xSize == sizeof( CondVar_t ) );
+            } /*lint !e529 xSize is referenced if configASSERT() is defined. */
+            #endif /* configASSERT_DEFINED */
+
+            /* CondVar_t and StaticCondVar_t are deliberately aliased for data
+             * hiding purposes. */
+            pxCondVar = ( CondVar_t * ) pxCondVarBuffer; /*lint !e740 !e9087 */
+
+            if( pxCondVar != NULL )
+            {
+                pxCondVar->xMutex = xMutex;
+                vListInitialise( &( pxCondVar->xTasksWaiting ) );
+
+                #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+                {
+                    /* Both static and dynamic allocation can be used, so note
+                     * that this condition variable was created statically in
+                     * case it is later deleted. */
+                    pxCondVar->ucStaticallyAllocated = pdTRUE;
+                }
+                #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+            }
+
+            return pxCondVar;
+        }
+
+    #endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+    #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+        CondVarHandle_t xCondVarCreate( SemaphoreHandle_t xMutex )
+        {
+            CondVar_t * pxCondVar;
+
+            configASSERT( xMutex );
+
+            pxCondVar = ( CondVar_t * ) pvPortMalloc( sizeof( CondVar_t ) ); /*lint !e9087 !e9079 pvPortMalloc() returns memory aligned for any type. */
+
+            if( pxCondVar != NULL )
+            {
+                pxCondVar->xMutex = xMutex;
+                vListInitialise( &( pxCondVar->xTasksWaiting ) );
+
+                #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                {
+                    /* Both static and dynamic allocation can be used, so note
+                     * this condition variable was allocated dynamically in case
+                     * it is later deleted. */
+                    pxCondVar->ucStaticallyAllocated = pdFALSE;
+                }
+                #endif /* configSUPPORT_STATIC_ALLOCATION */
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            return pxCondVar;
+        }
+
+    #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+    BaseType_t xCondVarWait( CondVarHandle_t xCondVar,
+                             TickType_t xTicksToWait )
+    {
+        CondVar_t * pxCondVar = xCondVar;
+        BaseType_t xReturn;
+
+        configASSERT( pxCondVar );
+        #if ( INCLUDE_xSemaphoreGetMutexHolder == 1 )
+        {
+            configASSERT( xSemaphoreGetMutexHolder( pxCondVar->xMutex ) == xTaskGetCurrentTaskHandle() );
+        }
+        #endif
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( xTaskGetSchedulerState() != taskSCHEDULER_SUSPENDED );
+        }
+        #endif
+
+        if( xTicksToWait == ( TickType_t ) 0 )
+        {
+            /* Nothing can signal this task without it blocking. */
+            return pdFALSE;
+        }
+
+        vTaskSuspendAll();
+        {
+            /* Give the mutex before blocking, as a give that drops an inherited
+             * priority moves the giving task between ready lists.  No other
+             * task can run to signal before this task is on the list, as the
+             * scheduler is suspended. */
+            ( void ) xSemaphoreGive( pxCondVar->xMutex );
+            vTaskPlaceOnFlaggedEventList( &( pxCondVar->xTasksWaiting ), condvarWAITING_FOR_SIGNAL, xTicksToWait );
+        }
+
+        if( xTaskResumeAll() == pdFALSE )
+        {
+            portYIELD_WITHIN_API();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* The flag is cleared when a signal moves this task onto the mutex.
+         * The block time may run out while the task is queued there, but the
+         * signal still counts.  Resetting the item value also leaves it fit
+         * for blocking on the mutex below. */
+        if( ( uxTaskResetEventItemValue() & condvarWAITING_FOR_SIGNAL ) == ( TickType_t ) 0 )
+        {
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            xReturn = pdFALSE;
+        }
+
+        /* A signalled task has been queued on the mutex, and a task that timed
+         * out must take the mutex back too, so both end up here. */
+        ( void ) xSemaphoreTake( pxCondVar->xMutex, portMAX_DELAY );
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vCondVarSignal( CondVarHandle_t xCondVar )
+    {
+        configASSERT( xCondVar );
+        prvWakeWaiters( xCondVar, ( UBaseType_t ) 1 );
+    }
+/*-----------------------------------------------------------*/
+
+    void vCondVarBroadcast( CondVarHandle_t xCondVar )
+    {
+        configASSERT( xCondVar );
+        prvWakeWaiters( xCondVar, listCURRENT_LIST_LENGTH( &( xCondVar->xTasksWaiting ) ) );
+    }
+/*-----------------------------------------------------------*/
+
+    void vCondVarDelete( CondVarHandle_t xCondVar )
+    {
+        CondVar_t * pxCondVar = xCondVar;
+
+        configASSERT( pxCondVar );
+        configASSERT( listLIST_IS_EMPTY( &( pxCondVar->xTasksWaiting ) ) != pdFALSE );
+
+        #if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+        {
+            /* The condition variable can only have been allocated dynamically -
+             * free it again. */
+            vPortFree( pxCondVar );
+        }
+        #elif ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+        {
+            /* The condition variable could have been allocated statically or
+             * dynamically, so check before attempting to free the memory. */
+            if( pxCondVar->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+            {
+                vPortFree( pxCondVar );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvWakeWaiters( CondVar_t * pxCondVar,
+                                UBaseType_t uxMaxTasks )
+    {
+        /* The scheduler is suspended so that, if a waiter of higher priority
+         * than this task is readied, the switch to it happens on resuming. */
+        vTaskSuspendAll();
+        {
+            ( void ) uxQueueMoveWaitersToMutex( pxCondVar->xMutex, &( pxCondVar->xTasksWaiting ), uxMaxTasks );
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+ * to include condition variables.  If you want to include them then ensure
+ * configUSE_CONDVARS is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_CONDVARS == 1 */
@@ -64,7 +64,8 @@
 typedef struct EventGroupDef_t
 {
     EventBits_t uxEventBits;
-    List_t xTasksWaitingForBits; /*< List of tasks waiting for a bit to be set. */
+    List_t xTasksWaitingForBits[ configEVENT_GROUP_WAITER_LISTS ];   /*< Lists of tasks waiting for a bit to be set, see prvPlaceOnWaiterList(). */
+    EventBits_t uxWaiterListBits[ configEVENT_GROUP_WAITER_LISTS ]; /*< The bits waited for by the tasks added to each list since it was last empty. */
 
     #if ( configUSE_TRACE_FACILITY == 1 )
         UBaseType_t uxEventGroupNumber;
@@ -89,6 +90,22 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits,
                                         const EventBits_t uxBitsToWaitFor,
                                         const BaseType_t xWaitForAllBits ) PRIVILEGED_FUNCTION;
 
+/*
+ * Initialises the event group's waiter lists.
+ */
+static void prvInitialiseWaiterLists( EventGroup_t * pxEventBits ) PRIVILEGED_FUNCTION;
+
+/*
+ * Blocks the calling task on the waiter list selected by the lowest bit in
+ * uxBitsToWaitFor, and adds uxBitsToWaitFor to the bits recorded for that list.
+ * xEventGroupSetBits() then only walks the lists recorded as waiting for at
+ * least one of the bits being set.  Called with the scheduler suspended.
+ */
+static void prvPlaceOnWaiterList( EventGroup_t * pxEventBits,
+                                  const EventBits_t uxBitsToWaitFor,
+                                  const EventBits_t uxControlBits,
+                                  const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------*/
 
 #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
@@ -116,7 +133,7 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits,
         if( pxEventBits != NULL )
         {
             pxEventBits->uxEventBits = 0;
-            vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
+            prvInitialiseWaiterLists( pxEventBits );
 
             #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
             {
@@ -167,7 +184,7 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits,
         if( pxEventBits != NULL )
         {
             pxEventBits->uxEventBits = 0;
-            vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
+            prvInitialiseWaiterLists( pxEventBits );
 
             #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
             {
@@ -235,7 +252,7 @@ EventBits_t xEventGroupSync( EventGroupHandle_t xEventGroup,
                 /* Store the bits that the calling task is waiting for in the
                  * task's event list item so the kernel knows when a match is
                  * found.  Then enter the blocked state. */
-                vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | eventCLEAR_EVENTS_ON_EXIT_BIT | eventWAIT_FOR_ALL_BITS ), xTicksToWait );
+                prvPlaceOnWaiterList( pxEventBits, uxBitsToWaitFor, ( eventCLEAR_EVENTS_ON_EXIT_BIT | eventWAIT_FOR_ALL_BITS ), xTicksToWait );
 
                 /* This assignment is obsolete as uxReturn will get set after
                  * the task unblocks, but some compilers mistakenly generate a
@@ -394,7 +411,7 @@ EventBits_t xEventGroupWaitBits( EventGroupHandle_t xEventGroup,
             /* Store the bits that the calling task is waiting for in the
              * task's event list item so the kernel knows when a match is
              * found.  Then enter the blocked state. */
-            vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | uxControlBits ), xTicksToWait );
+            prvPlaceOnWaiterList( pxEventBits, uxBitsToWaitFor, uxControlBits, xTicksToWait );
 
             /* This is obsolete as it will get set after the task unblocks, but
              * some compilers mistakenly generate a warning about the variable
@@ -540,80 +557,101 @@ EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup,
     EventBits_t uxBitsToClear = 0, uxBitsWaitedFor, uxControlBits;
     EventGroup_t * pxEventBits = xEventGroup;
     BaseType_t xMatchFound = pdFALSE;
+    UBaseType_t uxWaiterList;
 
     /* Check the user is not attempting to set the bits used by the kernel
      * itself. */
     configASSERT( xEventGroup );
     configASSERT( ( uxBitsToSet & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
 
-    pxList = &( pxEventBits->xTasksWaitingForBits );
-    pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
     vTaskSuspendAll();
     {
         traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet );
 
-        pxListItem = listGET_HEAD_ENTRY( pxList );
-
         /* Set the bits. */
         pxEventBits->uxEventBits |= uxBitsToSet;
 
-        /* See if the new bit value should unblock any tasks. */
-        while( pxListItem != pxListEnd )
+        for( uxWaiterList = ( UBaseType_t ) 0; uxWaiterList < ( UBaseType_t ) configEVENT_GROUP_WAITER_LISTS; uxWaiterList++ )
         {
-            pxNext = listGET_NEXT( pxListItem );
-            uxBitsWaitedFor = listGET_LIST_ITEM_VALUE( pxListItem );
-            xMatchFound = pdFALSE;
+            pxList = &( pxEventBits->xTasksWaitingForBits[ uxWaiterList ] );
 
-            /* Split the bits waited for from the control bits. */
-            uxControlBits = uxBitsWaitedFor & eventEVENT_BITS_CONTROL_BYTES;
-            uxBitsWaitedFor &= ~eventEVENT_BITS_CONTROL_BYTES;
-
-            if( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) == ( EventBits_t ) 0 )
+            if( listLIST_IS_EMPTY( pxList ) != pdFALSE )
             {
-                /* Just looking for single bit being set. */
-                if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) != ( EventBits_t ) 0 )
-                {
-                    xMatchFound = pdTRUE;
-                }
-                else
-                {
-                    mtCOVERAGE_TEST_MARKER();
-                }
+                /* Tasks that timed out or were deleted leave their bits
+                 * behind, so forget them once the list has emptied. */
+                pxEventBits->uxWaiterListBits[ uxWaiterList ] = 0;
             }
-            else if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) == uxBitsWaitedFor )
+            else if( ( pxEventBits->uxWaiterListBits[ uxWaiterList ] & uxBitsToSet ) != ( EventBits_t ) 0 )
             {
-                /* All bits are set. */
-                xMatchFound = pdTRUE;
+                /* A task's wait condition can only become true when one of the
+                 * bits it waits for is set, so only lists with a task waiting
+                 * for one of these bits need to be walked. */
+                pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+                pxListItem = listGET_HEAD_ENTRY( pxList );
+
+                /* See if the new bit value should unblock any tasks. */
+                while( pxListItem != pxListEnd )
+                {
+                    pxNext = listGET_NEXT( pxListItem );
+                    uxBitsWaitedFor = listGET_LIST_ITEM_VALUE( pxListItem );
+                    xMatchFound = pdFALSE;
+
+                    /* Split the bits waited for from the control bits. */
+                    uxControlBits = uxBitsWaitedFor & eventEVENT_BITS_CONTROL_BYTES;
+                    uxBitsWaitedFor &= ~eventEVENT_BITS_CONTROL_BYTES;
+
+                    if( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) == ( EventBits_t ) 0 )
+                    {
+                        /* Just looking for single bit being set. */
+                        if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) != ( EventBits_t ) 0 )
+                        {
+                            xMatchFound = pdTRUE;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    else if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) == uxBitsWaitedFor )
+                    {
+                        /* All bits are set. */
+                        xMatchFound = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Need all bits to be set, but not all the bits were set. */
+                    }
+
+                    if( xMatchFound != pdFALSE )
+                    {
+                        /* The bits match.  Should the bits be cleared on exit? */
+                        if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
+                        {
+                            uxBitsToClear |= uxBitsWaitedFor;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+
+                        /* Store the actual event flag value in the task's event list
+                         * item before removing the task from the event list.  The
+                         * eventUNBLOCKED_DUE_TO_BIT_SET bit is set so the task knows
+                         * that is was unblocked due to its required bits matching, rather
+                         * than because it timed out. */
+                        vTaskRemoveFromUnorderedEventList( pxListItem, pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET );
+                    }
+
+                    /* Move onto the next list item.  Note pxListItem->pxNext is not
+                     * used here as the list item may have been removed from the event list
+                     * and inserted into the ready/pending reading list. */
+                    pxListItem = pxNext;
+                }
             }
             else
             {
-                /* Need all bits to be set, but not all the bits were set. */
-            }
-
-            if( xMatchFound != pdFALSE )
-            {
-                /* The bits match.  Should the bits be cleared on exit? */
-                if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
-                {
-                    uxBitsToClear |= uxBitsWaitedFor;
-                }
-                else
-                {
-                    mtCOVERAGE_TEST_MARKER();
-                }
-
-                /* Store the actual event flag value in the task's event list
-                 * item before removing the task from the event list.  The
-                 * eventUNBLOCKED_DUE_TO_BIT_SET bit is set so the task knows
-                 * that is was unblocked due to its required bits matching, rather
-                 * than because it timed out. */
-                vTaskRemoveFromUnorderedEventList( pxListItem, pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET );
+                mtCOVERAGE_TEST_MARKER();
             }
-
-            /* Move onto the next list item.  Note pxListItem->pxNext is not
-             * used here as the list item may have been removed from the event list
-             * and inserted into the ready/pending reading list. */
-            pxListItem = pxNext;
         }
 
         /* Clear any bits that matched when the eventCLEAR_EVENTS_ON_EXIT_BIT
@@ -630,21 +668,25 @@ void vEventGroupDelete( EventGroupHandle_t xEventGroup )
 {
     EventGroup_t * pxEventBits = xEventGroup;
     const List_t * pxTasksWaitingForBits;
+    UBaseType_t uxWaiterList;
 
     configASSERT( pxEventBits );
 
-    pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
-
     vTaskSuspendAll();
     {
         traceEVENT_GROUP_DELETE( xEventGroup );
 
-        while( listCURRENT_LIST_LENGTH( pxTasksWaitingForBits ) > ( UBaseType_t ) 0 )
+        for( uxWaiterList = ( UBaseType_t ) 0; uxWaiterList < ( UBaseType_t ) configEVENT_GROUP_WAITER_LISTS; uxWaiterList++ )
         {
-            /* Unblock the task, returning 0 as the event list is being deleted
-             * and cannot therefore have any bits set. */
-            configASSERT( pxTasksWaitingForBits->xListEnd.pxNext != ( const ListItem_t * ) &( pxTasksWaitingForBits->xListEnd ) );
-            vTaskRemoveFromUnorderedEventList( pxTasksWaitingForBits->xListEnd.pxNext, eventUNBLOCKED_DUE_TO_BIT_SET );
+            pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits[ uxWaiterList ] );
+
+            while( listCURRENT_LIST_LENGTH( pxTasksWaitingForBits ) > ( UBaseType_t ) 0 )
+            {
+                /* Unblock the task, returning 0 as the event list is being deleted
+                 * and cannot therefore have any bits set. */
+                configASSERT( pxTasksWaitingForBits->xListEnd.pxNext != ( const ListItem_t * ) &( pxTasksWaitingForBits->xListEnd ) );
+                vTaskRemoveFromUnorderedEventList( pxTasksWaitingForBits->xListEnd.pxNext, eventUNBLOCKED_DUE_TO_BIT_SET );
+            }
         }
     }
     ( void ) xTaskResumeAll();
@@ -727,6 +769,55 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits,
 }
 /*-----------------------------------------------------------*/
 
+static void prvInitialiseWaiterLists( EventGroup_t * pxEventBits )
+{
+    UBaseType_t uxWaiterList;
+
+    for( uxWaiterList = ( UBaseType_t ) 0; uxWaiterList < ( UBaseType_t ) configEVENT_GROUP_WAITER_LISTS; uxWaiterList++ )
+    {
+        vListInitialise( &( pxEventBits->xTasksWaitingForBits[ uxWaiterList ] ) );
+        pxEventBits->uxWaiterListBits[ uxWaiterList ] = 0;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPlaceOnWaiterList( EventGroup_t * pxEventBits,
+                                  const EventBits_t uxBitsToWaitFor,
+                                  const EventBits_t uxControlBits,
+                                  const TickType_t xTicksToWait )
+{
+    UBaseType_t uxLowestBit = 0;
+    UBaseType_t uxWaiterList;
+
+    /* A task goes on the list of the lowest bit it waits for, modulo the
+     * number of lists, and the list records all of its bits, so setting bits
+     * only walks lists with a task waiting for one of them.  Bits n and
+     * n + configEVENT_GROUP_WAITER_LISTS share a list; setting
+     * configEVENT_GROUP_WAITER_LISTS to the number of event bits (24, or 8
+     * with 16-bit ticks) gives each bit its own list. */
+    while( ( uxBitsToWaitFor & ( ( EventBits_t ) 1 << uxLowestBit ) ) == ( EventBits_t ) 0 )
+    {
+        uxLowestBit++;
+    }
+
+    uxWaiterList = uxLowestBit % ( UBaseType_t ) configEVENT_GROUP_WAITER_LISTS;
+
+    if( listLIST_IS_EMPTY( &( pxEventBits->xTasksWaitingForBits[ uxWaiterList ] ) ) != pdFALSE )
+    {
+        pxEventBits->uxWaiterListBits[ uxWaiterList ] = uxBitsToWaitFor;
+    }
+    else
+    {
+        pxEventBits->uxWaiterListBits[ uxWaiterList ] |= uxBitsToWaitFor;
+    }
+
+    /* Store the bits that the calling task is waiting for in the task's event
+     * list item so the kernel knows when a match is found.  Then enter the
+     * blocked state. */
+    vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits[ uxWaiterList ] ), ( uxBitsToWaitFor | uxControlBits ), xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 ) && ( configUSE_TIMERS == 1 ) )
 
     BaseType_t xEventGroupSetBitsFromISR( EventGroupHandle_t xEventGroup,
@@ -873,6 +873,58 @@
     #define configUSE_QUEUE_SETS    0
 #endif
 
+#ifndef configUSE_EVENT_LIST_BUCKETS
+    #define configUSE_EVENT_LIST_BUCKETS    0
+#endif
+
+#if ( ( configUSE_EVENT_LIST_BUCKETS == 1 ) && ( configMAX_PRIORITIES > 31 ) )
+    #error configUSE_EVENT_LIST_BUCKETS can only be set to 1 when configMAX_PRIORITIES is less than 32.
+#endif
+
+#ifndef configUSE_PRIORITY_QUEUES
+    #define configUSE_PRIORITY_QUEUES    0
+#endif
+
+#ifndef configPRIORITY_QUEUE_MAX_LENGTH
+    #define configPRIORITY_QUEUE_MAX_LENGTH    16
+#endif
+
+#if ( ( configPRIORITY_QUEUE_MAX_LENGTH < 1 ) || ( configPRIORITY_QUEUE_MAX_LENGTH > 255 ) )
+    #error configPRIORITY_QUEUE_MAX_LENGTH must be from 1 to 255.
+#endif
+
+#ifndef configUSE_QUEUE_WORD_COPY
+    #define configUSE_QUEUE_WORD_COPY    0
+#endif
+
+#ifndef configUSE_RWLOCKS
+    #define configUSE_RWLOCKS    0
+#endif
+
+#if ( ( configUSE_RWLOCKS == 1 ) && ( configUSE_MUTEXES != 1 ) )
+    #error configUSE_MUTEXES must be set to 1 to use reader-writer locks, which rely on mutex priority inheritance.
+#endif
+
+#ifndef configUSE_CONDVARS
+    #define configUSE_CONDVARS    0
+#endif
+
+#if ( ( configUSE_CONDVARS == 1 ) && ( configUSE_MUTEXES != 1 ) )
+    #error configUSE_MUTEXES must be set to 1 to use condition variables.
+#endif
+
+#ifndef configUSE_BARRIERS
+    #define configUSE_BARRIERS    0
+#endif
+
+#ifndef configEVENT_GROUP_WAITER_LISTS
+    #define configEVENT_GROUP_WAITER_LISTS    1
+#endif
+
+#if ( configEVENT_GROUP_WAITER_LISTS < 1 )
+    #error configEVENT_GROUP_WAITER_LISTS must be at least 1.
+#endif
+
 #ifndef portTASK_USES_FLOATING_POINT
     #define portTASK_USES_FLOATING_POINT()
 #endif
@@ -1274,6 +1326,7 @@ typedef struct xSTATIC_TCB
     #endif
     #if ( configUSE_MUTEXES == 1 )
         UBaseType_t uxDummy12[ 2 ];
+        void * pvDummy24;
     #endif
     #if ( configUSE_APPLICATION_TASK_TAG == 1 )
         void * pxDummy14;
@@ -1301,6 +1354,10 @@ typedef struct xSTATIC_TCB
     #if ( configUSE_POSIX_ERRNO == 1 )
         int iDummy22;
     #endif
+    #if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+        void * pvDummy23;
+        UBaseType_t uxDummy25;
+    #endif
 } StaticTask_t;
 
 /*
@@ -1339,6 +1396,22 @@ typedef struct xSTATIC_QUEUE
         void * pvDummy7;
     #endif
 
+    #if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+        struct
+        {
+            UBaseType_t uxDummy10;
+            void * pvDummy11[ configMAX_PRIORITIES ];
+        } xDummy12[ 2 ];
+    #endif
+
+    #if ( configUSE_PRIORITY_QUEUES == 1 )
+        void * pvDummy13;
+    #endif
+
+    #if ( configUSE_MUTEXES == 1 )
+        void * pvDummy14[ 3 ];
+    #endif
+
     #if ( configUSE_TRACE_FACILITY == 1 )
         UBaseType_t uxDummy8;
         uint8_t ucDummy9;
@@ -1363,7 +1436,8 @@ typedef StaticQueue_t StaticSemaphore_t;
 typedef struct xSTATIC_EVENT_GROUP
 {
     TickType_t xDummy1;
-    StaticList_t xDummy2;
+    StaticList_t xDummy2[ configEVENT_GROUP_WAITER_LISTS ];
+    TickType_t xDummy5[ configEVENT_GROUP_WAITER_LISTS ];
 
     #if ( configUSE_TRACE_FACILITY == 1 )
         UBaseType_t uxDummy3;
@@ -1428,6 +1502,71 @@ typedef struct xSTATIC_STREAM_BUFFER
     #endif
 } StaticStreamBuffer_t;
 
+/*
+ * In line with software engineering best practice, especially when supplying a
+ * library that is likely to change in future versions, FreeRTOS implements a
+ * strict data hiding policy.  This means the reader-writer lock structure used
+ * internally by FreeRTOS is not accessible to application code.  However, if
+ * the application writer wants to statically allocate the memory required to
+ * create a reader-writer lock then the size of the lock object needs to be
+ * known.  The StaticRWLock_t structure below is provided for this purpose.
+ * Its size and alignment requirements are guaranteed to match those of the
+ * genuine structure, no matter which architecture is being used, and no
+ * matter how the values in FreeRTOSConfig.h are set.
+ */
+typedef struct xSTATIC_RWLOCK
+{
+    UBaseType_t uxDummy1;
+    void * pvDummy2;
+    StaticList_t xDummy3[ 2 ];
+    void * pvDummy5[ 3 ];
+    #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+        uint8_t ucDummy4;
+    #endif
+} StaticRWLock_t;
+
+/*
+ * In line with software engineering best practice, especially when supplying a
+ * library that is likely to change in future versions, FreeRTOS implements a
+ * strict data hiding policy.  This means the condition variable structure used
+ * internally by FreeRTOS is not accessible to application code.  However, if
+ * the application writer wants to statically allocate the memory required to
+ * create a condition variable then the size of the object needs to be known.
+ * The StaticCondVar_t structure below is provided for this purpose.  Its size
+ * and alignment requirements are guaranteed to match those of the genuine
+ * structure, no matter which architecture is being used, and no matter how
+ * the values in FreeRTOSConfig.h are set.
+ */
+typedef struct xSTATIC_CONDVAR
+{
+    void * pvDummy1;
+    StaticList_t xDummy2;
+    #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+        uint8_t ucDummy3;
+    #endif
+} StaticCondVar_t;
+
+/*
+ * In line with software engineering best practice, especially when supplying a
+ * library that is likely to change in future versions, FreeRTOS implements a
+ * strict data hiding policy.  This means the barrier structure used internally
+ * by FreeRTOS is not accessible to application code.  However, if the
+ * application writer wants to statically allocate the memory required to
+ * create a barrier then the size of the barrier object needs to be known.  The
+ * StaticBarrier_t structure below is provided for this purpose.  Its size and
+ * alignment requirements are guaranteed to match those of the genuine
+ * structure, no matter which architecture is being used, and no matter how the
+ * values in FreeRTOSConfig.h are set.
+ */
+typedef struct xSTATIC_BARRIER
+{
+    UBaseType_t uxDummy1[ 3 ];
+    StaticList_t xDummy2;
+    #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+        uint8_t ucDummy3;
+    #endif
+} StaticBarrier_t;
+
 /* Message buffers are built on stream buffers. */
 typedef StaticStreamBuffer_t StaticMessageBuffer_t;
 
@@ -0,0 +1,165 @@
+/*
+ * FreeRTOS Kernel V10.5.1
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include barrier.h"
+#endif
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * A barrier holds back a fixed number of tasks, the parties, until all of
+ * them have reached it, then lets them all continue.  Unlike a rendezvous
+ * built with xEventGroupSync() the parties need no bits of their own: the
+ * barrier just counts arrivals.
+ *
+ * The barrier is cyclic.  Each time the last party arrives the barrier moves
+ * on to a new generation, so the same tasks can meet at it again straight
+ * away, and a task that is quick to come back cannot be confused with one
+ * still leaving the previous round.  The last party wakes every waiting task
+ * in a single pass, and each is woken exactly once.
+ *
+ * A task that times out withdraws its arrival, so the round then needs it (or
+ * another task) to arrive again before the barrier opens.
+ *
+ * Barriers must not be used from interrupts.
+ */
+
+/**
+ * barrier.h
+ *
+ * Type by which barriers are referenced.
+ *
+ * \defgroup BarrierHandle_t BarrierHandle_t
+ * \ingroup Barrier
+ */
+struct BarrierDef_t;
+typedef struct BarrierDef_t * BarrierHandle_t;
+
+/**
+ * barrier.h
+ * @code{c}
+ * BarrierHandle_t xBarrierCreate( UBaseType_t uxParties );
+ * @endcode
+ *
+ * Create a barrier for uxParties tasks, allocating its memory with
+ * pvPortMalloc().
+ *
+ * @return The handle of the barrier, or NULL if there was not enough heap.
+ *
+ * \defgroup xBarrierCreate xBarrierCreate
+ * \ingroup Barrier
+ */
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+    BarrierHandle_t xBarrierCreate( UBaseType_t uxParties ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * barrier.h
+ * @code{c}
+ * BarrierHandle_t xBarrierCreateStatic( UBaseType_t uxParties, StaticBarrier_t * pxBarrierBuffer );
+ * @endcode
+ *
+ * Create a barrier for uxParties tasks in memory provided by the caller.
+ *
+ * \defgroup xBarrierCreateStatic xBarrierCreateStatic
+ * \ingroup Barrier
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    BarrierHandle_t xBarrierCreateStatic( UBaseType_t uxParties,
+                                          StaticBarrier_t * pxBarrierBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * barrier.h
+ * @code{c}
+ * BaseType_t xBarrierWait( BarrierHandle_t xBarrier, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Arrive at the barrier and wait up to xTicksToWait ticks for the remaining
+ * parties to arrive.
+ *
+ * @return pdTRUE if the barrier opened, or pdFALSE if the wait timed out
+ * first.
+ *
+ * Example usage:
+ * @code{c}
+ * for( ;; )
+ * {
+ *     vProcessStage( xMyStage );
+ *     ( void ) xBarrierWait( xStagesDone, portMAX_DELAY );
+ * }
+ * @endcode
+ *
+ * \defgroup xBarrierWait xBarrierWait
+ * \ingroup Barrier
+ */
+BaseType_t xBarrierWait( BarrierHandle_t xBarrier,
+                         TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * barrier.h
+ * @code{c}
+ * UBaseType_t uxBarrierGetGeneration( BarrierHandle_t xBarrier );
+ * @endcode
+ *
+ * @return The number of times the barrier has opened, modulo the range of
+ * UBaseType_t.
+ *
+ * \defgroup uxBarrierGetGeneration uxBarrierGetGeneration
+ * \ingroup Barrier
+ */
+UBaseType_t uxBarrierGetGeneration( BarrierHandle_t xBarrier ) PRIVILEGED_FUNCTION;
+
+/**
+ * barrier.h
+ * @code{c}
+ * void vBarrierDelete( BarrierHandle_t xBarrier );
+ * @endcode
+ *
+ * Delete a barrier no task is waiting at.
+ *
+ * \defgroup vBarrierDelete vBarrierDelete
+ * \ingroup Barrier
+ */
+void vBarrierDelete( BarrierHandle_t xBarrier ) PRIVILEGED_FUNCTION;
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* BARRIER_H */
@@ -0,0 +1,193 @@
+/*
+ * FreeRTOS Kernel V10.5.1
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef CONDVAR_H
+#define CONDVAR_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include condvar.h"
+#endif
+
+#include "semphr.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * A condition variable lets a task holding a mutex wait until another task
+ * changes the state that mutex protects.  The waiting task releases the mutex
+ * and blocks in one step, so no signal can be lost in between, and holds the
+ * mutex again when the wait returns.
+ *
+ * Each condition variable is bound to one mutex when it is created.  Waiting
+ * tasks are woken in priority order.  A signalled task is not simply readied
+ * to compete for the mutex: it is moved onto the mutex's own list of waiting
+ * tasks, exactly as if it had blocked in xSemaphoreTake(), so a broadcast
+ * hands the mutex from one waiter to the next instead of waking them all to
+ * find it taken.
+ *
+ * As with any condition variable, a wait can return with the condition still
+ * false (another task may have changed it first), so always wait in a loop
+ * that re-tests the condition.
+ *
+ * Condition variables must not be used from interrupts.
+ */
+
+/**
+ * condvar.h
+ *
+ * Type by which condition variables are referenced.
+ *
+ * \defgroup CondVarHandle_t CondVarHandle_t
+ * \ingroup CondVar
+ */
+struct CondVarDef_t;
+typedef struct CondVarDef_t * CondVarHandle_t;
+
+/**
+ * condvar.h
+ * @code{c}
+ * CondVarHandle_t xCondVarCreate( SemaphoreHandle_t xMutex );
+ * @endcode
+ *
+ * Create a condition variable for use with xMutex, which must be a mutex
+ * created with xSemaphoreCreateMutex(), allocating its memory with
+ * pvPortMalloc().
+ *
+ * @return The handle of the condition variable, or NULL if there was not
+ * enough heap.
+ *
+ * \defgroup xCondVarCreate xCondVarCreate
+ * \ingroup CondVar
+ */
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+    CondVarHandle_t xCondVarCreate( SemaphoreHandle_t xMutex ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * condvar.h
+ * @code{c}
+ * CondVarHandle_t xCondVarCreateStatic( SemaphoreHandle_t xMutex, StaticCondVar_t * pxCondVarBuffer );
+ * @endcode
+ *
+ * Create a condition variable for use with xMutex in memory provided by the
+ * caller.
+ *
+ * \defgroup xCondVarCreateStatic xCondVarCreateStatic
+ * \ingroup CondVar
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    CondVarHandle_t xCondVarCreateStatic( SemaphoreHandle_t xMutex,
+                                          StaticCondVar_t * pxCondVarBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * condvar.h
+ * @code{c}
+ * BaseType_t xCondVarWait( CondVarHandle_t xCondVar, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Release the condition variable's mutex, which the calling task must hold,
+ * and wait up to xTicksToWait ticks to be signalled.  The mutex is always
+ * taken again before returning, however long that takes.
+ *
+ * @return pdTRUE if the task was signalled within the block time, even if
+ * taking the mutex again then took longer, otherwise pdFALSE.
+ *
+ * Example usage:
+ * @code{c}
+ * xSemaphoreTake( xMutex, portMAX_DELAY );
+ * while( uxItemsReady == 0 )
+ * {
+ *     ( void ) xCondVarWait( xItemsChanged, portMAX_DELAY );
+ * }
+ * uxItemsReady--;
+ * xSemaphoreGive( xMutex );
+ * @endcode
+ *
+ * \defgroup xCondVarWait xCondVarWait
+ * \ingroup CondVar
+ */
+BaseType_t xCondVarWait( CondVarHandle_t xCondVar,
+                         TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * condvar.h
+ * @code{c}
+ * void vCondVarSignal( CondVarHandle_t xCondVar );
+ * @endcode
+ *
+ * Wake the highest priority task waiting on the condition variable, if any.
+ * The caller need not hold the mutex, but normally does.  A woken task waits
+ * for the mutex as if it were in xSemaphoreTake(), so the holder inherits its
+ * priority.
+ *
+ * \defgroup vCondVarSignal vCondVarSignal
+ * \ingroup CondVar
+ */
+void vCondVarSignal( CondVarHandle_t xCondVar ) PRIVILEGED_FUNCTION;
+
+/**
+ * condvar.h
+ * @code{c}
+ * void vCondVarBroadcast( CondVarHandle_t xCondVar );
+ * @endcode
+ *
+ * Wake every task waiting on the condition variable.  They return from
+ * xCondVarWait() one at a time, in priority order, as the mutex passes
+ * between them.
+ *
+ * \defgroup vCondVarBroadcast vCondVarBroadcast
+ * \ingroup CondVar
+ */
+void vCondVarBroadcast( CondVarHandle_t xCondVar ) PRIVILEGED_FUNCTION;
+
+/**
+ * condvar.h
+ * @code{c}
+ * void vCondVarDelete( CondVarHandle_t xCondVar );
+ * @endcode
+ *
+ * Delete a condition variable no task is waiting on.  Its mutex is not
+ * deleted.
+ *
+ * \defgroup vCondVarDelete vCondVarDelete
+ * \ingroup CondVar
+ */
+void vCondVarDelete( CondVarHandle_t xCondVar ) PRIVILEGED_FUNCTION;
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* CONDVAR_H */
@@ -178,6 +178,28 @@ typedef struct xLIST
     listSECOND_LIST_INTEGRITY_CHECK_VALUE     /*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
 } List_t;
 
+#if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+
+/*
+ * Index kept alongside an event list that is sorted by task priority, so a
+ * task can be inserted in constant time rather than by walking the list.
+ *
+ * An event list sorted by priority is a run of FIFO buckets, one per
+ * priority, highest priority first.  pxLast[ n ] is the last item in the
+ * bucket of items inserted with item value n + 1 (item values are
+ * configMAX_PRIORITIES - uxPriority), and bit n of uxNonEmpty is set while
+ * that bucket holds at least one item.  An item stays in its bucket if its
+ * value changes later, so the owner must remember the bucket.  The list itself is unchanged, so
+ * removing the head and checking for an empty list work as before.
+ */
+    typedef struct xEVENT_LIST_BUCKETS
+    {
+        UBaseType_t uxNonEmpty;
+        struct xLIST_ITEM * pxLast[ configMAX_PRIORITIES ];
+    } EventListBuckets_t;
+
+#endif /* configUSE_EVENT_LIST_BUCKETS */
+
 /*
  * Access macro to set the owner of a list item.  The owner of a list item
  * is the object (usually a TCB) that contains the list item.
@@ -494,6 +516,49 @@ void vListInsertEnd( List_t * const pxList,
  */
 UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+
+/*
+ * Must be called before the buckets of an event list are used.
+ */
+    void vListInitialiseBuckets( EventListBuckets_t * const pxBuckets ) PRIVILEGED_FUNCTION;
+
+/*
+ * Insert a list item into a list sorted in ascending item value order, using
+ * pxBuckets to find the insertion point without walking the list.  The
+ * result is the same as vListInsert(): the item is placed after all items
+ * with an equal or lower value.  The item value must lie between 1 and
+ * configMAX_PRIORITIES.
+ *
+ * @param pxList The list into which the item is to be inserted.
+ *
+ * @param pxBuckets The index that accompanies pxList.
+ *
+ * @param pxNewListItem The item that is to be placed in the list.
+ *
+ * @return The bucket the item was placed in, to be passed to
+ * vListRemoveFromBuckets() when it is removed.
+ */
+    UBaseType_t uxListInsertBucketed( List_t * const pxList,
+                                      EventListBuckets_t * const pxBuckets,
+                                      ListItem_t * const pxNewListItem ) PRIVILEGED_FUNCTION;
+
+/*
+ * Update pxBuckets for the removal of pxItem, which uxListInsertBucketed()
+ * placed in bucket uxBucket.  Must be called while pxItem is still in the
+ * list, immediately before it is removed with uxListRemove() or
+ * listREMOVE_ITEM().
+ *
+ * The bucket is not worked out from the item value, as that can change
+ * while the item is in the list (vTaskPrioritySet() or priority
+ * inheritance) without the item moving.
+ */
+    void vListRemoveFromBuckets( EventListBuckets_t * const pxBuckets,
+                                 UBaseType_t uxBucket,
+                                 const ListItem_t * const pxItem ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_EVENT_LIST_BUCKETS */
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
@@ -641,6 +641,80 @@ typedef StreamBufferHandle_t MessageBufferHandle_t;
 #define xMessageBufferReceiveFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken ) \
     xStreamBufferReceiveFromISR( ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( pxHigherPriorityTaskWoken ) )
 
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * UBaseType_t uxMessageBufferReceiveMany( MessageBufferHandle_t xMessageBuffer,
+ *                                         void *pvRxData,
+ *                                         size_t xBufferLengthBytes,
+ *                                         size_t *pxMessageLengths,
+ *                                         UBaseType_t uxMaxMessages,
+ *                                         TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Receives up to uxMaxMessages whole messages in one call.  The messages are
+ * packed one after another into pvRxData, and the length of each is stored in
+ * the matching element of pxMessageLengths.  A task blocked on the message
+ * buffer waiting for space is notified once for the whole batch, rather than
+ * once per message as with repeated calls to xMessageBufferReceive(), which
+ * keeps a reader handling many small messages off the notification path.
+ *
+ * Messages are taken in order until uxMaxMessages have been read, the message
+ * buffer is empty, or the next message does not fit in the space left in
+ * pvRxData, in which case it is left in the message buffer for the next call.
+ *
+ * The block time is used only when the message buffer is empty, as for
+ * xMessageBufferReceive().  Use uxMessageBufferReceiveManyFromISR() to receive
+ * from an interrupt service routine.
+ *
+ * @param xMessageBuffer The handle of the message buffer from which messages
+ * are being received.
+ *
+ * @param pvRxData A pointer to the buffer into which the messages are copied.
+ *
+ * @param xBufferLengthBytes The length of the buffer pointed to by pvRxData.
+ *
+ * @param pxMessageLengths An array of at least uxMaxMessages elements that
+ * receives the length of each message copied out.
+ *
+ * @param uxMaxMessages The maximum number of messages to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should remain in the
+ * Blocked state to wait for a message, should the message buffer be empty.
+ *
+ * @return The number of messages received, which may be 0 if the call timed
+ * out or the first message does not fit in pvRxData.
+ *
+ * \defgroup uxMessageBufferReceiveMany uxMessageBufferReceiveMany
+ * \ingroup MessageBufferManagement
+ */
+#define uxMessageBufferReceiveMany( xMessageBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, uxMaxMessages, xTicksToWait ) \
+    uxStreamBufferReceiveMessages( ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( pxMessageLengths ), ( uxMaxMessages ), ( xTicksToWait ) )
+
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * UBaseType_t uxMessageBufferReceiveManyFromISR( MessageBufferHandle_t xMessageBuffer,
+ *                                                void *pvRxData,
+ *                                                size_t xBufferLengthBytes,
+ *                                                size_t *pxMessageLengths,
+ *                                                UBaseType_t uxMaxMessages,
+ *                                                BaseType_t *pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * A version of uxMessageBufferReceiveMany() that can be called from an
+ * interrupt service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if
+ * the notification sent for the batch unblocked a task with a priority above
+ * that of the interrupted task, as for xMessageBufferReceiveFromISR().
+ *
+ * \defgroup uxMessageBufferReceiveManyFromISR uxMessageBufferReceiveManyFromISR
+ * \ingroup MessageBufferManagement
+ */
+#define uxMessageBufferReceiveManyFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, uxMaxMessages, pxHigherPriorityTaskWoken ) \
+    uxStreamBufferReceiveMessagesFromISR( ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( pxMessageLengths ), ( uxMaxMessages ), ( pxHigherPriorityTaskWoken ) )
+
 /**
  * message_buffer.h
  *
@@ -847,6 +921,67 @@ typedef StreamBufferHandle_t MessageBufferHandle_t;
 #define xMessageBufferReceiveCompletedFromISR( xMessageBuffer, pxHigherPriorityTaskWoken ) \
     xStreamBufferReceiveCompletedFromISR( ( xMessageBuffer ), ( pxHigherPriorityTaskWoken ) )
 
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * size_t xMessageBufferSendAcquire( MessageBufferHandle_t xMessageBuffer,
+ *                                   size_t xDataLengthBytes,
+ *                                   StreamBufferSegments_t * const pxSegments,
+ *                                   TickType_t xTicksToWait );
+ * size_t xMessageBufferSendCommit( MessageBufferHandle_t xMessageBuffer,
+ *                                  size_t xDataLengthBytes );
+ * size_t xMessageBufferSendCommitFromISR( MessageBufferHandle_t xMessageBuffer,
+ *                                         size_t xDataLengthBytes,
+ *                                         BaseType_t * const pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * Writes a message in place.  The acquire returns a region for a message of
+ * up to xDataLengthBytes bytes, or 0 if the whole message does not fit; the
+ * commit writes the length prefix for the xDataLengthBytes actually written
+ * and makes the message available to the reader.  See
+ * xStreamBufferSendAcquire() and xStreamBufferSendCommit().
+ *
+ * \defgroup xMessageBufferSendAcquire xMessageBufferSendAcquire
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendAcquire( xMessageBuffer, xDataLengthBytes, pxSegments, xTicksToWait ) \
+    xStreamBufferSendAcquire( ( xMessageBuffer ), ( xDataLengthBytes ), ( pxSegments ), ( xTicksToWait ) )
+#define xMessageBufferSendCommit( xMessageBuffer, xDataLengthBytes ) \
+    xStreamBufferSendCommit( ( xMessageBuffer ), ( xDataLengthBytes ) )
+#define xMessageBufferSendCommitFromISR( xMessageBuffer, xDataLengthBytes, pxHigherPriorityTaskWoken ) \
+    xStreamBufferSendCommitFromISR( ( xMessageBuffer ), ( xDataLengthBytes ), ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * size_t xMessageBufferReceiveAcquire( MessageBufferHandle_t xMessageBuffer,
+ *                                      StreamBufferSegments_t * const pxSegments,
+ *                                      TickType_t xTicksToWait );
+ * size_t xMessageBufferReceiveRelease( MessageBufferHandle_t xMessageBuffer,
+ *                                      size_t xBytesConsumed );
+ * size_t xMessageBufferReceiveReleaseFromISR( MessageBufferHandle_t xMessageBuffer,
+ *                                             size_t xBytesConsumed,
+ *                                             BaseType_t * const pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * Reads the next message in place.  The acquire returns the message, without
+ * its length prefix, as up to two segments of the buffer's storage area; the
+ * release removes the whole message, and xBytesConsumed must be the length the
+ * acquire returned.  See xStreamBufferReceiveAcquire() and
+ * xStreamBufferReceiveRelease().
+ *
+ * \defgroup xMessageBufferReceiveAcquire xMessageBufferReceiveAcquire
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceiveAcquire( xMessageBuffer, pxSegments, xTicksToWait ) \
+    xStreamBufferReceiveAcquire( ( xMessageBuffer ), ( pxSegments ), ( xTicksToWait ) )
+#define xMessageBufferReceiveRelease( xMessageBuffer, xBytesConsumed ) \
+    xStreamBufferReceiveRelease( ( xMessageBuffer ), ( xBytesConsumed ) )
+#define xMessageBufferReceiveReleaseFromISR( xMessageBuffer, xBytesConsumed, pxHigherPriorityTaskWoken ) \
+    xStreamBufferReceiveReleaseFromISR( ( xMessageBuffer ), ( xBytesConsumed ), ( pxHigherPriorityTaskWoken ) )
+
 /* *INDENT-OFF* */
 #if defined( __cplusplus )
     } /* extern "C" */
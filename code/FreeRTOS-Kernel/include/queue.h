@@ -68,6 +68,8 @@ typedef struct QueueDefinition   * QueueSetMemberHandle_t;
 #define queueSEND_TO_BACK                     ( ( BaseType_t ) 0 )
 #define queueSEND_TO_FRONT                    ( ( BaseType_t ) 1 )
 #define queueOVERWRITE                        ( ( BaseType_t ) 2 )
+#define queuePRIORITY_FLAG                    ( ( BaseType_t ) 0x100 )
+#define queueSEND_WITH_PRIORITY( uxPriority )    ( queuePRIORITY_FLAG | ( ( BaseType_t ) ( uxPriority ) & ( BaseType_t ) 0xff ) )
 
 /* For internal use only.  These definitions *must* match those in queue.c. */
 #define queueQUEUE_TYPE_BASE                  ( ( uint8_t ) 0U )
@@ -149,6 +151,145 @@ typedef struct QueueDefinition   * QueueSetMemberHandle_t;
     #define xQueueCreate( uxQueueLength, uxItemSize )    xQueueGenericCreate( ( uxQueueLength ), ( uxItemSize ), ( queueQUEUE_TYPE_BASE ) )
 #endif
 
+/**
+ * queue. h
+ * @code{c}
+ * QueueHandle_t xQueueCreatePriority(
+ *                            UBaseType_t uxQueueLength,
+ *                            UBaseType_t uxItemSize
+ *                        );
+ * @endcode
+ *
+ * Creates a queue whose items are received in order of message priority
+ * rather than the order in which they were sent.  Items are sent with
+ * xQueueSendWithPriority() or xQueueSendWithPriorityFromISR(), and items of
+ * equal priority are received first in, first out, so urgent messages bypass
+ * a backlog of less urgent ones.  Otherwise the queue behaves as one created
+ * by xQueueCreate(): the receive, peek and blocking functions are the same,
+ * and it can be added to a queue set.
+ *
+ * xQueueSendToBack() sends at priority 0, and xQueueSendToFront() at the
+ * highest priority, 255.  xQueueOverwrite() cannot be used.
+ *
+ * Each slot costs one byte more than in a FIFO queue.  Sending moves each
+ * waiting item of lower priority back one slot, with interrupts masked, so the
+ * length is limited to configPRIORITY_QUEUE_MAX_LENGTH (16 by default), which
+ * bounds that time.  configUSE_PRIORITY_QUEUES must be set to 1 in
+ * FreeRTOSConfig.h for this function to be available.
+ *
+ * @param uxQueueLength The maximum number of items that the queue can contain,
+ * from 1 to configPRIORITY_QUEUE_MAX_LENGTH.
+ *
+ * @param uxItemSize The number of bytes each item in the queue will require,
+ * which must not be zero.
+ *
+ * @return If the queue is successfully created then a handle to the newly
+ * created queue is returned.  If the queue cannot be created then 0 is
+ * returned.
+ *
+ * \defgroup xQueueCreatePriority xQueueCreatePriority
+ * \ingroup QueueManagement
+ */
+#if ( ( configUSE_PRIORITY_QUEUES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+    QueueHandle_t xQueueCreatePriority( const UBaseType_t uxQueueLength,
+                                        const UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * queue. h
+ * @code{c}
+ * QueueHandle_t xQueueCreatePriorityStatic(
+ *                            UBaseType_t uxQueueLength,
+ *                            UBaseType_t uxItemSize,
+ *                            uint8_t *pucQueueStorage,
+ *                            StaticQueue_t *pxQueueBuffer
+ *                        );
+ * @endcode
+ *
+ * Creates a priority queue, as xQueueCreatePriority(), in memory provided by
+ * the caller instead of the heap.
+ *
+ * @param uxQueueLength The maximum number of items that the queue can contain,
+ * from 1 to configPRIORITY_QUEUE_MAX_LENGTH.
+ *
+ * @param uxItemSize The number of bytes each item in the queue will require,
+ * which must not be zero.
+ *
+ * @param pucQueueStorage Must point to a uint8_t array of at least
+ * ( uxQueueLength * ( uxItemSize + 1 ) ) bytes, which will hold the items and
+ * their priorities.
+ *
+ * @param pxQueueBuffer Must point to a variable of type StaticQueue_t, which
+ * will be used to hold the queue's data structure.
+ *
+ * @return If the queue is created then a handle to the created queue is
+ * returned.  If an argument is out of range then NULL is returned.
+ *
+ * \defgroup xQueueCreatePriorityStatic xQueueCreatePriorityStatic
+ * \ingroup QueueManagement
+ */
+#if ( ( configUSE_PRIORITY_QUEUES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+    QueueHandle_t xQueueCreatePriorityStatic( const UBaseType_t uxQueueLength,
+                                              const UBaseType_t uxItemSize,
+                                              uint8_t * pucQueueStorage,
+                                              StaticQueue_t * pxStaticQueue ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueSendWithPriority(
+ *                                 QueueHandle_t xQueue,
+ *                                 const void *pvItemToQueue,
+ *                                 UBaseType_t uxPriority,
+ *                                 TickType_t xTicksToWait
+ *                            );
+ * @endcode
+ *
+ * Posts an item to a queue created with xQueueCreatePriority().  The item is
+ * placed behind any items of priority uxPriority or higher, and ahead of all
+ * items of lower priority.  Blocking behaves as for xQueueSend().
+ *
+ * @param xQueue The handle to the queue on which the item is to be posted.
+ *
+ * @param pvItemToQueue A pointer to the item that is to be placed on the
+ * queue.
+ *
+ * @param uxPriority The priority of the item, from 0 (least urgent) to 255.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue, should it already
+ * be full.
+ *
+ * @return pdTRUE if the item was successfully posted, otherwise errQUEUE_FULL.
+ *
+ * \defgroup xQueueSendWithPriority xQueueSendWithPriority
+ * \ingroup QueueManagement
+ */
+#define xQueueSendWithPriority( xQueue, pvItemToQueue, uxPriority, xTicksToWait ) \
+    xQueueGenericSend( ( xQueue ), ( pvItemToQueue ), ( xTicksToWait ), queueSEND_WITH_PRIORITY( uxPriority ) )
+
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueSendWithPriorityFromISR(
+ *                                     QueueHandle_t xQueue,
+ *                                     const void *pvItemToQueue,
+ *                                     UBaseType_t uxPriority,
+ *                                     BaseType_t *pxHigherPriorityTaskWoken
+ *                                );
+ * @endcode
+ *
+ * A version of xQueueSendWithPriority() that can be used in an interrupt
+ * service routine.  See xQueueSendFromISR() for the use of
+ * pxHigherPriorityTaskWoken.
+ *
+ * \defgroup xQueueSendWithPriorityFromISR xQueueSendWithPriorityFromISR
+ * \ingroup QueueManagement
+ */
+#define xQueueSendWithPriorityFromISR( xQueue, pvItemToQueue, uxPriority, pxHigherPriorityTaskWoken ) \
+    xQueueGenericSendFromISR( ( xQueue ), ( pvItemToQueue ), ( pxHigherPriorityTaskWoken ), queueSEND_WITH_PRIORITY( uxPriority ) )
+
 /**
  * queue. h
  * @code{c}
@@ -1711,6 +1852,11 @@ void vQueueSetQueueNumber( QueueHandle_t xQueue,
                            UBaseType_t uxQueueNumber ) PRIVILEGED_FUNCTION;
 UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
 uint8_t ucQueueGetQueueType( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+#if ( configUSE_CONDVARS == 1 )
+    UBaseType_t uxQueueMoveWaitersToMutex( QueueHandle_t xMutex,
+                                           List_t * const pxEventList,
+                                           const UBaseType_t uxMaxTasks ) PRIVILEGED_FUNCTION;
+#endif
 
 
 /* *INDENT-OFF* */
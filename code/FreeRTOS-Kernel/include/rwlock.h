@@ -0,0 +1,191 @@
+/*
+ * FreeRTOS Kernel V10.5.1
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include rwlock.h"
+#endif
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * A reader-writer lock protects data that is read often and written rarely.
+ * Any number of tasks may hold the lock for reading at the same time, or one
+ * task may hold it for writing.
+ *
+ * Writers are preferred: once a writer is waiting, new readers block until
+ * it has had its turn, so a steady stream of readers cannot starve a writer.
+ * When a writer releases the lock every reader waiting at that moment is let
+ * in before the next writer, so a steady stream of writers cannot starve the
+ * readers either.  Waiting writers are served in priority order.
+ *
+ * The lock is handed directly to the tasks it wakes, so a woken task never
+ * has to compete for it again.
+ *
+ * A task holding the lock for writing inherits the priority of any higher
+ * priority task that blocks on the lock, exactly as a mutex holder does.
+ * Readers do not inherit priority, as there may be many of them.
+ *
+ * Reader-writer locks must not be used from interrupts, and a task must not
+ * take the lock again while already holding it.
+ */
+
+/**
+ * rwlock.h
+ *
+ * Type by which reader-writer locks are referenced.
+ *
+ * \defgroup RWLockHandle_t RWLockHandle_t
+ * \ingroup RWLock
+ */
+struct RWLockDef_t;
+typedef struct RWLockDef_t * RWLockHandle_t;
+
+/**
+ * rwlock.h
+ * @code{c}
+ * RWLockHandle_t xRWLockCreate( void );
+ * @endcode
+ *
+ * Create a reader-writer lock, allocating its memory with pvPortMalloc().
+ *
+ * @return The handle of the lock, or NULL if there was not enough heap.
+ *
+ * \defgroup xRWLockCreate xRWLockCreate
+ * \ingroup RWLock
+ */
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+    RWLockHandle_t xRWLockCreate( void ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * rwlock.h
+ * @code{c}
+ * RWLockHandle_t xRWLockCreateStatic( StaticRWLock_t * pxRWLockBuffer );
+ * @endcode
+ *
+ * Create a reader-writer lock in memory provided by the caller.
+ *
+ * @param pxRWLockBuffer A StaticRWLock_t variable that will hold the lock.
+ *
+ * @return The handle of the lock.
+ *
+ * \defgroup xRWLockCreateStatic xRWLockCreateStatic
+ * \ingroup RWLock
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    RWLockHandle_t xRWLockCreateStatic( StaticRWLock_t * pxRWLockBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * rwlock.h
+ * @code{c}
+ * BaseType_t xRWLockTakeRead( RWLockHandle_t xRWLock, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Take the lock for reading, waiting up to xTicksToWait ticks while it is
+ * held for writing or a writer is waiting for it.
+ *
+ * @return pdTRUE if the lock was taken, pdFALSE if the wait timed out.
+ *
+ * \defgroup xRWLockTakeRead xRWLockTakeRead
+ * \ingroup RWLock
+ */
+BaseType_t xRWLockTakeRead( RWLockHandle_t xRWLock,
+                            TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * rwlock.h
+ * @code{c}
+ * void vRWLockGiveRead( RWLockHandle_t xRWLock );
+ * @endcode
+ *
+ * Release a lock taken with xRWLockTakeRead().
+ *
+ * \defgroup vRWLockGiveRead vRWLockGiveRead
+ * \ingroup RWLock
+ */
+void vRWLockGiveRead( RWLockHandle_t xRWLock ) PRIVILEGED_FUNCTION;
+
+/**
+ * rwlock.h
+ * @code{c}
+ * BaseType_t xRWLockTakeWrite( RWLockHandle_t xRWLock, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Take the lock for writing, waiting up to xTicksToWait ticks for any
+ * readers and any other writer to release it.
+ *
+ * @return pdTRUE if the lock was taken, pdFALSE if the wait timed out.
+ *
+ * \defgroup xRWLockTakeWrite xRWLockTakeWrite
+ * \ingroup RWLock
+ */
+BaseType_t xRWLockTakeWrite( RWLockHandle_t xRWLock,
+                             TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * rwlock.h
+ * @code{c}
+ * void vRWLockGiveWrite( RWLockHandle_t xRWLock );
+ * @endcode
+ *
+ * Release a lock taken with xRWLockTakeWrite().  Only the task that took the
+ * lock may release it.
+ *
+ * \defgroup vRWLockGiveWrite vRWLockGiveWrite
+ * \ingroup RWLock
+ */
+void vRWLockGiveWrite( RWLockHandle_t xRWLock ) PRIVILEGED_FUNCTION;
+
+/**
+ * rwlock.h
+ * @code{c}
+ * void vRWLockDelete( RWLockHandle_t xRWLock );
+ * @endcode
+ *
+ * Delete a lock that no task holds or is waiting for.
+ *
+ * \defgroup vRWLockDelete vRWLockDelete
+ * \ingroup RWLock
+ */
+void vRWLockDelete( RWLockHandle_t xRWLock ) PRIVILEGED_FUNCTION;
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* RWLOCK_H */
@@ -71,6 +71,19 @@
 struct StreamBufferDef_t;
 typedef struct StreamBufferDef_t * StreamBufferHandle_t;
 
+/**
+ * Describes a region of a stream buffer's storage area handed out by
+ * xStreamBufferSendAcquire() or xStreamBufferReceiveAcquire().  The region is
+ * contiguous unless it wraps around the end of the storage area, in which case
+ * it continues at the start in the second segment.  Unused segments have a
+ * NULL pointer and a zero length.
+ */
+typedef struct xSTREAM_BUFFER_SEGMENTS
+{
+    uint8_t * pucData[ 2 ];
+    size_t xLength[ 2 ];
+} StreamBufferSegments_t;
+
 /**
  *  Type used as a stream buffer's optional callback.
  */
@@ -879,6 +892,195 @@ BaseType_t xStreamBufferSendCompletedFromISR( StreamBufferHandle_t xStreamBuffer
 BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuffer,
                                                  BaseType_t * pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+ *                                  size_t xDataLengthBytes,
+ *                                  StreamBufferSegments_t * const pxSegments,
+ *                                  TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Obtains a region of the stream buffer's own storage area into which up to
+ * xDataLengthBytes bytes can be written in place, for example by a DMA
+ * channel, instead of being copied in by xStreamBufferSend().  Nothing is
+ * visible to the reader until xStreamBufferSendCommit() is called.
+ *
+ * The region is described by up to two segments, as it may wrap around the
+ * end of the storage area.  Data must be written to the first segment before
+ * the second.
+ *
+ * For a message buffer the region is for exactly one message of
+ * xDataLengthBytes bytes and the length prefix is written by the commit; for
+ * a stream buffer the region may be shorter than requested.
+ *
+ * As with xStreamBufferSend(), only one task or interrupt may write to a
+ * stream buffer, and it must not mix this function with xStreamBufferSend()
+ * between an acquire and its commit.  Call with xTicksToWait set to 0 from an
+ * interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to write to.
+ *
+ * @param xDataLengthBytes The number of bytes the caller wants to write.
+ *
+ * @param pxSegments Receives the writable region.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should remain
+ * in the Blocked state to wait for enough space, as for xStreamBufferSend().
+ *
+ * @return The number of bytes that may be written, which is the sum of the
+ * segment lengths.  0 if there is no space.
+ *
+ * \defgroup xStreamBufferSendAcquire xStreamBufferSendAcquire
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+                                 size_t xDataLengthBytes,
+                                 StreamBufferSegments_t * const pxSegments,
+                                 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer,
+ *                                 size_t xDataLengthBytes );
+ * @endcode
+ *
+ * Makes the first xDataLengthBytes bytes of the region obtained from
+ * xStreamBufferSendAcquire() available to the reader, unblocking a waiting
+ * reader if the trigger level has been reached.  xDataLengthBytes must not
+ * exceed the value returned by the acquire, and may be 0 to abandon the
+ * region.  For a message buffer it is the length of the message, which may
+ * be shorter than was acquired.
+ *
+ * Use xStreamBufferSendCommitFromISR() to commit from an interrupt service
+ * routine, such as the DMA transfer complete interrupt.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being written.
+ *
+ * @param xDataLengthBytes The number of bytes written into the region.
+ *
+ * @return The number of bytes committed.
+ *
+ * \defgroup xStreamBufferSendCommit xStreamBufferSendCommit
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer,
+                                size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+ *                                        size_t xDataLengthBytes,
+ *                                        BaseType_t * const pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * A version of xStreamBufferSendCommit() that can be called from an interrupt
+ * service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if the commit
+ * unblocked a task of higher priority than the one that was interrupted, as
+ * for xStreamBufferSendFromISR().
+ *
+ * \defgroup xStreamBufferSendCommitFromISR xStreamBufferSendCommitFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+                                       size_t xDataLengthBytes,
+                                       BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+ *                                     StreamBufferSegments_t * const pxSegments,
+ *                                     TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Obtains the data in the stream buffer as a region of its storage area that
+ * can be parsed in place, instead of being copied out by
+ * xStreamBufferReceive().  The data stays in the buffer until
+ * xStreamBufferReceiveRelease() is called.
+ *
+ * For a stream buffer the region holds all the bytes currently available.
+ * For a message buffer it holds the next message, without its length prefix.
+ * The region is described by up to two segments, as it may wrap around the end
+ * of the storage area.
+ *
+ * As with xStreamBufferReceive(), only one task or interrupt may read from a
+ * stream buffer.  Call with xTicksToWait set to 0 from an interrupt service
+ * routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to read from.
+ *
+ * @param pxSegments Receives the readable region.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should remain
+ * in the Blocked state to wait for data, as for xStreamBufferReceive().
+ *
+ * @return The number of bytes in the region, which is the sum of the segment
+ * lengths.  0 if the buffer is empty.
+ *
+ * \defgroup xStreamBufferReceiveAcquire xStreamBufferReceiveAcquire
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+                                    StreamBufferSegments_t * const pxSegments,
+                                    TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferReceiveRelease( StreamBufferHandle_t xStreamBuffer,
+ *                                     size_t xBytesConsumed );
+ * @endcode
+ *
+ * Removes the first xBytesConsumed bytes of the region obtained from
+ * xStreamBufferReceiveAcquire() from the buffer, unblocking a writer waiting
+ * for space.  A stream buffer may be released in parts; a message is always
+ * released whole, so for a message buffer xBytesConsumed must be the length
+ * returned by the acquire.
+ *
+ * Use xStreamBufferReceiveReleaseFromISR() to release from an interrupt service
+ * routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being read.
+ *
+ * @param xBytesConsumed The number of bytes to remove.
+ *
+ * @return The number of bytes removed.
+ *
+ * \defgroup xStreamBufferReceiveRelease xStreamBufferReceiveRelease
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveRelease( StreamBufferHandle_t xStreamBuffer,
+                                    size_t xBytesConsumed ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferReceiveReleaseFromISR( StreamBufferHandle_t xStreamBuffer,
+ *                                            size_t xBytesConsumed,
+ *                                            BaseType_t * const pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * A version of xStreamBufferReceiveRelease() that can be called from an
+ * interrupt service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if
+ * the release unblocked a task of higher priority than the one that was
+ * interrupted, as for xStreamBufferReceiveFromISR().
+ *
+ * \defgroup xStreamBufferReceiveReleaseFromISR xStreamBufferReceiveReleaseFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveReleaseFromISR( StreamBufferHandle_t xStreamBuffer,
+                                           size_t xBytesConsumed,
+                                           BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /* Functions below here are not part of the public API. */
 StreamBufferHandle_t xStreamBufferGenericCreate( size_t xBufferSizeBytes,
                                                  size_t xTriggerLevelBytes,
@@ -897,6 +1099,20 @@ StreamBufferHandle_t xStreamBufferGenericCreateStatic( size_t xBufferSizeBytes,
 
 size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer ) PRIVILEGED_FUNCTION;
 
+UBaseType_t uxStreamBufferReceiveMessages( StreamBufferHandle_t xStreamBuffer,
+                                           void * pvRxData,
+                                           size_t xBufferLengthBytes,
+                                           size_t * const pxMessageLengths,
+                                           UBaseType_t uxMaxMessages,
+                                           TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+UBaseType_t uxStreamBufferReceiveMessagesFromISR( StreamBufferHandle_t xStreamBuffer,
+                                                  void * pvRxData,
+                                                  size_t xBufferLengthBytes,
+                                                  size_t * const pxMessageLengths,
+                                                  UBaseType_t uxMaxMessages,
+                                                  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 #if ( configUSE_TRACE_FACILITY == 1 )
     void vStreamBufferSetStreamBufferNumber( StreamBufferHandle_t xStreamBuffer,
                                              UBaseType_t uxStreamBufferNumber ) PRIVILEGED_FUNCTION;
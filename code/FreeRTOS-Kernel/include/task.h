@@ -122,6 +122,19 @@ typedef struct xTIME_OUT
     TickType_t xTimeOnEntering;
 } TimeOut_t;
 
+/*
+ * Used internally only.  A lock that takes part in priority inheritance,
+ * linked into the list of locks its holder has.  pxWaitingTasks[] are the
+ * priority ordered lists of tasks blocked on the lock; unused entries are NULL.
+ */
+#define taskHELD_LOCK_WAIT_LISTS    2
+
+typedef struct xHELD_LOCK
+{
+    struct xHELD_LOCK * pxNext;
+    const List_t * pxWaitingTasks[ taskHELD_LOCK_WAIT_LISTS ];
+} HeldLock_t;
+
 /*
  * Defines the memory ranges allocated to the task when an MPU is used.
  */
@@ -2960,6 +2973,24 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList,
                                      const TickType_t xItemValue,
                                      const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * THIS FUNCTION MUST BE CALLED WITH INTERRUPTS DISABLED OR THE SCHEDULER
+ * SUSPENDED AND THE QUEUE BEING ACCESSED LOCKED.
+ *
+ * Equivalent to vTaskPlaceOnEventList(), but finds the insertion point in
+ * constant time using the buckets that accompany pxEventList, rather than
+ * walking the list.  The task remembers pxBuckets so the buckets are kept up
+ * to date however the task later leaves the event list.
+ */
+#if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+    void vTaskPlaceOnBucketedEventList( List_t * const pxEventList,
+                                        EventListBuckets_t * const pxBuckets,
+                                        const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -2975,6 +3006,48 @@ void vTaskPlaceOnEventListRestricted( List_t * const pxEventList,
                                       TickType_t xTicksToWait,
                                       const BaseType_t xWaitIndefinitely ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * THIS FUNCTION MUST BE CALLED FROM A CRITICAL SECTION.
+ *
+ * Move the highest priority task waiting on pxFromList, which must be in
+ * priority order, to its place in pxToList, leaving the task blocked with its
+ * original timeout, and return the task's priority.  Used by condition
+ * variables to requeue waiters on their mutex.  The item value is reset to the
+ * task's priority, clearing any flags vTaskPlaceOnFlaggedEventList() set.  The
+ * bucketed version keeps the buckets indexing pxToList up to date.
+ */
+#if ( configUSE_CONDVARS == 1 )
+    UBaseType_t uxTaskMoveToEventList( List_t * const pxFromList,
+                                       List_t * const pxToList ) PRIVILEGED_FUNCTION;
+
+    #if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+        UBaseType_t uxTaskMoveToBucketedEventList( List_t * const pxFromList,
+                                                   List_t * const pxToList,
+                                                   EventListBuckets_t * const pxBuckets ) PRIVILEGED_FUNCTION;
+    #endif
+#endif
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED.
+ *
+ * As vTaskPlaceOnEventList(), but xItemFlags are kept in the event list item
+ * value alongside the priority until uxTaskMoveToEventList() moves the task
+ * on, so on waking the task can tell a move from a timeout with
+ * uxTaskResetEventItemValue().  Every task on pxEventList must be placed with
+ * the same flags for the list to stay in priority order.
+ */
+#if ( configUSE_CONDVARS == 1 )
+    void vTaskPlaceOnFlaggedEventList( List_t * const pxEventList,
+                                       const TickType_t xItemFlags,
+                                       const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -3042,12 +3115,29 @@ BaseType_t xTaskGetSchedulerState( void ) PRIVILEGED_FUNCTION;
  */
 BaseType_t xTaskPriorityInherit( TaskHandle_t const pxMutexHolder ) PRIVILEGED_FUNCTION;
 
+/*
+ * As xTaskPriorityInherit(), but for a waiting task other than the calling
+ * task, of priority uxWaiterPriority.  Used when condition variables queue a
+ * signalled task on the mutex on its behalf.
+ */
+BaseType_t xTaskPriorityInheritFrom( TaskHandle_t const pxMutexHolder,
+                                     const UBaseType_t uxWaiterPriority ) PRIVILEGED_FUNCTION;
+
 /*
  * Set the priority of a task back to its proper priority in the case that it
  * inherited a higher priority while it was holding a semaphore.
  */
 BaseType_t xTaskPriorityDisinherit( TaskHandle_t const pxMutexHolder ) PRIVILEGED_FUNCTION;
 
+/*
+ * As xTaskPriorityDisinherit(), for a lock that was registered with
+ * pvTaskAddHeldLock().  pxLock is removed from the locks the holder has, and
+ * the holder keeps the priority of the highest priority task still waiting for
+ * any of the others.
+ */
+BaseType_t xTaskPriorityDisinheritLock( TaskHandle_t const pxMutexHolder,
+                                        HeldLock_t * const pxLock ) PRIVILEGED_FUNCTION;
+
 /*
  * If a higher priority task attempting to obtain a mutex caused a lower
  * priority task to inherit the higher priority task's priority - but the higher
@@ -3103,6 +3193,15 @@ eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
  */
 TaskHandle_t pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  Count pxLock as held by xTask, or by the calling task
+ * if xTask is NULL, so the priority the task inherits through it can be
+ * recalculated when any lock it holds is released.  Returns the handle of the
+ * task, or NULL if the scheduler has no tasks yet.
+ */
+TaskHandle_t pvTaskAddHeldLock( TaskHandle_t xTask,
+                                HeldLock_t * const pxLock ) PRIVILEGED_FUNCTION;
+
 /*
  * For internal use only.  Same as vTaskSetTimeOutState(), but without a critical
  * section.
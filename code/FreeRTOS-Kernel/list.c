@@ -224,3 +224,141 @@ UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove )
     return pxList->uxNumberOfItems;
 }
 /*-----------------------------------------------------------*/
+
+#if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+
+    void vListInitialiseBuckets( EventListBuckets_t * const pxBuckets )
+    {
+        UBaseType_t uxBucket;
+
+        pxBuckets->uxNonEmpty = ( UBaseType_t ) 0U;
+
+        for( uxBucket = ( UBaseType_t ) 0U; uxBucket < ( UBaseType_t ) configMAX_PRIORITIES; uxBucket++ )
+        {
+            pxBuckets->pxLast[ uxBucket ] = NULL;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxListInsertBucketed( List_t * const pxList,
+                                      EventListBuckets_t * const pxBuckets,
+                                      ListItem_t * const pxNewListItem )
+    {
+        ListItem_t * pxIterator;
+        UBaseType_t uxBucket, uxEarlierBuckets, uxPreceding;
+
+        listTEST_LIST_INTEGRITY( pxList );
+        listTEST_LIST_ITEM_INTEGRITY( pxNewListItem );
+
+        uxBucket = ( UBaseType_t ) pxNewListItem->xItemValue - ( UBaseType_t ) 1U;
+        configASSERT( uxBucket < ( UBaseType_t ) configMAX_PRIORITIES );
+
+        /* The new item goes after the last item of the lowest priority bucket
+         * that is not lower than its own.  With no such bucket it becomes the
+         * new head of the list. */
+        uxEarlierBuckets = pxBuckets->uxNonEmpty & ( ( ( UBaseType_t ) 2U << uxBucket ) - ( UBaseType_t ) 1U );
+
+        if( uxEarlierBuckets != ( UBaseType_t ) 0U )
+        {
+            #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+            {
+                portGET_HIGHEST_PRIORITY( uxPreceding, uxEarlierBuckets );
+            }
+            #else
+            {
+                uxPreceding = uxBucket;
+
+                while( ( uxEarlierBuckets & ( ( UBaseType_t ) 1U << uxPreceding ) ) == ( UBaseType_t ) 0U )
+                {
+                    uxPreceding--;
+                }
+            }
+            #endif
+
+            pxIterator = pxBuckets->pxLast[ uxPreceding ];
+            configASSERT( pxIterator->pxContainer == pxList );
+        }
+        else
+        {
+            pxIterator = ( ListItem_t * ) &( pxList->xListEnd ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+        }
+
+        pxNewListItem->pxNext = pxIterator->pxNext;
+        pxNewListItem->pxNext->pxPrevious = pxNewListItem;
+        pxNewListItem->pxPrevious = pxIterator;
+        pxIterator->pxNext = pxNewListItem;
+
+        pxNewListItem->pxContainer = pxList;
+
+        ( pxList->uxNumberOfItems )++;
+
+        pxBuckets->pxLast[ uxBucket ] = pxNewListItem;
+        pxBuckets->uxNonEmpty |= ( UBaseType_t ) 1U << uxBucket;
+
+        return uxBucket;
+    }
+/*-----------------------------------------------------------*/
+
+    void vListRemoveFromBuckets( EventListBuckets_t * const pxBuckets,
+                                 UBaseType_t uxBucket,
+                                 const ListItem_t * const pxItem )
+    {
+        UBaseType_t uxEarlierBuckets, uxPreceding;
+        ListItem_t * pxPrevious;
+        const ListItem_t * pxFirst;
+
+        configASSERT( uxBucket < ( UBaseType_t ) configMAX_PRIORITIES );
+        configASSERT( ( pxBuckets->uxNonEmpty & ( ( UBaseType_t ) 1U << uxBucket ) ) != ( UBaseType_t ) 0U );
+
+        /* Only the last item of a bucket is indexed. */
+        if( pxBuckets->pxLast[ uxBucket ] == pxItem )
+        {
+            /* The item before the bucket's first item is the last item of the
+             * nearest non-empty bucket ahead of it, or the list end marker if
+             * there is none.  If the item's predecessor is that item then the
+             * bucket empties, otherwise the predecessor becomes its last. */
+            uxEarlierBuckets = pxBuckets->uxNonEmpty & ( ( ( UBaseType_t ) 1U << uxBucket ) - ( UBaseType_t ) 1U );
+
+            if( uxEarlierBuckets != ( UBaseType_t ) 0U )
+            {
+                #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+                {
+                    portGET_HIGHEST_PRIORITY( uxPreceding, uxEarlierBuckets );
+                }
+                #else
+                {
+                    uxPreceding = uxBucket - ( UBaseType_t ) 1U;
+
+                    while( ( uxEarlierBuckets & ( ( UBaseType_t ) 1U << uxPreceding ) ) == ( UBaseType_t ) 0U )
+                    {
+                        uxPreceding--;
+                    }
+                }
+                #endif
+
+                pxFirst = pxBuckets->pxLast[ uxPreceding ];
+            }
+            else
+            {
+                pxFirst = ( const ListItem_t * ) &( ( ( List_t * ) pxItem->pxContainer )->xListEnd ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+            }
+
+            pxPrevious = pxItem->pxPrevious;
+
+            if( pxPrevious == pxFirst )
+            {
+                pxBuckets->uxNonEmpty &= ~( ( UBaseType_t ) 1U << uxBucket );
+            }
+            else
+            {
+                pxBuckets->pxLast[ uxBucket ] = pxPrevious;
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_EVENT_LIST_BUCKETS */
+/*-----------------------------------------------------------*/
@@ -54,6 +54,28 @@
 #define queueLOCKED_UNMODIFIED    ( ( int8_t ) 0 )
 #define queueINT8_MAX             ( ( int8_t ) 127 )
 
+/* Copies one item into or out of the queue storage area.  Most queues carry a
+ * single word - a uint32_t or, on 32-bit ports, a pointer - so when
+ * configUSE_QUEUE_WORD_COPY is 1 those get a copy of constant size, which the
+ * compiler reduces to one load and one store instead of a call to memcpy() with
+ * a length only known at run time. */
+#if ( configUSE_QUEUE_WORD_COPY == 1 )
+    #define queueCOPY_ITEM( pvDestination, pvSource, uxItemSize )                           \
+    {                                                                                       \
+        if( ( uxItemSize ) == ( UBaseType_t ) sizeof( uint32_t ) )                          \
+        {                                                                                   \
+            ( void ) memcpy( ( pvDestination ), ( pvSource ), sizeof( uint32_t ) );         \
+        }                                                                                   \
+        else                                                                                \
+        {                                                                                   \
+            ( void ) memcpy( ( pvDestination ), ( pvSource ), ( size_t ) ( uxItemSize ) ); \
+        }                                                                                   \
+    }
+#else
+    #define queueCOPY_ITEM( pvDestination, pvSource, uxItemSize ) \
+    ( void ) memcpy( ( pvDestination ), ( pvSource ), ( size_t ) ( uxItemSize ) )
+#endif
+
 /* When the Queue_t structure is used to represent a base queue its pcHead and
  * pcTail members are used as pointers into the queue storage area.  When the
  * Queue_t structure is used to represent a mutex pcHead and pcTail pointers are
@@ -92,6 +114,17 @@ typedef struct SemaphoreData
     #define queueYIELD_IF_USING_PREEMPTION()    portYIELD_WITHIN_API()
 #endif
 
+/* With configUSE_EVENT_LIST_BUCKETS set each event list is accompanied by
+ * buckets that let a task be placed in priority order without walking the
+ * tasks already waiting. */
+#if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+    #define queuePLACE_ON_EVENT_LIST( pxEventList, pxBuckets, xTicksToWait )    vTaskPlaceOnBucketedEventList( ( pxEventList ), ( pxBuckets ), ( xTicksToWait ) )
+    #define queueMOVE_TO_EVENT_LIST( pxFromList, pxEventList, pxBuckets )       uxTaskMoveToBucketedEventList( ( pxFromList ), ( pxEventList ), ( pxBuckets ) )
+#else
+    #define queuePLACE_ON_EVENT_LIST( pxEventList, pxBuckets, xTicksToWait )    vTaskPlaceOnEventList( ( pxEventList ), ( xTicksToWait ) )
+    #define queueMOVE_TO_EVENT_LIST( pxFromList, pxEventList, pxBuckets )       uxTaskMoveToEventList( ( pxFromList ), ( pxEventList ) )
+#endif
+
 /*
  * Definition of the queue used by the scheduler.
  * Items are queued by copy, not reference.  See the following link for the
@@ -126,6 +159,19 @@ typedef struct QueueDefinition /* The old naming convention is used to prevent b
         struct QueueDefinition * pxQueueSetContainer;
     #endif
 
+    #if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+        EventListBuckets_t xWaitingToSendBuckets;    /*< Indexes xTasksWaitingToSend by priority. */
+        EventListBuckets_t xWaitingToReceiveBuckets; /*< Indexes xTasksWaitingToReceive by priority. */
+    #endif
+
+    #if ( configUSE_PRIORITY_QUEUES == 1 )
+        uint8_t * pucPriorities; /*< The priority of the item in each slot of a queue created by xQueueCreatePriority(), NULL for any other queue. */
+    #endif
+
+    #if ( configUSE_MUTEXES == 1 )
+        HeldLock_t xHeldLock; /*< Links a mutex into the locks its holder has, so the holder's inherited priority can be recalculated. */
+    #endif
+
     #if ( configUSE_TRACE_FACILITY == 1 )
         UBaseType_t uxQueueNumber;
         uint8_t ucQueueType;
@@ -197,6 +243,18 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
                                       const void * pvItemToQueue,
                                       const BaseType_t xPosition ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_PRIORITY_QUEUES == 1 )
+
+/*
+ * Copies an item into a priority queue behind the items of equal or higher
+ * priority, moving the items of lower priority back one slot each to make
+ * room.  Called from prvCopyDataToQueue().
+ */
+    static void prvCopyDataToPriorityQueue( Queue_t * const pxQueue,
+                                            const void * pvItemToQueue,
+                                            const BaseType_t xPosition ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Copies an item out of a queue.
  */
@@ -343,6 +401,13 @@ BaseType_t xQueueGenericReset( QueueHandle_t xQueue,
                 /* Ensure the event queues start in the correct state. */
                 vListInitialise( &( pxQueue->xTasksWaitingToSend ) );
                 vListInitialise( &( pxQueue->xTasksWaitingToReceive ) );
+
+                #if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+                {
+                    vListInitialiseBuckets( &( pxQueue->xWaitingToSendBuckets ) );
+                    vListInitialiseBuckets( &( pxQueue->xWaitingToReceiveBuckets ) );
+                }
+                #endif
             }
         }
         taskEXIT_CRITICAL();
@@ -491,6 +556,106 @@ BaseType_t xQueueGenericReset( QueueHandle_t xQueue,
 #endif /* configSUPPORT_STATIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
+#if ( ( configUSE_PRIORITY_QUEUES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreatePriority( const UBaseType_t uxQueueLength,
+                                        const UBaseType_t uxItemSize )
+    {
+        Queue_t * pxNewQueue = NULL;
+        size_t xQueueSizeInBytes;
+        uint8_t * pucQueueStorage;
+
+        /* A priority queue carries data, and needs one more byte per slot
+         * for the priority of the item in it.  Its length bounds the items a
+         * send moves with interrupts masked, see prvCopyDataToPriorityQueue(). */
+        if( ( uxQueueLength > ( UBaseType_t ) 0 ) &&
+            ( uxQueueLength <= ( UBaseType_t ) configPRIORITY_QUEUE_MAX_LENGTH ) &&
+            ( uxItemSize > ( UBaseType_t ) 0 ) &&
+            /* Check for multiplication overflow. */
+            ( ( SIZE_MAX / uxQueueLength ) > uxItemSize ) &&
+            /* Check for addition overflow. */
+            ( ( SIZE_MAX - sizeof( Queue_t ) ) >= ( uxQueueLength * ( uxItemSize + ( UBaseType_t ) 1 ) ) ) )
+        {
+            xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+
+            /* See xQueueGenericCreate() for the alignment of the allocation. */
+            pxNewQueue = ( Queue_t * ) pvPortMalloc( sizeof( Queue_t ) + xQueueSizeInBytes + ( size_t ) uxQueueLength ); /*lint !e9087 !e9079 see comment above. */
+
+            if( pxNewQueue != NULL )
+            {
+                pucQueueStorage = ( uint8_t * ) pxNewQueue;
+                pucQueueStorage += sizeof( Queue_t ); /*lint !e9016 Pointer arithmetic allowed on char types, especially when it assists conveying intent. */
+
+                #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                {
+                    pxNewQueue->ucStaticallyAllocated = pdFALSE;
+                }
+                #endif /* configSUPPORT_STATIC_ALLOCATION */
+
+                prvInitialiseNewQueue( uxQueueLength, uxItemSize, pucQueueStorage, queueQUEUE_TYPE_BASE, pxNewQueue );
+
+                /* The priorities follow the item storage area. */
+                pxNewQueue->pucPriorities = pucQueueStorage + xQueueSizeInBytes;
+            }
+            else
+            {
+                traceQUEUE_CREATE_FAILED( queueQUEUE_TYPE_BASE );
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            configASSERT( pxNewQueue );
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return pxNewQueue;
+    }
+
+#endif /* ( configUSE_PRIORITY_QUEUES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_PRIORITY_QUEUES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreatePriorityStatic( const UBaseType_t uxQueueLength,
+                                              const UBaseType_t uxItemSize,
+                                              uint8_t * pucQueueStorage,
+                                              StaticQueue_t * pxStaticQueue )
+    {
+        Queue_t * pxNewQueue = NULL;
+
+        /* As xQueueCreatePriority(), the storage holding the items and then
+         * one priority byte per slot. */
+        if( ( uxQueueLength > ( UBaseType_t ) 0 ) &&
+            ( uxQueueLength <= ( UBaseType_t ) configPRIORITY_QUEUE_MAX_LENGTH ) &&
+            ( uxItemSize > ( UBaseType_t ) 0 ) &&
+            /* Check for multiplication overflow. */
+            ( ( SIZE_MAX / uxQueueLength ) > uxItemSize ) &&
+            ( pucQueueStorage != NULL ) )
+        {
+            pxNewQueue = ( Queue_t * ) xQueueGenericCreateStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxStaticQueue, queueQUEUE_TYPE_BASE ); /*lint !e9087 The handle is the queue structure. */
+
+            if( pxNewQueue != NULL )
+            {
+                pxNewQueue->pucPriorities = pucQueueStorage + ( uxQueueLength * uxItemSize );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            configASSERT( pxNewQueue );
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return pxNewQueue;
+    }
+
+#endif /* ( configUSE_PRIORITY_QUEUES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
+/*-----------------------------------------------------------*/
+
 static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
                                    const UBaseType_t uxItemSize,
                                    uint8_t * pucQueueStorage,
@@ -533,6 +698,12 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
     }
     #endif /* configUSE_QUEUE_SETS */
 
+    #if ( configUSE_PRIORITY_QUEUES == 1 )
+    {
+        pxNewQueue->pucPriorities = NULL;
+    }
+    #endif /* configUSE_PRIORITY_QUEUES */
+
     traceQUEUE_CREATE( pxNewQueue );
 }
 /*-----------------------------------------------------------*/
@@ -549,6 +720,9 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
             * in particular the information required for priority inheritance. */
             pxNewQueue->u.xSemaphore.xMutexHolder = NULL;
             pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
+            pxNewQueue->xHeldLock.pxNext = NULL;
+            pxNewQueue->xHeldLock.pxWaitingTasks[ 0 ] = &( pxNewQueue->xTasksWaitingToReceive );
+            pxNewQueue->xHeldLock.pxWaitingTasks[ 1 ] = NULL;
 
             /* In case this is a recursive mutex. */
             pxNewQueue->u.xSemaphore.uxRecursiveCallCount = 0;
@@ -761,6 +935,58 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
 #endif /* configUSE_RECURSIVE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_CONDVARS == 1 )
+
+    UBaseType_t uxQueueMoveWaitersToMutex( QueueHandle_t xMutex,
+                                           List_t * const pxEventList,
+                                           const UBaseType_t uxMaxTasks )
+    {
+        Queue_t * const pxMutex = xMutex;
+        UBaseType_t uxMoved = 0;
+        BaseType_t xWokeOne = pdFALSE;
+        UBaseType_t uxWaiterPriority;
+
+        configASSERT( pxMutex );
+        configASSERT( pxMutex->uxQueueType == queueQUEUE_IS_MUTEX );
+
+        taskENTER_CRITICAL();
+        {
+            while( ( uxMoved < uxMaxTasks ) && ( listLIST_IS_EMPTY( pxEventList ) == pdFALSE ) )
+            {
+                if( ( xWokeOne == pdFALSE ) &&
+                    ( pxMutex->uxMessagesWaiting > ( UBaseType_t ) 0 ) &&
+                    ( listLIST_IS_EMPTY( &( pxMutex->xTasksWaitingToReceive ) ) != pdFALSE ) )
+                {
+                    /* Nobody holds the mutex, so no give is coming to wake a
+                     * task queued on it.  Ready this one to take it now, going
+                     * through the mutex's list so that it leaves the condition
+                     * variable the same way as the tasks queued behind it. */
+                    ( void ) queueMOVE_TO_EVENT_LIST( pxEventList, &( pxMutex->xTasksWaitingToReceive ), &( pxMutex->xWaitingToReceiveBuckets ) );
+                    ( void ) xTaskRemoveFromEventList( &( pxMutex->xTasksWaitingToReceive ) );
+                    xWokeOne = pdTRUE;
+                }
+                else
+                {
+                    /* Queue the task on the mutex as though it had blocked in
+                     * xSemaphoreTake().  Each give then readies one task, so
+                     * the tasks do not all wake to fight over the mutex.  The
+                     * holder now keeps the task waiting, so it inherits the
+                     * task's priority just as it would from xSemaphoreTake(). */
+                    uxWaiterPriority = queueMOVE_TO_EVENT_LIST( pxEventList, &( pxMutex->xTasksWaitingToReceive ), &( pxMutex->xWaitingToReceiveBuckets ) );
+                    ( void ) xTaskPriorityInheritFrom( pxMutex->u.xSemaphore.xMutexHolder, uxWaiterPriority );
+                }
+
+                uxMoved++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return uxMoved;
+    }
+
+#endif /* configUSE_CONDVARS */
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
 
     QueueHandle_t xQueueCreateCountingSemaphoreStatic( const UBaseType_t uxMaxCount,
@@ -1005,7 +1231,7 @@ BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
             if( prvIsQueueFull( pxQueue ) != pdFALSE )
             {
                 traceBLOCKING_ON_QUEUE_SEND( pxQueue );
-                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+                queuePLACE_ON_EVENT_LIST( &( pxQueue->xTasksWaitingToSend ), &( pxQueue->xWaitingToSendBuckets ), xTicksToWait );
 
                 /* Unlocking the queue means queue events can effect the
                  * event list. It is possible that interrupts occurring now
@@ -1477,7 +1703,7 @@ BaseType_t xQueueReceive( QueueHandle_t xQueue,
             if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
             {
                 traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
-                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+                queuePLACE_ON_EVENT_LIST( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->xWaitingToReceiveBuckets ), xTicksToWait );
                 prvUnlockQueue( pxQueue );
 
                 if( xTaskResumeAll() == pdFALSE )
@@ -1570,7 +1796,7 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
                     {
                         /* Record the information required to implement
                          * priority inheritance should it become necessary. */
-                        pxQueue->u.xSemaphore.xMutexHolder = pvTaskIncrementMutexHeldCount();
+                        pxQueue->u.xSemaphore.xMutexHolder = pvTaskAddHeldLock( NULL, &( pxQueue->xHeldLock ) );
                     }
                     else
                     {
@@ -1660,7 +1886,7 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
                 }
                 #endif /* if ( configUSE_MUTEXES == 1 ) */
 
-                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+                queuePLACE_ON_EVENT_LIST( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->xWaitingToReceiveBuckets ), xTicksToWait );
                 prvUnlockQueue( pxQueue );
 
                 if( xTaskResumeAll() == pdFALSE )
@@ -1838,7 +2064,7 @@ BaseType_t xQueuePeek( QueueHandle_t xQueue,
             if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
             {
                 traceBLOCKING_ON_QUEUE_PEEK( pxQueue );
-                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+                queuePLACE_ON_EVENT_LIST( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->xWaitingToReceiveBuckets ), xTicksToWait );
                 prvUnlockQueue( pxQueue );
 
                 if( xTaskResumeAll() == pdFALSE )
@@ -2181,6 +2407,13 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
 
     /* This function is called from a critical section. */
 
+    #if ( configUSE_PRIORITY_QUEUES == 1 )
+    {
+        /* Only a priority queue can take an item with a priority. */
+        configASSERT( ( ( xPosition & queuePRIORITY_FLAG ) == ( BaseType_t ) 0 ) || ( pxQueue->pucPriorities != NULL ) );
+    }
+    #endif
+
     uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
     if( pxQueue->uxItemSize == ( UBaseType_t ) 0 )
@@ -2190,7 +2423,7 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
             if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
             {
                 /* The mutex is no longer being held. */
-                xReturn = xTaskPriorityDisinherit( pxQueue->u.xSemaphore.xMutexHolder );
+                xReturn = xTaskPriorityDisinheritLock( pxQueue->u.xSemaphore.xMutexHolder, &( pxQueue->xHeldLock ) );
                 pxQueue->u.xSemaphore.xMutexHolder = NULL;
             }
             else
@@ -2200,9 +2433,16 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
         }
         #endif /* configUSE_MUTEXES */
     }
+
+    #if ( configUSE_PRIORITY_QUEUES == 1 )
+        else if( pxQueue->pucPriorities != NULL )
+        {
+            prvCopyDataToPriorityQueue( pxQueue, pvItemToQueue, xPosition );
+        }
+    #endif /* configUSE_PRIORITY_QUEUES */
     else if( xPosition == queueSEND_TO_BACK )
     {
-        ( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+        queueCOPY_ITEM( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
         pxQueue->pcWriteTo += pxQueue->uxItemSize;                                                       /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
 
         if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail )                                             /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
@@ -2216,7 +2456,7 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
     }
     else
     {
-        ( void ) memcpy( ( void * ) pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
+        queueCOPY_ITEM( ( void * ) pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, pxQueue->uxItemSize ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
         pxQueue->u.xQueue.pcReadFrom -= pxQueue->uxItemSize;
 
         if( pxQueue->u.xQueue.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
@@ -2255,6 +2495,79 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PRIORITY_QUEUES == 1 )
+
+    static void prvCopyDataToPriorityQueue( Queue_t * const pxQueue,
+                                            const void * pvItemToQueue,
+                                            const BaseType_t xPosition )
+    {
+        const UBaseType_t uxItemSize = pxQueue->uxItemSize;
+        UBaseType_t uxPriority, uxSlot, uxPrevious, uxToMove;
+
+        /* This function is called from a critical section, and only when
+         * there is a free slot. */
+        configASSERT( xPosition != queueOVERWRITE );
+
+        if( ( xPosition & queuePRIORITY_FLAG ) != ( BaseType_t ) 0 )
+        {
+            uxPriority = ( UBaseType_t ) ( xPosition & ( BaseType_t ) 0xff );
+        }
+        else if( xPosition == queueSEND_TO_FRONT )
+        {
+            uxPriority = ( UBaseType_t ) 0xff;
+        }
+        else
+        {
+            uxPriority = ( UBaseType_t ) 0;
+        }
+
+        /* Items are held from the slot after pcReadFrom up to the slot before
+         * pcWriteTo, highest priority first.  Starting at the free slot, move
+         * each item of lower priority back one slot until the new item's place
+         * is found.  That is at most configPRIORITY_QUEUE_MAX_LENGTH - 1 items;
+         * for queues that short a sorted array beats a heap, which would need
+         * a sequence number per item to keep equal priorities in order, and a
+         * sift on every receive as well as every send. */
+        uxSlot = ( UBaseType_t ) ( ( pxQueue->pcWriteTo - pxQueue->pcHead ) / ( ptrdiff_t ) uxItemSize ); /*lint !e946 !e9033 Pointer difference within the storage area. */
+
+        for( uxToMove = pxQueue->uxMessagesWaiting; uxToMove > ( UBaseType_t ) 0; uxToMove-- )
+        {
+            uxPrevious = ( uxSlot == ( UBaseType_t ) 0 ) ? ( pxQueue->uxLength - ( UBaseType_t ) 1 ) : ( uxSlot - ( UBaseType_t ) 1 );
+
+            if( ( UBaseType_t ) pxQueue->pucPriorities[ uxPrevious ] >= uxPriority )
+            {
+                break;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            queueCOPY_ITEM( ( void * ) &( pxQueue->pcHead[ uxSlot * uxItemSize ] ), ( void * ) &( pxQueue->pcHead[ uxPrevious * uxItemSize ] ), uxItemSize );
+            pxQueue->pucPriorities[ uxSlot ] = pxQueue->pucPriorities[ uxPrevious ];
+            uxSlot = uxPrevious;
+        }
+
+        queueCOPY_ITEM( ( void * ) &( pxQueue->pcHead[ uxSlot * uxItemSize ] ), pvItemToQueue, uxItemSize );
+        pxQueue->pucPriorities[ uxSlot ] = ( uint8_t ) uxPriority;
+
+        /* The queue has grown by one slot at the back, whichever slot the new
+         * item went into. */
+        pxQueue->pcWriteTo += uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+
+        if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+        {
+            pxQueue->pcWriteTo = pxQueue->pcHead;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_PRIORITY_QUEUES */
+/*-----------------------------------------------------------*/
+
 static void prvCopyDataFromQueue( Queue_t * const pxQueue,
                                   void * const pvBuffer )
 {
@@ -2271,7 +2584,7 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue,
             mtCOVERAGE_TEST_MARKER();
         }
 
-        ( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+        queueCOPY_ITEM( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
     }
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,566 @@
+/*
+ * FreeRTOS Kernel V10.5.1
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Standard includes. */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rwlock.h"
+
+/* Lint e961, e750 and e9021 are suppressed as a MISRA exception justified
+ * because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+ * for the header files above, but not in this file, in order to generate the
+ * correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021 See comment above. */
+
+/* This entire source file will be skipped if the application is not configured
+ * to include reader-writer locks.  This #if is closed at the very bottom of this
+ * file. */
+#if ( configUSE_RWLOCKS == 1 )
+
+/* Set in a waiting task's event list item value when the lock is handed to it,
+ * so that on waking it can tell a grant from a timeout.  It must not clash with
+ * the taskEVENT_LIST_ITEM_VALUE_IN_USE definition, nor with the values used to
+ * order the event lists by priority. */
+    #if configUSE_16_BIT_TICKS == 1
+        #define rwlockUNBLOCKED_BY_GRANT    0x0200U
+    #else
+        #define rwlockUNBLOCKED_BY_GRANT    0x02000000UL
+    #endif
+
+    typedef struct RWLockDef_t
+    {
+        UBaseType_t uxReaders;        /*< The number of tasks holding the lock for reading. */
+        TaskHandle_t xWriter;         /*< The task holding the lock for writing, or NULL. */
+        List_t xTasksWaitingToRead;   /*< Tasks blocked waiting to read, in priority order. */
+        List_t xTasksWaitingToWrite;  /*< Tasks blocked waiting to write, in priority order. */
+        HeldLock_t xHeldLock;         /*< Links the lock into those the writer holds, for priority inheritance. */
+
+        #if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+            uint8_t ucStaticallyAllocated; /*< Set to pdTRUE if the lock is statically allocated to ensure no attempt is made to free the memory. */
+        #endif
+    } RWLock_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Put the lock in its unheld state.
+ */
+    static void prvInitialiseRWLock( RWLock_t * pxRWLock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Hand the lock to whichever waiting tasks may now have it, if it is not held
+ * for writing: every waiting reader if xPreferReaders is pdTRUE or no writer is
+ * waiting, otherwise the highest priority waiting writer once no readers hold
+ * it.  Must be called with the scheduler suspended.
+ */
+    static void prvGrantWaiters( RWLock_t * pxRWLock,
+                                 BaseType_t xPreferReaders ) PRIVILEGED_FUNCTION;
+
+/*
+ * Block the calling task on pxEventList, first raising the priority of the
+ * writer holding the lock, if any.  Must be called with the scheduler
+ * suspended.
+ */
+    static void prvBlockOnRWLock( RWLock_t * pxRWLock,
+                                  List_t * pxEventList,
+                                  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Tidy up after the calling task timed out waiting for the lock: undo any
+ * priority the writer inherited from it, and let in any readers that were
+ * held back only by it.
+ */
+    static void prvWaitTimedOut( RWLock_t * pxRWLock ) PRIVILEGED_FUNCTION;
+
+/*
+ * The priority of the highest priority task waiting for the lock, or
+ * tskIDLE_PRIORITY if there are none.
+ */
+    static UBaseType_t prvHighestWaitingPriority( const RWLock_t * pxRWLock ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+        RWLockHandle_t xRWLockCreateStatic( StaticRWLock_t * pxRWLockBuffer )
+        {
+            RWLock_t * pxRWLock;
+
+            /* A StaticRWLock_t object must be provided. */
+            configASSERT( pxRWLockBuffer );
+
+            #if ( configASSERT_DEFINED == 1 )
+            {
+                /* Sanity check that the size of the structure used to declare a
+                 * variable of type StaticRWLock_t equals the size of the real
+                 * lock structure. */
+                volatile size_t xSize = sizeof( StaticRWLock_t );
+                configASSERT( xSize == sizeof( RWLock_t ) );
+            } /*lint !e529 xSize is referenced if configASSERT() is defined. */
+            #endif /* configASSERT_DEFINED */
+
+            /* RWLock_t and StaticRWLock_t are deliberately aliased for data
+             * hiding purposes. */
+            pxRWLock = ( RWLock_t * ) pxRWLockBuffer; /*lint !e740 !e9087 */
+
+            if( pxRWLock != NULL )
+            {
+                prvInitialiseRWLock( pxRWLock );
+
+                #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+                {
+                    /* Both static and dynamic allocation can be used, so note
+                     * that this lock was created statically in case it is later
+                     * deleted. */
+                    pxRWLock->ucStaticallyAllocated = pdTRUE;
+                }
+                #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+            }
+
+            return pxRWLock;
+        }
+
+    #endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+    #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+        RWLockHandle_t xRWLockCreate( void )
+        {
+            RWLock_t * pxRWLock;
+
+            pxRWLock = ( RWLock_t * ) pvPortMalloc( sizeof( RWLock_t ) ); /*lint !e9087 !e9079 pvPortMalloc() returns memory aligned for any type. */
+
+            if( pxRWLock != NULL )
+            {
+                prvInitialiseRWLock( pxRWLock );
+
+                #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                {
+                    /* Both static and dynamic allocation can be used, so note
+                     * this lock was allocated dynamically in case it is later
+                     * deleted. */
+                    pxRWLock->ucStaticallyAllocated = pdFALSE;
+                }
+                #endif /* configSUPPORT_STATIC_ALLOCATION */
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            return pxRWLock;
+        }
+
+    #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRWLockTakeRead( RWLockHandle_t xRWLock,
+                                TickType_t xTicksToWait )
+    {
+        RWLock_t * pxRWLock = xRWLock;
+        BaseType_t xReturn = pdFALSE;
+        BaseType_t xAlreadyYielded;
+
+        configASSERT( pxRWLock );
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+        }
+        #endif
+
+        vTaskSuspendAll();
+        {
+            /* Readers may enter while there is no writer, and no writer
+             * waiting - writers are preferred. */
+            if( ( pxRWLock->xWriter == NULL ) && ( listLIST_IS_EMPTY( &( pxRWLock->xTasksWaitingToWrite ) ) != pdFALSE ) )
+            {
+                ( pxRWLock->uxReaders )++;
+                xReturn = pdTRUE;
+            }
+            else if( xTicksToWait != ( TickType_t ) 0 )
+            {
+                prvBlockOnRWLock( pxRWLock, &( pxRWLock->xTasksWaitingToRead ), xTicksToWait );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        xAlreadyYielded = xTaskResumeAll();
+
+        if( ( xReturn == pdFALSE ) && ( xTicksToWait != ( TickType_t ) 0 ) )
+        {
+            if( xAlreadyYielded == pdFALSE )
+            {
+                portYIELD_WITHIN_API();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Either the lock was handed to this task, which is then already
+             * counted in uxReaders, or the block time expired. */
+            if( ( uxTaskResetEventItemValue() & rwlockUNBLOCKED_BY_GRANT ) != ( TickType_t ) 0 )
+            {
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                prvWaitTimedOut( pxRWLock );
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vRWLockGiveRead( RWLockHandle_t xRWLock )
+    {
+        RWLock_t * pxRWLock = xRWLock;
+
+        configASSERT( pxRWLock );
+
+        vTaskSuspendAll();
+        {
+            configASSERT( pxRWLock->uxReaders > ( UBaseType_t ) 0 );
+            ( pxRWLock->uxReaders )--;
+
+            if( pxRWLock->uxReaders == ( UBaseType_t ) 0 )
+            {
+                prvGrantWaiters( pxRWLock, pdFALSE );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRWLockTakeWrite( RWLockHandle_t xRWLock,
+                                 TickType_t xTicksToWait )
+    {
+        RWLock_t * pxRWLock = xRWLock;
+        BaseType_t xReturn = pdFALSE;
+        BaseType_t xAlreadyYielded;
+
+        configASSERT( pxRWLock );
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+        }
+        #endif
+
+        vTaskSuspendAll();
+        {
+            configASSERT( pxRWLock->xWriter != xTaskGetCurrentTaskHandle() );
+
+            if( ( pxRWLock->xWriter == NULL ) && ( pxRWLock->uxReaders == ( UBaseType_t ) 0 ) )
+            {
+                pxRWLock->xWriter = pvTaskAddHeldLock( NULL, &( pxRWLock->xHeldLock ) );
+                xReturn = pdTRUE;
+            }
+            else if( xTicksToWait != ( TickType_t ) 0 )
+            {
+                prvBlockOnRWLock( pxRWLock, &( pxRWLock->xTasksWaitingToWrite ), xTicksToWait );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        xAlreadyYielded = xTaskResumeAll();
+
+        if( ( xReturn == pdFALSE ) && ( xTicksToWait != ( TickType_t ) 0 ) )
+        {
+            if( xAlreadyYielded == pdFALSE )
+            {
+                portYIELD_WITHIN_API();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            if( ( uxTaskResetEventItemValue() & rwlockUNBLOCKED_BY_GRANT ) != ( TickType_t ) 0 )
+            {
+                /* The lock was handed to this task, which is already recorded
+                 * as the writer and counted as holding it. */
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                prvWaitTimedOut( pxRWLock );
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vRWLockGiveWrite( RWLockHandle_t xRWLock )
+    {
+        RWLock_t * pxRWLock = xRWLock;
+        BaseType_t xYieldRequired;
+
+        configASSERT( pxRWLock );
+        configASSERT( pxRWLock->xWriter == xTaskGetCurrentTaskHandle() );
+
+        vTaskSuspendAll();
+        {
+            pxRWLock->xWriter = NULL;
+
+            /* Drop any priority inherited while holding the lock. */
+            taskENTER_CRITICAL();
+            {
+                xYieldRequired = xTaskPriorityDisinheritLock( xTaskGetCurrentTaskHandle(), &( pxRWLock->xHeldLock ) );
+            }
+            taskEXIT_CRITICAL();
+
+            /* Readers that queued up behind this writer go first, so a run of
+             * writers cannot starve them. */
+            prvGrantWaiters( pxRWLock, pdTRUE );
+        }
+
+        if( ( xTaskResumeAll() == pdFALSE ) && ( xYieldRequired != pdFALSE ) )
+        {
+            portYIELD_WITHIN_API();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vRWLockDelete( RWLockHandle_t xRWLock )
+    {
+        RWLock_t * pxRWLock = xRWLock;
+
+        configASSERT( pxRWLock );
+        configASSERT( pxRWLock->xWriter == NULL );
+        configASSERT( pxRWLock->uxReaders == ( UBaseType_t ) 0 );
+        configASSERT( listLIST_IS_EMPTY( &( pxRWLock->xTasksWaitingToRead ) ) != pdFALSE );
+        configASSERT( listLIST_IS_EMPTY( &( pxRWLock->xTasksWaitingToWrite ) ) != pdFALSE );
+
+        #if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+        {
+            /* The lock can only have been allocated dynamically - free it
+             * again. */
+            vPortFree( pxRWLock );
+        }
+        #elif ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+        {
+            /* The lock could have been allocated statically or dynamically,
+             * so check before attempting to free the memory. */
+            if( pxRWLock->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+            {
+                vPortFree( pxRWLock );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvInitialiseRWLock( RWLock_t * pxRWLock )
+    {
+        pxRWLock->uxReaders = ( UBaseType_t ) 0;
+        pxRWLock->xWriter = NULL;
+        vListInitialise( &( pxRWLock->xTasksWaitingToRead ) );
+        vListInitialise( &( pxRWLock->xTasksWaitingToWrite ) );
+
+        /* Tasks waiting to read as well as to write are blocked by the
+         * writer, so both lists count towards the priority it inherits. */
+        pxRWLock->xHeldLock.pxNext = NULL;
+        pxRWLock->xHeldLock.pxWaitingTasks[ 0 ] = &( pxRWLock->xTasksWaitingToWrite );
+        pxRWLock->xHeldLock.pxWaitingTasks[ 1 ] = &( pxRWLock->xTasksWaitingToRead );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvGrantWaiters( RWLock_t * pxRWLock,
+                                 BaseType_t xPreferReaders )
+    {
+        List_t * const pxReaders = &( pxRWLock->xTasksWaitingToRead );
+        List_t * const pxWriters = &( pxRWLock->xTasksWaitingToWrite );
+
+        if( pxRWLock->xWriter == NULL )
+        {
+            if( ( listLIST_IS_EMPTY( pxReaders ) == pdFALSE ) &&
+                ( ( xPreferReaders != pdFALSE ) || ( listLIST_IS_EMPTY( pxWriters ) != pdFALSE ) ) )
+            {
+                /* Admit every waiting reader.  Each is counted here, before it
+                 * runs, so a writer cannot slip in ahead of it. */
+                while( listLIST_IS_EMPTY( pxReaders ) == pdFALSE )
+                {
+                    ( pxRWLock->uxReaders )++;
+                    vTaskRemoveFromUnorderedEventList( listGET_HEAD_ENTRY( pxReaders ), rwlockUNBLOCKED_BY_GRANT );
+                }
+            }
+            else if( ( pxRWLock->uxReaders == ( UBaseType_t ) 0 ) && ( listLIST_IS_EMPTY( pxWriters ) == pdFALSE ) )
+            {
+                /* The head of the list is the highest priority writer.  It is
+                 * counted as holding the lock now, before it runs, so that
+                 * priority inheritance sees it as the holder from here on. */
+                pxRWLock->xWriter = pvTaskAddHeldLock( ( TaskHandle_t ) listGET_OWNER_OF_HEAD_ENTRY( pxWriters ), &( pxRWLock->xHeldLock ) ); /*lint !e9079 The list item owner is the waiting task's TCB. */
+
+                /* Readers held back for the writer are blocked by it from now
+                 * on, and may be of higher priority.  Its priority is set from
+                 * the waiters on every lock it holds before it is readied, so
+                 * that it is readied at that priority. */
+                if( listLIST_IS_EMPTY( pxReaders ) == pdFALSE )
+                {
+                    taskENTER_CRITICAL();
+                    {
+                        vTaskPriorityDisinheritAfterTimeout( pxRWLock->xWriter, prvHighestWaitingPriority( pxRWLock ) );
+                    }
+                    taskEXIT_CRITICAL();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                vTaskRemoveFromUnorderedEventList( listGET_HEAD_ENTRY( pxWriters ), rwlockUNBLOCKED_BY_GRANT );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvBlockOnRWLock( RWLock_t * pxRWLock,
+                                  List_t * pxEventList,
+                                  TickType_t xTicksToWait )
+    {
+        if( pxRWLock->xWriter != NULL )
+        {
+            taskENTER_CRITICAL();
+            {
+                ( void ) xTaskPriorityInherit( pxRWLock->xWriter );
+            }
+            taskEXIT_CRITICAL();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        vTaskPlaceOnEventList( pxEventList, xTicksToWait );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvWaitTimedOut( RWLock_t * pxRWLock )
+    {
+        vTaskSuspendAll();
+        {
+            /* The writer may have inherited this task's priority, and should
+             * now drop back to that of the highest priority remaining waiter. */
+            if( pxRWLock->xWriter != NULL )
+            {
+                taskENTER_CRITICAL();
+                {
+                    vTaskPriorityDisinheritAfterTimeout( pxRWLock->xWriter, prvHighestWaitingPriority( pxRWLock ) );
+                }
+                taskEXIT_CRITICAL();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* If this task was the only waiting writer, the readers held back
+             * for it can now enter. */
+            prvGrantWaiters( pxRWLock, pdFALSE );
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvHighestWaitingPriority( const RWLock_t * pxRWLock )
+    {
+        UBaseType_t uxHighestPriority = tskIDLE_PRIORITY;
+        UBaseType_t uxPriority;
+
+        /* Both lists are ordered by priority, so only their heads need be
+         * considered. */
+        if( listCURRENT_LIST_LENGTH( &( pxRWLock->xTasksWaitingToRead ) ) > 0U )
+        {
+            uxHighestPriority = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxRWLock->xTasksWaitingToRead ) );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( listCURRENT_LIST_LENGTH( &( pxRWLock->xTasksWaitingToWrite ) ) > 0U )
+        {
+            uxPriority = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxRWLock->xTasksWaitingToWrite ) );
+
+            if( uxPriority > uxHighestPriority )
+            {
+                uxHighestPriority = uxPriority;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return uxHighestPriority;
+    }
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+ * to include reader-writer locks.  If you want to include them then ensure
+ * configUSE_RWLOCKS is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_RWLOCKS == 1 */
@@ -274,6 +274,20 @@ static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
                                         size_t xBufferLengthBytes,
                                         size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
 
+/*
+ * Reads as many whole messages as will fit, up to uxMaxMessages, packing them
+ * into pvRxData and storing their lengths in pxMessageLengths.  xTail is
+ * updated once, after the last message is copied out.  Returns the number of
+ * messages read, and their total length in *pxBytesReceived.
+ */
+static UBaseType_t prvReadMessagesFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                              void * pvRxData,
+                                              size_t xBufferLengthBytes,
+                                              size_t * const pxMessageLengths,
+                                              UBaseType_t uxMaxMessages,
+                                              size_t xBytesAvailable,
+                                              size_t * const pxBytesReceived ) PRIVILEGED_FUNCTION;
+
 /*
  * If the stream buffer is being used as a message buffer, then writes an entire
  * message to the buffer.  If the stream buffer is being used as a stream
@@ -304,6 +318,34 @@ static size_t prvReadBytesFromBuffer( StreamBuffer_t * pxStreamBuffer,
                                       size_t xCount,
                                       size_t xTail ) PRIVILEGED_FUNCTION;
 
+/*
+ * Describes the xCount bytes starting at index xIndex of the buffer's data
+ * storage area as one or two contiguous segments, the second being used only
+ * if the bytes wrap around the end of the storage area.
+ */
+static void prvGetSegments( const StreamBuffer_t * const pxStreamBuffer,
+                            size_t xIndex,
+                            size_t xCount,
+                            StreamBufferSegments_t * const pxSegments ) PRIVILEGED_FUNCTION;
+
+/*
+ * Moves xHead past xDataLengthBytes bytes written in place into the region
+ * obtained from xStreamBufferSendAcquire(), first writing the length of the
+ * message if the stream buffer is being used as a message buffer.  Returns the
+ * number of bytes committed.
+ */
+static size_t prvCommitBytesInBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                      size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+/*
+ * Moves xTail past xBytesConsumed bytes of the region obtained from
+ * xStreamBufferReceiveAcquire(), or past the whole of the next message if the
+ * stream buffer is being used as a message buffer.  Returns the number of
+ * bytes released.
+ */
+static size_t prvReleaseBytesFromBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                         size_t xBytesConsumed ) PRIVILEGED_FUNCTION;
+
 /*
  * Called by both pxStreamBufferCreate() and pxStreamBufferCreateStatic() to
  * initialise the members of the newly created stream buffer structure.
@@ -1124,6 +1166,199 @@ static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
+UBaseType_t uxStreamBufferReceiveMessages( StreamBufferHandle_t xStreamBuffer,
+                                           void * pvRxData,
+                                           size_t xBufferLengthBytes,
+                                           size_t * const pxMessageLengths,
+                                           UBaseType_t uxMaxMessages,
+                                           TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    UBaseType_t uxReceivedMessages = 0;
+    size_t xBytesAvailable, xReceivedLength = 0;
+
+    configASSERT( pvRxData );
+    configASSERT( pxMessageLengths );
+    configASSERT( pxStreamBuffer );
+
+    /* Only message buffers hold discrete messages. */
+    configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 );
+
+    if( xTicksToWait != ( TickType_t ) 0 )
+    {
+        /* Checking if there is data and clearing the notification state must be
+         * performed atomically. */
+        taskENTER_CRITICAL();
+        {
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+            if( xBytesAvailable <= sbBYTES_TO_STORE_MESSAGE_LENGTH )
+            {
+                /* Clear notification state as going to wait for data. */
+                ( void ) xTaskNotifyStateClear( NULL );
+
+                /* Should only be one reader. */
+                configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+                pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xBytesAvailable <= sbBYTES_TO_STORE_MESSAGE_LENGTH )
+        {
+            /* Wait for data to be available. */
+            traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
+            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+            /* Recheck the data available after blocking. */
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+    }
+
+    if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+    {
+        uxReceivedMessages = prvReadMessagesFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, uxMaxMessages, xBytesAvailable, &xReceivedLength );
+
+        /* One notification for the whole batch. */
+        if( uxReceivedMessages != ( UBaseType_t ) 0 )
+        {
+            traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReceivedLength );
+            prvRECEIVE_COMPLETED( xStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer );
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return uxReceivedMessages;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxStreamBufferReceiveMessagesFromISR( StreamBufferHandle_t xStreamBuffer,
+                                                  void * pvRxData,
+                                                  size_t xBufferLengthBytes,
+                                                  size_t * const pxMessageLengths,
+                                                  UBaseType_t uxMaxMessages,
+                                                  BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    UBaseType_t uxReceivedMessages = 0;
+    size_t xBytesAvailable, xReceivedLength = 0;
+
+    configASSERT( pvRxData );
+    configASSERT( pxMessageLengths );
+    configASSERT( pxStreamBuffer );
+    configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 );
+
+    xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+    if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+    {
+        uxReceivedMessages = prvReadMessagesFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, uxMaxMessages, xBytesAvailable, &xReceivedLength );
+
+        /* One notification for the whole batch. */
+        if( uxReceivedMessages != ( UBaseType_t ) 0 )
+        {
+            prvRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xReceivedLength );
+
+    return uxReceivedMessages;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvReadMessagesFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                              void * pvRxData,
+                                              size_t xBufferLengthBytes,
+                                              size_t * const pxMessageLengths,
+                                              UBaseType_t uxMaxMessages,
+                                              size_t xBytesAvailable,
+                                              size_t * const pxBytesReceived )
+{
+    const size_t xBufferSpace = xBufferLengthBytes;
+    uint8_t * pucRxData = ( uint8_t * ) pvRxData; /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+    UBaseType_t uxCount = 0;
+    size_t xNextTail = pxStreamBuffer->xTail;
+    size_t xMessageTail, xNextMessageLength;
+    configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+    while( ( uxCount < uxMaxMessages ) && ( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH ) )
+    {
+        xMessageTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xNextTail );
+        xNextMessageLength = ( size_t ) xTempNextMessageLength;
+        configASSERT( xNextMessageLength <= ( xBytesAvailable - sbBYTES_TO_STORE_MESSAGE_LENGTH ) );
+
+        if( xNextMessageLength > xBufferLengthBytes )
+        {
+            /* Leave this message for the next call. */
+            break;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( xNextMessageLength != ( size_t ) 0 )
+        {
+            xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, pucRxData, xNextMessageLength, xMessageTail );
+        }
+        else
+        {
+            xNextTail = xMessageTail;
+        }
+
+        pucRxData += xNextMessageLength;
+        xBufferLengthBytes -= xNextMessageLength;
+        xBytesAvailable -= sbBYTES_TO_STORE_MESSAGE_LENGTH + xNextMessageLength;
+        pxMessageLengths[ uxCount ] = xNextMessageLength;
+        uxCount++;
+    }
+
+    if( uxCount != ( UBaseType_t ) 0 )
+    {
+        /* Mark all the messages read as consumed in one step. */
+        pxStreamBuffer->xTail = xNextTail;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    *pxBytesReceived = xBufferSpace - xBufferLengthBytes;
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xStreamBufferIsEmpty( StreamBufferHandle_t xStreamBuffer )
 {
     const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
@@ -1245,6 +1480,486 @@ BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuf
 }
 /*-----------------------------------------------------------*/
 
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+                                 size_t xDataLengthBytes,
+                                 StreamBufferSegments_t * const pxSegments,
+                                 TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn = 0, xSpace = 0, xIndex;
+    size_t xRequiredSpace = xDataLengthBytes;
+    TimeOut_t xTimeOut;
+    size_t xMaxReportedSpace;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( pxSegments );
+
+    xMaxReportedSpace = pxStreamBuffer->xLength - ( size_t ) 1;
+    xIndex = pxStreamBuffer->xHead;
+
+    /* As in xStreamBufferSend(), a message buffer needs room for the length of
+     * the message as well as the message itself, and the message must fit
+     * whole.  The length is written in front of the region by the commit. */
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+        xIndex += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+
+        /* Overflow? */
+        configASSERT( xRequiredSpace > xDataLengthBytes );
+        configASSERT( ( size_t ) ( ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes ) == xDataLengthBytes );
+
+        if( xRequiredSpace > xMaxReportedSpace )
+        {
+            /* The message would not fit even if the entire buffer was empty,
+             * so don't wait for space. */
+            xTicksToWait = ( TickType_t ) 0;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        if( xRequiredSpace > xMaxReportedSpace )
+        {
+            xRequiredSpace = xMaxReportedSpace;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    if( xTicksToWait != ( TickType_t ) 0 )
+    {
+        vTaskSetTimeOutState( &xTimeOut );
+
+        do
+        {
+            taskENTER_CRITICAL();
+            {
+                xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+                if( xSpace < xRequiredSpace )
+                {
+                    /* Clear notification state as going to wait for space. */
+                    ( void ) xTaskNotifyStateClear( NULL );
+
+                    /* Should only be one writer. */
+                    configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+                    pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+                }
+                else
+                {
+                    taskEXIT_CRITICAL();
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
+            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToSend = NULL;
+        } while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* Only the reader can change the space available, and only by adding to
+     * it, so the space seen here is still there when the caller fills it. */
+    xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        if( xSpace >= xRequiredSpace )
+        {
+            xReturn = xDataLengthBytes;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        xReturn = configMIN( xDataLengthBytes, xSpace );
+    }
+
+    prvGetSegments( pxStreamBuffer, xIndex, xReturn, pxSegments );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer,
+                                size_t xDataLengthBytes )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvCommitBytesInBuffer( pxStreamBuffer, xDataLengthBytes );
+
+    if( xReturn > ( size_t ) 0 )
+    {
+        traceSTREAM_BUFFER_SEND( xStreamBuffer, xReturn );
+
+        /* Was a task waiting for the data? */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            prvSEND_COMPLETED( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+                                       size_t xDataLengthBytes,
+                                       BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvCommitBytesInBuffer( pxStreamBuffer, xDataLengthBytes );
+
+    if( xReturn > ( size_t ) 0 )
+    {
+        /* Was a task waiting for the data? */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            prvSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xReturn );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+                                    StreamBufferSegments_t * const pxSegments,
+                                    TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn = 0, xBytesAvailable, xBytesToStoreMessageLength;
+    size_t xIndex;
+    configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( pxSegments );
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+    }
+    else
+    {
+        xBytesToStoreMessageLength = 0;
+    }
+
+    if( xTicksToWait != ( TickType_t ) 0 )
+    {
+        /* Checking if there is data and clearing the notification state must be
+         * performed atomically. */
+        taskENTER_CRITICAL();
+        {
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+            if( xBytesAvailable <= xBytesToStoreMessageLength )
+            {
+                /* Clear notification state as going to wait for data. */
+                ( void ) xTaskNotifyStateClear( NULL );
+
+                /* Should only be one reader. */
+                configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+                pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xBytesAvailable <= xBytesToStoreMessageLength )
+        {
+            /* Wait for data to be available. */
+            traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
+            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+            /* Recheck the data available after blocking. */
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+    }
+
+    xIndex = pxStreamBuffer->xTail;
+
+    if( xBytesAvailable > xBytesToStoreMessageLength )
+    {
+        if( xBytesToStoreMessageLength != ( size_t ) 0 )
+        {
+            /* The region is the next message, which starts after its length. */
+            xIndex = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xIndex );
+            xReturn = ( size_t ) xTempNextMessageLength;
+            configASSERT( xReturn <= ( xBytesAvailable - sbBYTES_TO_STORE_MESSAGE_LENGTH ) );
+        }
+        else
+        {
+            /* The region is everything written so far.  Only the writer can
+             * change this, and only by adding to it. */
+            xReturn = xBytesAvailable;
+        }
+    }
+    else
+    {
+        traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer );
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    prvGetSegments( pxStreamBuffer, xIndex, xReturn, pxSegments );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveRelease( StreamBufferHandle_t xStreamBuffer,
+                                    size_t xBytesConsumed )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvReleaseBytesFromBuffer( pxStreamBuffer, xBytesConsumed );
+
+    /* Was a task waiting for space in the buffer? */
+    if( xReturn != ( size_t ) 0 )
+    {
+        traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReturn );
+        prvRECEIVE_COMPLETED( pxStreamBuffer );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveReleaseFromISR( StreamBufferHandle_t xStreamBuffer,
+                                           size_t xBytesConsumed,
+                                           BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvReleaseBytesFromBuffer( pxStreamBuffer, xBytesConsumed );
+
+    /* Was a task waiting for space in the buffer? */
+    if( xReturn != ( size_t ) 0 )
+    {
+        prvRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xReturn );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetSegments( const StreamBuffer_t * const pxStreamBuffer,
+                            size_t xIndex,
+                            size_t xCount,
+                            StreamBufferSegments_t * const pxSegments )
+{
+    size_t xFirstLength;
+
+    if( xIndex >= pxStreamBuffer->xLength )
+    {
+        xIndex -= pxStreamBuffer->xLength;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    xFirstLength = configMIN( pxStreamBuffer->xLength - xIndex, xCount );
+
+    if( xFirstLength != ( size_t ) 0 )
+    {
+        pxSegments->pucData[ 0 ] = &( pxStreamBuffer->pucBuffer[ xIndex ] );
+    }
+    else
+    {
+        pxSegments->pucData[ 0 ] = NULL;
+    }
+
+    pxSegments->xLength[ 0 ] = xFirstLength;
+
+    /* If the region wraps, the rest of it is at the start of the buffer. */
+    if( xCount > xFirstLength )
+    {
+        pxSegments->pucData[ 1 ] = pxStreamBuffer->pucBuffer;
+    }
+    else
+    {
+        pxSegments->pucData[ 1 ] = NULL;
+    }
+
+    pxSegments->xLength[ 1 ] = xCount - xFirstLength;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvCommitBytesInBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                      size_t xDataLengthBytes )
+{
+    size_t xNextHead = pxStreamBuffer->xHead;
+    size_t xRequiredSpace = xDataLengthBytes;
+    configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* The bytes must lie within the region handed out by the acquire. */
+    configASSERT( xStreamBufferSpacesAvailable( pxStreamBuffer ) >= xRequiredSpace );
+
+    if( xDataLengthBytes != ( size_t ) 0 )
+    {
+        if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+        {
+            xMessageLength = ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes;
+            xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xMessageLength ), sbBYTES_TO_STORE_MESSAGE_LENGTH, xNextHead );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        xNextHead += xDataLengthBytes;
+
+        if( xNextHead >= pxStreamBuffer->xLength )
+        {
+            xNextHead -= pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* Publish the message or bytes to the reader. */
+        pxStreamBuffer->xHead = xNextHead;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xDataLengthBytes;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReleaseBytesFromBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                         size_t xBytesConsumed )
+{
+    size_t xNextTail = pxStreamBuffer->xTail;
+    size_t xBytesAvailable;
+    configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+    xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+        {
+            /* A message is only ever released whole. */
+            xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xNextTail );
+            configASSERT( xBytesConsumed == ( size_t ) xTempNextMessageLength );
+            xBytesConsumed = ( size_t ) xTempNextMessageLength;
+        }
+        else
+        {
+            xBytesConsumed = 0;
+        }
+    }
+    else
+    {
+        configASSERT( xBytesConsumed <= xBytesAvailable );
+        xBytesConsumed = configMIN( xBytesConsumed, xBytesAvailable );
+    }
+
+    if( xBytesConsumed != ( size_t ) 0 )
+    {
+        xNextTail += xBytesConsumed;
+
+        if( xNextTail >= pxStreamBuffer->xLength )
+        {
+            xNextTail -= pxStreamBuffer->xLength;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* Hand the space back to the writer. */
+        pxStreamBuffer->xTail = xNextTail;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xBytesConsumed;
+}
+/*-----------------------------------------------------------*/
+
 static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer,
                                      const uint8_t * pucData,
                                      size_t xCount,
@@ -247,6 +247,23 @@
     #define taskEVENT_LIST_ITEM_VALUE_IN_USE    0x80000000UL
 #endif
 
+/*
+ * Must be used immediately before a task's event list item is removed from
+ * its event list, so the buckets indexing that list (if any) stay valid.
+ */
+#if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+    #define taskUNLINK_EVENT_LIST_BUCKETS( pxTCB )                                              \
+    {                                                                                           \
+        if( ( pxTCB )->pxEventListBuckets != NULL )                                             \
+        {                                                                                       \
+            vListRemoveFromBuckets( ( pxTCB )->pxEventListBuckets, ( pxTCB )->uxEventListBucket, &( ( pxTCB )->xEventListItem ) ); \
+            ( pxTCB )->pxEventListBuckets = NULL;                                               \
+        }                                                                                       \
+    }
+#else
+    #define taskUNLINK_EVENT_LIST_BUCKETS( pxTCB )
+#endif
+
 /*
  * Task control block.  A task control block (TCB) is allocated for each task,
  * and stores task state information, including a pointer to the task's context
@@ -282,6 +299,7 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
     #if ( configUSE_MUTEXES == 1 )
         UBaseType_t uxBasePriority; /*< The priority last assigned to the task - used by the priority inheritance mechanism. */
         UBaseType_t uxMutexesHeld;
+        HeldLock_t * pxLocksHeld;   /*< The locks counted in uxMutexesHeld that were registered with pvTaskAddHeldLock(), so the inherited priority can be recomputed as each is released. */
     #endif
 
     #if ( configUSE_APPLICATION_TASK_TAG == 1 )
@@ -318,6 +336,11 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
     #if ( configUSE_POSIX_ERRNO == 1 )
         int iTaskErrno;
     #endif
+
+    #if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+        EventListBuckets_t * pxEventListBuckets; /*< The buckets indexing the event list the task is in, or NULL if that list has none. */
+        UBaseType_t uxEventListBucket;           /*< The bucket the task was placed in, which its event list item value may no longer match. */
+    #endif
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -516,6 +539,27 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
  */
 static void prvResetNextTaskUnblockTime( void ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_MUTEXES == 1 )
+
+/*
+ * Work out the priority pxTCB should run at given the locks it holds: its base
+ * priority, raised to that of the highest priority task waiting for any of
+ * them.  Returns pdFALSE, leaving *puxPriority unset, if the task holds a lock
+ * that was not registered with pvTaskAddHeldLock(), as the waiters on that
+ * lock cannot then be seen.
+ */
+    static BaseType_t prvGetHeldLocksPriority( const TCB_t * const pxTCB,
+                                               UBaseType_t * const puxPriority ) PRIVILEGED_FUNCTION;
+
+/*
+ * Change the priority pxTCB runs at, keeping its event list item value and
+ * ready list in step, without changing its base priority.
+ */
+    static void prvSetInheritedPriority( TCB_t * const pxTCB,
+                                         UBaseType_t uxPriorityToUse ) PRIVILEGED_FUNCTION;
+
+#endif
+
 #if ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
 
 /*
@@ -1132,6 +1176,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
             /* Is the task waiting on an event also? */
             if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
             {
+                taskUNLINK_EVENT_LIST_BUCKETS( pxTCB );
                 ( void ) uxListRemove( &( pxTCB->xEventListItem ) );
             }
             else
@@ -1696,6 +1741,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
             /* Is the task waiting on an event also? */
             if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
             {
+                taskUNLINK_EVENT_LIST_BUCKETS( pxTCB );
                 ( void ) uxListRemove( &( pxTCB->xEventListItem ) );
             }
             else
@@ -2667,6 +2713,7 @@ BaseType_t xTaskCatchUpTicks( TickType_t xTicksToCatchUp )
                 {
                     if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
                     {
+                        taskUNLINK_EVENT_LIST_BUCKETS( pxTCB );
                         ( void ) uxListRemove( &( pxTCB->xEventListItem ) );
 
                         /* This lets the task know it was forcibly removed from the
@@ -2796,6 +2843,7 @@ BaseType_t xTaskIncrementTick( void )
                      * it from the event list. */
                     if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
                     {
+                        taskUNLINK_EVENT_LIST_BUCKETS( pxTCB );
                         listREMOVE_ITEM( &( pxTCB->xEventListItem ) );
                     }
                     else
@@ -3105,6 +3153,105 @@ void vTaskPlaceOnEventList( List_t * const pxEventList,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+
+    void vTaskPlaceOnBucketedEventList( List_t * const pxEventList,
+                                        EventListBuckets_t * const pxBuckets,
+                                        const TickType_t xTicksToWait )
+    {
+        configASSERT( pxEventList );
+        configASSERT( pxBuckets );
+
+        /* THIS FUNCTION MUST BE CALLED WITH EITHER INTERRUPTS DISABLED OR THE
+         * SCHEDULER SUSPENDED AND THE QUEUE BEING ACCESSED LOCKED.
+         *
+         * The list ends up in the same order vTaskPlaceOnEventList() would
+         * leave it, but the insertion point comes from the buckets instead of
+         * a walk along the list, so the cost does not grow with the number of
+         * tasks already waiting. */
+        pxCurrentTCB->uxEventListBucket = uxListInsertBucketed( pxEventList, pxBuckets, &( pxCurrentTCB->xEventListItem ) );
+        pxCurrentTCB->pxEventListBuckets = pxBuckets;
+
+        prvAddCurrentTaskToDelayedList( xTicksToWait, pdTRUE );
+    }
+
+#endif /* configUSE_EVENT_LIST_BUCKETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_CONDVARS == 1 )
+
+    void vTaskPlaceOnFlaggedEventList( List_t * const pxEventList,
+                                       const TickType_t xItemFlags,
+                                       const TickType_t xTicksToWait )
+    {
+        configASSERT( pxEventList );
+        configASSERT( uxSchedulerSuspended != 0 );
+
+        /* The flags sit above any priority, and every task on the list has the
+         * same ones, so vListInsert() still orders the list by priority.  The
+         * value is marked as in use so that a priority change while the task
+         * waits leaves the flags alone; the move off the list sets the value
+         * from the priority the task has by then. */
+        listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xEventListItem ), ( ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) pxCurrentTCB->uxPriority ) | xItemFlags | taskEVENT_LIST_ITEM_VALUE_IN_USE ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+        vListInsert( pxEventList, &( pxCurrentTCB->xEventListItem ) );
+
+        prvAddCurrentTaskToDelayedList( xTicksToWait, pdTRUE );
+    }
+/*-----------------------------------------------------------*/
+
+    static TCB_t * prvUnlinkEventListHead( List_t * const pxFromList )
+    {
+        TCB_t * pxTCB;
+
+        /* THIS FUNCTION MUST BE CALLED FROM A CRITICAL SECTION.  The moved
+         * task stays blocked, and keeps its timeout, so only its event list
+         * item is touched. */
+        pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxFromList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+        configASSERT( pxTCB );
+
+        taskUNLINK_EVENT_LIST_BUCKETS( pxTCB );
+        listREMOVE_ITEM( &( pxTCB->xEventListItem ) );
+
+        /* The item value decides the task's position in the new list, so it
+         * must hold the task's priority, and no longer any flags the task was
+         * placed with. */
+        listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) pxTCB->uxPriority ) ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+
+        return pxTCB;
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxTaskMoveToEventList( List_t * const pxFromList,
+                                       List_t * const pxToList )
+    {
+        TCB_t * pxTCB = prvUnlinkEventListHead( pxFromList );
+
+        vListInsert( pxToList, &( pxTCB->xEventListItem ) );
+
+        return pxTCB->uxPriority;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_EVENT_LIST_BUCKETS == 1 )
+
+        UBaseType_t uxTaskMoveToBucketedEventList( List_t * const pxFromList,
+                                                   List_t * const pxToList,
+                                                   EventListBuckets_t * const pxBuckets )
+        {
+            TCB_t * pxTCB = prvUnlinkEventListHead( pxFromList );
+
+            configASSERT( pxBuckets );
+            pxTCB->uxEventListBucket = uxListInsertBucketed( pxToList, pxBuckets, &( pxTCB->xEventListItem ) );
+            pxTCB->pxEventListBuckets = pxBuckets;
+
+            return pxTCB->uxPriority;
+        }
+
+    #endif /* configUSE_EVENT_LIST_BUCKETS */
+
+#endif /* configUSE_CONDVARS */
+/*-----------------------------------------------------------*/
+
 void vTaskPlaceOnUnorderedEventList( List_t * pxEventList,
                                      const TickType_t xItemValue,
                                      const TickType_t xTicksToWait )
@@ -3186,6 +3333,7 @@ BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList )
      * pxEventList is not empty. */
     pxUnblockedTCB = listGET_OWNER_OF_HEAD_ENTRY( pxEventList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
     configASSERT( pxUnblockedTCB );
+    taskUNLINK_EVENT_LIST_BUCKETS( pxUnblockedTCB );
     listREMOVE_ITEM( &( pxUnblockedTCB->xEventListItem ) );
 
     if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
@@ -4065,6 +4213,13 @@ static void prvResetNextTaskUnblockTime( void )
 #if ( configUSE_MUTEXES == 1 )
 
     BaseType_t xTaskPriorityInherit( TaskHandle_t const pxMutexHolder )
+    {
+        return xTaskPriorityInheritFrom( pxMutexHolder, pxCurrentTCB->uxPriority );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xTaskPriorityInheritFrom( TaskHandle_t const pxMutexHolder,
+                                         const UBaseType_t uxWaiterPriority )
     {
         TCB_t * const pxMutexHolderTCB = pxMutexHolder;
         BaseType_t xReturn = pdFALSE;
@@ -4075,16 +4230,16 @@ static void prvResetNextTaskUnblockTime( void )
         if( pxMutexHolder != NULL )
         {
             /* If the holder of the mutex has a priority below the priority of
-             * the task attempting to obtain the mutex then it will temporarily
-             * inherit the priority of the task attempting to obtain the mutex. */
-            if( pxMutexHolderTCB->uxPriority < pxCurrentTCB->uxPriority )
+             * the task waiting for the mutex then it will temporarily inherit the
+             * priority of the task waiting for the mutex. */
+            if( pxMutexHolderTCB->uxPriority < uxWaiterPriority )
             {
                 /* Adjust the mutex holder state to account for its new
                  * priority.  Only reset the event list item value if the value is
                  * not being used for anything else. */
                 if( ( listGET_LIST_ITEM_VALUE( &( pxMutexHolderTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
                 {
-                    listSET_LIST_ITEM_VALUE( &( pxMutexHolderTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) pxCurrentTCB->uxPriority ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+                    listSET_LIST_ITEM_VALUE( &( pxMutexHolderTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxWaiterPriority ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
                 }
                 else
                 {
@@ -4108,23 +4263,23 @@ static void prvResetNextTaskUnblockTime( void )
                     }
 
                     /* Inherit the priority before being moved into the new list. */
-                    pxMutexHolderTCB->uxPriority = pxCurrentTCB->uxPriority;
+                    pxMutexHolderTCB->uxPriority = uxWaiterPriority;
                     prvAddTaskToReadyList( pxMutexHolderTCB );
                 }
                 else
                 {
                     /* Just inherit the priority. */
-                    pxMutexHolderTCB->uxPriority = pxCurrentTCB->uxPriority;
+                    pxMutexHolderTCB->uxPriority = uxWaiterPriority;
                 }
 
-                traceTASK_PRIORITY_INHERIT( pxMutexHolderTCB, pxCurrentTCB->uxPriority );
+                traceTASK_PRIORITY_INHERIT( pxMutexHolderTCB, uxWaiterPriority );
 
                 /* Inheritance occurred. */
                 xReturn = pdTRUE;
             }
             else
             {
-                if( pxMutexHolderTCB->uxBasePriority < pxCurrentTCB->uxPriority )
+                if( pxMutexHolderTCB->uxBasePriority < uxWaiterPriority )
                 {
                     /* The base priority of the mutex holder is lower than the
                      * priority of the task attempting to take the mutex, but the
@@ -4152,11 +4307,50 @@ static void prvResetNextTaskUnblockTime( void )
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEXES == 1 )
+
+    TaskHandle_t pvTaskAddHeldLock( TaskHandle_t xTask,
+                                    HeldLock_t * const pxLock )
+    {
+        TCB_t * const pxTCB = prvGetTCBFromHandle( xTask );
+
+        /* If a mutex is taken before any tasks have been created then
+         * pxCurrentTCB will be NULL. */
+        if( pxTCB != NULL )
+        {
+            ( pxTCB->uxMutexesHeld )++;
+            pxLock->pxNext = pxTCB->pxLocksHeld;
+            pxTCB->pxLocksHeld = pxLock;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return pxTCB;
+    }
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_MUTEXES == 1 )
 
     BaseType_t xTaskPriorityDisinherit( TaskHandle_t const pxMutexHolder )
+    {
+        return xTaskPriorityDisinheritLock( pxMutexHolder, NULL );
+    }
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+    BaseType_t xTaskPriorityDisinheritLock( TaskHandle_t const pxMutexHolder,
+                                            HeldLock_t * const pxLock )
     {
         TCB_t * const pxTCB = pxMutexHolder;
+        HeldLock_t ** ppxLink;
+        UBaseType_t uxPriorityToUse;
         BaseType_t xReturn = pdFALSE;
 
         if( pxMutexHolder != NULL )
@@ -4169,37 +4363,46 @@ static void prvResetNextTaskUnblockTime( void )
             configASSERT( pxTCB->uxMutexesHeld );
             ( pxTCB->uxMutexesHeld )--;
 
+            if( pxLock != NULL )
+            {
+                /* Unlink the lock from those the task holds.  Few locks are
+                 * held at once, so the walk is short. */
+                ppxLink = &( pxTCB->pxLocksHeld );
+
+                while( *ppxLink != pxLock )
+                {
+                    configASSERT( *ppxLink != NULL );
+                    ppxLink = &( ( *ppxLink )->pxNext );
+                }
+
+                *ppxLink = pxLock->pxNext;
+                pxLock->pxNext = NULL;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
             /* Has the holder of the mutex inherited the priority of another
              * task? */
             if( pxTCB->uxPriority != pxTCB->uxBasePriority )
             {
-                /* Only disinherit if no other mutexes are held. */
-                if( pxTCB->uxMutexesHeld == ( UBaseType_t ) 0 )
+                /* Drop to the priority still justified by the locks that remain
+                 * held.  If some of those were not registered their waiters are
+                 * unknown, so only disinherit once no locks are held at all. */
+                if( prvGetHeldLocksPriority( pxTCB, &uxPriorityToUse ) == pdFALSE )
                 {
-                    /* A task can only have an inherited priority if it holds
-                     * the mutex.  If the mutex is held by a task then it cannot be
-                     * given from an interrupt, and if a mutex is given by the
-                     * holding task then it must be the running state task.  Remove
-                     * the holding task from the ready list. */
-                    if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
-                    {
-                        portRESET_READY_PRIORITY( pxTCB->uxPriority, uxTopReadyPriority );
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
-
-                    /* Disinherit the priority before adding the task into the
-                     * new  ready list. */
-                    traceTASK_PRIORITY_DISINHERIT( pxTCB, pxTCB->uxBasePriority );
-                    pxTCB->uxPriority = pxTCB->uxBasePriority;
+                    uxPriorityToUse = pxTCB->uxPriority;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
 
-                    /* Reset the event list item value.  It cannot be in use for
-                     * any other purpose if this task is running, and it must be
-                     * running to give back the mutex. */
-                    listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) pxTCB->uxPriority ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
-                    prvAddTaskToReadyList( pxTCB );
+                if( pxTCB->uxPriority != uxPriorityToUse )
+                {
+                    traceTASK_PRIORITY_DISINHERIT( pxTCB, uxPriorityToUse );
+                    prvSetInheritedPriority( pxTCB, uxPriorityToUse );
 
                     /* Return true to indicate that a context switch is required.
                      * This is only actually required in the corner case whereby
@@ -4207,8 +4410,8 @@ static void prvResetNextTaskUnblockTime( void )
                      * in an order different to that in which they were taken.
                      * If a context switch did not occur when the first mutex was
                      * returned, even if a task was waiting on it, then a context
-                     * switch should occur when the last mutex is returned whether
-                     * a task is waiting on it or not. */
+                     * switch should occur when the priority drops whether a task
+                     * is waiting on the mutex or not. */
                     xReturn = pdTRUE;
                 }
                 else
@@ -4238,7 +4441,7 @@ static void prvResetNextTaskUnblockTime( void )
                                               UBaseType_t uxHighestPriorityWaitingTask )
     {
         TCB_t * const pxTCB = pxMutexHolder;
-        UBaseType_t uxPriorityUsedOnEntry, uxPriorityToUse;
+        UBaseType_t uxPriorityToUse;
         const UBaseType_t uxOnlyOneMutexHeld = ( UBaseType_t ) 1;
 
         if( pxMutexHolder != NULL )
@@ -4248,71 +4451,91 @@ static void prvResetNextTaskUnblockTime( void )
             configASSERT( pxTCB->uxMutexesHeld );
 
             /* Determine the priority to which the priority of the task that
-             * holds the mutex should be set.  This will be the greater of the
-             * holding task's base priority and the priority of the highest
-             * priority task that is waiting to obtain the mutex. */
-            if( pxTCB->uxBasePriority < uxHighestPriorityWaitingTask )
+             * holds the mutex should be set.  When every lock the holder has is
+             * registered this accounts for the waiters on all of them, the task
+             * that timed out having already left its lock's list.  Otherwise
+             * fall back to the greater of the holder's base priority and the
+             * priority of the highest priority task that is waiting to obtain
+             * the mutex - but only if this is the one mutex held, as the other
+             * mutexes may have caused the priority inheritance. */
+            if( prvGetHeldLocksPriority( pxTCB, &uxPriorityToUse ) == pdFALSE )
             {
-                uxPriorityToUse = uxHighestPriorityWaitingTask;
+                if( pxTCB->uxMutexesHeld == uxOnlyOneMutexHeld )
+                {
+                    if( pxTCB->uxBasePriority < uxHighestPriorityWaitingTask )
+                    {
+                        uxPriorityToUse = uxHighestPriorityWaitingTask;
+                    }
+                    else
+                    {
+                        uxPriorityToUse = pxTCB->uxBasePriority;
+                    }
+                }
+                else
+                {
+                    uxPriorityToUse = pxTCB->uxPriority;
+                }
             }
             else
             {
-                uxPriorityToUse = pxTCB->uxBasePriority;
+                mtCOVERAGE_TEST_MARKER();
             }
 
             /* Does the priority need to change? */
             if( pxTCB->uxPriority != uxPriorityToUse )
             {
-                /* Only disinherit if no other mutexes are held.  This is a
-                 * simplification in the priority inheritance implementation.  If
-                 * the task that holds the mutex is also holding other mutexes then
-                 * the other mutexes may have caused the priority inheritance. */
-                if( pxTCB->uxMutexesHeld == uxOnlyOneMutexHeld )
-                {
-                    /* If a task has timed out because it already holds the
-                     * mutex it was trying to obtain then it cannot of inherited
-                     * its own priority. */
-                    configASSERT( pxTCB != pxCurrentTCB );
+                /* If a task has timed out because it already holds the
+                 * mutex it was trying to obtain then it cannot of inherited
+                 * its own priority. */
+                configASSERT( pxTCB != pxCurrentTCB );
 
-                    /* Disinherit the priority, remembering the previous
-                     * priority to facilitate determining the subject task's
-                     * state. */
-                    traceTASK_PRIORITY_DISINHERIT( pxTCB, uxPriorityToUse );
-                    uxPriorityUsedOnEntry = pxTCB->uxPriority;
-                    pxTCB->uxPriority = uxPriorityToUse;
+                traceTASK_PRIORITY_DISINHERIT( pxTCB, uxPriorityToUse );
+                prvSetInheritedPriority( pxTCB, uxPriorityToUse );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
 
-                    /* Only reset the event list item value if the value is not
-                     * being used for anything else. */
-                    if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
-                    {
-                        listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxPriorityToUse ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
 
-                    /* If the running task is not the task that holds the mutex
-                     * then the task that holds the mutex could be in either the
-                     * Ready, Blocked or Suspended states.  Only remove the task
-                     * from its current state list if it is in the Ready state as
-                     * the task's priority is going to change and there is one
-                     * Ready list per priority. */
-                    if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ uxPriorityUsedOnEntry ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
-                    {
-                        if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
-                        {
-                            /* It is known that the task is in its ready list so
-                             * there is no need to check again and the port level
-                             * reset macro can be called directly. */
-                            portRESET_READY_PRIORITY( pxTCB->uxPriority, uxTopReadyPriority );
-                        }
-                        else
-                        {
-                            mtCOVERAGE_TEST_MARKER();
-                        }
+#if ( configUSE_MUTEXES == 1 )
+
+    static BaseType_t prvGetHeldLocksPriority( const TCB_t * const pxTCB,
+                                               UBaseType_t * const puxPriority )
+    {
+        const HeldLock_t * pxLock;
+        const List_t * pxWaitingTasks;
+        UBaseType_t uxLocks = ( UBaseType_t ) 0;
+        UBaseType_t uxPriority = pxTCB->uxBasePriority;
+        UBaseType_t uxWaiting;
+        UBaseType_t uxList;
+        BaseType_t xReturn = pdFALSE;
+
+        for( pxLock = pxTCB->pxLocksHeld; pxLock != NULL; pxLock = pxLock->pxNext )
+        {
+            uxLocks++;
 
-                        prvAddTaskToReadyList( pxTCB );
+            for( uxList = ( UBaseType_t ) 0; uxList < ( UBaseType_t ) taskHELD_LOCK_WAIT_LISTS; uxList++ )
+            {
+                pxWaitingTasks = pxLock->pxWaitingTasks[ uxList ];
+
+                /* The lists are in priority order, so the head of each is its
+                 * highest priority waiter. */
+                if( ( pxWaitingTasks != NULL ) && ( listLIST_IS_EMPTY( pxWaitingTasks ) == pdFALSE ) )
+                {
+                    uxWaiting = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxWaitingTasks );
+
+                    if( uxWaiting > uxPriority )
+                    {
+                        uxPriority = uxWaiting;
                     }
                     else
                     {
@@ -4324,10 +4547,62 @@ static void prvResetNextTaskUnblockTime( void )
                     mtCOVERAGE_TEST_MARKER();
                 }
             }
+        }
+
+        if( uxLocks == pxTCB->uxMutexesHeld )
+        {
+            *puxPriority = uxPriority;
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xReturn;
+    }
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+    static void prvSetInheritedPriority( TCB_t * const pxTCB,
+                                         UBaseType_t uxPriorityToUse )
+    {
+        const UBaseType_t uxPriorityUsedOnEntry = pxTCB->uxPriority;
+
+        pxTCB->uxPriority = uxPriorityToUse;
+
+        /* Only reset the event list item value if the value is not being used
+         * for anything else. */
+        if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
+        {
+            listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxPriorityToUse ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* The task could be in either the Ready (or Running), Blocked or
+         * Suspended states.  Only move it if it is in the Ready state, as there
+         * is one Ready list per priority. */
+        if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ uxPriorityUsedOnEntry ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+        {
+            if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
+            {
+                /* It is known that the task is in its ready list so there is
+                 * no need to check again and the port level reset macro can be
+                 * called directly. */
+                portRESET_READY_PRIORITY( uxPriorityUsedOnEntry, uxTopReadyPriority );
+            }
             else
             {
                 mtCOVERAGE_TEST_MARKER();
             }
+
+            prvAddTaskToReadyList( pxTCB );
         }
         else
         {
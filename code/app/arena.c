@@ -0,0 +1,38 @@
+// -*- c++ -*-
+/**
+   Per-task bump arenas, see arena.h
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "arena.h"
+
+bool arena_attach(TaskHandle_t task, size_t size, size_t budget,
+                  ArenaOverflowHook overflow) {
+    configASSERT(pvTaskGetThreadLocalStoragePointer(task, ARENA_TLS_INDEX)
+                 == ((void*)0));
+
+    // round the header up so the region starts aligned
+    size_t header = (sizeof(Arena) + (ARENA_ALIGNMENT - 1u))
+        & ~(size_t)(ARENA_ALIGNMENT - 1u);
+    uint8_t * block = pvPortMalloc(header + size);
+    if (block == ((void*)0))
+        return false;
+
+    Arena * a = (Arena *)block;
+    a->base = block + header;
+    a->budget = (budget == 0u || budget > size) ? size : budget;
+    a->used = 0u;
+    a->peak = 0u;
+    a->overflow = overflow;
+
+    vTaskSetThreadLocalStoragePointer(task, ARENA_TLS_INDEX, a);
+    return true;
+}
+
+void arena_detach(TaskHandle_t task) {
+    Arena * a = pvTaskGetThreadLocalStoragePointer(task, ARENA_TLS_INDEX);
+
+    vTaskSetThreadLocalStoragePointer(task, ARENA_TLS_INDEX, ((void*)0));
+    vPortFree(a);
+}
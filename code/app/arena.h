@@ -0,0 +1,91 @@
+/** -*- c++ -*-
+   arena.h: per-task bump allocator for short-lived working buffers
+
+   A task that allocates scratch buffers every cycle attaches an arena
+   once, allocates from it with arena_alloc(), and calls arena_reset()
+   at the end of the cycle to discard everything in O(1).  Nothing is
+   ever freed individually, so there is no locking and no list walk,
+   unlike pvPortMalloc.
+
+   The arena lives in the task's thread-local storage slot
+   ARENA_TLS_INDEX, so only the owning task may allocate from it.
+ */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// thread-local storage slot holding the Arena pointer
+#define ARENA_TLS_INDEX 0
+
+#if configNUM_THREAD_LOCAL_STORAGE_POINTERS <= ARENA_TLS_INDEX
+#error "arena.h needs configNUM_THREAD_LOCAL_STORAGE_POINTERS > ARENA_TLS_INDEX"
+#endif
+
+// allocations are rounded up to this, matching heap_4
+#define ARENA_ALIGNMENT portBYTE_ALIGNMENT
+
+typedef struct arena Arena;
+
+/** Called when an allocation would exceed the arena's budget, before
+    arena_alloc() returns NULL.  May log, or reset the arena. */
+typedef void (*ArenaOverflowHook)(Arena * arena, size_t wanted);
+
+struct arena {
+    uint8_t * base;
+    size_t budget;              // bytes usable per cycle, <= region size
+    size_t used;                // bytes handed out since the last reset
+    size_t peak;                // largest `used` ever seen
+    ArenaOverflowHook overflow; // optional, may be NULL
+};
+
+/** Carve an arena of `size` bytes from the heap and attach it to
+    `task` (NULL means the calling task).
+
+    `budget` caps how much may be allocated per cycle; 0 means the
+    whole region.  Call this right after creating the task, or first
+    thing in the task function.  Returns false if the heap is
+    exhausted.
+ */
+bool arena_attach(TaskHandle_t task, size_t size, size_t budget,
+                  ArenaOverflowHook overflow);
+
+// return the arena's region to the heap, before deleting the task
+void arena_detach(TaskHandle_t task);
+
+/** Allocate `n` bytes from the calling task's arena.
+
+    Returns NULL (after calling the overflow hook, if any) when the
+    budget would be exceeded.
+ */
+static inline void * arena_alloc(size_t n) {
+    Arena * a = pvTaskGetThreadLocalStoragePointer(((void*)0), ARENA_TLS_INDEX);
+    configASSERT(a != ((void*)0));
+
+    n = (n + (ARENA_ALIGNMENT - 1u)) & ~(size_t)(ARENA_ALIGNMENT - 1u);
+    if (n > a->budget - a->used) {
+        if (a->overflow != ((void*)0))
+            a->overflow(a, n);
+        return ((void*)0);
+    }
+
+    void * p = a->base + a->used;
+    a->used += n;
+    if (a->used > a->peak)
+        a->peak = a->used;
+    return p;
+}
+
+// discard everything allocated from the calling task's arena
+static inline void arena_reset(void) {
+    Arena * a = pvTaskGetThreadLocalStoragePointer(((void*)0), ARENA_TLS_INDEX);
+    configASSERT(a != ((void*)0));
+    a->used = 0u;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,75 @@
+/** -*- c++ -*-
+   bitband.h: single-bit access through the Cortex-M3 bit-band aliases
+
+   Setting one bit of a shared register with `reg |= bit` is a load,
+   an OR and a store; an interrupt in between that changes another bit
+   of the same register has its change overwritten.  The Cortex-M3
+   maps every bit of the first 1 MB of SRAM (0x20000000) and of the
+   peripherals (0x40000000) to a word of its own in an alias region
+   (0x22000000 and 0x42000000).  Storing 0 or 1 to the alias word
+   clears or sets just that bit, in a single store the bus performs as
+   an atomic read-modify-write, so no critical section is needed.
+
+       BITBAND(RCC->APB2ENR, 2) = 1u;     // IOPAEN, atomically
+       if (BITBAND(GPIOC->IDR, 13)) ...   // read one bit
+
+   With a constant register and bit, BITBAND folds to a constant
+   address.  Only registers and variables inside the two bit-band
+   regions can be used: the whole peripheral space of the f103rb
+   qualifies, as does all of its 20 KB of SRAM.
+ */
+#ifndef BITBAND_H
+#define BITBAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#define BITBAND_SRAM_BASE       0x20000000u
+#define BITBAND_PERIPH_BASE     0x40000000u
+#define BITBAND_REGION_SIZE     0x00100000u  // 1 MB per region
+
+/** Alias address of bit `bit` of the word at `addr`.  The region's
+    alias starts 32 MB above its base, and each byte of the region
+    becomes 32 bytes of alias, one word per bit. */
+#define BITBAND_ALIAS_ADDR(addr, bit)                                   \
+    (((uintptr_t)(addr) & 0xf0000000u) + 0x02000000u                    \
+     + (((uintptr_t)(addr) & 0x000fffffu) << 5) + ((uintptr_t)(bit) << 2))
+
+// the alias word of bit `bit` of lvalue `reg`, to read or write
+#define BITBAND(reg, bit)                                               \
+    (*(uint32_t volatile *)BITBAND_ALIAS_ADDR(&(reg), (bit)))
+
+static inline bool bitband_in_region(void const volatile * addr) {
+    uintptr_t a = (uintptr_t)addr;
+
+    return (a - BITBAND_SRAM_BASE < BITBAND_REGION_SIZE)
+        || (a - BITBAND_PERIPH_BASE < BITBAND_REGION_SIZE);
+}
+
+// as BITBAND, checking at run time that `word` is bit-band addressable
+static inline uint32_t volatile * bitband_alias(uint32_t volatile * word,
+                                                unsigned bit) {
+    assert(bitband_in_region(word));
+    assert(bit < 32u);
+    return (uint32_t volatile *)BITBAND_ALIAS_ADDR(word, bit);
+}
+
+static inline void bitband_set(uint32_t volatile * word, unsigned bit) {
+    *bitband_alias(word, bit) = 1u;
+}
+
+static inline void bitband_clear(uint32_t volatile * word, unsigned bit) {
+    *bitband_alias(word, bit) = 0u;
+}
+
+static inline void bitband_write(uint32_t volatile * word, unsigned bit,
+                                 bool on) {
+    *bitband_alias(word, bit) = on ? 1u : 0u;
+}
+
+static inline bool bitband_read(uint32_t volatile const * word, unsigned bit) {
+    return *bitband_alias((uint32_t volatile *)word, bit) != 0u;
+}
+
+#endif // BITBAND_H
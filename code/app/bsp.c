@@ -6,19 +6,19 @@
 #include <stm32f10x.h>
 #include "bsp.h"
 
-// introduce global variable, shared between an ISR and a thread
+// presses confirmed by button-input.c, read by the display thread
 uint32_t gl_button_count = 0u;
 
-// prototype for external ISR function used here
-void EXTI15_10_IRQHandler(void);
-
 void afio_exticr_source(Port port, Pin pin) {
     assert(0 <= port && port < 5);  // how to avoid magic number 5 here?
     assert(0 <= pin && pin < 16);
 
     uint32_t idx = pin / 4;  // was constrained to 0..15, now 0..3
     uint32_t nybble = pin % 4;
-    AFIO->EXTICR[idx] = (uint32_t)port << (nybble*4); // bits[idx] <- port;
+    uint32_t shift = nybble*4;
+    // bits[shift+3:shift] <- port, leaving the other three lines alone
+    AFIO->EXTICR[idx] = (AFIO->EXTICR[idx] & ~(0xfu << shift))
+        | ((uint32_t)port << shift);
 }
 
 void NVIC_set_enable(uint32_t irq_num) {
@@ -44,13 +44,6 @@ void NVIC_set_enable(uint32_t irq_num) {
     __asm volatile("":::"memory");
 }
 
-// Handle USER button interrupt.  The name for this is determined
-// by searching through the startup assembly code
-void EXTI15_10_IRQHandler(void) {
-    EXTI->PR |= (1u << 13);
-    gl_button_count++;
-}
-
 void NVIC_clr_pending(uint32_t irq_num) {
     // the f103rb only supports IRQ# 0-68 (or 0-0x44)
     assert(irq_num < 68);
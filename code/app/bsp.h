@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stm32f10x.h>
+#include "bitband.h"
 
 // used for range-checking input parameters
 typedef enum { PortA, PortB, PortC, PortD, PortE
@@ -34,53 +35,60 @@ typedef enum {
     Pin8, Pin9, Pin10, Pin11, Pin12, Pin13, Pin14, Pin15,
 } Pin;
 
+// The board's pins, as descriptors for the GPIO_* macros in gpio-drivers.h
+#define LED_USER    GPIOA, Pin5     // LD2 on the nucleo board
+#define LED_RED     GPIOB, Pin10
+#define LED_YELLOW  GPIOA, Pin8
+#define LED_GREEN   GPIOA, Pin9
+#define LED_BLUE    GPIOB, Pin6
+#define BUTTON_USER GPIOC, Pin13    // B1, low when pressed
+
 // NVIC-related functions
 void NVIC_set_enable(uint32_t irq_num);
 void NVIC_clr_pending(uint32_t irq_num);
 
+// route EXTI line `pin` to `port`; read-modify-write of a register
+// shared by four lines, so callers serialise (exti_attach does)
 void afio_exticr_source(Port port, Pin pin);
 
 // Many of these function can be inlined
 
+// The helpers below change one bit of a register that tasks and ISRs
+// share, so each does it with a single bit-band store, see bitband.h
+
 // clock enabling-disabling functions
 static inline void enable_afio_clk(void) {
-    RCC->APB2ENR |= (1u << 0); // bits[0] = AFIOEN <- 1
+    BITBAND(RCC->APB2ENR, 0) = 1u; // bits[0] = AFIOEN <- 1
 }
 static inline void enable_gpioa_clk(void) {
-    RCC->APB2ENR |= (1u << 2); // bits[2] = IOPAEN <- 1
+    BITBAND(RCC->APB2ENR, 2) = 1u; // bits[2] = IOPAEN <- 1
 }
 static inline void enable_gpiob_clk(void) {
-    RCC->APB2ENR |= (1u << 3); // bits[3] = IOPAEN <- 1
+    BITBAND(RCC->APB2ENR, 3) = 1u; // bits[3] = IOPBEN <- 1
 }
 static inline void enable_gpioc_clk(void) {
-    RCC->APB2ENR |= (1u << 4); // bits[4] = IOPCEN <- 1
+    BITBAND(RCC->APB2ENR, 4) = 1u; // bits[4] = IOPCEN <- 1
 }
 static inline void enable_gpiod_clk(void) {
-    RCC->APB2ENR |= (1u << 5); // bits[5] = IOPCEN <- 1
+    BITBAND(RCC->APB2ENR, 5) = 1u; // bits[5] = IOPDEN <- 1
 }
 
-// External event/interrupt configuration
+// External event/interrupt configuration.  Lines 0-15 are the GPIO
+// pins, 16-18 are PVD, RTC alarm and USB wakeup; see also exti.h
+#define EXTI_LINES 19u
+
 static inline void exti_unmask(uint32_t line, bool unmask) {
-    assert(line==13);
-    if (unmask)
-        EXTI->IMR |= (1u << line); // bits[line] <- 1
-    else
-        EXTI->IMR &= ~(1u << line); // bits[line] <- 0
+    assert(line < EXTI_LINES);
+    BITBAND(EXTI->IMR, line) = unmask; // bits[line] <- unmask
 }
 
 static inline void exti_falling_edge_trig(uint32_t line, bool enable) {
-    assert(line==13);
-    if (enable)
-        EXTI->FTSR |= (1u << line);
-    else
-        EXTI->FTSR &= ~(1u << line);
+    assert(line < EXTI_LINES);
+    BITBAND(EXTI->FTSR, line) = enable;
 }
 static inline void exti_rising_edge_trig(uint32_t line, bool enable) {
-    assert(line==13);
-    if (enable)
-        EXTI->RTSR |= (1u << line);
-    else
-        EXTI->RTSR &= ~(1u << line);
+    assert(line < EXTI_LINES);
+    BITBAND(EXTI->RTSR, line) = enable;
 }
 
 // introduce global variable, shared between an ISR and a thread
@@ -0,0 +1,34 @@
+// -*- c++ -*-
+/**
+   Debounce decisions for button-input.c, see button-debounce.h
+ */
+
+#include "button-debounce.h"
+
+void button_debounce_init(ButtonDebounce * d, bool pressed) {
+    d->pressed = pressed;
+    d->burst = false;
+    d->edge_time = 0u;
+}
+
+void button_debounce_edge(ButtonDebounce * d, TickType_t now) {
+    if (!d->burst) {
+        d->burst = true;
+        d->edge_time = now;
+    }
+}
+
+bool button_debounce_settled(ButtonDebounce * d, bool pressed) {
+    d->burst = false;
+    if (pressed == d->pressed)
+        return false;           // a glitch, or a press and release
+    d->pressed = pressed;
+    return true;
+}
+
+bool button_debounce_moved(ButtonDebounce * d, bool pressed, TickType_t now) {
+    if (pressed == d->pressed)
+        return false;
+    button_debounce_edge(d, now);
+    return true;
+}
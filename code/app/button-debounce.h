@@ -0,0 +1,45 @@
+/** -*- c++ -*-
+   button-debounce.h: the debounce decisions of button-input.c
+
+   Plain logic on a ButtonDebounce, free of the hardware and of the
+   kernel's timers, so it also builds on the host
+   (tools/test-debounce.c).  button-input.c supplies the pin readings,
+   the EXTI mask and the timer around it.
+
+   A burst begins at its first edge, whose time it keeps.  It ends
+   when the debounce timer expires and the pin is read: if the level
+   differs from the last confirmed one, that is a press or a release,
+   stamped with the burst's first edge.
+ */
+#ifndef BUTTON_DEBOUNCE_H
+#define BUTTON_DEBOUNCE_H
+
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+
+typedef struct {
+    bool pressed;               // last confirmed state
+    bool burst;                 // an edge is waiting to be confirmed
+    TickType_t edge_time;       // first edge of the burst
+} ButtonDebounce;
+
+// start from the pin's current level, with no burst
+void button_debounce_init(ButtonDebounce * d, bool pressed);
+
+/** An edge at `now`.  The first edge of a burst sets its time; a
+    later one, which only comes if the debounce timer could not be
+    started and the line was unmasked again, keeps it. */
+void button_debounce_edge(ButtonDebounce * d, TickType_t now);
+
+/** The debounce timer expired with the pin reading `pressed`, which
+    ends the burst.  True if that is a change of the confirmed state,
+    now in d->pressed, first seen at d->edge_time. */
+bool button_debounce_settled(ButtonDebounce * d, bool pressed);
+
+/** With the line unmasked again, the pin reads `pressed` at `now`.
+    True if it has moved since it settled, without leaving a pending
+    bit: that starts a new burst, to be timed like an edge. */
+bool button_debounce_moved(ButtonDebounce * d, bool pressed, TickType_t now);
+
+#endif // BUTTON_DEBOUNCE_H
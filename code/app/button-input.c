@@ -0,0 +1,113 @@
+// -*- c++ -*-
+/**
+   Debounced button events, see button-input.h
+ */
+
+#include <stdbool.h>
+#include <assert.h>
+#include <stm32f10x.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+#include "bsp.h"
+#include "gpio-drivers.h"
+#include "exti.h"
+#include "static-objects.h"
+#include "button-debounce.h"
+#include "button-input.h"
+
+#define LINE 13u                // EXTI line of PC13
+
+static TimerHandle_t gl_debounce = ((void*)0);
+STATIC_TIMER(gl_debounce);
+static TimerHandle_t gl_long_press = ((void*)0);
+STATIC_TIMER(gl_long_press);
+static QueueHandle_t gl_events = ((void*)0);
+
+// the ISR touches it only while the line is unmasked, the timer
+// callback only while it is masked or in a critical section
+static ButtonDebounce gl_state;
+
+static bool pin_pressed(void) {
+    return GPIO_READ(BUTTON_USER) == 0u;   // B1 pulls PC13 low
+}
+
+static void post(ButtonEventType type, TickType_t time) {
+    ButtonEvent ev = { type, time };
+
+    if (gl_events != ((void*)0))
+        (void) xQueueSend(gl_events, &ev, 0);
+}
+
+// the pin has been quiet since the first edge: see where it settled
+static void debounce_expired(TimerHandle_t timer) {
+    bool again;
+
+    if (button_debounce_settled(&gl_state, pin_pressed())) {
+        if (gl_state.pressed) {
+            gl_button_count++;
+            post(BUTTON_PRESS, gl_state.edge_time);
+            (void) xTimerReset(gl_long_press, 0);
+        } else {
+            post(BUTTON_RELEASE, gl_state.edge_time);
+            (void) xTimerStop(gl_long_press, 0);
+        }
+    }
+
+    // listen again.  An edge after the pin was read but before the
+    // line was unmasked left no pending bit, so read the pin once more;
+    // the ISR cannot run in between
+    taskENTER_CRITICAL();
+    EXTI->PR = 1u << LINE;
+    exti_unmask(LINE, true);
+    again = button_debounce_moved(&gl_state, pin_pressed(),
+                                  xTaskGetTickCount());
+    if (again)
+        exti_unmask(LINE, false);
+    taskEXIT_CRITICAL();
+
+    // with the timer queue full, leave the next edge to try again
+    if (again && xTimerReset(timer, 0) != pdPASS)
+        exti_unmask(LINE, true);
+}
+
+static void long_press_expired(TimerHandle_t timer) {
+    (void) timer;
+    if (gl_state.pressed)
+        post(BUTTON_LONG_PRESS, xTaskGetTickCount());
+}
+
+// the first edge of a burst: the dispatcher has cleared its pending bit
+static void edge(Pin line, void * ctx, BaseType_t * woken) {
+    (void) line;
+    (void) ctx;
+    button_debounce_edge(&gl_state, xTaskGetTickCountFromISR());
+
+    // deaf to the bounces that follow, but only once the timer is
+    // sure to unmask the line again; with the timer queue full, the
+    // next edge tries again and the burst keeps this edge's time
+    if (xTimerResetFromISR(gl_debounce, woken) == pdPASS)
+        exti_unmask(LINE, false);
+}
+
+void button_input_init(QueueHandle_t events) {
+    assert(gl_debounce == ((void*)0));
+
+    gl_events = events;
+    gl_debounce = STATIC_TIMER_CREATE(gl_debounce, "debounce",
+        pdMS_TO_TICKS(BUTTON_DEBOUNCE_MS), pdFALSE, ((void*)0),
+        debounce_expired);
+    gl_long_press = STATIC_TIMER_CREATE(gl_long_press, "long press",
+        pdMS_TO_TICKS(BUTTON_LONG_PRESS_MS), pdFALSE, ((void*)0),
+        long_press_expired);
+
+    enable_gpioc_clk();
+    GPIO_CONFIG(BUTTON_USER, GPIO_IN_FLOATING);
+    button_debounce_init(&gl_state, pin_pressed());
+
+    // both edges: presses and releases
+    exti_attach(PortC, Pin13, EXTI_BOTH_EDGES, edge, ((void*)0));
+}
+
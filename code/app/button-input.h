@@ -0,0 +1,56 @@
+/** -*- c++ -*-
+   button-input.h: debounced, timestamped events from the USER button
+
+   A mechanical button bounces for several milliseconds on every press
+   and release, and an interrupt per edge turns one press into a burst
+   of them.  Here the first edge masks the EXTI line, notes the time
+   and starts a one-shot debounce timer; only when the timer expires
+   is the pin read, with the line unmasked again.  A bounce storm so
+   costs a single interrupt, and the event is stamped with the time of
+   its first edge.
+   If the timer cannot be started, the line stays unmasked and the
+   next edge tries again.  The decisions themselves are in
+   button-debounce.h.
+
+   Confirmed changes are posted as ButtonEvents: a press, a release,
+   and a long press if the button stays down BUTTON_LONG_PRESS_MS.
+   Each press also counts in gl_button_count.
+
+   The timers are kernel software timers, which run in the timer
+   daemon task: every hardware timer of the f103rb is taken already.
+ */
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+// how long the pin must be left alone before it is read
+#ifndef BUTTON_DEBOUNCE_MS
+#define BUTTON_DEBOUNCE_MS 20u
+#endif
+
+#ifndef BUTTON_LONG_PRESS_MS
+#define BUTTON_LONG_PRESS_MS 1000u
+#endif
+
+typedef enum {
+    BUTTON_PRESS,
+    BUTTON_RELEASE,
+    BUTTON_LONG_PRESS,          // still held BUTTON_LONG_PRESS_MS on
+} ButtonEventType;
+
+typedef struct {
+    ButtonEventType type;
+    TickType_t time;            // tick count at the first edge
+} ButtonEvent;
+
+/** Configure PC13, attach to its EXTI line (see exti.h), and start
+    watching the button.
+    Events go to `events`, a queue of ButtonEvent, or nowhere if it is
+    NULL; they are dropped if the queue is full.  Call once. */
+void button_input_init(QueueHandle_t events);
+
+#endif // BUTTON_INPUT_H
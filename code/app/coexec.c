@@ -0,0 +1,189 @@
+// -*- c++ -*-
+/**
+   Stackless coroutine executor, see coexec.h
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "coexec.h"
+
+static Co gl_pool[CO_POOL_SIZE];
+static Co * gl_free = ((void*)0);
+static unsigned gl_used = 0u;
+static bool gl_ready = false;
+
+static Co * take(void) {
+    Co * co;
+
+    taskENTER_CRITICAL();
+    if (!gl_ready) {
+        for (unsigned i = 0; i < CO_POOL_SIZE; ++i) {
+            gl_pool[i].next = gl_free;
+            gl_free = &gl_pool[i];
+        }
+        gl_ready = true;
+    }
+    co = gl_free;
+    if (co != ((void*)0)) {
+        gl_free = co->next;
+        gl_used++;
+    }
+    taskEXIT_CRITICAL();
+    return co;
+}
+
+static void give(Co * co) {
+    taskENTER_CRITICAL();
+    co->next = gl_free;
+    gl_free = co;
+    gl_used--;
+    taskEXIT_CRITICAL();
+}
+
+unsigned co_pool_used(void) {
+    return gl_used;
+}
+
+// ticks left before `co`'s wait times out, portMAX_DELAY if it never does
+static TickType_t remaining(Co const * co, TickType_t now) {
+    TickType_t waited = now - co->since;
+
+    if (co->ticks == portMAX_DELAY)
+        return portMAX_DELAY;
+    return (waited >= co->ticks) ? 0u : co->ticks - waited;
+}
+
+/** Is `co` ready to resume?  Consumes what it was waiting for, and
+    sets co->ok. */
+static bool ready(CoExec * ex, Co * co, TickType_t now) {
+    switch (co->wait) {
+    case CO_WAIT_NONE:
+        co->ok = true;
+        return true;
+
+    case CO_WAIT_DELAY:
+        co->ok = true;
+        return remaining(co, now) == 0u;
+
+    case CO_WAIT_QUEUE:
+        co->ok = (xQueueReceive(co->queue, co->item, 0) == pdTRUE);
+        break;
+
+    case CO_WAIT_NOTIFY:
+        co->bits = ex->pending & co->mask;
+        ex->pending &= ~co->bits;
+        co->ok = (co->bits != 0u);
+        break;
+
+    default:
+        return false;
+    }
+    return co->ok || remaining(co, now) == 0u;
+}
+
+// run every ready coroutine once; returns how long the executor may sleep
+static TickType_t step(CoExec * ex) {
+    TickType_t sleep = portMAX_DELAY;
+    TickType_t now = xTaskGetTickCount();
+    Co ** link = &ex->running;
+
+    while (*link != ((void*)0)) {
+        Co * co = *link;
+
+        if (ready(ex, co, now)) {
+            co->wait = CO_WAIT_NONE;
+            co->fn(co);
+        }
+
+        if (co->wait == CO_WAIT_DONE) {
+            *link = co->next;
+            give(co);
+            continue;
+        }
+
+        TickType_t t = remaining(co, xTaskGetTickCount());
+        if (co->wait == CO_WAIT_NONE)
+            t = 0u;
+        else if (co->wait == CO_WAIT_QUEUE && t > CO_QUEUE_POLL_TICKS)
+            t = CO_QUEUE_POLL_TICKS;
+        if (t < sleep)
+            sleep = t;
+        link = &co->next;
+    }
+    return sleep;
+}
+
+// take over the coroutines spawned since the last pass
+static void adopt(CoExec * ex) {
+    taskENTER_CRITICAL();
+    Co * spawned = ex->spawned;
+    ex->spawned = ((void*)0);
+    taskEXIT_CRITICAL();
+
+    while (spawned != ((void*)0)) {
+        Co * co = spawned;
+        spawned = co->next;
+        co->next = ex->running;
+        ex->running = co;
+    }
+}
+
+static void executor(void * param) {
+    CoExec * ex = param;
+    TickType_t sleep = 0u;
+    uint32_t bits;
+
+    for (;;) {
+        if (xTaskNotifyWait(0u, UINT32_MAX, &bits, sleep) == pdTRUE)
+            ex->pending |= bits;
+        adopt(ex);
+        sleep = step(ex);
+    }
+}
+
+bool co_exec_create(CoExec * ex, char const * name,
+                    configSTACK_DEPTH_TYPE stack_words, UBaseType_t priority) {
+    ex->running = ((void*)0);
+    ex->spawned = ((void*)0);
+    ex->pending = 0u;
+    return xTaskCreate(executor, name, stack_words, ex, priority,
+                       &ex->task) == pdPASS;
+}
+
+Co * co_spawn(CoExec * ex, CoFn fn, void * arg, size_t locals) {
+    assert(fn != ((void*)0));
+    assert(locals <= sizeof gl_pool[0].frame);
+
+    Co * co = take();
+    if (co == ((void*)0))
+        return ((void*)0);
+
+    memset(co->frame, 0, sizeof co->frame);
+    co->exec = ex;
+    co->fn = fn;
+    co->arg = arg;
+    co->resume = 0u;
+    co->wait = CO_WAIT_NONE;
+    co->ok = true;
+
+    taskENTER_CRITICAL();
+    co->next = ex->spawned;
+    ex->spawned = co;
+    taskEXIT_CRITICAL();
+
+    (void) xTaskNotify(ex->task, 0u, eNoAction);
+    return co;
+}
+
+void co_notify(CoExec * ex, uint32_t bits) {
+    (void) xTaskNotify(ex->task, bits, eSetBits);
+}
+
+void co_notify_from_isr(CoExec * ex, uint32_t bits,
+                        BaseType_t * higher_prio_task_woken) {
+    (void) xTaskNotifyFromISR(ex->task, bits, eSetBits, higher_prio_task_woken);
+}
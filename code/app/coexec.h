@@ -0,0 +1,162 @@
+/** -*- c++ -*-
+   coexec.h: stackless coroutines sharing one task
+
+   A behaviour that spends its life waiting (blink, pause, blink) does
+   not need a stack of its own while it waits.  Here many such
+   behaviours run as coroutines inside a single executor task, each
+   costing only a fixed-size frame from a static pool instead of a
+   task stack and TCB.
+
+   A coroutine is an ordinary function taking its Co.  It runs from
+   CO_BEGIN to the first CO_AWAIT_*, returns to the executor, and on
+   the next call resumes just after that await.  Being stackless, it
+   loses its local variables at every await: keep anything that must
+   survive in the frame, reached through CO_LOCALS().  Only one await
+   may appear per source line, and awaits must sit in the coroutine's
+   own body, not in functions it calls.
+
+       struct blink { unsigned n; };
+
+       static void blink(Co * co) {
+           struct blink * l = CO_LOCALS(co, struct blink);
+           CO_BEGIN(co);
+           for (l->n = 0; l->n < 10; l->n++) {
+               GPIO_WRITE(LED_USER, l->n & 1u);
+               CO_AWAIT_DELAY(co, 100);
+           }
+           CO_END(co);
+       }
+
+       co_spawn(&exec, blink, NULL, sizeof(struct blink));
+
+   A coroutine can await a delay, an item from a queue (or a take of a
+   semaphore, with a NULL buffer), or notification bits sent to the
+   executor with co_notify() / co_notify_from_isr(), e.g. by a GPIO
+   edge interrupt.  Queues are polled, so while any coroutine waits on
+   one the executor wakes every CO_QUEUE_POLL_TICKS.
+
+   A coroutine must never block the executor task itself, e.g. with
+   vTaskDelay() or a blocking queue call: every other coroutine would
+   stall with it.
+ */
+#ifndef COEXEC_H
+#define COEXEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// bytes of locals each coroutine frame can hold
+#ifndef CO_FRAME_SIZE
+#define CO_FRAME_SIZE 32u
+#endif
+
+// coroutines that can exist at once, across all executors
+#ifndef CO_POOL_SIZE
+#define CO_POOL_SIZE 8u
+#endif
+
+// how often the executor polls queues that coroutines are awaiting
+#ifndef CO_QUEUE_POLL_TICKS
+#define CO_QUEUE_POLL_TICKS 1u
+#endif
+
+typedef struct co Co;
+typedef struct co_exec CoExec;
+typedef void (*CoFn)(Co * co);
+
+typedef enum {
+    CO_WAIT_NONE,               // runnable
+    CO_WAIT_DELAY,
+    CO_WAIT_QUEUE,
+    CO_WAIT_NOTIFY,
+    CO_WAIT_DONE,               // finished, frame about to be freed
+} CoWait;
+
+struct co {
+    Co * next;
+    CoExec * exec;
+    CoFn fn;
+    void * arg;
+    unsigned resume;            // where to resume, 0 at the start
+    CoWait wait;
+    TickType_t since;           // when the current wait began
+    TickType_t ticks;           // how long it may last
+    QueueHandle_t queue;        // CO_WAIT_QUEUE: queue and item buffer
+    void * item;
+    uint32_t mask;              // CO_WAIT_NOTIFY: bits awaited,
+    uint32_t bits;              //   and those that arrived
+    bool ok;                    // false if the last await timed out
+    uint64_t frame[(CO_FRAME_SIZE + 7u) / 8u];
+};
+
+struct co_exec {
+    TaskHandle_t task;
+    Co * running;               // owned by the executor task
+    Co * spawned;               // new coroutines not yet picked up
+    uint32_t pending;           // notification bits not yet consumed
+};
+
+/** Create the task that runs `ex`'s coroutines.  Returns false if the
+    heap is exhausted. */
+bool co_exec_create(CoExec * ex, char const * name,
+                    configSTACK_DEPTH_TYPE stack_words, UBaseType_t priority);
+
+/** Start `fn` as a coroutine of `ex`, with a zeroed frame of at least
+    `locals` bytes (<= CO_FRAME_SIZE).  Callable from any task once
+    `ex` is created, before or after the scheduler starts.  Returns
+    NULL if the pool is empty. */
+Co * co_spawn(CoExec * ex, CoFn fn, void * arg, size_t locals);
+
+// set notification `bits` for `ex`'s coroutines to await
+void co_notify(CoExec * ex, uint32_t bits);
+
+// as co_notify, for use in an ISR
+void co_notify_from_isr(CoExec * ex, uint32_t bits,
+                        BaseType_t * higher_prio_task_woken);
+
+// coroutines currently in use, across all executors
+unsigned co_pool_used(void);
+
+#define CO_LOCALS(co, type) ((type *)(void *)(co)->frame)
+
+#define CO_BEGIN(co) switch ((co)->resume) { case 0u:
+
+#define CO_END(co) } (co)->wait = CO_WAIT_DONE; return
+
+// suspend here until the executor next calls this coroutine
+#define CO_AWAIT_(co, kind, timeout)                            \
+    do {                                                        \
+        (co)->wait = (kind);                                    \
+        (co)->since = xTaskGetTickCount();                      \
+        (co)->ticks = (timeout);                                \
+        (co)->resume = __LINE__; return; case __LINE__:;        \
+    } while (0)
+
+// let the other coroutines run, then carry on
+#define CO_YIELD(co) CO_AWAIT_(co, CO_WAIT_NONE, 0u)
+
+#define CO_AWAIT_DELAY(co, t) CO_AWAIT_(co, CO_WAIT_DELAY, (t))
+
+/** Receive an item from queue `q` into `buf`, waiting up to `t` ticks
+    (portMAX_DELAY for ever).  (co)->ok tells whether one arrived. */
+#define CO_AWAIT_QUEUE(co, q, buf, t)                           \
+    do {                                                        \
+        (co)->queue = (q);                                      \
+        (co)->item = (buf);                                     \
+        CO_AWAIT_(co, CO_WAIT_QUEUE, (t));                      \
+    } while (0)
+
+/** Wait up to `t` ticks for any of the notification bits in `m`.
+    The bits that arrived are in (co)->bits, and are cleared. */
+#define CO_AWAIT_NOTIFY(co, m, t)                               \
+    do {                                                        \
+        (co)->mask = (m);                                       \
+        CO_AWAIT_(co, CO_WAIT_NOTIFY, (t));                     \
+    } while (0)
+
+#endif // COEXEC_H
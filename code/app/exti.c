@@ -0,0 +1,149 @@
+// -*- c++ -*-
+/**
+   EXTI line dispatch, see exti.h
+ */
+
+#include <assert.h>
+#include <stm32f10x.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "bsp.h"
+#include "exti.h"
+
+// prototypes for the ISRs, named as in the startup code
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+
+#define LINES 16u
+
+typedef struct {
+    ExtiHandler fn;
+    void * ctx;
+} ExtiSlot;
+
+static ExtiSlot gl_slot[LINES];
+
+#if EXTI_STATS
+static ExtiStats gl_stats;
+#endif
+
+static IRQn_Type line_irq(Pin line) {
+    if (line <= Pin4)
+        return (IRQn_Type)(EXTI0_IRQn + line);
+    return (line <= Pin9) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+}
+
+void exti_attach(Port port, Pin pin, ExtiEdges edges,
+                 ExtiHandler fn, void * ctx) {
+    assert(pin < LINES);
+    assert(fn != ((void*)0));
+    assert(gl_slot[pin].fn == ((void*)0));
+
+#if EXTI_STATS
+    CoreDebug->DEMCR |= 1u << 24;   // bits[24] = TRCENA <- 1
+    DWT->CTRL |= 1u << 0;           // bits[0] = CYCCNTENA <- 1
+#endif
+
+    enable_afio_clk();
+
+    exti_unmask(pin, false);
+    gl_slot[pin].fn = fn;
+    gl_slot[pin].ctx = ctx;
+
+    // EXTICR is shared by four lines, and updated read-modify-write
+    taskENTER_CRITICAL();
+    afio_exticr_source(port, pin);
+    taskEXIT_CRITICAL();
+
+    exti_rising_edge_trig(pin, (edges & EXTI_RISING) != 0);
+    exti_falling_edge_trig(pin, (edges & EXTI_FALLING) != 0);
+    EXTI->PR = 1u << pin;       // forget edges from before
+    exti_unmask(pin, true);
+
+    // handlers call into the kernel, so must be at or below
+    // configMAX_SYSCALL_INTERRUPT_PRIORITY
+    NVIC_SetPriority(line_irq(pin), configLIBRARY_KERNEL_INTERRUPT_PRIORITY);
+    NVIC_EnableIRQ(line_irq(pin));
+}
+
+void exti_detach(Pin line) {
+    assert(line < LINES);
+
+    exti_unmask(line, false);
+    exti_rising_edge_trig(line, false);
+    exti_falling_edge_trig(line, false);
+    EXTI->PR = 1u << line;
+
+    // masked, so the dispatcher no longer looks at the slot
+    gl_slot[line].fn = ((void*)0);
+    gl_slot[line].ctx = ((void*)0);
+}
+
+// call the handlers of the pending, unmasked lines within `lines`;
+// a line with none is masked
+static void dispatch(uint32_t lines) {
+    BaseType_t woken = pdFALSE;
+    uint32_t pending = EXTI->PR & EXTI->IMR & lines;
+
+#if EXTI_STATS
+    uint32_t start = DWT->CYCCNT;
+    uint32_t in_handlers = 0u;
+    gl_stats.interrupts++;
+#endif
+
+    while (pending != 0u) {
+        Pin line = (Pin)(31u - __CLZ(pending));
+        uint32_t bit = 1u << line;
+        ExtiSlot const * s = &gl_slot[line];
+
+        pending &= ~bit;
+        EXTI->PR = bit;         // write-1-to-clear: this line only
+
+        // unmasked through bsp.h without a handler attached: drop the
+        // edge, and keep the line from pending the vector again
+        if (s->fn == ((void*)0)) {
+            exti_unmask(line, false);
+            continue;
+        }
+
+#if EXTI_STATS
+        uint32_t t = DWT->CYCCNT;
+        s->fn(line, s->ctx, &woken);
+        in_handlers += DWT->CYCCNT - t;
+        gl_stats.lines++;
+#else
+        s->fn(line, s->ctx, &woken);
+#endif
+    }
+
+#if EXTI_STATS
+    uint32_t cycles = DWT->CYCCNT - start - in_handlers;
+    gl_stats.cycles += cycles;
+    if (cycles > gl_stats.max_cycles)
+        gl_stats.max_cycles = cycles;
+#endif
+
+    portYIELD_FROM_ISR(woken);
+}
+
+#if EXTI_STATS
+void exti_stats(ExtiStats * out) {
+    taskENTER_CRITICAL();
+    *out = gl_stats;
+    taskEXIT_CRITICAL();
+}
+#endif
+
+void EXTI0_IRQHandler(void)     { dispatch(1u << 0); }
+void EXTI1_IRQHandler(void)     { dispatch(1u << 1); }
+void EXTI2_IRQHandler(void)     { dispatch(1u << 2); }
+void EXTI3_IRQHandler(void)     { dispatch(1u << 3); }
+void EXTI4_IRQHandler(void)     { dispatch(1u << 4); }
+void EXTI9_5_IRQHandler(void)   { dispatch(0x1fu << 5); }
+void EXTI15_10_IRQHandler(void) { dispatch(0x3fu << 10); }
@@ -0,0 +1,69 @@
+/** -*- c++ -*-
+   exti.h: per-line handlers for the 16 GPIO EXTI lines
+
+   The f103 has 16 EXTI lines for GPIO pins, line n taking pin n of
+   one port (chosen in AFIO_EXTICR), but only seven vectors for them:
+   lines 0 to 4 have one each, while 5-9 and 10-15 share
+   EXTI9_5_IRQHandler and EXTI15_10_IRQHandler.  This module owns all
+   seven and calls the handler attached to each pending line.
+
+   A shared vector finds its lines from the pending register, a set
+   bit at a time with count-leading-zeros, so it does work only for
+   the lines that actually fired.  The pending bit is cleared before
+   the handler runs; an edge arriving during the handler pends the
+   line, and the vector, again.  A line unmasked with bsp.h's
+   exti_unmask() but never attached has no handler to call: its edge
+   is dropped and the line masked again.
+
+   Handlers run at configLIBRARY_KERNEL_INTERRUPT_PRIORITY, so they
+   may use the kernel's FromISR calls, and request a context switch by
+   setting *woken, as those calls do; the dispatcher yields once for
+   all the lines it handled.
+ */
+#ifndef EXTI_H
+#define EXTI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+
+// set to 1 to have the dispatcher count its cycles, see exti_stats()
+#ifndef EXTI_STATS
+#define EXTI_STATS 0
+#endif
+
+typedef enum {
+    EXTI_RISING = 1,
+    EXTI_FALLING = 2,
+    EXTI_BOTH_EDGES = 3,
+} ExtiEdges;
+
+typedef void (*ExtiHandler)(Pin line, void * ctx, BaseType_t * woken);
+
+/** Route pin `pin` of `port` to EXTI line `pin`, trigger it on
+    `edges`, and call `fn(pin, ctx, woken)` from the interrupt.  The
+    GPIO pin must already be configured as an input.  The line must be
+    free: asserts if a handler is attached to it already. */
+void exti_attach(Port port, Pin pin, ExtiEdges edges,
+                 ExtiHandler fn, void * ctx);
+
+// mask the line and forget its handler
+void exti_detach(Pin line);
+
+#if EXTI_STATS
+typedef struct {
+    uint32_t interrupts;        // vector entries
+    uint32_t lines;             // handlers called
+    uint32_t cycles;            // total in the dispatcher, handlers excluded
+    uint32_t max_cycles;        // worst single entry, handlers excluded
+} ExtiStats;
+
+/** Copy out the dispatcher's counters.  Cycles come from the DWT
+    cycle counter, which exti_attach() starts; cycles / interrupts is
+    the dispatch overhead per interrupt. */
+void exti_stats(ExtiStats * out);
+#endif
+
+#endif // EXTI_H
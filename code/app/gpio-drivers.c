@@ -40,12 +40,9 @@
 void gpio_config_pin(GPIO_TypeDef* base, Pin pin, uint32_t bits4) {
     assert(base != ((void*)0));
     assert(pin < 16);
-    assert(bits4 < 15);  // must be a valid pattern from table
+    assert(bits4 < 16 && bits4 != 0xc);  // must be a valid pattern from table
 
-    Reg32 CR =  (pin >= 8) ? &base->CRH : &base->CRL;
-    pin  = (pin >= 8) ? pin - 8 : pin;
-    *CR &= ~(0xfu << (pin*4));  // zero the nybble
-    *CR |= bits4 << (pin*4);    // assign bits4 to nybble
+    gpio_config_masked(base, pin, (GpioMode)bits4);
 }
 
 void gpio_pin_onoff(GPIO_TypeDef* base, uint32_t pin, bool on) {
@@ -1,4 +1,21 @@
 /** gpio-drivers.h
+
+   Pins can be named at compile time by a descriptor: a `port, pin`
+   pair of constants, such as
+
+       #define LED_RED GPIOB, Pin10
+
+   (bsp.h names the breadboard's pins this way).  The GPIO_* macros
+   below take a descriptor, so with every operand a constant a pin
+   write compiles to a single store to BSRR and a configuration to a
+   single masked write of CRL or CRH, with no range checks or register
+   selection left at run time:
+
+       GPIO_CONFIG(LED_RED, GPIO_OUT_PP_50MHZ);
+       GPIO_SET(LED_RED);
+
+   gpio_config_pin() and gpio_pin_onoff() remain for pins only known
+   at run time.
  */
 
 #ifndef GPIO_DRIVERS_H
@@ -11,8 +28,63 @@
 #include "bsp.h"
 
 typedef uint32_t volatile * const Reg32;
+
+// CNF[1:0]MODE[1:0] patterns, see the table in gpio-drivers.c
+typedef enum {
+    GPIO_IN_ANALOG      = 0x0,
+    GPIO_OUT_PP_10MHZ   = 0x1,
+    GPIO_OUT_PP_2MHZ    = 0x2,
+    GPIO_OUT_PP_50MHZ   = 0x3,
+    GPIO_IN_FLOATING    = 0x4,  // reset state
+    GPIO_OUT_OD_10MHZ   = 0x5,
+    GPIO_OUT_OD_2MHZ    = 0x6,
+    GPIO_OUT_OD_50MHZ   = 0x7,
+    GPIO_IN_PULL        = 0x8,  // up or down, as set in ODR
+    GPIO_AF_PP_10MHZ    = 0x9,
+    GPIO_AF_PP_2MHZ     = 0xa,
+    GPIO_AF_PP_50MHZ    = 0xb,
+    // 0xc is forbidden
+    GPIO_AF_OD_10MHZ    = 0xd,
+    GPIO_AF_OD_2MHZ     = 0xe,
+    GPIO_AF_OD_50MHZ    = 0xf,
+} GpioMode;
+
 void gpio_config_pin(GPIO_TypeDef* base, Pin pin, uint32_t bits4);
 void gpio_pin_onoff(GPIO_TypeDef* base, uint32_t pin, bool on);
 
+// Each macro taking a descriptor is variadic, so that the descriptor
+// can expand to its `port, pin` before the arguments are matched up.
+#define GPIO_PORT(...) GPIO_PORT_(__VA_ARGS__)
+#define GPIO_PORT_(port, pin) (port)
+#define GPIO_PIN(...) GPIO_PIN_(__VA_ARGS__)
+#define GPIO_PIN_(port, pin) (pin)
+
+// BSRR value driving the pin high (on) or low: GPIO_BSRR_BITS(desc, on)
+#define GPIO_BSRR_BITS(...) GPIO_BSRR_BITS_(__VA_ARGS__)
+#define GPIO_BSRR_BITS_(port, pin, on) \
+    ((on) ? (1u << (pin)) : (1u << ((pin) + 16u)))
+
+// GPIO_WRITE(desc, on)
+#define GPIO_WRITE(...) GPIO_WRITE_(__VA_ARGS__)
+#define GPIO_WRITE_(port, pin, on) \
+    ((port)->BSRR = GPIO_BSRR_BITS_(port, pin, on))
+#define GPIO_SET(...) GPIO_WRITE_(__VA_ARGS__, true)
+#define GPIO_RESET(...) GPIO_WRITE_(__VA_ARGS__, false)
+
+#define GPIO_READ(...) GPIO_READ_(__VA_ARGS__)
+#define GPIO_READ_(port, pin) (((port)->IDR >> (pin)) & 1u)
+
+// GPIO_CONFIG(desc, mode)
+#define GPIO_CONFIG(...) gpio_config_masked(__VA_ARGS__)
+
+/** Set the pin's CNF/MODE nybble in one read-modify-write.  Given
+    constant arguments the register choice and shifts fold away. */
+static inline void gpio_config_masked(GPIO_TypeDef * base, Pin pin,
+                                      GpioMode mode) {
+    uint32_t volatile * cr = (pin >= 8) ? &base->CRH : &base->CRL;
+    uint32_t shift = ((uint32_t)pin & 7u) * 4u;
+
+    *cr = (*cr & ~(0xfu << shift)) | ((uint32_t)mode << shift);
+}
 
 #endif // GPIO_DRIVERS_H
@@ -0,0 +1,103 @@
+// -*- c++ -*-
+/**
+   Heap allocation tracer and fragmentation metric, see heap-trace.h
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "serial-io.h"
+#include "heap-trace.h"
+
+typedef struct {
+    HeapTraceRecord record[HEAP_TRACE_DEPTH];
+    uint32_t count;             // total records ever written
+} HeapTrace;
+
+static HeapTrace gl_heap_trace = {0};
+
+static void record(void * pv, uint32_t flags, size_t block_size,
+                   void const * caller) {
+    HeapTraceRecord * r =
+        &gl_heap_trace.record[gl_heap_trace.count & (HEAP_TRACE_DEPTH - 1u)];
+
+    r->tick = xTaskGetTickCount();
+    r->caller = caller;
+    r->task = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+        ? ((void*)0) : xTaskGetCurrentTaskHandle();
+    r->addr = (uint16_t)(uintptr_t)pv;
+    r->size = (uint16_t)(flags | (block_size & HEAP_TRACE_SIZE_MASK));
+    gl_heap_trace.count++;
+}
+
+void heap_trace_malloc(void * pv, size_t block_size, void const * caller) {
+    record(pv, pv == ((void*)0) ? HEAP_TRACE_FAILED : 0u,
+           block_size, caller);
+}
+
+void heap_trace_free(void * pv, size_t block_size, void const * caller) {
+    record(pv, HEAP_TRACE_FREE, block_size, caller);
+}
+
+uint32_t heap_fragmentation_pct(void) {
+    HeapStats_t stats;
+    vPortGetHeapStats(&stats);
+
+    if (stats.xAvailableHeapSpaceInBytes == 0u)
+        return 0u;
+    return 100u - (uint32_t)(stats.xSizeOfLargestFreeBlockInBytes * 100u
+                             / stats.xAvailableHeapSpaceInBytes);
+}
+
+void heap_trace_dump(void) {
+    // the copy printed from, static as it is too big for a task stack
+    static HeapTrace snapshot;
+    HeapStats_t stats;
+
+    // printing takes ~2.5 KB of serial output, too long to hold up
+    // other tasks' allocations, so copy the ring and print the copy
+    taskENTER_CRITICAL();
+    snapshot = gl_heap_trace;
+    taskEXIT_CRITICAL();
+
+    uint32_t count = snapshot.count;
+    uint32_t first = (count > HEAP_TRACE_DEPTH) ? count - HEAP_TRACE_DEPTH : 0u;
+
+    serial_printf("heap-trace begin total=%u records=%u dropped=%u\n",
+                  (unsigned)configTOTAL_HEAP_SIZE, (unsigned)(count - first),
+                  (unsigned)first);
+    for (uint32_t i = first; i != count; ++i) {
+        HeapTraceRecord const * r =
+            &snapshot.record[i & (HEAP_TRACE_DEPTH - 1u)];
+        char kind = (r->size & HEAP_TRACE_FREE) ? 'F'
+            : (r->size & HEAP_TRACE_FAILED) ? 'X' : 'M';
+
+        // SRAM is below 64 KB, so the low half-word locates the block
+        serial_printf("%c %u %08x %u %08x %08x\n", kind, (unsigned)r->tick,
+                      (unsigned)(SRAM_BASE | r->addr),
+                      (unsigned)(r->size & HEAP_TRACE_SIZE_MASK),
+                      (unsigned)(uintptr_t)r->caller,
+                      (unsigned)(uintptr_t)r->task);
+    }
+
+    vPortGetHeapStats(&stats);
+    serial_printf("heap-trace end free=%u largest=%u blocks=%u min-ever=%u"
+                  " frag=%u%%\n",
+                  (unsigned)stats.xAvailableHeapSpaceInBytes,
+                  (unsigned)stats.xSizeOfLargestFreeBlockInBytes,
+                  (unsigned)stats.xNumberOfFreeBlocks,
+                  (unsigned)stats.xMinimumEverFreeBytesRemaining,
+                  (unsigned)heap_fragmentation_pct());
+}
+
+/** Called by heap_4 when pvPortMalloc fails (configUSE_MALLOC_FAILED_HOOK).
+
+    The failure is already in the trace as an 'X' record; trap here so
+    the debugger shows the state of the heap at the point of failure.
+ */
+void vApplicationMallocFailedHook(void) {
+    vAssertCalled(__FILE__, __LINE__);
+}
@@ -0,0 +1,53 @@
+/** -*- c++ -*-
+   heap-trace.h: record every pvPortMalloc/vPortFree made through heap_4
+
+   The kernel calls traceMALLOC and traceFREE (see FreeRTOSConfig.h)
+   with the scheduler suspended, so recording needs no further
+   locking.  Records go into a small ring buffer; the oldest ones are
+   overwritten once it fills.
+
+   heap_trace_dump() prints the buffer over the serial port in a line
+   format understood by tools/heap-map.c, which replays it on a Linux
+   host and draws the heap layout after every event.
+ */
+#ifndef HEAP_TRACE_H
+#define HEAP_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// number of records kept, must be a power of 2
+#define HEAP_TRACE_DEPTH 64u
+
+// size field flags, block sizes never reach these on a 20 KB part
+#define HEAP_TRACE_FREE   0x8000u
+#define HEAP_TRACE_FAILED 0x4000u
+#define HEAP_TRACE_SIZE_MASK 0x3fffu
+
+// 16 bytes per record on the target
+typedef struct {
+    uint32_t tick;              // xTaskGetTickCount() at the call
+    void const * caller;        // return address of pvPortMalloc/vPortFree
+    void const * task;          // calling task, NULL before the scheduler runs
+    uint16_t addr;              // low 16 bits of the returned pointer
+    uint16_t size;              // heap_4 block size plus HEAP_TRACE_* flags
+} HeapTraceRecord;
+
+// hooks named by traceMALLOC/traceFREE in FreeRTOSConfig.h
+void heap_trace_malloc(void * pv, size_t block_size, void const * caller);
+void heap_trace_free(void * pv, size_t block_size, void const * caller);
+
+/** Fragmentation of the free space, in percent.
+
+    Derived from heap_4's free list: 0 means all free bytes are in
+    one block, values near 100 mean the free space is scattered in
+    blocks too small to satisfy a large request.
+ */
+uint32_t heap_fragmentation_pct(void);
+
+// print all records, as they were at the call, and a summary of the
+// free list to stdout.  Other tasks keep running while it prints, so
+// call it from one task at a time.
+void heap_trace_dump(void);
+
+#endif // HEAP_TRACE_H
@@ -51,19 +51,35 @@
 #define configUSE_TRACE_FACILITY    0
 #define configUSE_16_BIT_TICKS      0
 #define configIDLE_SHOULD_YIELD     1
+#define configUSE_EVENT_LIST_BUCKETS 1   /* O(1) priority-ordered blocking on queues */
+#define configEVENT_GROUP_WAITER_LISTS 1   /* 24 B of RAM per list per event group */
+#define configUSE_QUEUE_WORD_COPY 1   /* single load/store for 4-byte queue items */
+#define configUSE_PRIORITY_QUEUES 1   /* xQueueCreatePriority() */
+#define configUSE_MUTEXES 1
+#define configUSE_RWLOCKS 1   /* rwlock.h, needs configUSE_MUTEXES */
+#define configUSE_CONDVARS 1   /* condvar.h, needs configUSE_MUTEXES */
+#define configUSE_BARRIERS 1   /* barrier.h */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1   /* app/arena.h */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 3   /* 0 general, 1 worker-pool.h, 2 isr-events.h; 5 B of RAM each per task */
 
 /* memory allocation related definitions */
 #define configTOTAL_HEAP_SIZE              ( ( size_t ) ( 4 * 1024 ) )
-#define configSUPPORT_STATIC_ALLOCATION    0
+#define configSUPPORT_STATIC_ALLOCATION    1   /* app/static-objects.h */
 #define configSUPPORT_DYNAMIC_ALLOCATION   1
 
 /* Hook function related definitions */
-#define configUSE_MALLOC_FAILED_HOOK 0
+#define configUSE_MALLOC_FAILED_HOOK 1
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES       0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
+/* Software timer definitions. */
+#define configUSE_TIMERS             1   /* app/button-input.c debouncing */
+#define configTIMER_TASK_PRIORITY    ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH     5
+#define configTIMER_TASK_STACK_DEPTH configMINIMAL_STACK_SIZE
+
 /* Define to trap errors. */
 void vAssertCalled(char const * const filename, int line_num );
 
@@ -83,6 +99,17 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend            1
 #define INCLUDE_vTaskDelayUntil         1
 #define INCLUDE_vTaskDelay              1
+#define INCLUDE_xTaskGetSchedulerState  1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+
+/* Record every heap_4 allocation and free, see app/heap-trace.h.  The
+caller is the return address of pvPortMalloc/vPortFree. */
+void heap_trace_malloc(void * pv, size_t block_size, void const * caller);
+void heap_trace_free(void * pv, size_t block_size, void const * caller);
+#define traceMALLOC(pvAddress, uiSize) \
+    heap_trace_malloc((pvAddress), (uiSize), __builtin_return_address(0))
+#define traceFREE(pvAddress, uiSize) \
+    heap_trace_free((pvAddress), (uiSize), __builtin_return_address(0))
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
 (lowest) to 0 (1?) (highest). */
@@ -0,0 +1,138 @@
+// -*- c++ -*-
+/**
+   Event flags settable from an ISR, see isr-events.h
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "stm32f10x.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "isr-events.h"
+
+#if ISR_EVENTS_MAX_WAITERS == 32
+#define ALL_SLOTS 0xffffffffu
+#else
+#define ALL_SLOTS ((1u << ISR_EVENTS_MAX_WAITERS) - 1u)
+#endif
+
+static bool satisfied(uint32_t bits, uint32_t mask, unsigned flags) {
+    uint32_t hit = bits & mask;
+    return (flags & ISR_EVENTS_ALL) ? hit == mask : hit != 0u;
+}
+
+void isr_events_init(IsrEvents * e) {
+    memset(e, 0, sizeof *e);
+}
+
+/** Set `bits` and wake every waiter now satisfied.  Runs with
+    interrupts masked, so the work is bounded by the number of armed
+    slots.  `woken` is NULL when called from a task. */
+static uint32_t set_masked(IsrEvents * e, uint32_t bits, BaseType_t * woken) {
+    uint32_t to_clear = 0u;
+    uint32_t armed;
+
+    e->bits |= bits;
+    armed = e->pending;
+    while (armed != 0u) {
+        unsigned i = 31u - __CLZ(armed);
+        IsrEventsWaiter * w = &e->slot[i];
+
+        armed &= ~(1u << i);
+        if (!satisfied(e->bits, w->mask, w->flags))
+            continue;
+
+        w->result = e->bits;
+        e->pending &= ~(1u << i);
+        if (w->flags & ISR_EVENTS_CLEAR)
+            to_clear |= w->mask;
+
+        if (woken != ((void*)0))
+            vTaskNotifyGiveIndexedFromISR(w->task, ISR_EVENTS_NOTIFY_INDEX,
+                                          woken);
+        else
+            xTaskNotifyGiveIndexed(w->task, ISR_EVENTS_NOTIFY_INDEX);
+    }
+
+    // clear only after every waiter has seen the bits
+    e->bits &= ~to_clear;
+    return e->bits;
+}
+
+uint32_t isr_events_set(IsrEvents * e, uint32_t bits) {
+    uint32_t result;
+
+    taskENTER_CRITICAL();
+    result = set_masked(e, bits, ((void*)0));
+    taskEXIT_CRITICAL();
+    return result;
+}
+
+uint32_t isr_events_set_from_isr(IsrEvents * e, uint32_t bits,
+                                 BaseType_t * higher_prio_task_woken) {
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    uint32_t result = set_masked(e, bits, higher_prio_task_woken);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+    return result;
+}
+
+uint32_t isr_events_clear(IsrEvents * e, uint32_t bits) {
+    uint32_t before;
+
+    taskENTER_CRITICAL();
+    before = e->bits;
+    e->bits = before & ~bits;
+    taskEXIT_CRITICAL();
+    return before;
+}
+
+uint32_t isr_events_wait(IsrEvents * e, uint32_t mask, unsigned flags,
+                         TickType_t ticks) {
+    TimeOut_t timeout;
+    uint32_t result;
+
+    assert(mask != 0u);
+
+    taskENTER_CRITICAL();
+    if (satisfied(e->bits, mask, flags) || ticks == 0u) {
+        result = e->bits;
+        if (satisfied(result, mask, flags) && (flags & ISR_EVENTS_CLEAR))
+            e->bits = result & ~mask;
+        taskEXIT_CRITICAL();
+        return result;
+    }
+
+    uint32_t free_slots = ~e->claimed & ALL_SLOTS;
+    assert(free_slots != 0u);
+    unsigned i = 31u - __CLZ(free_slots);
+    IsrEventsWaiter * w = &e->slot[i];
+
+    w->task = xTaskGetCurrentTaskHandle();
+    w->mask = mask;
+    w->flags = flags;
+    e->claimed |= 1u << i;
+    e->pending |= 1u << i;
+    taskEXIT_CRITICAL();
+
+    vTaskSetTimeOutState(&timeout);
+    for (;;) {
+        (void) ulTaskNotifyTakeIndexed(ISR_EVENTS_NOTIFY_INDEX, pdTRUE, ticks);
+
+        taskENTER_CRITICAL();
+        if ((e->pending & (1u << i)) == 0u) {
+            result = w->result;
+            break;
+        }
+        if (xTaskCheckForTimeOut(&timeout, &ticks) != pdFALSE) {
+            e->pending &= ~(1u << i);
+            result = e->bits;
+            break;
+        }
+        taskEXIT_CRITICAL();
+    }
+    e->claimed &= ~(1u << i);
+    taskEXIT_CRITICAL();
+    return result;
+}
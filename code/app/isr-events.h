@@ -0,0 +1,90 @@
+/** -*- c++ -*-
+   isr-events.h: event flags that an ISR can set without deferral
+
+   xEventGroupSetBitsFromISR() cannot touch the event group's waiter
+   list from an ISR, so it posts the work to the timer daemon task's
+   queue, costing an extra wakeup and context switch per event.  That
+   queue is shared with the button's debounce timer (button-input.c),
+   and holds only configTIMER_QUEUE_LENGTH commands, so a burst of
+   events can fail to post.  Here each waiter occupies one of a fixed
+   number of slots, tracked by a bitmap, and is woken with a task
+   notification.  Setting bits from an ISR visits only the armed
+   slots, at most ISR_EVENTS_MAX_WAITERS of them, and readies the
+   satisfied waiters before the ISR returns.
+
+   Waiters block on notification index ISR_EVENTS_NOTIFY_INDEX, apart
+   from the index 0 the rest of the app uses, and re-check their slot
+   after every wakeup, so a notification left over from a wait that
+   timed out is harmless.
+ */
+#ifndef ISR_EVENTS_H
+#define ISR_EVENTS_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// number of tasks that may wait on one IsrEvents at a time, <= 32
+#ifndef ISR_EVENTS_MAX_WAITERS
+#define ISR_EVENTS_MAX_WAITERS 8
+#endif
+
+// the task notification index waiters block on
+#ifndef ISR_EVENTS_NOTIFY_INDEX
+#define ISR_EVENTS_NOTIFY_INDEX 2
+#endif
+
+#if ISR_EVENTS_MAX_WAITERS > 32
+#error "ISR_EVENTS_MAX_WAITERS must fit in the 32-bit slot bitmap"
+#endif
+
+#if ISR_EVENTS_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error "ISR_EVENTS_NOTIFY_INDEX needs configTASK_NOTIFICATION_ARRAY_ENTRIES above it"
+#endif
+
+// isr_events_wait() flags
+#define ISR_EVENTS_ALL   1u     // wait for every bit in the mask, not any
+#define ISR_EVENTS_CLEAR 2u     // clear the mask bits on a successful wait
+
+typedef struct {
+    TaskHandle_t task;
+    uint32_t mask;
+    uint32_t result;            // the bits when the wait was satisfied
+    unsigned flags;
+} IsrEventsWaiter;
+
+typedef struct {
+    uint32_t volatile bits;
+    uint32_t volatile claimed;  // slots in use
+    uint32_t volatile pending;  // claimed slots not yet satisfied
+    IsrEventsWaiter slot[ISR_EVENTS_MAX_WAITERS];
+} IsrEvents;
+
+void isr_events_init(IsrEvents * e);
+
+/** Wait up to `ticks` for the bits in `mask`, as selected by `flags`.
+
+    Returns the bits at the moment the wait was satisfied (before any
+    ISR_EVENTS_CLEAR), or the current bits on timeout; test the result
+    against `mask` to tell which.  Asserts if all the waiter slots are
+    taken.
+ */
+uint32_t isr_events_wait(IsrEvents * e, uint32_t mask, unsigned flags,
+                         TickType_t ticks);
+
+// set bits from a task, returns the bits after any waiters cleared theirs
+uint32_t isr_events_set(IsrEvents * e, uint32_t bits);
+
+// as isr_events_set, for use in an ISR
+uint32_t isr_events_set_from_isr(IsrEvents * e, uint32_t bits,
+                                 BaseType_t * higher_prio_task_woken);
+
+// clear bits, returns the bits before clearing
+uint32_t isr_events_clear(IsrEvents * e, uint32_t bits);
+
+static inline uint32_t isr_events_get(IsrEvents const * e) {
+    return e->bits;
+}
+
+#endif // ISR_EVENTS_H
@@ -0,0 +1,53 @@
+// -*- c++ -*-
+/**
+   LED pattern step table and timing, see led-pattern-table.h
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "led-pattern-table.h"
+
+void led_pattern_init(LedPattern * p, unsigned period_ms) {
+    assert(period_ms >= 1u
+           && period_ms * (LED_PATTERN_TIMER_HZ / 1000u) <= 0x10000u);
+
+    memset(p, 0, sizeof *p);
+    p->steps = 1u;
+    p->period_ms = period_ms;
+}
+
+bool led_pattern_add_step(LedPattern * p) {
+    if (p->steps == LED_PATTERN_MAX_STEPS)
+        return false;
+    p->steps++;
+    return true;
+}
+
+void led_pattern_set_pin(LedPattern * p, LedPatternPort port, unsigned pin,
+                         bool on) {
+    assert(pin < 16u);
+
+    uint32_t * word = (port == LED_PATTERN_PORT_A) ? &p->bsrr_a[p->steps - 1u]
+                                                   : &p->bsrr_b[p->steps - 1u];
+    uint32_t set = 1u << pin;
+    uint32_t reset = 1u << (pin + 16u);
+
+    // BSRR gives set priority over reset, so keep only the latest
+    *word = (*word & ~(set | reset)) | (on ? set : reset);
+}
+
+uint32_t led_pattern_edge(LedPattern const * p, unsigned step,
+                          LedPatternPort port) {
+    assert(step < p->steps);
+
+    if (step == 0u)
+        return 0u;
+
+    // step i lands in the i-th period: at its update event (the end
+    // of the period) for GPIOA, at the compare event for GPIOB
+    uint32_t start = (step - 1u) * led_pattern_period_counts(p);
+    return (port == LED_PATTERN_PORT_A)
+        ? start + led_pattern_period_counts(p)
+        : start + led_pattern_compare_count(p);
+}
@@ -0,0 +1,63 @@
+/** -*- c++ -*-
+   led-pattern-table.h: the step table and timing of led-pattern.h
+
+   Everything here is plain arithmetic on a LedPattern, free of the
+   hardware, so it also builds on the host (tools/test-led-pattern.c).
+   Apps use led-pattern.h, which includes this.
+
+   Playback counts at LED_PATTERN_TIMER_HZ.  Step 0 is written at
+   count 0, when playback starts.  Step i (i >= 1) is written to
+   GPIOA by TIM3's update event at count i * period, and to GPIOB by
+   its compare 1 event, set to the last count of the period, so one
+   count earlier.  led_pattern_edge() gives these counts, from the
+   same values led_pattern_play() programs into TIM3.
+ */
+#ifndef LED_PATTERN_TABLE_H
+#define LED_PATTERN_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef LED_PATTERN_MAX_STEPS
+#define LED_PATTERN_MAX_STEPS 16u
+#endif
+
+// step timing resolution
+#define LED_PATTERN_TIMER_HZ 10000u
+
+typedef enum { LED_PATTERN_PORT_A, LED_PATTERN_PORT_B } LedPatternPort;
+
+typedef struct {
+    uint32_t bsrr_a[LED_PATTERN_MAX_STEPS]; // written to GPIOA->BSRR
+    uint32_t bsrr_b[LED_PATTERN_MAX_STEPS]; // written to GPIOB->BSRR
+    unsigned steps;
+    unsigned period_ms;
+} LedPattern;
+
+/** Start an empty pattern of one step that changes no pins, to be
+    played `period_ms` (1..6553) per step. */
+void led_pattern_init(LedPattern * p, unsigned period_ms);
+
+// start another step, which changes no pins yet; false if full
+bool led_pattern_add_step(LedPattern * p);
+
+// drive pin `pin` (0..15) of `port` high (on) or low in the last step
+void led_pattern_set_pin(LedPattern * p, LedPatternPort port, unsigned pin,
+                         bool on);
+
+// timer counts per step, for TIM3's ARR + 1
+static inline uint32_t led_pattern_period_counts(LedPattern const * p) {
+    return p->period_ms * (LED_PATTERN_TIMER_HZ / 1000u);
+}
+
+// count within a period at which GPIOB is written, for TIM3's CCR1
+static inline uint32_t led_pattern_compare_count(LedPattern const * p) {
+    return led_pattern_period_counts(p) - 1u;
+}
+
+/** Count, from the start of playback, at which step `step` is written
+    to `port`. */
+uint32_t led_pattern_edge(LedPattern const * p, unsigned step,
+                          LedPatternPort port);
+
+#endif // LED_PATTERN_TABLE_H
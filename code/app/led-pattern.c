@@ -0,0 +1,108 @@
+// -*- c++ -*-
+/**
+   DMA-driven LED pattern playback, see led-pattern.h
+ */
+
+#include <assert.h>
+#include <stm32f10x.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "bsp.h"
+#include "static-objects.h"
+#include "led-pattern.h"
+
+// prototype for the ISR, named as in the startup code
+void DMA1_Channel3_IRQHandler(void);
+
+// available while no pattern plays
+static SemaphoreHandle_t gl_idle = ((void*)0);
+STATIC_SEMAPHORE(gl_idle);
+
+// DMA CCR: priority high, 32-bit memory and peripheral, memory
+// increment, memory to peripheral, enabled
+#define CCR_PLAY ((2u << 12) | (2u << 10) | (2u << 8) | (1u << 7) \
+                  | (1u << 4) | (1u << 0))
+#define CCR_TCIE (1u << 1)
+
+void led_pattern_engine_init(void) {
+    BITBAND(RCC->AHBENR, 0) = 1u;   // bits[0] = DMA1EN <- 1
+    BITBAND(RCC->APB1ENR, 1) = 1u;  // bits[1] = TIM3EN <- 1
+
+    gl_idle = STATIC_BINARY_SEMAPHORE_CREATE(gl_idle);
+    (void) xSemaphoreGive(gl_idle);
+
+    // the ISR gives a semaphore, so must be at or below
+    // configMAX_SYSCALL_INTERRUPT_PRIORITY
+    NVIC_SetPriority(DMA1_Channel3_IRQn, configLIBRARY_KERNEL_INTERRUPT_PRIORITY);
+    NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+}
+
+void led_pattern_set(LedPattern * p, GPIO_TypeDef * port, Pin pin, bool on) {
+    assert(port == GPIOA || port == GPIOB);
+
+    led_pattern_set_pin(p, (port == GPIOA) ? LED_PATTERN_PORT_A
+                                           : LED_PATTERN_PORT_B, pin, on);
+}
+
+bool led_pattern_play(LedPattern const * p) {
+    assert(gl_idle != ((void*)0));
+
+    if (xSemaphoreTake(gl_idle, 0) != pdTRUE)
+        return false;
+
+    // step 0 right now
+    GPIOA->BSRR = p->bsrr_a[0];
+    GPIOB->BSRR = p->bsrr_b[0];
+    if (p->steps == 1u) {
+        (void) xSemaphoreGive(gl_idle);
+        return true;
+    }
+
+    // the rest, one per timer period
+    DMA1_Channel3->CCR = 0u;
+    DMA1_Channel6->CCR = 0u;
+    DMA1->IFCR = (0xfu << 8) | (0xfu << 20);  // clear channels 3 and 6
+
+    DMA1_Channel3->CPAR = (uint32_t)(uintptr_t)&GPIOA->BSRR;
+    DMA1_Channel3->CMAR = (uint32_t)(uintptr_t)&p->bsrr_a[1];
+    DMA1_Channel3->CNDTR = p->steps - 1u;
+    DMA1_Channel6->CPAR = (uint32_t)(uintptr_t)&GPIOB->BSRR;
+    DMA1_Channel6->CMAR = (uint32_t)(uintptr_t)&p->bsrr_b[1];
+    DMA1_Channel6->CNDTR = p->steps - 1u;
+    DMA1_Channel6->CCR = CCR_PLAY;
+    DMA1_Channel3->CCR = CCR_PLAY | CCR_TCIE;
+
+    // TIM3 runs from 2 x PCLK1, that is the 72 MHz core clock
+    TIM3->CR1 = 0u;
+    TIM3->PSC = (uint16_t)(configCPU_CLOCK_HZ / LED_PATTERN_TIMER_HZ - 1u);
+    TIM3->ARR = (uint16_t)(led_pattern_period_counts(p) - 1u);
+    TIM3->CCR1 = (uint16_t)led_pattern_compare_count(p);
+    TIM3->EGR = 1u << 0;        // UG: load PSC now, before DMA is enabled
+    TIM3->SR = 0u;
+    TIM3->DIER = (1u << 9) | (1u << 8);     // CC1DE, UDE
+    TIM3->CR1 = 1u << 0;                    // CEN
+    return true;
+}
+
+bool led_pattern_wait(TickType_t ticks) {
+    if (xSemaphoreTake(gl_idle, ticks) != pdTRUE)
+        return false;
+    (void) xSemaphoreGive(gl_idle);
+    return true;
+}
+
+// the last step's GPIOA word has been written: playback is over
+void DMA1_Channel3_IRQHandler(void) {
+    BaseType_t woken = pdFALSE;
+
+    DMA1->IFCR = 0xfu << 8;
+    TIM3->CR1 = 0u;
+    TIM3->DIER = 0u;
+    DMA1_Channel3->CCR = 0u;
+    DMA1_Channel6->CCR = 0u;
+
+    (void) xSemaphoreGiveFromISR(gl_idle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
@@ -0,0 +1,54 @@
+/** -*- c++ -*-
+   led-pattern.h: play LED sequences by DMA, without the CPU
+
+   A sequence is compiled ahead of time into a table of BSRR words,
+   one per step for each GPIO port.  Playback is paced by TIM3: each
+   period its update event has DMA1 channel 3 copy the next word into
+   GPIOA->BSRR, and its compare 1 event has channel 6 do the same for
+   GPIOB->BSRR.  No code runs between steps.  Channel 3's
+   transfer-complete interrupt ends playback and wakes whoever waits.
+
+   Timing: step 0 is applied when playback starts and step i a period
+   later than step i-1.  Each GPIOB change comes one timer count
+   (100 us) before the GPIOA change of the same step.  The step table
+   and its timing are in led-pattern-table.h.
+
+       static LedPattern p;
+       led_pattern_init(&p, 500);          // 500 ms per step
+       led_pattern_set(&p, LED_RED, true);  // step 0
+       led_pattern_add_step(&p);
+       led_pattern_set(&p, LED_RED, false); // step 1
+       led_pattern_play(&p);
+
+   Only pins of GPIOA and GPIOB can be used.  One pattern plays at a
+   time, and it must stay unchanged until it finishes.  TIM3 and DMA1
+   channels 3 and 6 belong to this engine.
+ */
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stm32f10x.h>
+
+#include "FreeRTOS.h"
+#include "bsp.h"
+#include "led-pattern-table.h"
+
+/** Turn on the clocks and interrupt the engine uses.  Call once,
+    before the first led_pattern_play(). */
+void led_pattern_engine_init(void);
+
+/** Drive `pin` of `port` high (on) or low in the last step.  Takes a
+    pin descriptor: led_pattern_set(&p, LED_RED, true). */
+void led_pattern_set(LedPattern * p, GPIO_TypeDef * port, Pin pin, bool on);
+
+/** Start playing `p`, returning at once.  Returns false if another
+    pattern is still playing. */
+bool led_pattern_play(LedPattern const * p);
+
+/** Wait up to `ticks` for the engine to be idle.  Returns false on
+    timeout. */
+bool led_pattern_wait(TickType_t ticks);
+
+#endif // LED_PATTERN_H
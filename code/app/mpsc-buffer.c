@@ -0,0 +1,168 @@
+// -*- c++ -*-
+/**
+   Multi-producer, single-consumer stream buffer, see mpsc-buffer.h
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mpsc-buffer.h"
+
+static uint32_t padded(uint32_t n) {
+    return (n + 3u) & ~3u;
+}
+
+static uint32_t volatile * header_at(MpscBuffer const * b, uint32_t pos) {
+    return (uint32_t volatile *)(void *)&b->storage[pos & (b->size - 1u)];
+}
+
+// copy into the storage at free-running position `pos`, wrapping if needed
+static void copy_in(MpscBuffer * b, uint32_t pos, void const * data, uint32_t n) {
+    uint32_t idx = pos & (b->size - 1u);
+    uint32_t first = (n < b->size - idx) ? n : b->size - idx;
+
+    memcpy(&b->storage[idx], data, first);
+    memcpy(b->storage, (uint8_t const *)data + first, n - first);
+}
+
+static void copy_out(MpscBuffer const * b, uint32_t pos, void * out, uint32_t n) {
+    uint32_t idx = pos & (b->size - 1u);
+    uint32_t first = (n < b->size - idx) ? n : b->size - idx;
+
+    memcpy(out, &b->storage[idx], first);
+    memcpy((uint8_t *)out + first, b->storage, n - first);
+}
+
+// zero a consumed record so stale payload can never pass for a header
+static void clear(MpscBuffer * b, uint32_t pos, uint32_t n) {
+    uint32_t idx = pos & (b->size - 1u);
+    uint32_t first = (n < b->size - idx) ? n : b->size - idx;
+
+    memset(&b->storage[idx], 0, first);
+    memset(b->storage, 0, n - first);
+}
+
+void mpsc_init(MpscBuffer * b, uint8_t * storage, uint32_t size) {
+    assert(size >= 8u && (size & (size - 1u)) == 0u);
+    assert(((uintptr_t)storage & 3u) == 0u);
+
+    memset(storage, 0, size);
+    b->storage = storage;
+    b->size = size;
+    b->reserve = 0u;
+    b->tail = 0u;
+    b->read_offset = 0u;
+    b->reader = ((void*)0);
+}
+
+/** Claim the space for a record of `n` payload bytes, at free-running
+    position *pos.  Returns false if it does not fit. */
+static bool reserve(MpscBuffer * b, size_t n, uint32_t * pos) {
+    if (n == 0u || n > MPSC_LENGTH_MASK || padded((uint32_t)n) + 4u > b->size)
+        return false;
+
+    uint32_t need = 4u + padded((uint32_t)n);
+    uint32_t p = __atomic_load_n(&b->reserve, __ATOMIC_RELAXED);
+    do {
+        uint32_t tail = __atomic_load_n(&b->tail, __ATOMIC_ACQUIRE);
+        if ((p - tail) + need > b->size)
+            return false;
+    } while (!__atomic_compare_exchange_n(&b->reserve, &p, p + need, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    *pos = p;
+    return true;
+}
+
+// fill the space reserved at `pos` and hand it to the reader
+static void publish(MpscBuffer * b, uint32_t pos, void const * data, size_t n) {
+    // the space is ours alone until the header says otherwise
+    copy_in(b, pos + 4u, data, (uint32_t)n);
+    __atomic_store_n(header_at(b, pos), (uint32_t)n | MPSC_COMMITTED,
+                     __ATOMIC_RELEASE);
+}
+
+// claim, fill and publish one record; false if it did not fit
+static bool put(MpscBuffer * b, void const * data, size_t n) {
+    uint32_t pos;
+
+    if (!reserve(b, n, &pos))
+        return false;
+    publish(b, pos, data, n);
+    return true;
+}
+
+size_t mpsc_send(MpscBuffer * b, void const * data, size_t n) {
+    if (!put(b, data, n))
+        return 0u;
+
+    TaskHandle_t reader = b->reader;
+    if (reader != ((void*)0))
+        xTaskNotifyGive(reader);
+    return n;
+}
+
+size_t mpsc_send_from_isr(MpscBuffer * b, void const * data, size_t n,
+                          BaseType_t * higher_prio_task_woken) {
+    if (!put(b, data, n))
+        return 0u;
+
+    TaskHandle_t reader = b->reader;
+    if (reader != ((void*)0))
+        vTaskNotifyGiveFromISR(reader, higher_prio_task_woken);
+    return n;
+}
+
+/** Copy out whatever published bytes are available, without blocking. */
+static size_t take(MpscBuffer * b, uint8_t * out, size_t max) {
+    size_t got = 0u;
+
+    while (got < max) {
+        uint32_t tail = b->tail;
+        uint32_t header = __atomic_load_n(header_at(b, tail), __ATOMIC_ACQUIRE);
+        if ((header & MPSC_COMMITTED) == 0u)
+            break;              // empty, or the next writer is still copying
+
+        uint32_t len = header & MPSC_LENGTH_MASK;
+        uint32_t n = len - b->read_offset;
+        if (n > max - got)
+            n = (uint32_t)(max - got);
+
+        copy_out(b, tail + 4u + b->read_offset, out + got, n);
+        got += n;
+        b->read_offset += n;
+
+        if (b->read_offset == len) {
+            uint32_t used = 4u + padded(len);
+            clear(b, tail, used);
+            b->read_offset = 0u;
+            __atomic_store_n(&b->tail, tail + used, __ATOMIC_RELEASE);
+        }
+    }
+    return got;
+}
+
+size_t mpsc_receive(MpscBuffer * b, void * out, size_t max, TickType_t ticks) {
+    TimeOut_t timeout;
+    size_t got;
+
+    vTaskSetTimeOutState(&timeout);
+    for (;;) {
+        got = take(b, out, max);
+        if (got != 0u || max == 0u)
+            break;
+
+        // announce ourselves, then look again so a send that raced
+        // with the first look is not missed
+        b->reader = xTaskGetCurrentTaskHandle();
+        got = take(b, out, max);
+        if (got != 0u || xTaskCheckForTimeOut(&timeout, &ticks) != pdFALSE)
+            break;
+        (void) ulTaskNotifyTake(pdTRUE, ticks);
+        b->reader = ((void*)0);
+    }
+    b->reader = ((void*)0);
+    return got;
+}
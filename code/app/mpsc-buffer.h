@@ -0,0 +1,59 @@
+/** -*- c++ -*-
+   mpsc-buffer.h: byte stream buffer with many writers and one reader
+
+   The kernel's stream buffers allow only one writer, so several tasks
+   emitting serial output would have to share a mutex.  Here a writer
+   claims space by advancing the reserve counter with a single
+   compare-and-swap (LDREX/STREX on the Cortex-M3), copies its bytes
+   in without holding any lock, then publishes them by storing the
+   record header.  Writers may finish in any order; the reader always
+   consumes records in the order the space was reserved, and stops at
+   the first record whose writer has not finished yet.
+
+   Writers never block: a send that does not fit returns 0 and writes
+   nothing.  Sends are also safe from ISRs (mpsc_send_from_isr).
+
+   Storage layout: each record is a 4-byte header (payload length,
+   plus MPSC_COMMITTED once the payload is in place) followed by the
+   payload, padded to a multiple of 4 bytes.  A record may wrap around
+   the end of the storage.
+ */
+#ifndef MPSC_BUFFER_H
+#define MPSC_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define MPSC_COMMITTED 0x80000000u
+#define MPSC_LENGTH_MASK 0x0000ffffu
+
+typedef struct {
+    uint8_t * storage;
+    uint32_t size;              // power of 2, at least 8
+    uint32_t volatile reserve;  // free-running, advanced by writers (CAS)
+    uint32_t volatile tail;     // free-running, advanced by the reader only
+    uint32_t read_offset;       // bytes already read from the record at tail
+    TaskHandle_t volatile reader; // reader blocked in mpsc_receive, or NULL
+} MpscBuffer;
+
+/** Prepare `b` to use `storage`, which must be 4-byte aligned and
+    `size` bytes long, `size` a power of 2.  The largest message that
+    fits is `size` - 4 bytes. */
+void mpsc_init(MpscBuffer * b, uint8_t * storage, uint32_t size);
+
+/** Append `n` bytes from any task.  Returns `n`, or 0 if there is not
+    room for all of them. */
+size_t mpsc_send(MpscBuffer * b, void const * data, size_t n);
+
+// as mpsc_send, for use in an ISR
+size_t mpsc_send_from_isr(MpscBuffer * b, void const * data, size_t n,
+                          BaseType_t * higher_prio_task_woken);
+
+/** Read up to `max` bytes, waiting up to `ticks` for the first byte.
+    Only one task may call this.  Returns the number of bytes read. */
+size_t mpsc_receive(MpscBuffer * b, void * out, size_t max, TickType_t ticks);
+
+#endif // MPSC_BUFFER_H
@@ -0,0 +1,223 @@
+// -*- c++ -*-
+/**
+   Reference-counted buffer chains, see pbuf.h
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pbuf.h"
+
+static Pbuf gl_pool[PBUF_POOL_SIZE];
+static Pbuf * gl_free = ((void*)0);
+static unsigned gl_nfree = 0u;
+static bool gl_ready = false;
+
+// take one segment from the pool, with `headroom` bytes left unused
+static Pbuf * take(size_t headroom) {
+    Pbuf * p;
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+
+    if (!gl_ready) {
+        for (unsigned i = 0; i < PBUF_POOL_SIZE; ++i) {
+            gl_pool[i].next = gl_free;
+            gl_free = &gl_pool[i];
+        }
+        gl_nfree = PBUF_POOL_SIZE;
+        gl_ready = true;
+    }
+    p = gl_free;
+    if (p != ((void*)0)) {
+        gl_free = p->next;
+        gl_nfree--;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if (p != ((void*)0)) {
+        p->next = ((void*)0);
+        p->payload = p->data + headroom;
+        p->len = 0u;
+        p->tot_len = 0u;
+        p->refs = 1u;
+        p->owner = ((void*)0);
+    }
+    return p;
+}
+
+Pbuf * pbuf_alloc(size_t len, size_t headroom) {
+    assert(headroom <= PBUF_SEGMENT_SIZE);
+    assert(len <= UINT16_MAX);
+
+    Pbuf * head = take(headroom);
+    if (head == ((void*)0))
+        return ((void*)0);
+
+    Pbuf * last = head;
+    size_t room = PBUF_SEGMENT_SIZE - headroom;
+    size_t left = len;
+    for (;;) {
+        last->len = (uint16_t)(left < room ? left : room);
+        left -= last->len;
+        if (left == 0u)
+            break;
+
+        last->next = take(0u);
+        if (last->next == ((void*)0)) {
+            pbuf_free(head);
+            return ((void*)0);
+        }
+        last = last->next;
+        room = PBUF_SEGMENT_SIZE;
+    }
+
+    // each segment's tot_len counts itself and everything after it
+    left = len;
+    for (Pbuf * q = head; q != ((void*)0); q = q->next) {
+        q->tot_len = (uint16_t)left;
+        left -= q->len;
+    }
+    return head;
+}
+
+void pbuf_ref(Pbuf * p) {
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    assert(p->refs != 0u && p->refs != UINT16_MAX);
+    p->refs++;
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+void pbuf_free(Pbuf * p) {
+    while (p != ((void*)0)) {
+        Pbuf * next = ((void*)0);
+        Pbuf * owner = ((void*)0);
+        bool last;
+
+        UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        assert(p->refs != 0u);
+        last = (--p->refs == 0u);
+        if (last) {
+            next = p->next;
+            owner = p->owner;
+            p->next = gl_free;
+            gl_free = p;
+            gl_nfree++;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+
+        // a segment still referenced elsewhere keeps the rest of its chain
+        if (!last)
+            break;
+
+        // owners are never reference segments, so this recurses once at most
+        if (owner != ((void*)0))
+            pbuf_free(owner);
+        p = next;
+    }
+}
+
+unsigned pbuf_pool_free(void) {
+    return gl_ready ? gl_nfree : PBUF_POOL_SIZE;
+}
+
+uint8_t * pbuf_push_header(Pbuf * p, size_t n) {
+    if (p->owner != ((void*)0) || n > (size_t)(p->payload - p->data)
+        || p->tot_len + n > UINT16_MAX)
+        return ((void*)0);
+
+    p->payload -= n;
+    p->len = (uint16_t)(p->len + n);
+    p->tot_len = (uint16_t)(p->tot_len + n);
+    return p->payload;
+}
+
+bool pbuf_pull_header(Pbuf * p, size_t n) {
+    if (n > p->len)
+        return false;
+
+    p->payload += n;
+    p->len = (uint16_t)(p->len - n);
+    p->tot_len = (uint16_t)(p->tot_len - n);
+    return true;
+}
+
+void pbuf_cat(Pbuf * head, Pbuf * tail) {
+    assert(head->tot_len + tail->tot_len <= UINT16_MAX);
+
+    Pbuf * q = head;
+    for (;;) {
+        q->tot_len = (uint16_t)(q->tot_len + tail->tot_len);
+        if (q->next == ((void*)0))
+            break;
+        q = q->next;
+    }
+    q->next = tail;
+}
+
+Pbuf * pbuf_split(Pbuf * p, size_t offset) {
+    assert(offset > 0u && offset < p->tot_len);
+
+    // find the segment q holding the last byte before the cut
+    Pbuf * q = p;
+    while (offset > q->len) {
+        offset -= q->len;
+        q = q->next;
+    }
+
+    Pbuf * rest;
+    if (offset == q->len) {
+        rest = q->next;
+    } else {
+        // the cut is inside q: reference the bytes after it
+        rest = take(0u);
+        if (rest == ((void*)0))
+            return ((void*)0);
+
+        rest->owner = (q->owner != ((void*)0)) ? q->owner : q;
+        pbuf_ref(rest->owner);
+        rest->payload = q->payload + offset;
+        rest->len = (uint16_t)(q->len - offset);
+        rest->tot_len = (uint16_t)(q->tot_len - offset);
+        rest->next = q->next;
+        q->len = (uint16_t)offset;
+    }
+
+    for (Pbuf * s = p; s != q->next; s = s->next)
+        s->tot_len = (uint16_t)(s->tot_len - rest->tot_len);
+    q->next = ((void*)0);
+    return rest;
+}
+
+unsigned pbuf_gather(Pbuf const * p, PbufIov * iov, unsigned max) {
+    unsigned n = 0u;
+
+    for (; p != ((void*)0); p = p->next) {
+        if (p->len == 0u)
+            continue;
+        if (n == max)
+            return 0u;
+        iov[n].addr = p->payload;
+        iov[n].len = p->len;
+        n++;
+    }
+    return n;
+}
+
+size_t pbuf_copy_out(Pbuf const * p, size_t offset, void * dst, size_t n) {
+    size_t copied = 0u;
+
+    for (; p != ((void*)0) && copied < n; p = p->next) {
+        if (offset >= p->len) {
+            offset -= p->len;
+            continue;
+        }
+        size_t chunk = p->len - offset;
+        if (chunk > n - copied)
+            chunk = n - copied;
+        memcpy((uint8_t *)dst + copied, p->payload + offset, chunk);
+        copied += chunk;
+        offset = 0u;
+    }
+    return copied;
+}
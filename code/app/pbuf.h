@@ -0,0 +1,102 @@
+/** -*- c++ -*-
+   pbuf.h: reference-counted buffer chains for driver I/O
+
+   A packet is a chain of fixed-size segments taken from a static pool,
+   in the style of lwIP's pbufs.  Drivers and protocol code pass chains
+   around instead of flat arrays, so a message can be framed and sent
+   without copying the payload:
+
+   - pbuf_alloc() leaves headroom in the first segment, and
+     pbuf_push_header() claims it later for a frame header;
+   - pbuf_cat() appends one chain to another;
+   - pbuf_split() cuts a chain in two at any offset; when the cut falls
+     inside a segment, the second half starts with a reference segment
+     pointing into the first half's storage;
+   - pbuf_gather() lists the chain's pieces, e.g. to build DMA
+     descriptors.
+
+   Every segment counts its references.  pbuf_free() releases a chain
+   from the head, stopping at the first segment still referenced
+   elsewhere, so chains may safely share tails.
+
+   Allocation and freeing are safe from ISRs.
+ */
+#ifndef PBUF_H
+#define PBUF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// payload bytes per segment
+#ifndef PBUF_SEGMENT_SIZE
+#define PBUF_SEGMENT_SIZE 64u
+#endif
+
+// segments in the pool
+#ifndef PBUF_POOL_SIZE
+#define PBUF_POOL_SIZE 8u
+#endif
+
+typedef struct pbuf Pbuf;
+
+struct pbuf {
+    Pbuf * next;                // next segment in the chain, or NULL
+    uint8_t * payload;          // first byte in use
+    uint16_t len;               // bytes in use in this segment
+    uint16_t tot_len;           // len of this and every following segment
+    uint16_t refs;
+    Pbuf * owner;               // segment whose storage payload points into,
+                                // or NULL when it is this one's own
+    uint8_t data[PBUF_SEGMENT_SIZE];
+};
+
+// one piece of a chain, see pbuf_gather()
+typedef struct {
+    uint8_t const * addr;
+    size_t len;
+} PbufIov;
+
+/** Allocate a chain able to hold `len` bytes after `headroom` bytes
+    reserved in front, `headroom` <= PBUF_SEGMENT_SIZE.  The chain's
+    tot_len is `len`.  Returns NULL if the pool runs out. */
+Pbuf * pbuf_alloc(size_t len, size_t headroom);
+
+// take another reference to the head segment (and so the whole chain)
+void pbuf_ref(Pbuf * p);
+
+// drop a reference to the chain `p`, returning unused segments to the pool
+void pbuf_free(Pbuf * p);
+
+// segments left in the pool
+unsigned pbuf_pool_free(void);
+
+/** Extend the head segment's payload `n` bytes into its headroom.
+    Returns a pointer to the new first byte, or NULL if there is not
+    enough headroom. */
+uint8_t * pbuf_push_header(Pbuf * p, size_t n);
+
+// drop `n` bytes from the front of the head segment, false if too few
+bool pbuf_pull_header(Pbuf * p, size_t n);
+
+/** Append chain `tail` to chain `head`.  The caller's reference to
+    `tail` passes to `head`. */
+void pbuf_cat(Pbuf * head, Pbuf * tail);
+
+/** Cut `p` after its first `offset` bytes, 0 < `offset` < p->tot_len.
+
+    Returns the chain holding the remaining bytes, or NULL if a
+    reference segment was needed and the pool is empty (`p` is then
+    unchanged).  No payload is copied.
+ */
+Pbuf * pbuf_split(Pbuf * p, size_t offset);
+
+/** Fill `iov` with the chain's non-empty pieces, in order.  Returns
+    how many were filled, or 0 if there are more than `max`. */
+unsigned pbuf_gather(Pbuf const * p, PbufIov * iov, unsigned max);
+
+/** Copy `n` bytes starting `offset` bytes into the chain to `dst`.
+    Returns the number copied, fewer if the chain is shorter. */
+size_t pbuf_copy_out(Pbuf const * p, size_t offset, void * dst, size_t n);
+
+#endif // PBUF_H
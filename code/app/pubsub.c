@@ -0,0 +1,126 @@
+// -*- c++ -*-
+/**
+   Publish/subscribe with pooled buffers, see pubsub.h
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "pubsub.h"
+
+// block size, header included, rounded so every header stays aligned
+static size_t block_size(size_t payload_size) {
+    return (sizeof(PubsubMsg) + payload_size + (portBYTE_ALIGNMENT - 1u))
+        & ~(size_t)(portBYTE_ALIGNMENT - 1u);
+}
+
+bool pubsub_pool_create(PubsubPool * pool, size_t payload_size, unsigned count) {
+    size_t size = block_size(payload_size);
+
+    assert(count != 0u);
+
+    pool->payload_size = payload_size;
+    pool->blocks = pvPortMalloc(size * count);
+    pool->free = xQueueCreate(count, sizeof(PubsubMsg *));
+    if (pool->blocks == ((void*)0) || pool->free == ((void*)0)) {
+        vPortFree(pool->blocks);
+        if (pool->free != ((void*)0))
+            vQueueDelete(pool->free);
+        return false;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        PubsubMsg * msg = (PubsubMsg *)(void *)(pool->blocks + i * size);
+        msg->pool = pool;
+        (void) xQueueSend(pool->free, &msg, 0);
+    }
+    return true;
+}
+
+PubsubMsg * pubsub_alloc(PubsubPool * pool, TickType_t ticks) {
+    PubsubMsg * msg;
+
+    if (xQueueReceive(pool->free, &msg, ticks) != pdTRUE)
+        return ((void*)0);
+
+    msg->topic = ((void*)0);
+    msg->refs = 1u;
+    msg->length = 0u;
+    return msg;
+}
+
+void pubsub_release(PubsubMsg * msg) {
+    assert(msg->refs != 0u);
+
+    if (__atomic_sub_fetch(&msg->refs, 1u, __ATOMIC_ACQ_REL) == 0u) {
+        // the pool's queue holds every buffer, so this cannot fail
+        (void) xQueueSend(msg->pool->free, &msg, 0);
+    }
+}
+
+void pubsub_topic_init(PubsubTopic * topic) {
+    memset(topic, 0, sizeof *topic);
+}
+
+bool pubsub_subscribe(PubsubTopic * topic, QueueHandle_t inbox) {
+    bool ok = false;
+
+    assert(inbox != ((void*)0));
+
+    vTaskSuspendAll();
+    if (topic->subscribers < PUBSUB_MAX_SUBSCRIBERS) {
+        topic->inbox[topic->subscribers++] = inbox;
+        ok = true;
+    }
+    (void) xTaskResumeAll();
+    return ok;
+}
+
+void pubsub_unsubscribe(PubsubTopic * topic, QueueHandle_t inbox) {
+    vTaskSuspendAll();
+    for (unsigned i = 0; i < topic->subscribers; ++i) {
+        if (topic->inbox[i] == inbox) {
+            topic->inbox[i] = topic->inbox[--topic->subscribers];
+            break;
+        }
+    }
+    (void) xTaskResumeAll();
+}
+
+unsigned pubsub_publish(PubsubTopic * topic, PubsubMsg * msg) {
+    unsigned delivered = 0u;
+
+    assert(msg->refs == 1u);
+    assert(msg->length <= msg->pool->payload_size);
+    msg->topic = topic;
+
+    // with the scheduler suspended the subscriber list cannot change,
+    // and no subscriber can release the message before its reference
+    // is counted
+    vTaskSuspendAll();
+    msg->refs += topic->subscribers;
+    for (unsigned i = 0; i < topic->subscribers; ++i) {
+        if (xQueueSend(topic->inbox[i], &msg, 0) == pdTRUE) {
+            delivered++;
+        } else {
+            topic->drops++;
+            msg->refs--;
+        }
+    }
+    (void) xTaskResumeAll();
+
+    // drop the publisher's own reference
+    pubsub_release(msg);
+    return delivered;
+}
+
+PubsubMsg * pubsub_receive(QueueHandle_t inbox, TickType_t ticks) {
+    PubsubMsg * msg;
+
+    if (xQueueReceive(inbox, &msg, ticks) != pdTRUE)
+        return ((void*)0);
+    return msg;
+}
@@ -0,0 +1,102 @@
+/** -*- c++ -*-
+   pubsub.h: topic-based publish/subscribe with shared, pooled buffers
+
+   Sending the same data to several queues copies it once per queue.
+   Here a publisher takes a buffer from a pool, fills it in place, and
+   publishes it to a topic; each subscriber's inbox receives only a
+   pointer to the buffer.  The buffer counts its references and goes
+   back to its pool when the last subscriber releases it, so the
+   payload is written exactly once however many subscribers there are.
+
+   An inbox is an ordinary queue of `PubsubMsg *` (create it with
+   PUBSUB_INBOX_ITEM_SIZE), owned by the subscribing task; one inbox
+   may subscribe to several topics, and PubsubMsg.topic tells them
+   apart.  Publishing never blocks on a slow subscriber: if an inbox
+   is full that subscriber misses the message and the topic's drop
+   counter goes up.
+
+   Everything here is for tasks only, not ISRs.
+ */
+#ifndef PUBSUB_H
+#define PUBSUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+// number of inboxes that may subscribe to one topic
+#ifndef PUBSUB_MAX_SUBSCRIBERS
+#define PUBSUB_MAX_SUBSCRIBERS 4
+#endif
+
+#define PUBSUB_INBOX_ITEM_SIZE sizeof(PubsubMsg *)
+
+typedef struct pubsub_pool PubsubPool;
+typedef struct pubsub_topic PubsubTopic;
+
+typedef struct {
+    PubsubPool * pool;          // where the buffer returns when released
+    PubsubTopic const * topic;  // set by pubsub_publish()
+    uint32_t volatile refs;
+    size_t length;              // bytes of data in use, set by the publisher
+    uint8_t data[];             // pool->payload_size bytes
+} PubsubMsg;
+
+struct pubsub_pool {
+    QueueHandle_t free;         // PubsubMsg pointers not in use
+    size_t payload_size;
+    uint8_t * blocks;
+};
+
+struct pubsub_topic {
+    QueueHandle_t inbox[PUBSUB_MAX_SUBSCRIBERS];
+    unsigned subscribers;
+    uint32_t volatile drops;    // deliveries lost to full inboxes
+};
+
+/** Allocate `count` buffers of `payload_size` bytes each from the
+    heap.  Returns false if the heap is exhausted. */
+bool pubsub_pool_create(PubsubPool * pool, size_t payload_size, unsigned count);
+
+/** Take a buffer from `pool`, waiting up to `ticks` for one to be
+    released.  Returns NULL on timeout.  The caller holds the only
+    reference, and must either publish or release it. */
+PubsubMsg * pubsub_alloc(PubsubPool * pool, TickType_t ticks);
+
+void pubsub_topic_init(PubsubTopic * topic);
+
+/** Deliver `inbox` every message published to `topic` from now on.
+    Returns false if the topic already has PUBSUB_MAX_SUBSCRIBERS. */
+bool pubsub_subscribe(PubsubTopic * topic, QueueHandle_t inbox);
+
+// stop delivering `topic` to `inbox`; messages already queued remain
+void pubsub_unsubscribe(PubsubTopic * topic, QueueHandle_t inbox);
+
+/** Hand `msg` to every subscriber of `topic`, without copying it.
+
+    Consumes the caller's reference: do not touch `msg` afterwards.
+    Returns the number of inboxes that received it; each one that was
+    full counts as a drop.
+ */
+unsigned pubsub_publish(PubsubTopic * topic, PubsubMsg * msg);
+
+/** Wait up to `ticks` for the next message in `inbox`.  Returns NULL
+    on timeout.  Release the message when finished with it. */
+PubsubMsg * pubsub_receive(QueueHandle_t inbox, TickType_t ticks);
+
+// take another reference, e.g. to keep a message past its release
+static inline void pubsub_retain(PubsubMsg * msg) {
+    (void) __atomic_add_fetch(&msg->refs, 1u, __ATOMIC_RELAXED);
+}
+
+// drop a reference; the last one returns the buffer to its pool
+void pubsub_release(PubsubMsg * msg);
+
+static inline uint32_t pubsub_drops(PubsubTopic const * topic) {
+    return topic->drops;
+}
+
+#endif // PUBSUB_H
@@ -0,0 +1,217 @@
+// -*- c++ -*-
+/**
+   PWM brightness and DMA fades for the breadboard LEDs, see pwm-led.h
+ */
+
+#include <assert.h>
+#include <stm32f10x.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "bsp.h"
+#include "gpio-drivers.h"
+#include "static-objects.h"
+#include "pwm-led.h"
+
+// prototypes for the ISRs, named as in the startup code
+void DMA1_Channel2_IRQHandler(void);
+void DMA1_Channel5_IRQHandler(void);
+void DMA1_Channel7_IRQHandler(void);
+
+#define TIMER_HZ 1000000u
+#define PERIOD (TIMER_HZ / PWM_LED_HZ)      // timer counts per PWM period
+
+// DMA CCR: priority medium, 16-bit memory and peripheral, memory
+// increment, memory to peripheral, transfer-complete interrupt, enabled
+#define CCR_FADE ((1u << 12) | (1u << 10) | (1u << 8) | (1u << 7) \
+                  | (1u << 4) | (1u << 1) | (1u << 0))
+
+typedef struct {
+    TIM_TypeDef * tim;
+    DMA_Channel_TypeDef * dma;
+    IRQn_Type irq;
+    uint32_t ifcr;              // the DMA channel's flags in DMA1->IFCR
+    uint16_t volatile * reg;    // where the DMA writes
+    unsigned leds;              // compare channels in each table row
+    uint16_t * table;           // PWM_LED_MAX_STEPS rows
+} Timer;
+
+// timer numbers, in gl_timer[] and as notification bits
+enum { T1, T2, T4, TIMERS };
+
+static uint16_t gl_table1[PWM_LED_MAX_STEPS * 2u];
+static uint16_t gl_table2[PWM_LED_MAX_STEPS];
+static uint16_t gl_table4[PWM_LED_MAX_STEPS];
+
+static Timer const gl_timer[TIMERS] = {
+    // TIM1 bursts write CCR1 and CCR2 through DMAR
+    [T1] = { TIM1, DMA1_Channel5, DMA1_Channel5_IRQn, 0xfu << 16,
+             &TIM1->DMAR, 2u, gl_table1 },
+    [T2] = { TIM2, DMA1_Channel2, DMA1_Channel2_IRQn, 0xfu << 4,
+             &TIM2->CCR3, 1u, gl_table2 },
+    [T4] = { TIM4, DMA1_Channel7, DMA1_Channel7_IRQn, 0xfu << 24,
+             &TIM4->CCR1, 1u, gl_table4 },
+};
+
+// each LED's timer, and its column in that timer's table rows
+static struct { uint8_t timer, column; } const gl_led[PWM_LED_COUNT] = {
+    [PWM_LED_RED]    = { T2, 0u },
+    [PWM_LED_YELLOW] = { T1, 0u },
+    [PWM_LED_GREEN]  = { T1, 1u },
+    [PWM_LED_BLUE]   = { T4, 0u },
+};
+
+typedef struct {
+    PwmLed led;
+    uint8_t brightness;
+    unsigned ms;
+} FadeCommand;
+
+STATIC_TASK(gl_fader, 128);
+STATIC_QUEUE(gl_commands, FadeCommand, PWM_LED_QUEUE_LENGTH);
+static QueueHandle_t gl_command_queue = ((void*)0);
+static TaskHandle_t gl_fade_task = ((void*)0);
+
+// start playing the first `steps` rows of timer `t`'s table
+static void start(unsigned t, unsigned steps) {
+    Timer const * tm = &gl_timer[t];
+
+    tm->dma->CCR = 0u;
+    DMA1->IFCR = tm->ifcr;
+    tm->dma->CPAR = (uint32_t)tm->reg;
+    tm->dma->CMAR = (uint32_t)tm->table;
+    tm->dma->CNDTR = steps * tm->leds;
+    tm->dma->CCR = CCR_FADE;
+    tm->tim->DIER = 1u << 8;                // UDE
+}
+
+static void fader(void * param) {
+    uint8_t level[PWM_LED_COUNT] = { 0 };
+    uint32_t busy = 0u;
+    FadeCommand cmd;
+
+    (void) param;
+    for (;;) {
+        (void) xQueueReceive(gl_command_queue, &cmd, portMAX_DELAY);
+
+        unsigned t = gl_led[cmd.led].timer;
+        Timer const * tm = &gl_timer[t];
+
+        // the ISRs report finished fades as notification bits
+        while (busy & (1u << t)) {
+            uint32_t done;
+            (void) xTaskNotifyWait(0u, UINT32_MAX, &done, portMAX_DELAY);
+            busy &= ~done;
+        }
+
+        unsigned steps = cmd.ms * PWM_LED_HZ / 1000u;
+        if (steps == 0u)
+            steps = 1u;
+        if (steps > PWM_LED_MAX_STEPS)
+            steps = PWM_LED_MAX_STEPS;
+
+        // fill every column: the LED being faded, and any other LED of
+        // the same timer held where it is
+        for (unsigned led = 0; led < PWM_LED_COUNT; ++led) {
+            if (gl_led[led].timer != t)
+                continue;
+
+            uint8_t to = (led == cmd.led) ? cmd.brightness : level[led];
+            pwm_led_curve(&tm->table[gl_led[led].column], tm->leds, steps,
+                          level[led], to, PERIOD);
+            level[led] = to;
+        }
+
+        busy |= 1u << t;
+        start(t, steps);
+    }
+}
+
+// PWM mode 1 with preload, in an output compare nybble pair of CCMRx
+#define OC_PWM1 ((6u << 4) | (1u << 3))
+
+static void setup_timer(TIM_TypeDef * tim) {
+    tim->PSC = (uint16_t)(configCPU_CLOCK_HZ / TIMER_HZ - 1u);
+    tim->ARR = (uint16_t)(PERIOD - 1u);
+    tim->EGR = 1u << 0;                     // UG: load PSC and ARR
+    tim->CR1 = (1u << 7) | (1u << 0);       // ARPE, CEN
+}
+
+void pwm_led_init(UBaseType_t priority) {
+    assert(gl_fade_task == ((void*)0));
+
+    enable_afio_clk();
+    enable_gpioa_clk();
+    enable_gpiob_clk();
+    BITBAND(RCC->APB2ENR, 11) = 1u;         // bits[11] = TIM1EN <- 1
+    BITBAND(RCC->APB1ENR, 0) = 1u;          // bits[0] = TIM2EN <- 1
+    BITBAND(RCC->APB1ENR, 2) = 1u;          // bits[2] = TIM4EN <- 1
+    BITBAND(RCC->AHBENR, 0) = 1u;           // bits[0] = DMA1EN <- 1
+
+    // TIM2 partial remap 2 puts CH3 on PB10: MAPR bits[9:8] <- 10
+    BITBAND(AFIO->MAPR, 9) = 1u;
+
+    GPIO_CONFIG(LED_RED, GPIO_AF_PP_2MHZ);
+    GPIO_CONFIG(LED_YELLOW, GPIO_AF_PP_2MHZ);
+    GPIO_CONFIG(LED_GREEN, GPIO_AF_PP_2MHZ);
+    GPIO_CONFIG(LED_BLUE, GPIO_AF_PP_2MHZ);
+
+    // compare registers start at 0, so every LED starts off
+    TIM1->CCMR1 = (uint16_t)((OC_PWM1 << 8) | OC_PWM1);  // CH2, CH1
+    TIM1->CCER = (1u << 4) | (1u << 0);                 // CC2E, CC1E
+    TIM1->BDTR = 1u << 15;                              // MOE
+    TIM1->DCR = (1u << 8) | 13u;    // bursts of 2 from CCR1 (0x34 / 4)
+    TIM2->CCMR2 = OC_PWM1;                              // CH3
+    TIM2->CCER = 1u << 8;                               // CC3E
+    TIM4->CCMR1 = OC_PWM1;                              // CH1
+    TIM4->CCER = 1u << 0;                               // CC1E
+    setup_timer(TIM1);
+    setup_timer(TIM2);
+    setup_timer(TIM4);
+
+    for (unsigned t = 0; t < TIMERS; ++t) {
+        // the ISRs notify a task, so must be at or below
+        // configMAX_SYSCALL_INTERRUPT_PRIORITY
+        NVIC_SetPriority(gl_timer[t].irq, configLIBRARY_KERNEL_INTERRUPT_PRIORITY);
+        NVIC_EnableIRQ(gl_timer[t].irq);
+    }
+
+    gl_command_queue = STATIC_QUEUE_CREATE(gl_commands);
+    gl_fade_task = STATIC_TASK_CREATE(gl_fader, fader, "pwm fader",
+                                      ((void*)0), priority);
+}
+
+bool pwm_led_fade(PwmLed led, uint8_t brightness, unsigned ms,
+                  TickType_t ticks) {
+    FadeCommand cmd = { led, brightness, ms };
+
+    assert(led < PWM_LED_COUNT);
+    assert(gl_command_queue != ((void*)0));
+    return xQueueSend(gl_command_queue, &cmd, ticks) == pdTRUE;
+}
+
+// a fade has written its last compare value: stop, and tell the fader
+static void fade_done(unsigned t) {
+    Timer const * tm = &gl_timer[t];
+    BaseType_t woken = pdFALSE;
+
+    DMA1->IFCR = tm->ifcr;
+    tm->tim->DIER = 0u;
+    tm->dma->CCR = 0u;
+
+    (void) xTaskNotifyFromISR(gl_fade_task, 1u << t, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void DMA1_Channel2_IRQHandler(void) {
+    fade_done(T2);
+}
+
+void DMA1_Channel5_IRQHandler(void) {
+    fade_done(T1);
+}
+
+void DMA1_Channel7_IRQHandler(void) {
+    fade_done(T4);
+}
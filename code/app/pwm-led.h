@@ -0,0 +1,79 @@
+/** -*- c++ -*-
+   pwm-led.h: dimmable breadboard LEDs, faded by DMA
+
+   Each breadboard LED (see bsp.h) sits on a timer output:
+
+       LED      pin    timer channel   DMA1 channel (timer update)
+       red      PB10   TIM2_CH3 *      2
+       yellow   PA8    TIM1_CH1        5
+       green    PA9    TIM1_CH2        5
+       blue     PB6    TIM4_CH1        7
+
+       * with TIM2's partial remap 2
+
+   so its brightness is a PWM duty cycle, at PWM_LED_HZ.  Brightness
+   runs 0..255 and is gamma corrected, so equal steps look equally
+   large.
+
+   A fade is precomputed into a table of compare values, one per PWM
+   period; the timer's update event then has DMA copy the next value
+   into the compare register, so a fade costs no CPU time while it
+   runs.  Both TIM1 LEDs are updated by one DMA burst per period.
+
+   Tasks queue fade commands with pwm_led_fade(); a task owned by this
+   driver builds the tables and starts the DMA.  A command for an LED
+   whose timer is still fading waits for that fade to finish, and
+   commands behind it in the queue wait too.  A fade lasts at most
+   PWM_LED_MAX_STEPS PWM periods; longer durations are cut to that.
+
+   The driver takes over the four pins as timer outputs, so it cannot
+   be used together with led-pattern.h or GPIO writes to the same LEDs.
+ */
+#ifndef PWM_LED_H
+#define PWM_LED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+
+#define PWM_LED_HZ 200u
+
+// longest fade, in PWM periods: 200 is one second
+#ifndef PWM_LED_MAX_STEPS
+#define PWM_LED_MAX_STEPS 200u
+#endif
+
+// fade commands that may wait in the driver's queue
+#ifndef PWM_LED_QUEUE_LENGTH
+#define PWM_LED_QUEUE_LENGTH 8u
+#endif
+
+typedef enum {
+    PWM_LED_RED,
+    PWM_LED_YELLOW,
+    PWM_LED_GREEN,
+    PWM_LED_BLUE,
+    PWM_LED_COUNT
+} PwmLed;
+
+/** Configure the pins, timers and DMA, with every LED off, and start
+    the fade task at `priority`.  Call once. */
+void pwm_led_init(UBaseType_t priority);
+
+/** Queue a fade of `led` from its current brightness to `brightness`
+    over `ms` milliseconds (0 to jump straight there), waiting up to
+    `ticks` for room in the queue.  Returns false if there was none. */
+bool pwm_led_fade(PwmLed led, uint8_t brightness, unsigned ms,
+                  TickType_t ticks);
+
+/** Write `steps` compare values fading from brightness `from` to
+    `to`, evenly spaced in brightness and gamma corrected for a timer
+    period of `period` counts, to every `stride`th element of `out`.
+    The last value is always that of `to`.  Pure, and in its own file
+    (pwm-led-curve.c), so it is checked on the host. */
+void pwm_led_curve(uint16_t * out, size_t stride, unsigned steps,
+                   uint8_t from, uint8_t to, uint16_t period);
+
+#endif // PWM_LED_H
@@ -6,12 +6,21 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stdlib.h>     // for abort() used by __aeabi_assert()
+#include <assert.h>
 #include <stm32f10x.h>
 
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mpsc-buffer.h"
+#include "static-objects.h"
+
 // prototypes
 #include "serial-io.h"
 static void sendByte (char c);
+static void sendRaw (uint8_t c);
 static char getByte (void);
 
 __attribute__((noreturn))
@@ -22,15 +31,31 @@ __attribute__((noreturn))
  */
 void __aeabi_assert(char const *expr, char const * filename, int line);
 
+// output from tasks, waiting for the serial task
+static uint8_t gl_tx_storage[SERIAL_TX_BUFFER_SIZE] __attribute__((aligned(4)));
+static MpscBuffer gl_tx;
+static bool gl_tx_started = false;
+STATIC_TASK(gl_serial_tx, 128);
+
+// largest record serial_write() sends; longer writes are split
+#define SERIAL_RECORD_MAX 128u
+
+// true once output from tasks is buffered
+static bool buffered(void) {
+    return gl_tx_started
+        && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
 // implement basic functions needed to retarget std C I/O
 static void sendByte (char c)
 {
-    if (c == '\n') {  // insert CR before each NL
-        while ((USART2->SR & 1u<<7)==0) {  // spin while TDR is occupied
-        }
-        USART2->DR = '\r';
-    }
+    if (c == '\n')  // insert CR before each NL
+        sendRaw('\r');
+    sendRaw((uint8_t)c);
+}
 
+static void sendRaw (uint8_t c)
+{
     while ((USART2->SR & 1u<<7)==0) {  // spin while TDR is occupied
     }
     USART2->DR = c;
@@ -38,8 +63,11 @@ static void sendByte (char c)
 
 static char getByte (void)
 {
-    // while the read data register is empty, spin
+    // while the read data register is empty, spin, but let the
+    // serial task print any prompt meanwhile
     while ((USART2->SR & 1u<<5)==0) {
+        if (buffered())
+            vTaskDelay(1);
     }
     return (char)USART2->DR;
 }
@@ -54,14 +82,82 @@ int fgetc(FILE * stream) {
 int fputc(int c, FILE * stream) {
     (void)stream; // disable warning about unused parameter
     char byte = (char)c;  // avoid implicit conversion warning
-    sendByte(byte);
+    if (buffered())
+        (void) serial_write(&byte, 1u);
+    else
+        sendByte(byte);
     return c;
 }
 
-/** This function is to be called exactly once, generally at the start of main.
+static void serial_tx(void * arg) {
+    uint8_t chunk[32];
+
+    (void) arg;
+    for (;;) {
+        size_t n = mpsc_receive(&gl_tx, chunk, sizeof chunk, portMAX_DELAY);
+        for (size_t i = 0; i < n; ++i)
+            sendByte((char)chunk[i]);
+    }
+}
+
+void serial_start(UBaseType_t priority) {
+    assert(!gl_tx_started);
+
+    mpsc_init(&gl_tx, gl_tx_storage, sizeof gl_tx_storage);
+    (void) STATIC_TASK_CREATE(gl_serial_tx, serial_tx, "serial tx",
+                              ((void*)0), priority);
+    gl_tx_started = true;
+}
 
-    This is the only public function defined here, and the only one
-    present in the associated header file serial-io.h.
+size_t serial_write(void const * data, size_t n) {
+    uint8_t const * p = data;
+    size_t left = n;
+
+    if (!buffered()) {
+        for (size_t i = 0; i < n; ++i)
+            sendByte((char)p[i]);
+        return n;
+    }
+
+    while (left != 0u) {
+        size_t chunk = (left < SERIAL_RECORD_MAX) ? left : SERIAL_RECORD_MAX;
+
+        if (mpsc_send(&gl_tx, p, chunk) == 0u) {
+            vTaskDelay(1);      // full: let the serial task drain it
+            continue;
+        }
+        p += chunk;
+        left -= chunk;
+    }
+    return n;
+}
+
+int serial_printf(char const * fmt, ...) {
+    char line[SERIAL_LINE_MAX];
+    va_list args;
+
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof line, fmt, args);
+    va_end(args);
+
+    if (n < 0)
+        return n;
+    if ((size_t)n >= sizeof line)
+        n = (int)sizeof line - 1;   // cut short
+    (void) serial_write(line, (size_t)n);
+    return n;
+}
+
+// send a frame assembled from segments, without flattening it first
+void serial_send_chain(Pbuf * p) {
+    for (Pbuf const * q = p; q != ((void*)0); q = q->next) {
+        for (uint16_t i = 0; i < q->len; ++i)
+            sendRaw(q->payload[i]);
+    }
+    pbuf_free(p);
+}
+
+/** This function is to be called exactly once, generally at the start of main.
 
     Note: this implementation assumes the use of Keil's Microlib
  */
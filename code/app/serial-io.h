@@ -2,13 +2,52 @@
    Serial I/O.  For Keil we can just implement fputc and fgetc (in serial-io.c)
    and clients will get the prototypes by including stdio.h.
 
+   Once serial_start() has run and the scheduler is running, output
+   from tasks goes through a many-writer buffer (mpsc-buffer.h) that
+   a serial task drains to USART2, so writers neither spin on the
+   UART nor share a lock.  serial_printf() and serial_write() keep a
+   whole line together; printf() still works, a byte per record, but
+   its bytes may interleave with other tasks' output.  Before then,
+   and for output sent from main(), bytes go straight to the UART.
+
    Note: this implementation depends on MicroLib being enabled (which means no C++).
  */
 #ifndef SERIAL_IO_H
 #define SERIAL_IO_H
 
 #include <stdio.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "pbuf.h"
+
+// bytes of output waiting for the UART; a power of 2
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 512u
+#endif
+
+// longest line serial_printf() formats, with its terminating NUL
+#define SERIAL_LINE_MAX 96u
 
 void openUsart2(void);
 
+/** Create the task that drains buffered output, at `priority`.  Call
+    once, after openUsart2() and before starting the scheduler. */
+void serial_start(UBaseType_t priority);
+
+/** Send `n` bytes as one record, from a task.  If the buffer is full
+    the caller sleeps a tick at a time until there is room; it holds
+    no lock meanwhile.  Returns `n`. */
+size_t serial_write(void const * data, size_t n);
+
+/** printf() into one record: the line is not interleaved with other
+    tasks' output.  Longer lines are cut at SERIAL_LINE_MAX - 1
+    characters.  Returns the number of characters sent, or a negative
+    value on a format error. */
+int serial_printf(char const * fmt, ...);
+
+/** Transmit every byte of the chain `p` as is (no CR is inserted
+    before NL), then drop the caller's reference to it. */
+void serial_send_chain(Pbuf * p);
+
 #endif //SERIAL_IO_H
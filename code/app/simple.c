@@ -20,6 +20,7 @@
 #include "gpio-drivers.h"       // FIXME: should not need this here
 
 #include "bsp.h"
+#include "static-objects.h"
 
 ////////////////////////////////////////////////////////////////
 // Allow hand-off from task blinkPA8 to blinkPA5.  I want the PA8 task
@@ -32,25 +33,31 @@
 //  PA5....................^^__................^^__.......... etc
 //  PA8__________^^^^^^^^^^__________^^^^^^^^^^__________^^^^^ etc
 static SemaphoreHandle_t gl_sequence_tasks_sem = ((void*)0);
+STATIC_SEMAPHORE(gl_sequence_tasks);
+
+// FIXME: for both blinkPA5 and displayPattern, investigate stack usage.
+//   I fixed the stack overflow by just multiplying the size by 5.
+STATIC_TASK(gl_blink, 250);     // stack in words
+STATIC_TASK(gl_display, 250);
 
 __attribute__((noreturn))
 static void blinkPA5(void * blah) {
     (void) blah;
     // turn on clock for GPIOA
-    RCC->APB2ENR |= 1<<2;
+    enable_gpioa_clk();
 
     // configure PA5 to be output, push-pull, 50MHz
-    gpio_config_pin(GPIOA, 5u, 3u);
+    GPIO_CONFIG(LED_USER, GPIO_OUT_PP_50MHZ);
 
     while (1) {
         xSemaphoreTake(gl_sequence_tasks_sem, portMAX_DELAY);  // wait
 
         // turn on PA5 LED
-        gpio_pin_onoff(GPIOA, 5, 1);
+        GPIO_SET(LED_USER);
         vTaskDelay(100);
 
         // turn off PA5 LED
-        gpio_pin_onoff(GPIOA, 5, 0);
+        GPIO_RESET(LED_USER);
         vTaskDelay(100);
     }
 }
@@ -62,9 +69,8 @@ static void displayPattern(void * blah) {
     configureButton();          // install ISR, count button presses
 
     while (1) {
-        // FIXME: race condition in call to fputs, and
-        //  when accessing gl_button_count
-        printf("USER button count: %d\n", gl_button_count);
+        // FIXME: race condition when accessing gl_button_count
+        serial_printf("USER button count: %d\n", gl_button_count);
         runWidget();
         xSemaphoreGive(gl_sequence_tasks_sem);  // let other task run
     }
@@ -73,30 +79,25 @@ int main() {
     openUsart2();
     printf("Version: %s\n", GIT_COMMIT);
 
-    // FIXME: for both blinkPA5 and displayPattern, investigate stack usage.
-    //   I fixed the stack overflow by just multiplying the size by 5.
-    BaseType_t retval = xTaskCreate(
+    // static storage: none of these can fail
+    (void) STATIC_TASK_CREATE(gl_blink,
         blinkPA5,    // task function
         "blink PA5", // task name
-        250,          // stack in words
         ((void*)0),     // optional parameter
-        4,           // priority
-        ((void*)0)      // optional out: task handle
+        4            // priority
         );
-    assert(retval==pdPASS);
 
-    retval = xTaskCreate(
+    (void) STATIC_TASK_CREATE(gl_display,
         displayPattern,    // task function
         "displ pattn", // task name
-        250,          // stack in words
         ((void*)0),     // optional parameter
-        4,           // priority
-        ((void*)0)      // optional out: task handle
+        4            // priority
         );
-    assert(retval==pdPASS);
 
-    gl_sequence_tasks_sem = xSemaphoreCreateBinary();
-    assert(gl_sequence_tasks_sem != ((void*)0));
+    gl_sequence_tasks_sem = STATIC_BINARY_SEMAPHORE_CREATE(gl_sequence_tasks);
+
+    // below the app tasks: output drains while they wait
+    serial_start(3);
 
     printf("starting scheduler\n");
     vTaskStartScheduler();
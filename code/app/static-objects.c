@@ -0,0 +1,37 @@
+// -*- c++ -*-
+/**
+   Storage the kernel needs when configSUPPORT_STATIC_ALLOCATION is 1,
+   see static-objects.h
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "static-objects.h"
+
+/** Called by vTaskStartScheduler() for the idle task's TCB and stack,
+    so the idle task, like the app's static objects, is not on the
+    heap. */
+void vApplicationGetIdleTaskMemory(StaticTask_t ** tcb,
+                                   StackType_t ** stack,
+                                   uint32_t * stack_words) {
+    static StaticTask_t idle_tcb;
+    static StackType_t idle_stack[configMINIMAL_STACK_SIZE];
+
+    *tcb = &idle_tcb;
+    *stack = idle_stack;
+    *stack_words = configMINIMAL_STACK_SIZE;
+}
+
+#if ( configUSE_TIMERS == 1 )
+// as vApplicationGetIdleTaskMemory, for the timer daemon task
+void vApplicationGetTimerTaskMemory(StaticTask_t ** tcb,
+                                    StackType_t ** stack,
+                                    uint32_t * stack_words) {
+    static StaticTask_t timer_tcb;
+    static StackType_t timer_stack[configTIMER_TASK_STACK_DEPTH];
+
+    *tcb = &timer_tcb;
+    *stack = timer_stack;
+    *stack_words = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
@@ -0,0 +1,112 @@
+/** -*- c++ -*-
+   static-objects.h: kernel objects in static storage, sized at compile time
+
+   The kernel's xCreateStatic functions take the object's storage as
+   arguments, which means declaring a buffer and a control block for
+   every object, keeping their sizes in step, and checking a handle
+   that can only be NULL if the arguments were wrong.  These macros
+   pair each object's storage with its create call:
+
+       STATIC_TASK(blinker, 250);
+       STATIC_QUEUE(events, uint32_t, 8);
+
+       TaskHandle_t t = STATIC_TASK_CREATE(blinker, blink, "blink", NULL, 4);
+       QueueHandle_t q = STATIC_QUEUE_CREATE(events);
+
+   The storage macros go at file scope, one per object, and declare
+   `static` variables named after the object.  The create macros expand
+   to exactly the raw kernel call, so they cost nothing over writing it
+   out by hand; since the storage is fixed at build time they cannot
+   fail and touch no heap.  Create each object once.
+ */
+#ifndef STATIC_OBJECTS_H
+#define STATIC_OBJECTS_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "timers.h"
+
+#if ( configSUPPORT_STATIC_ALLOCATION != 1 )
+#error static-objects.h needs configSUPPORT_STATIC_ALLOCATION set to 1
+#endif
+
+#define STATIC_TASK(name, stack_words)                                  \
+    static StackType_t name##_stack[stack_words];                       \
+    static StaticTask_t name##_tcb
+
+#define STATIC_TASK_CREATE(name, fn, label, param, priority)            \
+    xTaskCreateStatic((fn), (label),                                    \
+                      sizeof name##_stack / sizeof name##_stack[0],     \
+                      (param), (priority), name##_stack, &name##_tcb)
+
+// a queue of `length` items of `type`
+#define STATIC_QUEUE(name, type, length)                                \
+    enum { name##_item_size = sizeof(type) };                           \
+    static uint8_t name##_storage[(length) * sizeof(type)];             \
+    static StaticQueue_t name##_queue
+
+#define STATIC_QUEUE_CREATE(name)                                       \
+    xQueueCreateStatic(sizeof name##_storage / name##_item_size,        \
+                       name##_item_size, name##_storage, &name##_queue)
+
+#if ( configUSE_PRIORITY_QUEUES == 1 )
+// a priority queue of `length` items of `type`, and their priorities
+#define STATIC_PRIORITY_QUEUE(name, type, length)                       \
+    enum { name##_item_size = sizeof(type), name##_length = (length) }; \
+    static uint8_t name##_storage[(length) * (sizeof(type) + 1u)];      \
+    static StaticQueue_t name##_queue
+
+#define STATIC_PRIORITY_QUEUE_CREATE(name)                              \
+    xQueueCreatePriorityStatic(name##_length, name##_item_size,         \
+                               name##_storage, &name##_queue)
+#endif
+
+#define STATIC_SEMAPHORE(name)                                          \
+    static StaticSemaphore_t name##_semaphore
+
+#define STATIC_MUTEX_CREATE(name)                                       \
+    xSemaphoreCreateMutexStatic(&name##_semaphore)
+
+#define STATIC_BINARY_SEMAPHORE_CREATE(name)                            \
+    xSemaphoreCreateBinaryStatic(&name##_semaphore)
+
+// a stream buffer holding up to `size` bytes
+#define STATIC_STREAM_BUFFER(name, size)                                \
+    static uint8_t name##_storage[(size) + 1u];                         \
+    static StaticStreamBuffer_t name##_stream
+
+#define STATIC_STREAM_BUFFER_CREATE(name, trigger_level)                \
+    xStreamBufferCreateStatic(sizeof name##_storage - 1u,               \
+                              (trigger_level), name##_storage,          \
+                              &name##_stream)
+
+#if ( configUSE_TIMERS == 1 )
+#define STATIC_TIMER(name)                                              \
+    static StaticTimer_t name##_timer
+
+#define STATIC_TIMER_CREATE(name, label, ticks, auto_reload, id, fn)    \
+    xTimerCreateStatic((label), (ticks), (auto_reload), (id), (fn),     \
+                       &name##_timer)
+#endif
+
+/** Run the following statement or block holding mutex `m`:
+
+       WITH_MUTEX(gl_lock) {
+           ...
+       }
+
+    The mutex is given back when the block ends normally.  Leaving it
+    by `break`, `return` or `goto` skips the give, so don't.
+ */
+#define WITH_MUTEX(m)                                                   \
+    for (int with_mutex_once_ =                                         \
+             (xSemaphoreTake((m), portMAX_DELAY), 1);                   \
+         with_mutex_once_;                                              \
+         with_mutex_once_ = 0, (void) xSemaphoreGive(m))
+
+#endif // STATIC_OBJECTS_H
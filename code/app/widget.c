@@ -9,50 +9,59 @@
 #include "task.h"
 #include "widget.h"
 #include "gpio-drivers.h"
+#include "heap-trace.h"
+#include "serial-io.h"
+#include "led-pattern.h"
+
+// the LED sequence runWidget plays, built once by configureWidget
+static LedPattern gl_cycle;
 
 void configureWidget() {
     // turn on clock for GPIOA and GPIOB
-    RCC->APB2ENR |= 1u<<2;
-    RCC->APB2ENR |= 1u<<3;
+    enable_gpioa_clk();
+    enable_gpiob_clk();
 
     // configure four pins to be output, push-pull, 50MHz
     // PB10: Red, PA8: Yellow, PA9: Green, PB6: Blue
-    gpio_config_pin(GPIOB, 10u, 3u);
-    gpio_config_pin(GPIOA, 8u, 3u);
-    gpio_config_pin(GPIOA, 9u, 3u);
-    gpio_config_pin(GPIOB, 6u, 3u);
+    GPIO_CONFIG(LED_RED, GPIO_OUT_PP_50MHZ);
+    GPIO_CONFIG(LED_YELLOW, GPIO_OUT_PP_50MHZ);
+    GPIO_CONFIG(LED_GREEN, GPIO_OUT_PP_50MHZ);
+    GPIO_CONFIG(LED_BLUE, GPIO_OUT_PP_50MHZ);
 
+    // one cycle: each LED on then off, 500 ms per step
+    led_pattern_engine_init();
+    led_pattern_init(&gl_cycle, 500);
+    led_pattern_set(&gl_cycle, LED_RED, true);
+    (void) led_pattern_add_step(&gl_cycle);
+    led_pattern_set(&gl_cycle, LED_RED, false);
+    (void) led_pattern_add_step(&gl_cycle);
+    led_pattern_set(&gl_cycle, LED_YELLOW, true);
+    (void) led_pattern_add_step(&gl_cycle);
+    led_pattern_set(&gl_cycle, LED_YELLOW, false);
+    (void) led_pattern_add_step(&gl_cycle);
+    led_pattern_set(&gl_cycle, LED_GREEN, true);
+    (void) led_pattern_add_step(&gl_cycle);
+    led_pattern_set(&gl_cycle, LED_GREEN, false);
+    (void) led_pattern_add_step(&gl_cycle);
+    led_pattern_set(&gl_cycle, LED_BLUE, true);
+    (void) led_pattern_add_step(&gl_cycle);
+    led_pattern_set(&gl_cycle, LED_BLUE, false);
+    (void) led_pattern_add_step(&gl_cycle);  // hold the last step 500 ms too
 }
 
 void runWidget() {
-    static const struct {
-        GPIO_TypeDef* gpio;
-        uint32_t pin;
-        uint32_t onoff;
-    } seq[]  = {
-        {GPIOB, 10, 1},  // turn on PB10
-        {GPIOB, 10, 0},  // turn off PB10
-        {GPIOA, 8, 1},   // turn on PA8 LED
-        {GPIOA, 8, 0},   // turn off PA8 LED
-        {GPIOA, 9, 1},   // turn on PA9 LED
-        {GPIOA, 9, 0},   // turn off PA9 LED
-        {GPIOB, 6, 1},   // turn on PB4 LED
-        {GPIOB, 6, 0},   // turn off PB4 LED
-    };
-
-    // FIXME: race condition in call to fputs/fgets
-    printf("Press any key to initiate one cycle: ");
+    // FIXME: race condition in call to fgets
+    serial_printf("Press any key to initiate one cycle: ");
     int c = fgetc(stdin);
     if (isprint(c))
-        printf("\nKey pressed: %c (0x%02x)\n", c, c);
+        serial_printf("\nKey pressed: %c (0x%02x)\n", c, c);
     else
-        printf("\nNon-printable key pressed: 0x%02x\n", c);
-    for (uint32_t i=0; i < 8; ++i) {
-        GPIO_TypeDef* gpio = seq[i].gpio;
-        uint32_t pin = seq[i].pin;
-        uint32_t onoff = seq[i].onoff;
+        serial_printf("\nNon-printable key pressed: 0x%02x\n", c);
+    if (c == 'h')               // capture for tools/heap-map
+        heap_trace_dump();
 
-        gpio_pin_onoff(gpio, pin, onoff);
-        vTaskDelay(500);
-    }
+    // let any earlier cycle finish, then play this one by DMA; the
+    // task is free again as soon as it starts
+    (void) led_pattern_wait(portMAX_DELAY);
+    (void) led_pattern_play(&gl_cycle);
 }
@@ -0,0 +1,123 @@
+// -*- c++ -*-
+/**
+   Worker task pool, see worker-pool.h
+ */
+
+#include <assert.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "worker-pool.h"
+
+#if WORKER_POOL_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error "WORKER_POOL_NOTIFY_INDEX needs configTASK_NOTIFICATION_ARRAY_ENTRIES above it"
+#endif
+
+static void worker(void * param) {
+    WorkerPool * pool = param;
+    WorkerJob * job;
+
+    for (;;) {
+        if (xQueueReceive(pool->jobs, &job, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        job->state = WORKER_JOB_RUNNING;
+        job->result = job->fn(job->arg);
+
+        // the callback runs before the job is marked done, as the
+        // owner may reuse the job as soon as it is
+        if (job->on_done != ((void*)0))
+            job->on_done(job);
+
+        // publish the result and pick up the waiter in one step, so a
+        // waiter that arrives concurrently either sees DONE or is seen
+        taskENTER_CRITICAL();
+        job->state = WORKER_JOB_DONE;
+        TaskHandle_t waiter = job->waiter;
+        taskEXIT_CRITICAL();
+
+        if (waiter != ((void*)0))
+            xTaskNotifyGiveIndexed(waiter, WORKER_POOL_NOTIFY_INDEX);
+    }
+}
+
+bool worker_pool_create(WorkerPool * pool, char const * name,
+                        unsigned workers, configSTACK_DEPTH_TYPE stack_words,
+                        UBaseType_t priority, unsigned queue_length) {
+    assert(workers != 0u && workers <= WORKER_POOL_MAX_WORKERS);
+    assert(queue_length != 0u);
+
+    pool->stack_words = stack_words;
+    pool->workers = 0u;
+    pool->jobs = xQueueCreatePriority(queue_length, sizeof(WorkerJob *));
+    if (pool->jobs == ((void*)0))
+        return false;
+
+    for (unsigned i = 0; i < workers; ++i) {
+        if (xTaskCreate(worker, name, stack_words, pool, priority,
+                        &pool->worker[i]) != pdPASS) {
+            // the queue is empty, so the workers are all blocked on it
+            while (pool->workers != 0u)
+                vTaskDelete(pool->worker[--pool->workers]);
+            vQueueDelete(pool->jobs);
+            pool->jobs = ((void*)0);
+            return false;
+        }
+        pool->workers++;
+    }
+    return true;
+}
+
+void worker_job_init(WorkerJob * job, int (*fn)(void * arg), void * arg,
+                     configSTACK_DEPTH_TYPE stack_words,
+                     void (*on_done)(WorkerJob * job)) {
+    assert(fn != ((void*)0));
+
+    job->fn = fn;
+    job->arg = arg;
+    job->on_done = on_done;
+    job->stack_words = stack_words;
+    job->state = WORKER_JOB_IDLE;
+    job->result = 0;
+    job->waiter = ((void*)0);
+}
+
+bool worker_pool_submit(WorkerPool * pool, WorkerJob * job,
+                        uint8_t priority, TickType_t ticks) {
+    assert(job->state != WORKER_JOB_QUEUED && job->state != WORKER_JOB_RUNNING);
+
+    if (job->stack_words > pool->stack_words)
+        return false;
+
+    job->state = WORKER_JOB_QUEUED;
+    job->waiter = ((void*)0);
+    if (xQueueSendWithPriority(pool->jobs, &job, priority, ticks) != pdTRUE) {
+        job->state = WORKER_JOB_IDLE;
+        return false;
+    }
+    return true;
+}
+
+bool worker_job_wait(WorkerJob * job, TickType_t ticks) {
+    TimeOut_t timeout;
+    bool done;
+
+    assert(job->state != WORKER_JOB_IDLE);
+
+    vTaskSetTimeOutState(&timeout);
+    for (;;) {
+        taskENTER_CRITICAL();
+        done = (job->state == WORKER_JOB_DONE);
+        job->waiter = done ? ((void*)0) : xTaskGetCurrentTaskHandle();
+        taskEXIT_CRITICAL();
+
+        // a notification left over from an earlier wait that timed out
+        // wakes us early, so keep waiting out whatever time is left
+        if (done || xTaskCheckForTimeOut(&timeout, &ticks) != pdFALSE)
+            break;
+        (void) ulTaskNotifyTakeIndexed(WORKER_POOL_NOTIFY_INDEX, pdTRUE, ticks);
+    }
+    job->waiter = ((void*)0);
+    return done;
+}
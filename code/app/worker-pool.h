@@ -0,0 +1,111 @@
+/** -*- c++ -*-
+   worker-pool.h: a fixed set of worker tasks running short jobs
+
+   Giving every background activity its own task costs a stack and a
+   TCB each, plus the time to create it.  A worker pool instead creates
+   a few tasks once, all sharing one stack size, and feeds them jobs
+   through a priority queue: the most urgent waiting job runs next,
+   jobs of equal priority in the order they were submitted.
+
+   A job is a function and its argument, in storage the caller owns
+   (no allocation per job).  The WorkerJob doubles as its own future:
+   once submitted, the caller can poll worker_job_done(), block in
+   worker_job_wait(), or have a callback run in the worker when the
+   job finishes.
+
+   Pools are stack-size aware.  Each job states the stack it needs and
+   a pool refuses jobs larger than its workers' stacks, so an app can
+   run e.g. a small pool for most jobs and a second pool with bigger
+   stacks for the few that need it.
+
+   Everything here is for tasks only, not ISRs.
+ */
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// most workers one pool may have
+#ifndef WORKER_POOL_MAX_WORKERS
+#define WORKER_POOL_MAX_WORKERS 4
+#endif
+
+// the task notification index worker_job_wait() blocks on, kept apart
+// from index 0 so that the waiting task's other notifications are
+// neither taken by the wait nor cut it short
+#ifndef WORKER_POOL_NOTIFY_INDEX
+#define WORKER_POOL_NOTIFY_INDEX 1
+#endif
+
+typedef struct worker_job WorkerJob;
+
+typedef enum {
+    WORKER_JOB_IDLE,            // never submitted
+    WORKER_JOB_QUEUED,
+    WORKER_JOB_RUNNING,
+    WORKER_JOB_DONE,
+} WorkerJobState;
+
+struct worker_job {
+    int (*fn)(void * arg);
+    void * arg;
+    void (*on_done)(WorkerJob * job); // optional, runs in the worker
+                                      // just before the job is done
+    configSTACK_DEPTH_TYPE stack_words; // stack the job needs, in words
+    WorkerJobState volatile state;
+    int result;                 // fn's return value, once DONE
+    TaskHandle_t volatile waiter; // task blocked in worker_job_wait, or NULL
+};
+
+typedef struct {
+    QueueHandle_t jobs;         // priority queue of WorkerJob pointers
+    configSTACK_DEPTH_TYPE stack_words;
+    unsigned workers;
+    TaskHandle_t worker[WORKER_POOL_MAX_WORKERS];
+} WorkerPool;
+
+/** Create `workers` tasks named `name`, each with a `stack_words`
+    stack and running at `priority`, and a queue for up to
+    `queue_length` waiting jobs.  Returns false if the heap is
+    exhausted; nothing is left allocated in that case. */
+bool worker_pool_create(WorkerPool * pool, char const * name,
+                        unsigned workers, configSTACK_DEPTH_TYPE stack_words,
+                        UBaseType_t priority, unsigned queue_length);
+
+/** Prepare `job` to run `fn(arg)` in a worker.  `stack_words` is the
+    most stack fn uses.  `on_done` may be NULL. */
+void worker_job_init(WorkerJob * job, int (*fn)(void * arg), void * arg,
+                     configSTACK_DEPTH_TYPE stack_words,
+                     void (*on_done)(WorkerJob * job));
+
+/** Queue `job` at `priority` (0..255, highest runs first), waiting up
+    to `ticks` for room in the queue.
+
+    Returns false if the queue stayed full, or if the job needs a
+    bigger stack than the pool's workers have.  `job` must not already
+    be queued or running, and must stay valid until it is done.
+ */
+bool worker_pool_submit(WorkerPool * pool, WorkerJob * job,
+                        uint8_t priority, TickType_t ticks);
+
+/** Wait up to `ticks` for `job` to finish.  Returns true once it has;
+    its result is then in job->result.  Only one task may wait on a
+    job at a time. */
+bool worker_job_wait(WorkerJob * job, TickType_t ticks);
+
+static inline bool worker_job_done(WorkerJob const * job) {
+    return job->state == WORKER_JOB_DONE;
+}
+
+// jobs queued and not yet picked up by a worker
+static inline unsigned worker_pool_backlog(WorkerPool const * pool) {
+    return (unsigned)uxQueueMessagesWaiting(pool->jobs);
+}
+
+#endif // WORKER_POOL_H
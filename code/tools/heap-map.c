@@ -0,0 +1,150 @@
+/**
+   heap-map: replay a heap trace and draw the heap after every event
+
+   Runs on the Linux host.  Feed it the serial output of
+   heap_trace_dump() (see app/heap-trace.h); any other lines are
+   ignored, so a raw capture of the terminal session will do:
+
+       make tools/heap-map
+       tools/heap-map [-w columns] < capture.txt
+
+   Each event prints one row: a map of the heap where '#' is a cell
+   that is fully allocated, '+' partly allocated and '.' free,
+   followed by the fragmentation of the free space seen so far.
+
+   Blocks allocated before the oldest record in the dump are unknown
+   to the replay, so dump early (or raise HEAP_TRACE_DEPTH) when the
+   startup allocations matter.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// sizeof(BlockLink_t) in heap_4 on a 32-bit target
+#define BLOCK_HEADER 8u
+#define MAX_BLOCKS 256u
+
+typedef struct {
+    uint32_t start;             // first byte of the heap_4 block
+    uint32_t size;              // block size, header included
+} Block;
+
+static Block gl_blocks[MAX_BLOCKS];
+static unsigned gl_nblocks = 0;
+
+static void add_block(uint32_t start, uint32_t size) {
+    if (gl_nblocks == MAX_BLOCKS) {
+        fprintf(stderr, "heap-map: more than %u live blocks\n", MAX_BLOCKS);
+        exit(1);
+    }
+    gl_blocks[gl_nblocks].start = start;
+    gl_blocks[gl_nblocks].size = size;
+    gl_nblocks++;
+}
+
+static void remove_block(uint32_t start) {
+    for (unsigned i = 0; i < gl_nblocks; ++i) {
+        if (gl_blocks[i].start == start) {
+            gl_blocks[i] = gl_blocks[--gl_nblocks];
+            return;
+        }
+    }
+    // allocated before the first record in the dump, nothing to undo
+}
+
+static int by_start(void const * a, void const * b) {
+    uint32_t x = ((Block const *)a)->start;
+    uint32_t y = ((Block const *)b)->start;
+    return (x > y) - (x < y);
+}
+
+/** Percentage of free bytes outside the largest free gap, the same
+    metric heap_fragmentation_pct() computes on the target. */
+static unsigned fragmentation(uint32_t base, uint32_t total) {
+    uint32_t free_bytes = 0, largest = 0, pos = base;
+
+    qsort(gl_blocks, gl_nblocks, sizeof gl_blocks[0], by_start);
+    for (unsigned i = 0; i <= gl_nblocks; ++i) {
+        uint32_t end = (i < gl_nblocks) ? gl_blocks[i].start : base + total;
+        if (end > pos) {
+            uint32_t gap = end - pos;
+            free_bytes += gap;
+            if (gap > largest)
+                largest = gap;
+        }
+        if (i < gl_nblocks && gl_blocks[i].start + gl_blocks[i].size > pos)
+            pos = gl_blocks[i].start + gl_blocks[i].size;
+    }
+    return free_bytes ? 100u - (unsigned)((uint64_t)largest * 100u / free_bytes)
+                      : 0u;
+}
+
+static void draw(uint32_t base, uint32_t total, unsigned columns) {
+    for (unsigned c = 0; c < columns; ++c) {
+        uint32_t lo = base + (uint32_t)((uint64_t)total * c / columns);
+        uint32_t hi = base + (uint32_t)((uint64_t)total * (c + 1) / columns);
+        uint32_t used = 0;
+
+        for (unsigned i = 0; i < gl_nblocks; ++i) {
+            uint32_t s = gl_blocks[i].start;
+            uint32_t e = s + gl_blocks[i].size;
+            if (s < lo) s = lo;
+            if (e > hi) e = hi;
+            if (e > s)
+                used += e - s;
+        }
+        putchar(used == 0 ? '.' : used >= hi - lo ? '#' : '+');
+    }
+}
+
+int main(int argc, char * argv[]) {
+    unsigned columns = 64;
+    uint32_t total = 0, base = 0;
+    char line[256];
+
+    if (argc == 3 && strcmp(argv[1], "-w") == 0) {
+        columns = (unsigned)atoi(argv[2]);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: heap-map [-w columns] < trace\n");
+        return 2;
+    }
+    if (columns == 0)
+        columns = 64;
+
+    while (fgets(line, sizeof line, stdin) != NULL) {
+        char kind;
+        unsigned tick, addr, size, caller, task;
+
+        if (sscanf(line, "heap-trace begin total=%u", &total) == 1) {
+            gl_nblocks = 0;
+            base = 0;
+            continue;
+        }
+        if (strncmp(line, "heap-trace end", 14) == 0) {
+            fputs(line, stdout);
+            continue;
+        }
+        if (sscanf(line, "%c %u %x %u %x %x", &kind, &tick, &addr, &size,
+                   &caller, &task) != 6 || total == 0)
+            continue;
+
+        // the lowest block seen so far is our best guess at ucHeap
+        uint32_t start = addr - BLOCK_HEADER;
+        if (kind != 'X' && (base == 0 || start < base))
+            base = start;
+
+        switch (kind) {
+        case 'M': add_block(start, size); break;
+        case 'F': remove_block(start); break;
+        case 'X': break;
+        default: continue;
+        }
+
+        printf("%8u %c %5u %08x ", tick, kind, size, caller);
+        draw(base, total, columns);
+        printf(" %3u%%\n", fragmentation(base, total));
+    }
+    return 0;
+}
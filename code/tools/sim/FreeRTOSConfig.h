@@ -0,0 +1,65 @@
+/** -*- c++ -*-
+   FreeRTOSConfig.h for the host simulation, see port.c
+
+   The kernel features match app/include/FreeRTOSConfig.h, so the
+   code under test is built as it is for the board; only the
+   hardware-specific settings differ.
+ */
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#define configUSE_PREEMPTION        1
+#define configUSE_IDLE_HOOK         1   /* moves simulated time, see port.c */
+#define configUSE_TICK_HOOK         0
+#define configCPU_CLOCK_HZ          ( ( unsigned long ) 72000000 )
+#define configTICK_RATE_HZ          ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES        ( 5 )
+#define configMINIMAL_STACK_SIZE    ( ( unsigned short ) 128 )
+#define configMAX_TASK_NAME_LEN     ( 16 )
+#define configUSE_TRACE_FACILITY    0
+#define configUSE_16_BIT_TICKS      0
+#define configIDLE_SHOULD_YIELD     1
+#define configLIBRARY_KERNEL_INTERRUPT_PRIORITY 15  /* for NVIC_SetPriority() in app code */
+
+#define configUSE_EVENT_LIST_BUCKETS 1
+#ifndef configEVENT_GROUP_WAITER_LISTS
+#define configEVENT_GROUP_WAITER_LISTS 8
+#endif
+#ifndef configUSE_QUEUE_WORD_COPY
+#define configUSE_QUEUE_WORD_COPY 1
+#endif
+#define configUSE_PRIORITY_QUEUES 1
+#define configUSE_MUTEXES 1
+#define configUSE_RWLOCKS 1
+#define configUSE_CONDVARS 1
+#define configUSE_BARRIERS 1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1
+#define configUSE_TASK_NOTIFICATIONS 1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 3
+#define configUSE_SB_COMPLETED_CALLBACK 1
+
+#define configTOTAL_HEAP_SIZE              ( ( size_t ) ( 256 * 1024 ) )
+#define configSUPPORT_STATIC_ALLOCATION    1
+#define configSUPPORT_DYNAMIC_ALLOCATION   1
+#define configUSE_MALLOC_FAILED_HOOK       0
+
+#define configUSE_CO_ROUTINES       0
+#define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
+#define configUSE_TIMERS            0
+
+void sim_assert_failed(char const * file, int line);
+#define configASSERT(x) if ( (x)==0 ) sim_assert_failed(__FILE__, __LINE__)
+
+#define INCLUDE_vTaskPrioritySet        1
+#define INCLUDE_uxTaskPriorityGet       1
+#define INCLUDE_vTaskDelete             1
+#define INCLUDE_vTaskCleanUpResources   0
+#define INCLUDE_vTaskSuspend            1
+#define INCLUDE_vTaskDelayUntil         1
+#define INCLUDE_vTaskDelay              1
+#define INCLUDE_xTaskGetSchedulerState  1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_xTaskAbortDelay         1
+#define INCLUDE_xSemaphoreGetMutexHolder 1
+
+#endif /* FREERTOS_CONFIG_H */
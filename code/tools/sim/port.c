@@ -0,0 +1,162 @@
+/**
+   port.c: FreeRTOS port for running tests on the Linux host
+
+   Each task is a ucontext with its own host stack; the stack the
+   kernel allocates for it holds nothing, and the TCB's stack pointer
+   points at the context instead.  A yield asks the kernel for the
+   next task and swaps to it directly.  There are no interrupts, so a
+   critical section is only a nesting count, and a yield requested
+   inside one is held until it ends, as PendSV would be on the board.
+
+   See sim.h for how tests use it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "sim.h"
+
+// host stack per task: generous, printf and the checks run on it
+#define SIM_STACK_BYTES (64u * 1024u)
+
+typedef struct {
+    ucontext_t context;
+    TaskFunction_t fn;
+    void * arg;
+} SimTask;
+
+static ucontext_t gl_main;                  // where sim_run() waits
+static UBaseType_t gl_nesting = 0;
+static BaseType_t gl_yield_pending = pdFALSE;
+static unsigned long gl_idle_ticks = 0;     // since a task last woke
+
+static SimTask * current(void) {
+    // pxTopOfStack is the TCB's first member
+    return *(SimTask **)xTaskGetCurrentTaskHandle();
+}
+
+static void task_entry(void) {
+    SimTask * t = current();
+
+    t->fn(t->arg);
+    fprintf(stderr, "sim: a task returned from its function\n");
+    exit(1);
+}
+
+StackType_t * pxPortInitialiseStack(StackType_t * pxTopOfStack,
+                                    TaskFunction_t pxCode,
+                                    void * pvParameters) {
+    SimTask * t = malloc(sizeof *t + SIM_STACK_BYTES);
+
+    (void) pxTopOfStack;
+    if (t == NULL) {
+        fprintf(stderr, "sim: out of host memory\n");
+        exit(1);
+    }
+    t->fn = pxCode;
+    t->arg = pvParameters;
+    getcontext(&t->context);
+    t->context.uc_stack.ss_sp = t + 1;
+    t->context.uc_stack.ss_size = SIM_STACK_BYTES;
+    t->context.uc_link = NULL;
+    makecontext(&t->context, task_entry, 0);
+    return (StackType_t *)t;
+}
+
+void vPortCleanUpContext(void * pvTopOfStack) {
+    free(pvTopOfStack);
+}
+
+static void switch_task(void) {
+    SimTask * from = current();
+
+    vTaskSwitchContext();
+    SimTask * to = current();
+    if (to != from)
+        swapcontext(&from->context, &to->context);
+}
+
+void vPortYield(void) {
+    if (gl_nesting != 0u)
+        gl_yield_pending = pdTRUE;
+    else
+        switch_task();
+}
+
+void vPortEnterCritical(void) {
+    gl_nesting++;
+}
+
+void vPortExitCritical(void) {
+    configASSERT(gl_nesting != 0u);
+    gl_nesting--;
+    if (gl_nesting == 0u && gl_yield_pending != pdFALSE) {
+        gl_yield_pending = pdFALSE;
+        switch_task();
+    }
+}
+
+BaseType_t xPortStartScheduler(void) {
+    gl_nesting = 0u;
+    swapcontext(&gl_main, &current()->context);
+    return pdFALSE;
+}
+
+void vPortEndScheduler(void) {
+    setcontext(&gl_main);
+}
+
+void sim_tick(TickType_t n) {
+    while (n-- != 0u) {
+        vPortEnterCritical();
+        if (xTaskIncrementTick() != pdFALSE) {
+            gl_idle_ticks = 0u;
+            gl_yield_pending = pdTRUE;
+        }
+        vPortExitCritical();
+    }
+}
+
+void vApplicationIdleHook(void) {
+    // every task is blocked: move time on to the next wakeup
+    if (++gl_idle_ticks > SIM_MAX_IDLE_TICKS) {
+        fprintf(stderr, "sim: no task woke in %u ticks\n",
+                SIM_MAX_IDLE_TICKS);
+        exit(1);
+    }
+    sim_tick(1u);
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t ** tcb, StackType_t ** stack,
+                                   uint32_t * stack_words) {
+    static StaticTask_t idle_tcb;
+    static StackType_t idle_stack[configMINIMAL_STACK_SIZE];
+
+    *tcb = &idle_tcb;
+    *stack = idle_stack;
+    *stack_words = configMINIMAL_STACK_SIZE;
+}
+
+void sim_assert_failed(char const * file, int line) {
+    fprintf(stderr, "%s:%d: configASSERT failed\n", file, line);
+    exit(1);
+}
+
+void sim_run(void) {
+    vTaskStartScheduler();
+}
+
+void sim_pass(void) {
+    vTaskEndScheduler();
+}
+
+uint64_t sim_host_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
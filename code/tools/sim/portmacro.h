@@ -0,0 +1,74 @@
+/** -*- c++ -*-
+   portmacro.h: FreeRTOS port for the host simulation, see port.c
+ */
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+
+#define portCHAR          char
+#define portFLOAT         float
+#define portDOUBLE        double
+#define portLONG          long
+#define portSHORT         short
+#define portSTACK_TYPE    uintptr_t
+#define portBASE_TYPE     long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+typedef uint32_t TickType_t;
+#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC 1
+
+#define portSTACK_GROWTH      ( -1 )
+#define portTICK_PERIOD_MS    ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT    8
+#define portPOINTER_SIZE_TYPE uintptr_t
+#define portDONT_DISCARD      __attribute__( ( used ) )
+#define portNOP()
+
+// there are no interrupts: tasks switch only where the kernel yields,
+// and time only moves in sim_tick()
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portSET_INTERRUPT_MASK_FROM_ISR()       0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )  ( void ) ( x )
+
+void vPortEnterCritical( void );
+void vPortExitCritical( void );
+void vPortYield( void );
+void vPortCleanUpContext( void * pvTopOfStack );
+
+#define portENTER_CRITICAL()    vPortEnterCritical()
+#define portEXIT_CRITICAL()     vPortExitCritical()
+
+// a yield inside a critical section waits for its end, like PendSV
+#define portYIELD()             vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired ) \
+    do { if( ( xSwitchRequired ) != pdFALSE ) vPortYield(); } while( 0 )
+#define portYIELD_FROM_ISR( x ) portEND_SWITCHING_ISR( x )
+
+// the task's context lives where the TCB's stack pointer points
+#define portCLEAN_UP_TCB( pxTCB ) vPortCleanUpContext( *( void ** ) ( pxTCB ) )
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) \
+    void vFunction( void * pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) \
+    void vFunction( void * pvParameters )
+
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) \
+    ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) \
+    ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) \
+    uxTopPriority = ( 31UL - ( uint32_t ) __builtin_clz( ( uint32_t ) ( uxReadyPriorities ) ) )
+#endif
+
+#endif // PORTMACRO_H
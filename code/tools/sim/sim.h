@@ -0,0 +1,83 @@
+/** -*- c++ -*-
+   sim.h: run kernel and app code on the Linux host, for tests
+
+   tools/sim/port.c is a FreeRTOS port whose tasks are ucontext
+   coroutines in one host thread.  Nothing is preemptive: a task runs
+   until the kernel blocks it or switches away from it, and time moves
+   only when a task calls sim_tick() or every task is blocked (the
+   idle task then ticks until one wakes).  A run is therefore exactly
+   repeatable, and a test can place a tick, and so a timeout, between
+   any two of its own steps.
+
+   A test program creates its tasks, or one task that creates the
+   rest, and calls sim_run(); the test task calls sim_pass() at the
+   end.  A failed CHECK or configASSERT ends the program with exit
+   status 1.
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+
+// idle ticks without any task waking before the run is declared hung
+#define SIM_MAX_IDLE_TICKS 1000000u
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                \
+                    __FILE__, __LINE__, #cond);                         \
+            exit(1);                                                    \
+        }                                                               \
+    } while (0)
+
+// advance the tick count by n, as n tick interrupts would
+void sim_tick(TickType_t n);
+
+// start the scheduler; returns once a task calls sim_pass()
+void sim_run(void);
+
+// end the run from a task
+void sim_pass(void);
+
+/** Host time in nanoseconds, for the benchmarks some tests print.
+    The figures only compare two ways of doing the same thing on the
+    host; they say nothing absolute about the board. */
+uint64_t sim_host_ns(void);
+
+// timings of one benchmark run
+typedef struct {
+    uint64_t total, worst;      // host ns
+    unsigned n;                 // operations timed
+} SimTiming;
+
+// count an operation that began at host time `start`
+static inline void sim_timed(SimTiming * t, uint64_t start) {
+    uint64_t ns = sim_host_ns() - start;
+
+    t->total += ns;
+    t->n++;
+    if (ns > t->worst)
+        t->worst = ns;
+}
+
+/** Keep the better of `best` and another run `r` in `best`, which
+    starts zeroed; repeated runs keep the host's own noise out. */
+static inline void sim_keep_best(SimTiming * best, SimTiming const * r) {
+    if (best->n == 0u || r->total < best->total) {
+        best->total = r->total;
+        best->n = r->n;
+    }
+    if (best->worst == 0u || r->worst < best->worst)
+        best->worst = r->worst;
+}
+
+static inline void sim_report(char const * what, SimTiming const * t) {
+    printf("  %-32s %8.1f ns avg %8lu ns worst\n", what,
+           t->n ? (double)t->total / t->n : 0.0, (unsigned long)t->worst);
+}
+
+#endif // SIM_H
@@ -0,0 +1,181 @@
+/** -*- c++ -*-
+   stm32f10x.h: the device header, as far as app code under test uses
+   it, for the host
+
+   The CMSIS intrinsics, and the registers of the peripherals that
+   app code drives, with the f103rb's layouts and addresses.  Nothing
+   on the host backs those addresses: a test that runs code touching
+   them first calls sim_map_device(), which maps plain memory at the
+   peripherals, at SRAM, at the NVIC and at the bit-band aliases of
+   SRAM and the peripherals (bitband.h).  Registers then read back
+   what was written to them; a test that needs more, such as a timer
+   counting, models it on that memory itself (test-led-pattern.c).
+ */
+#ifndef STM32F10X_H
+#define STM32F10X_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define __IO volatile
+#define __NVIC_PRIO_BITS 4
+
+typedef enum {
+    EXTI0_IRQn = 6, EXTI1_IRQn = 7, EXTI2_IRQn = 8, EXTI3_IRQn = 9,
+    EXTI4_IRQn = 10, DMA1_Channel1_IRQn = 11, DMA1_Channel2_IRQn = 12,
+    DMA1_Channel3_IRQn = 13, DMA1_Channel4_IRQn = 14,
+    DMA1_Channel5_IRQn = 15, DMA1_Channel6_IRQn = 16,
+    DMA1_Channel7_IRQn = 17, EXTI9_5_IRQn = 23, TIM2_IRQn = 28,
+    TIM3_IRQn = 29, TIM4_IRQn = 30, EXTI15_10_IRQn = 40,
+} IRQn_Type;
+
+typedef struct {
+    __IO uint32_t CRL, CRH, IDR, ODR, BSRR, BRR, LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t EVCR, MAPR, EXTICR[4];
+    uint32_t RESERVED0;
+    __IO uint32_t MAPR2;
+} AFIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t IMR, EMR, RTSR, FTSR, SWIER, PR;
+} EXTI_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR, CFGR, CIR, APB2RSTR, APB1RSTR, AHBENR, APB2ENR,
+                  APB1ENR, BDCR, CSR;
+} RCC_TypeDef;
+
+// 16-bit registers on 32-bit boundaries
+typedef struct {
+    __IO uint16_t CR1;   uint16_t RESERVED0;
+    __IO uint16_t CR2;   uint16_t RESERVED1;
+    __IO uint16_t SMCR;  uint16_t RESERVED2;
+    __IO uint16_t DIER;  uint16_t RESERVED3;
+    __IO uint16_t SR;    uint16_t RESERVED4;
+    __IO uint16_t EGR;   uint16_t RESERVED5;
+    __IO uint16_t CCMR1; uint16_t RESERVED6;
+    __IO uint16_t CCMR2; uint16_t RESERVED7;
+    __IO uint16_t CCER;  uint16_t RESERVED8;
+    __IO uint16_t CNT;   uint16_t RESERVED9;
+    __IO uint16_t PSC;   uint16_t RESERVED10;
+    __IO uint16_t ARR;   uint16_t RESERVED11;
+    __IO uint16_t RCR;   uint16_t RESERVED12;
+    __IO uint16_t CCR1;  uint16_t RESERVED13;
+    __IO uint16_t CCR2;  uint16_t RESERVED14;
+    __IO uint16_t CCR3;  uint16_t RESERVED15;
+    __IO uint16_t CCR4;  uint16_t RESERVED16;
+    __IO uint16_t BDTR;  uint16_t RESERVED17;
+    __IO uint16_t DCR;   uint16_t RESERVED18;
+    __IO uint16_t DMAR;  uint16_t RESERVED19;
+} TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t CCR, CNDTR, CPAR, CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    __IO uint32_t ISR, IFCR;
+} DMA_TypeDef;
+
+typedef struct {
+    __IO uint32_t ISER[8]; uint32_t RESERVED0[24];
+    __IO uint32_t ICER[8]; uint32_t RESERVED1[24];
+    __IO uint32_t ISPR[8]; uint32_t RESERVED2[24];
+    __IO uint32_t ICPR[8]; uint32_t RESERVED3[24];
+    __IO uint32_t IABR[8]; uint32_t RESERVED4[56];
+    __IO uint8_t IP[240];
+} NVIC_Type;
+
+#define SRAM_BASE           0x20000000u
+#define SRAM_SIZE           0x00005000u     // 20 KB
+#define PERIPH_BASE         0x40000000u
+#define PERIPH_SIZE         0x00022000u     // up to the end of RCC
+#define APB1PERIPH_BASE     PERIPH_BASE
+#define APB2PERIPH_BASE     (PERIPH_BASE + 0x10000u)
+#define AHBPERIPH_BASE      (PERIPH_BASE + 0x20000u)
+#define SCS_BASE            0xE000E000u
+#define NVIC_BASE           (SCS_BASE + 0x0100u)
+
+#define TIM2_BASE           (APB1PERIPH_BASE + 0x0000u)
+#define TIM3_BASE           (APB1PERIPH_BASE + 0x0400u)
+#define TIM4_BASE           (APB1PERIPH_BASE + 0x0800u)
+#define AFIO_BASE           (APB2PERIPH_BASE + 0x0000u)
+#define EXTI_BASE           (APB2PERIPH_BASE + 0x0400u)
+#define GPIOA_BASE          (APB2PERIPH_BASE + 0x0800u)
+#define GPIOB_BASE          (APB2PERIPH_BASE + 0x0C00u)
+#define GPIOC_BASE          (APB2PERIPH_BASE + 0x1000u)
+#define GPIOD_BASE          (APB2PERIPH_BASE + 0x1400u)
+#define DMA1_BASE           (AHBPERIPH_BASE + 0x0000u)
+#define DMA1_Channel1_BASE  (AHBPERIPH_BASE + 0x0008u)
+#define DMA1_Channel2_BASE  (AHBPERIPH_BASE + 0x001Cu)
+#define DMA1_Channel3_BASE  (AHBPERIPH_BASE + 0x0030u)
+#define DMA1_Channel4_BASE  (AHBPERIPH_BASE + 0x0044u)
+#define DMA1_Channel5_BASE  (AHBPERIPH_BASE + 0x0058u)
+#define DMA1_Channel6_BASE  (AHBPERIPH_BASE + 0x006Cu)
+#define DMA1_Channel7_BASE  (AHBPERIPH_BASE + 0x0080u)
+#define RCC_BASE            (AHBPERIPH_BASE + 0x1000u)
+
+#define TIM2            ((TIM_TypeDef *) (uintptr_t) TIM2_BASE)
+#define TIM3            ((TIM_TypeDef *) (uintptr_t) TIM3_BASE)
+#define TIM4            ((TIM_TypeDef *) (uintptr_t) TIM4_BASE)
+#define AFIO            ((AFIO_TypeDef *) (uintptr_t) AFIO_BASE)
+#define EXTI            ((EXTI_TypeDef *) (uintptr_t) EXTI_BASE)
+#define GPIOA           ((GPIO_TypeDef *) (uintptr_t) GPIOA_BASE)
+#define GPIOB           ((GPIO_TypeDef *) (uintptr_t) GPIOB_BASE)
+#define GPIOC           ((GPIO_TypeDef *) (uintptr_t) GPIOC_BASE)
+#define GPIOD           ((GPIO_TypeDef *) (uintptr_t) GPIOD_BASE)
+#define DMA1            ((DMA_TypeDef *) (uintptr_t) DMA1_BASE)
+#define DMA1_Channel1   ((DMA_Channel_TypeDef *) (uintptr_t) DMA1_Channel1_BASE)
+#define DMA1_Channel2   ((DMA_Channel_TypeDef *) (uintptr_t) DMA1_Channel2_BASE)
+#define DMA1_Channel3   ((DMA_Channel_TypeDef *) (uintptr_t) DMA1_Channel3_BASE)
+#define DMA1_Channel4   ((DMA_Channel_TypeDef *) (uintptr_t) DMA1_Channel4_BASE)
+#define DMA1_Channel5   ((DMA_Channel_TypeDef *) (uintptr_t) DMA1_Channel5_BASE)
+#define DMA1_Channel6   ((DMA_Channel_TypeDef *) (uintptr_t) DMA1_Channel6_BASE)
+#define DMA1_Channel7   ((DMA_Channel_TypeDef *) (uintptr_t) DMA1_Channel7_BASE)
+#define RCC             ((RCC_TypeDef *) (uintptr_t) RCC_BASE)
+#define NVIC            ((NVIC_Type *) (uintptr_t) NVIC_BASE)
+
+// as CMSIS's, for device interrupts (IRQn >= 0)
+static inline void NVIC_EnableIRQ(IRQn_Type irq) {
+    NVIC->ISER[(uint32_t)irq >> 5] = 1u << ((uint32_t)irq & 0x1fu);
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type irq) {
+    NVIC->ICER[(uint32_t)irq >> 5] = 1u << ((uint32_t)irq & 0x1fu);
+}
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    NVIC->IP[(uint32_t)irq] = (uint8_t)(priority << (8 - __NVIC_PRIO_BITS));
+}
+
+// count leading zeros; the app never passes 0
+static inline uint32_t __CLZ(uint32_t x) {
+    return (uint32_t)__builtin_clz(x);
+}
+
+static inline void sim_map_region(uintptr_t base, size_t size) {
+    void * p = mmap((void *)base, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (p != (void *)base) {
+        fprintf(stderr, "sim: cannot map %#lx for the device\n",
+                (unsigned long)base);
+        exit(1);
+    }
+}
+
+// zeroed memory at the addresses above, as after reset
+static inline void sim_map_device(void) {
+    sim_map_region(SRAM_BASE, SRAM_SIZE);
+    sim_map_region(SRAM_BASE + 0x02000000u, (size_t)SRAM_SIZE << 5);
+    sim_map_region(PERIPH_BASE, PERIPH_SIZE);
+    sim_map_region(PERIPH_BASE + 0x02000000u, (size_t)PERIPH_SIZE << 5);
+    sim_map_region(SCS_BASE, 0x1000u);
+}
+
+#endif // STM32F10X_H
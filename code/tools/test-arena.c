@@ -0,0 +1,230 @@
+/**
+   test-arena: per-task bump arenas (app/arena.c) on the host
+   simulation (tools/sim)
+
+       make check
+
+   Checks alignment, the per-cycle budget and its overflow hook, reset
+   and detach, then prints a benchmark: a cycle of scratch allocations
+   from an arena and reset, against the same allocations from
+   pvPortMalloc (heap_4) and freed, on an empty and on a fragmented
+   heap.  The figures are host nanoseconds per allocation, average and
+   worst, each the best of three runs, and only compare the two.
+ */
+
+#include "sim.h"
+#include "task.h"
+#include "arena.h"
+
+enum { CONTROL = 4, OTHER = 3 };
+
+static Arena * self(void) {
+    return pvTaskGetThreadLocalStoragePointer(NULL, ARENA_TLS_INDEX);
+}
+
+static size_t rounded(size_t n) {
+    return (n + ARENA_ALIGNMENT - 1u) & ~(size_t)(ARENA_ALIGNMENT - 1u);
+}
+
+static Arena * gl_hooked;
+static size_t gl_wanted;
+static unsigned gl_overflows;
+static bool gl_reset_in_hook;
+
+static void overflow(Arena * a, size_t wanted) {
+    gl_hooked = a;
+    gl_wanted = wanted;
+    gl_overflows++;
+    if (gl_reset_in_hook)
+        arena_reset();
+}
+
+static void alignment_and_budget(void) {
+    size_t free_before = xPortGetFreeHeapSize();
+
+    CHECK(arena_attach(NULL, 256, 96, overflow));
+    Arena * a = self();
+    CHECK(a != NULL && a->budget == 96u);
+
+    uint8_t * p = arena_alloc(1);
+    uint8_t * q = arena_alloc(13);
+    CHECK(p == a->base);
+    CHECK(q == p + rounded(1));
+    CHECK((uintptr_t)q % ARENA_ALIGNMENT == 0u);
+    CHECK(a->used == rounded(1) + rounded(13));
+
+    // fill the budget exactly, then go one byte over it
+    gl_overflows = 0u;
+    CHECK(arena_alloc(96u - a->used) != NULL);
+    CHECK(a->used == 96u);
+    size_t used = a->used;
+    CHECK(arena_alloc(1) == NULL);
+    CHECK(gl_overflows == 1u && gl_hooked == a);
+    CHECK(gl_wanted == rounded(1) && a->used == used);
+
+    // the region beyond the budget is never handed out
+    CHECK(arena_alloc(200) == NULL && gl_wanted == 200u);
+    CHECK(gl_overflows == 2u && a->peak == used);
+
+    // reset: everything goes, the peak stays
+    arena_reset();
+    CHECK(a->used == 0u && a->peak == used);
+    CHECK(arena_alloc(1) == p);
+
+    // a hook may reset the arena; the failing call still fails, but
+    // the next one succeeds from the start of the region
+    gl_reset_in_hook = true;
+    CHECK(arena_alloc(200) == NULL);
+    gl_reset_in_hook = false;
+    CHECK(a->used == 0u);
+    CHECK(arena_alloc(8) == p);
+
+    arena_detach(NULL);
+    CHECK(self() == NULL);
+    CHECK(xPortGetFreeHeapSize() == free_before);
+
+    // no budget means the whole region, as does one above it
+    CHECK(arena_attach(NULL, 64, 0, NULL));
+    CHECK(self()->budget == 64u);
+    CHECK(arena_alloc(64) != NULL && arena_alloc(1) == NULL);
+    arena_detach(NULL);
+    CHECK(arena_attach(NULL, 64, 1000, NULL));
+    CHECK(self()->budget == 64u);
+    arena_detach(NULL);
+
+    // too big for the heap
+    CHECK(!arena_attach(NULL, configTOTAL_HEAP_SIZE, 0, NULL));
+    CHECK(self() == NULL);
+}
+
+// an arena attached by another task, before this one runs
+static volatile bool gl_other_done;
+
+static void other(void * arg) {
+    (void) arg;
+    uint32_t * p = arena_alloc(sizeof *p * 4u);
+
+    CHECK(p != NULL && p == (uint32_t *)self()->base);
+    CHECK(self()->used == rounded(sizeof *p * 4u));
+    gl_other_done = true;
+    vTaskSuspend(NULL);
+}
+
+static void attached_by_creator(void) {
+    TaskHandle_t h;
+
+    CHECK(xTaskCreate(other, "other", configMINIMAL_STACK_SIZE, NULL,
+                      OTHER, &h) == pdPASS);
+    vTaskSuspend(h);
+    CHECK(arena_attach(h, 128, 0, NULL));
+    CHECK(self() == NULL);
+    vTaskResume(h);
+    vTaskDelay(1);
+    CHECK(gl_other_done);
+    arena_detach(h);
+    vTaskDelete(h);
+}
+
+// benchmark
+
+#define CYCLES 200u
+#define PER_CYCLE 32u
+
+static uint32_t gl_random = 1u;
+
+static size_t random_size(void) {
+    gl_random = gl_random * 1103515245u + 12345u;
+    return 8u + (gl_random >> 16) % 249u;          // 8..256 bytes
+}
+
+static void bench_heap(SimTiming * t) {
+    void * block[PER_CYCLE];
+
+    gl_random = 1u;
+    for (unsigned c = 0; c < CYCLES; ++c) {
+        for (unsigned i = 0; i < PER_CYCLE; ++i) {
+            size_t n = random_size();
+            uint64_t start = sim_host_ns();
+            block[i] = pvPortMalloc(n);
+            sim_timed(t, start);
+            CHECK(block[i] != NULL);
+        }
+        for (unsigned i = 0; i < PER_CYCLE; ++i)
+            vPortFree(block[i]);
+    }
+}
+
+static void bench_arena(SimTiming * t) {
+    gl_random = 1u;
+    CHECK(arena_attach(NULL, PER_CYCLE * 256u, 0, NULL));
+    for (unsigned c = 0; c < CYCLES; ++c) {
+        for (unsigned i = 0; i < PER_CYCLE; ++i) {
+            size_t n = random_size();
+            uint64_t start = sim_host_ns();
+            void * p = arena_alloc(n);
+            sim_timed(t, start);
+            CHECK(p != NULL);
+        }
+        arena_reset();
+    }
+    arena_detach(NULL);
+}
+
+// what the timing itself costs, to read the others against
+static void bench_nothing(SimTiming * t) {
+    for (unsigned i = 0; i < CYCLES * PER_CYCLE; ++i)
+        sim_timed(t, sim_host_ns());
+}
+
+// the best of three runs
+static void best_of_3(SimTiming * t, void (*run)(SimTiming *)) {
+    for (unsigned i = 0; i < 3u; ++i) {
+        SimTiming r = { 0 };
+
+        run(&r);
+        sim_keep_best(t, &r);
+    }
+}
+
+static void benchmark(void) {
+    SimTiming nothing = { 0 }, heap = { 0 }, arena = { 0 };
+    SimTiming fragmented = { 0 };
+    void * live[64];
+
+    best_of_3(&nothing, bench_nothing);
+    best_of_3(&heap, bench_heap);
+    best_of_3(&arena, bench_arena);
+
+    // leave every other block of 64 allocated, so heap_4's free list
+    // has 32 holes to walk
+    for (unsigned i = 0; i < 64u; ++i)
+        live[i] = pvPortMalloc(24u + 8u * (i % 5u));
+    for (unsigned i = 0; i < 64u; i += 2u)
+        vPortFree(live[i]);
+    best_of_3(&fragmented, bench_heap);
+    for (unsigned i = 1; i < 64u; i += 2u)
+        vPortFree(live[i]);
+
+    printf("test-arena: %u cycles of %u allocations of 8..256 bytes\n",
+           CYCLES, PER_CYCLE);
+    sim_report("timing alone", &nothing);
+    sim_report("pvPortMalloc", &heap);
+    sim_report("pvPortMalloc, 32 holes", &fragmented);
+    sim_report("arena_alloc", &arena);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    alignment_and_budget();
+    attached_by_creator();
+    benchmark();
+    printf("test-arena: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
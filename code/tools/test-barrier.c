@@ -0,0 +1,190 @@
+/**
+   test-barrier: cyclic barriers (FreeRTOS-Kernel/barrier.c) on the
+   host simulation (tools/sim)
+
+       make check
+
+   An arrival that times out must be withdrawn, unless the barrier
+   opened before the task ran again.  The stress test runs tasks of
+   mixed priorities through many generations, with random block
+   times, yields and ticks, and checks no task passes a generation
+   before every task has arrived at it.
+ */
+
+#include "sim.h"
+#include "task.h"
+#include "barrier.h"
+
+enum { CONTROL = 4, HIGH = 3, MID = 2, LOW = 1 };
+
+static BarrierHandle_t gl_barrier;
+
+typedef struct {
+    TickType_t wait;
+    BaseType_t got;
+} Party;
+
+static void party(void * arg) {
+    Party * p = arg;
+
+    p->got = xBarrierWait(gl_barrier, p->wait);
+    vTaskDelete(NULL);
+}
+
+static void start(Party * p, TickType_t wait, UBaseType_t priority) {
+    p->wait = wait;
+    p->got = -1;
+    CHECK(xTaskCreate(party, "party", configMINIMAL_STACK_SIZE, p,
+                      priority, NULL) == pdPASS);
+}
+
+static void opens_on_last_arrival(void) {
+    Party a, b;
+
+    gl_barrier = xBarrierCreate(3);
+    CHECK(gl_barrier != NULL);
+    start(&a, portMAX_DELAY, LOW);
+    start(&b, portMAX_DELAY, HIGH);
+    vTaskDelay(1);
+    CHECK(a.got == -1 && b.got == -1);
+    CHECK(uxBarrierGetGeneration(gl_barrier) == 0u);
+
+    CHECK(xBarrierWait(gl_barrier, 0) == pdTRUE);
+    CHECK(uxBarrierGetGeneration(gl_barrier) == 1u);
+    vTaskDelay(1);
+    CHECK(a.got == pdTRUE && b.got == pdTRUE);
+    vBarrierDelete(gl_barrier);
+}
+
+static void timeout_withdraws_arrival(void) {
+    Party a, b;
+
+    gl_barrier = xBarrierCreate(2);
+    CHECK(gl_barrier != NULL);
+
+    // not waiting does not count as an arrival either
+    CHECK(xBarrierWait(gl_barrier, 0) == pdFALSE);
+
+    start(&a, 5, MID);
+    vTaskDelay(10);
+    CHECK(a.got == pdFALSE);
+    CHECK(uxBarrierGetGeneration(gl_barrier) == 0u);
+
+    // were either arrival still counted, one party would open it
+    start(&a, portMAX_DELAY, MID);
+    vTaskDelay(1);
+    CHECK(a.got == -1);
+    start(&b, portMAX_DELAY, LOW);
+    vTaskDelay(1);
+    CHECK(a.got == pdTRUE && b.got == pdTRUE);
+    CHECK(uxBarrierGetGeneration(gl_barrier) == 1u);
+    vBarrierDelete(gl_barrier);
+}
+
+// the waiter's block time ends on the tick the last party arrives,
+// and the last party runs first
+static void opens_as_block_time_ends(void) {
+    Party a;
+
+    gl_barrier = xBarrierCreate(2);
+    CHECK(gl_barrier != NULL);
+    start(&a, 5, LOW);
+    vTaskDelay(1);
+    vTaskDelay(4);
+    CHECK(a.got == -1);
+    CHECK(xBarrierWait(gl_barrier, 0) == pdTRUE);
+    vTaskDelay(1);
+    CHECK(a.got == pdTRUE);
+    CHECK(uxBarrierGetGeneration(gl_barrier) == 1u);
+
+    // and the barrier is left empty for the next generation
+    start(&a, 5, LOW);
+    vTaskDelay(10);
+    CHECK(a.got == pdFALSE);
+    vBarrierDelete(gl_barrier);
+}
+
+// stress
+
+#define PARTIES 5u
+#define ROUNDS 300u
+
+static unsigned gl_at[PARTIES];         // generation each has reached
+static unsigned gl_finished;
+static BaseType_t gl_timeouts;          // use random block times
+static uint32_t gl_random;
+
+static unsigned random_below(unsigned n) {
+    gl_random = gl_random * 1103515245u + 12345u;
+    return (gl_random >> 16) % n;
+}
+
+static void pause(void) {
+    switch (random_below(5)) {
+    case 0: taskYIELD(); break;
+    case 1: vTaskDelay(1 + random_below(3)); break;
+    case 2: sim_tick(1); break;
+    default: break;
+    }
+}
+
+static void stage(void * arg) {
+    unsigned me = (unsigned)(uintptr_t)arg;
+
+    for (unsigned round = 1; round <= ROUNDS; ++round) {
+        pause();
+        gl_at[me] = round;
+        if (gl_timeouts) {
+            while (xBarrierWait(gl_barrier, 1 + random_below(4)) == pdFALSE)
+                pause();
+        } else {
+            CHECK(xBarrierWait(gl_barrier, portMAX_DELAY) == pdTRUE);
+        }
+        for (unsigned j = 0; j < PARTIES; ++j)
+            CHECK(gl_at[j] >= round);
+    }
+    gl_finished++;
+    vTaskDelete(NULL);
+}
+
+static void generations(BaseType_t timeouts, uint32_t seed) {
+    static UBaseType_t const priority[PARTIES] = { LOW, HIGH, MID, LOW, HIGH };
+
+    gl_barrier = xBarrierCreate(PARTIES);
+    CHECK(gl_barrier != NULL);
+    gl_timeouts = timeouts;
+    gl_random = seed;
+    gl_finished = 0u;
+    for (unsigned i = 0; i < PARTIES; ++i)
+        gl_at[i] = 0u;
+
+    for (uintptr_t i = 0; i < PARTIES; ++i)
+        CHECK(xTaskCreate(stage, "stage", configMINIMAL_STACK_SIZE,
+                          (void *)i, priority[i], NULL) == pdPASS);
+    while (gl_finished < PARTIES)
+        vTaskDelay(100);
+
+    CHECK(uxBarrierGetGeneration(gl_barrier) == ROUNDS);
+    vBarrierDelete(gl_barrier);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    opens_on_last_arrival();
+    timeout_withdraws_arrival();
+    opens_as_block_time_ends();
+    for (uint32_t seed = 1u; seed <= 4u; ++seed) {
+        generations(pdFALSE, seed);
+        generations(pdTRUE, seed);
+    }
+
+    printf("test-barrier: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
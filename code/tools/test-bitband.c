@@ -0,0 +1,81 @@
+/**
+   test-bitband: bit-band alias addresses (app/bitband.h) on the host
+
+       make check
+
+   The expected aliases are the worked examples of RM0008 (section
+   2.3.2) and of the Cortex-M3 programming manual, plus the registers
+   the app sets bits in.  Only the address arithmetic is checked: the
+   aliases do not exist on the host.
+ */
+
+#include "sim.h"
+#include "bitband.h"
+
+// with constant arguments the alias is a constant expression
+_Static_assert(BITBAND_ALIAS_ADDR(0x20000300u, 2) == 0x22006008u,
+               "BITBAND_ALIAS_ADDR does not fold to a constant");
+
+static void check_alias(uintptr_t addr, unsigned bit, uintptr_t alias) {
+    if (BITBAND_ALIAS_ADDR(addr, bit) != alias) {
+        fprintf(stderr, "alias of %#lx bit %u: %#lx, expected %#lx\n",
+                (unsigned long)addr, bit,
+                (unsigned long)BITBAND_ALIAS_ADDR(addr, bit),
+                (unsigned long)alias);
+        exit(1);
+    }
+}
+
+static void manual_examples(void) {
+    // RM0008: bit 2 of the byte at 0x20000300
+    check_alias(0x20000300u, 2, 0x22006008u);
+
+    // programming manual: both ends of the SRAM region
+    check_alias(0x20000000u, 0, 0x22000000u);
+    check_alias(0x20000000u, 7, 0x2200001Cu);
+    check_alias(0x200FFFFFu, 0, 0x23FFFFE0u);
+    check_alias(0x200FFFFFu, 7, 0x23FFFFFCu);
+
+    // and of the peripheral region
+    check_alias(0x40000000u, 0, 0x42000000u);
+    check_alias(0x400FFFFFu, 7, 0x43FFFFFCu);
+}
+
+static void app_registers(void) {
+    check_alias(0x40021018u, 2, 0x42420308u);   // RCC_APB2ENR IOPAEN
+    check_alias(0x40021014u, 0, 0x42420280u);   // RCC_AHBENR DMA1EN
+    check_alias(0x40010004u, 9, 0x422000A4u);   // AFIO_MAPR TIM2_REMAP[1]
+    check_alias(0x40010400u, 13, 0x42208034u);  // EXTI_IMR 13
+}
+
+// bit n of a word is bit n % 8 of its byte n / 8
+static void word_bits_are_byte_bits(void) {
+    for (uintptr_t word = 0x20000000u; word < 0x20005000u; word += 0x124u)
+        for (unsigned bit = 0; bit < 32u; ++bit) {
+            check_alias(word, bit,
+                        BITBAND_ALIAS_ADDR(word + bit / 8u, bit % 8u));
+            CHECK(BITBAND_ALIAS_ADDR(word, bit) % 4u == 0u);
+        }
+}
+
+static void regions(void) {
+    CHECK(bitband_in_region((void *)0x20000000u));
+    CHECK(bitband_in_region((void *)0x200FFFFFu));
+    CHECK(bitband_in_region((void *)0x40000000u));
+    CHECK(bitband_in_region((void *)0x400FFFFFu));
+    CHECK(!bitband_in_region((void *)0x1FFFFFFFu));
+    CHECK(!bitband_in_region((void *)0x20100000u));
+    CHECK(!bitband_in_region((void *)0x22000000u));    // an alias itself
+    CHECK(!bitband_in_region((void *)0x3FFFFFFFu));
+    CHECK(!bitband_in_region((void *)0x40100000u));
+    CHECK(!bitband_in_region((void *)0xE000E100u));    // NVIC
+}
+
+int main(void) {
+    manual_examples();
+    app_registers();
+    word_bits_are_byte_bits();
+    regions();
+    printf("test-bitband: ok\n");
+    return 0;
+}
@@ -0,0 +1,318 @@
+/**
+   test-coexec: how the coroutine executor (app/coexec.c) decides what
+   runs and how long it may sleep, on the host
+
+       make check
+
+   The executor's step() is driven directly, with the tick count, the
+   queues and the task notifications it uses stubbed out below, so
+   each test sets the time and checks what resumed and the sleep
+   step() asked for.  No kernel is linked.
+ */
+
+#include "sim.h"
+#include "coexec.c"
+
+// stubs
+
+static TickType_t gl_now;
+static unsigned gl_nesting;
+
+TickType_t xTaskGetTickCount(void) {
+    return gl_now;
+}
+
+void vPortEnterCritical(void) {
+    gl_nesting++;
+}
+
+void vPortExitCritical(void) {
+    CHECK(gl_nesting != 0u);
+    gl_nesting--;
+}
+
+// a queue of up to 8 uint32_t items; a QueueHandle_t points at one
+typedef struct {
+    uint32_t item[8];
+    unsigned count;
+} FakeQueue;
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void * const pvBuffer,
+                         TickType_t xTicksToWait) {
+    FakeQueue * q = (FakeQueue *)(void *)xQueue;
+
+    CHECK(xTicksToWait == 0u);          // the executor must not block
+    if (q->count == 0u)
+        return pdFALSE;
+    memcpy(pvBuffer, &q->item[0], sizeof q->item[0]);
+    memmove(&q->item[0], &q->item[1], --q->count * sizeof q->item[0]);
+    return pdTRUE;
+}
+
+BaseType_t xTaskGenericNotify(TaskHandle_t xTaskToNotify,
+                              UBaseType_t uxIndexToNotify, uint32_t ulValue,
+                              eNotifyAction eAction,
+                              uint32_t * pulPreviousNotificationValue) {
+    return pdPASS;
+}
+
+BaseType_t xTaskGenericNotifyFromISR(TaskHandle_t xTaskToNotify,
+                                     UBaseType_t uxIndexToNotify,
+                                     uint32_t ulValue, eNotifyAction eAction,
+                                     uint32_t * pulPreviousNotificationValue,
+                                     BaseType_t * pxHigherPriorityTaskWoken) {
+    return pdPASS;
+}
+
+BaseType_t xTaskGenericNotifyWait(UBaseType_t uxIndexToWaitOn,
+                                  uint32_t ulBitsToClearOnEntry,
+                                  uint32_t ulBitsToClearOnExit,
+                                  uint32_t * pulNotificationValue,
+                                  TickType_t xTicksToWait) {
+    CHECK(0);
+    return pdFALSE;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char * const pcName,
+                       const configSTACK_DEPTH_TYPE usStackDepth,
+                       void * const pvParameters, UBaseType_t uxPriority,
+                       TaskHandle_t * const pxCreatedTask) {
+    CHECK(0);
+    return pdFAIL;
+}
+
+void sim_assert_failed(char const * file, int line) {
+    fprintf(stderr, "%s:%d: configASSERT failed\n", file, line);
+    exit(1);
+}
+
+// coroutines under test
+
+static CoExec gl_ex;
+
+typedef struct {
+    TickType_t ticks;
+    unsigned resumed;           // times run past an await
+    bool ok;                    // co->ok after the last await
+    uint32_t got;               // item or notification bits
+} Probe;
+
+static void delayer(Co * co) {
+    Probe * p = co->arg;
+    CO_BEGIN(co);
+    for (;;) {
+        CO_AWAIT_DELAY(co, p->ticks);
+        p->resumed++;
+    }
+    CO_END(co);
+}
+
+static void yielder(Co * co) {
+    Probe * p = co->arg;
+    CO_BEGIN(co);
+    for (;;) {
+        CO_YIELD(co);
+        p->resumed++;
+    }
+    CO_END(co);
+}
+
+static FakeQueue gl_queue;
+
+static void receiver(Co * co) {
+    Probe * p = co->arg;
+    CO_BEGIN(co);
+    for (;;) {
+        CO_AWAIT_QUEUE(co, (QueueHandle_t)(void *)&gl_queue, &p->got, p->ticks);
+        p->ok = co->ok;
+        p->resumed++;
+    }
+    CO_END(co);
+}
+
+static void listener(Co * co) {
+    Probe * p = co->arg;
+    CO_BEGIN(co);
+    for (;;) {
+        CO_AWAIT_NOTIFY(co, 0x3u, p->ticks);
+        p->ok = co->ok;
+        p->got = co->bits;
+        p->resumed++;
+    }
+    CO_END(co);
+}
+
+// finishes after `ticks`
+static void once(Co * co) {
+    Probe * p = co->arg;
+    CO_BEGIN(co);
+    CO_AWAIT_DELAY(co, p->ticks);
+    p->resumed++;
+    CO_END(co);
+}
+
+static void spawn(CoFn fn, Probe * p, TickType_t ticks) {
+    p->ticks = ticks;
+    p->resumed = 0u;
+    p->ok = false;
+    p->got = 0u;
+    CHECK(co_spawn(&gl_ex, fn, p, 0) != NULL);
+}
+
+// drop every coroutine, between tests
+static void reset(TickType_t now) {
+    while (gl_ex.running != NULL) {
+        Co * co = gl_ex.running;
+        gl_ex.running = co->next;
+        give(co);
+    }
+    CHECK(co_pool_used() == 0u && gl_nesting == 0u);
+    gl_ex.pending = 0u;
+    gl_queue.count = 0u;
+    gl_now = now;
+}
+
+static void delays(TickType_t start) {
+    Probe a, b;
+
+    reset(start);
+    spawn(delayer, &a, 10);
+    spawn(delayer, &b, 4);
+    adopt(&gl_ex);
+
+    // the first pass runs both up to their awaits
+    CHECK(step(&gl_ex) == 4u);
+    CHECK(a.resumed == 0u && b.resumed == 0u);
+
+    gl_now = start + 3u;
+    CHECK(step(&gl_ex) == 1u);
+    gl_now = start + 4u;
+    CHECK(step(&gl_ex) == 4u);
+    CHECK(a.resumed == 0u && b.resumed == 1u);
+
+    // a late pass resumes a coroutine once, however late it is
+    gl_now = start + 25u;
+    CHECK(step(&gl_ex) == 4u);
+    CHECK(a.resumed == 1u && b.resumed == 2u);
+}
+
+static void yields(void) {
+    Probe a, b;
+
+    reset(0);
+    spawn(yielder, &a, 0);
+    spawn(delayer, &b, 7);
+    adopt(&gl_ex);
+    for (unsigned i = 1; i <= 3; ++i) {
+        CHECK(step(&gl_ex) == 0u);
+        CHECK(a.resumed == i - 1u);
+    }
+    CHECK(b.resumed == 0u);
+}
+
+static void queues(void) {
+    Probe a;
+
+    reset(100);
+    spawn(receiver, &a, 5);
+    adopt(&gl_ex);
+
+    // waiting on a queue, the executor polls
+    CHECK(step(&gl_ex) == CO_QUEUE_POLL_TICKS);
+    gl_now = 102;
+    CHECK(step(&gl_ex) == CO_QUEUE_POLL_TICKS);
+    CHECK(a.resumed == 0u);
+
+    gl_queue.item[0] = 42u;
+    gl_queue.count = 1u;
+    gl_now = 103;
+    (void) step(&gl_ex);
+    CHECK(a.resumed == 1u && a.ok && a.got == 42u && gl_queue.count == 0u);
+
+    // the next await times out 5 ticks after it began
+    gl_now = 107;
+    (void) step(&gl_ex);
+    CHECK(a.resumed == 1u);
+    gl_now = 108;
+    (void) step(&gl_ex);
+    CHECK(a.resumed == 2u && !a.ok);
+
+    // only a queue wait is polled: without a timeout the rest sleep
+    reset(0);
+    spawn(delayer, &a, portMAX_DELAY);
+    adopt(&gl_ex);
+    CHECK(step(&gl_ex) == portMAX_DELAY);
+}
+
+static void notifications(void) {
+    Probe a;
+
+    reset(0);
+    spawn(listener, &a, portMAX_DELAY);
+    adopt(&gl_ex);
+    CHECK(step(&gl_ex) == portMAX_DELAY);
+
+    // bits outside the mask neither wake nor are consumed
+    gl_ex.pending = 0x4u;
+    CHECK(step(&gl_ex) == portMAX_DELAY);
+    CHECK(a.resumed == 0u && gl_ex.pending == 0x4u);
+
+    gl_ex.pending = 0x6u;
+    (void) step(&gl_ex);
+    CHECK(a.resumed == 1u && a.ok && a.got == 0x2u);
+    CHECK(gl_ex.pending == 0x4u);
+
+    reset(0);
+    spawn(listener, &a, 3);
+    adopt(&gl_ex);
+    CHECK(step(&gl_ex) == 3u);
+    gl_now = 3;
+    (void) step(&gl_ex);
+    CHECK(a.resumed == 1u && !a.ok && a.got == 0u);
+}
+
+// a finished coroutine leaves the list wherever it is, and its frame
+// goes back to the pool
+static void finishing(void) {
+    Probe p[3];
+
+    reset(0);
+    spawn(delayer, &p[0], 9);
+    spawn(once, &p[1], 2);
+    spawn(delayer, &p[2], 5);
+    adopt(&gl_ex);
+    CHECK(co_pool_used() == 3u);
+    CHECK(step(&gl_ex) == 2u);
+
+    gl_now = 2;
+    CHECK(step(&gl_ex) == 3u);
+    CHECK(p[1].resumed == 1u && co_pool_used() == 2u);
+
+    gl_now = 5;
+    CHECK(step(&gl_ex) == 4u);
+    gl_now = 9;
+    CHECK(step(&gl_ex) == 1u);
+    CHECK(p[0].resumed == 1u && p[2].resumed == 1u);
+
+    // the pool runs dry, and refills
+    reset(0);
+    Probe q[CO_POOL_SIZE];
+    for (unsigned i = 0; i < CO_POOL_SIZE; ++i)
+        spawn(once, &q[i], 0);
+    CHECK(co_spawn(&gl_ex, once, &q[0], 0) == NULL);
+    adopt(&gl_ex);
+    (void) step(&gl_ex);
+    (void) step(&gl_ex);
+    CHECK(co_pool_used() == 0u);
+}
+
+int main(void) {
+    delays(0);
+    delays(portMAX_DELAY - 5u);         // across the tick count wrapping
+    yields();
+    queues();
+    notifications();
+    finishing();
+    printf("test-coexec: ok\n");
+    return 0;
+}
@@ -0,0 +1,277 @@
+/**
+   test-condvar: condition variables (FreeRTOS-Kernel/condvar.c) on
+   the host simulation (tools/sim)
+
+       make check
+
+   A signalled task is queued on the mutex rather than readied, so
+   the mutex holder must inherit its priority, and the signal must
+   count even if the task's block time runs out before it gets the
+   mutex back.  The stress test then runs producers and consumers of
+   mixed priorities over a small buffer, with random block times,
+   yields and ticks, and checks every item arrives exactly once.
+ */
+
+#include "sim.h"
+#include "task.h"
+#include "semphr.h"
+#include "condvar.h"
+
+enum { CONTROL = 4, HIGH = 3, MID = 2, LOW = 1 };
+
+static SemaphoreHandle_t gl_mutex;
+static CondVarHandle_t gl_cv;
+
+typedef struct {
+    TickType_t wait;
+    BaseType_t got;
+    BaseType_t held;        // held the mutex on return
+    unsigned order;         // of return, counting from 1
+} Waiter;
+
+static unsigned gl_returned;
+
+static BaseType_t holding(void) {
+    return xSemaphoreGetMutexHolder(gl_mutex) == xTaskGetCurrentTaskHandle();
+}
+
+static void waiter(void * arg) {
+    Waiter * w = arg;
+
+    CHECK(xSemaphoreTake(gl_mutex, portMAX_DELAY) == pdTRUE);
+    w->got = xCondVarWait(gl_cv, w->wait);
+    w->held = holding();
+    w->order = ++gl_returned;
+    xSemaphoreGive(gl_mutex);
+    vTaskDelete(NULL);
+}
+
+static void start(Waiter * w, TickType_t wait, UBaseType_t priority) {
+    w->wait = wait;
+    w->got = -1;
+    w->held = pdFALSE;
+    w->order = 0u;
+    CHECK(xTaskCreate(waiter, "wait", configMINIMAL_STACK_SIZE, w,
+                      priority, NULL) == pdPASS);
+}
+
+static void timeout_without_signal(void) {
+    Waiter w;
+
+    start(&w, 10, HIGH);
+    vTaskDelay(5);
+    CHECK(w.got == -1);
+    vTaskDelay(10);
+    CHECK(w.got == pdFALSE && w.held);
+}
+
+// signalled in time, then kept from the mutex past the block time
+static void signal_outlives_block_time(void) {
+    Waiter w;
+
+    start(&w, 10, HIGH);
+    vTaskDelay(1);
+
+    CHECK(xSemaphoreTake(gl_mutex, 0) == pdTRUE);
+    vCondVarSignal(gl_cv);
+    vTaskDelay(30);
+    CHECK(w.got == -1);
+    xSemaphoreGive(gl_mutex);
+    vTaskDelay(1);
+    CHECK(w.got == pdTRUE && w.held);
+}
+
+static TaskHandle_t gl_holder;
+static UBaseType_t gl_holder_after;
+
+// takes the mutex, and holds it until notified
+static void holder(void * arg) {
+    (void) arg;
+    CHECK(xSemaphoreTake(gl_mutex, portMAX_DELAY) == pdTRUE);
+    (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xSemaphoreGive(gl_mutex);
+    gl_holder_after = uxTaskPriorityGet(NULL);
+    vTaskDelete(NULL);
+}
+
+static void holder_inherits_from_woken(void) {
+    Waiter mid, high;
+
+    start(&mid, portMAX_DELAY, MID);
+    start(&high, portMAX_DELAY, HIGH);
+    CHECK(xTaskCreate(holder, "hold", configMINIMAL_STACK_SIZE, NULL,
+                      LOW, &gl_holder) == pdPASS);
+    vTaskDelay(1);
+    CHECK(xSemaphoreGetMutexHolder(gl_mutex) == gl_holder);
+
+    // signal from a task that does not hold the mutex
+    vCondVarSignal(gl_cv);
+    CHECK(uxTaskPriorityGet(gl_holder) == HIGH);
+    vCondVarBroadcast(gl_cv);
+    CHECK(uxTaskPriorityGet(gl_holder) == HIGH);
+
+    gl_returned = 0u;
+    xTaskNotifyGive(gl_holder);
+    vTaskDelay(1);
+    CHECK(gl_holder_after == LOW);
+    CHECK(high.got == pdTRUE && high.held && high.order == 1u);
+    CHECK(mid.got == pdTRUE && mid.held && mid.order == 2u);
+}
+
+// a woken task that is not queued behind a holder is readied at once
+static void signal_with_mutex_free(void) {
+    Waiter w;
+
+    start(&w, portMAX_DELAY, MID);
+    vTaskDelay(1);
+    vCondVarSignal(gl_cv);
+    CHECK(uxTaskPriorityGet(NULL) == CONTROL);
+    vTaskDelay(1);
+    CHECK(w.got == pdTRUE && w.held);
+}
+
+// bounded buffer
+
+#define SLOTS 3u
+#define PRODUCERS 3u
+#define CONSUMERS 4u
+#define ITEMS 400u                      // per producer
+#define TOTAL (PRODUCERS * ITEMS)
+
+static CondVarHandle_t gl_not_empty, gl_not_full;
+static uint32_t gl_slot[SLOTS];
+static unsigned gl_head, gl_count;
+static unsigned gl_consumed, gl_finished;
+static uint8_t gl_seen[TOTAL];
+static BaseType_t gl_timeouts;          // use random block times
+static uint32_t gl_random;
+
+static unsigned random_below(unsigned n) {
+    gl_random = gl_random * 1103515245u + 12345u;
+    return (gl_random >> 16) % n;
+}
+
+static TickType_t block_time(void) {
+    return gl_timeouts ? 1u + random_below(3) : portMAX_DELAY;
+}
+
+// let the other tasks and the clock move, possibly with the mutex held
+static void pause(void) {
+    switch (random_below(6)) {
+    case 0: taskYIELD(); break;
+    case 1: vTaskDelay(1); break;
+    case 2: sim_tick(1 + random_below(3)); break;
+    default: break;
+    }
+}
+
+static void wake(CondVarHandle_t cv) {
+    if (random_below(4) == 0u)
+        vCondVarBroadcast(cv);
+    else
+        vCondVarSignal(cv);
+}
+
+static void producer(void * arg) {
+    uint32_t first = (uint32_t)(uintptr_t)arg * ITEMS;
+
+    for (uint32_t i = first; i < first + ITEMS; ++i) {
+        CHECK(xSemaphoreTake(gl_mutex, portMAX_DELAY) == pdTRUE);
+        while (gl_count == SLOTS) {
+            (void) xCondVarWait(gl_not_full, block_time());
+            CHECK(holding());
+        }
+        gl_slot[(gl_head + gl_count) % SLOTS] = i;
+        gl_count++;
+        wake(gl_not_empty);
+        pause();
+        xSemaphoreGive(gl_mutex);
+        pause();
+    }
+    gl_finished++;
+    vTaskDelete(NULL);
+}
+
+static void consumer(void * arg) {
+    (void) arg;
+    CHECK(xSemaphoreTake(gl_mutex, portMAX_DELAY) == pdTRUE);
+    while (gl_consumed < TOTAL) {
+        if (gl_count == 0u) {
+            (void) xCondVarWait(gl_not_empty, block_time());
+            CHECK(holding());
+            continue;
+        }
+        uint32_t item = gl_slot[gl_head];
+        gl_head = (gl_head + 1u) % SLOTS;
+        gl_count--;
+        CHECK(item < TOTAL && gl_seen[item] == 0u);
+        gl_seen[item] = 1u;
+        if (++gl_consumed == TOTAL)
+            vCondVarBroadcast(gl_not_empty);
+        wake(gl_not_full);
+        pause();
+        xSemaphoreGive(gl_mutex);
+        pause();
+        CHECK(xSemaphoreTake(gl_mutex, portMAX_DELAY) == pdTRUE);
+    }
+    xSemaphoreGive(gl_mutex);
+    gl_finished++;
+    vTaskDelete(NULL);
+}
+
+static void bounded_buffer(BaseType_t timeouts, uint32_t seed) {
+    static UBaseType_t const priority[] = { LOW, MID, HIGH, MID };
+
+    gl_timeouts = timeouts;
+    gl_random = seed;
+    gl_head = gl_count = gl_consumed = gl_finished = 0u;
+    for (unsigned i = 0; i < TOTAL; ++i)
+        gl_seen[i] = 0u;
+
+    for (uintptr_t i = 0; i < PRODUCERS; ++i)
+        CHECK(xTaskCreate(producer, "prod", configMINIMAL_STACK_SIZE,
+                          (void *)i, priority[i], NULL) == pdPASS);
+    for (unsigned i = 0; i < CONSUMERS; ++i)
+        CHECK(xTaskCreate(consumer, "cons", configMINIMAL_STACK_SIZE,
+                          NULL, priority[CONSUMERS - 1u - i], NULL) == pdPASS);
+
+    while (gl_finished < PRODUCERS + CONSUMERS)
+        vTaskDelay(100);
+
+    CHECK(gl_count == 0u && gl_consumed == TOTAL);
+    for (unsigned i = 0; i < TOTAL; ++i)
+        CHECK(gl_seen[i] == 1u);
+    CHECK(xSemaphoreGetMutexHolder(gl_mutex) == NULL);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    gl_mutex = xSemaphoreCreateMutex();
+    gl_cv = xCondVarCreate(gl_mutex);
+    gl_not_empty = xCondVarCreate(gl_mutex);
+    gl_not_full = xCondVarCreate(gl_mutex);
+    CHECK(gl_mutex != NULL && gl_cv != NULL);
+    CHECK(gl_not_empty != NULL && gl_not_full != NULL);
+
+    timeout_without_signal();
+    signal_outlives_block_time();
+    holder_inherits_from_woken();
+    signal_with_mutex_free();
+    for (uint32_t seed = 1u; seed <= 4u; ++seed) {
+        bounded_buffer(pdFALSE, seed);
+        bounded_buffer(pdTRUE, seed);
+    }
+
+    vCondVarDelete(gl_cv);
+    vCondVarDelete(gl_not_empty);
+    vCondVarDelete(gl_not_full);
+    printf("test-condvar: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
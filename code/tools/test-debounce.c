@@ -0,0 +1,243 @@
+/**
+   test-debounce: the button's debounce decisions (app/button-debounce.c)
+   replayed against bounce traces on the host
+
+       make check
+
+   A trace lists the pin's level changes.  It is played tick by tick
+   through a model of button-input.c: the EXTI line's mask and pending
+   bit, the edge ISR, and the one-shot debounce timer, whose starts can
+   be made to fail as with a full timer queue.  The events posted, and
+   how often the ISR ran, are checked.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "button-debounce.h"
+#include "button-input.h"
+
+#define DEBOUNCE pdMS_TO_TICKS(BUTTON_DEBOUNCE_MS)
+
+typedef struct {
+    TickType_t time;
+    bool pressed;               // the pin's level from `time` on
+    bool after_read;            // lands in the timer callback, after the
+                                // pin was read but before the unmask
+} Change;
+
+typedef struct {
+    ButtonDebounce d;
+    bool pin;
+    bool masked;
+    bool pending;
+    bool timing;
+    TickType_t expiry;
+    unsigned starts;            // timer starts so far
+    uint32_t fails;             // bit n: start n fails
+    unsigned isrs;
+    ButtonEvent ev[8];
+    unsigned events;
+} Model;
+
+static bool start_timer(Model * m, TickType_t now) {
+    bool ok = !(m->fails & (1u << m->starts++));
+
+    if (ok) {
+        m->timing = true;
+        m->expiry = now + DEBOUNCE;
+    }
+    return ok;
+}
+
+// edge() of button-input.c
+static void isr(Model * m, TickType_t now) {
+    m->isrs++;
+    m->pending = false;
+    button_debounce_edge(&m->d, now);
+    if (start_timer(m, now))
+        m->masked = true;
+}
+
+// debounce_expired() of button-input.c
+static void expired(Model * m, TickType_t now, Change const * race) {
+    m->timing = false;
+    if (button_debounce_settled(&m->d, m->pin)) {
+        CHECK(m->events < 8u);
+        m->ev[m->events].type = m->d.pressed ? BUTTON_PRESS : BUTTON_RELEASE;
+        m->ev[m->events++].time = m->d.edge_time;
+    }
+
+    // its pending bit is cleared below, unseen
+    if (race != NULL)
+        m->pin = race->pressed;
+
+    m->pending = false;
+    m->masked = false;
+    if (button_debounce_moved(&m->d, m->pin, now)) {
+        m->masked = true;
+        if (!start_timer(m, now))
+            m->masked = false;
+    }
+}
+
+static void replay(Model * m, Change const * trace, unsigned n,
+                   uint32_t fails) {
+    memset(m, 0, sizeof *m);
+    m->fails = fails;
+    button_debounce_init(&m->d, false);
+
+    TickType_t end = trace[n - 1u].time + 10u * DEBOUNCE;
+    unsigned next = 0;
+
+    for (TickType_t t = 0; t <= end; ++t) {
+        Change const * race = NULL;
+
+        for (; next < n && trace[next].time == t; ++next) {
+            if (trace[next].after_read) {
+                race = &trace[next];
+                continue;
+            }
+            m->pin = trace[next].pressed;
+            m->pending = true;  // both edges
+        }
+        if (m->pending && !m->masked)
+            isr(m, t);
+        if (m->timing && t == m->expiry)
+            expired(m, t, race);
+        else
+            CHECK(race == NULL);
+    }
+
+    // whatever happened, the line is left listening
+    CHECK(!m->timing && !m->masked);
+}
+
+static void check_events(Model const * m, ButtonEvent const * want,
+                         unsigned n) {
+    if (m->events != n) {
+        fprintf(stderr, "%u events, expected %u\n", m->events, n);
+        exit(1);
+    }
+    for (unsigned i = 0; i < n; ++i)
+        if (m->ev[i].type != want[i].type || m->ev[i].time != want[i].time) {
+            fprintf(stderr, "event %u: %d at %lu, expected %d at %lu\n", i,
+                    (int)m->ev[i].type, (unsigned long)m->ev[i].time,
+                    (int)want[i].type, (unsigned long)want[i].time);
+            exit(1);
+        }
+}
+
+#define P true
+#define R false
+#define AT(t, level)    { (t), (level), false }
+#define LATE(t, level)  { (t), (level), true }     // after the read
+#define LEN(a) (sizeof (a) / sizeof (a)[0])
+
+static void clean(void) {
+    static Change const trace[] = { AT(100, P), AT(600, R) };
+    static ButtonEvent const want[] = {
+        { BUTTON_PRESS, 100 }, { BUTTON_RELEASE, 600 },
+    };
+    Model m;
+
+    replay(&m, trace, LEN(trace), 0u);
+    check_events(&m, want, LEN(want));
+    CHECK(m.isrs == 2u);
+}
+
+// a burst of bounces costs one interrupt and posts one event, stamped
+// with its first edge
+static void bouncy(void) {
+    static Change const trace[] = {
+        AT(100, P), AT(101, R), AT(103, P), AT(104, R), AT(106, P),
+        AT(500, R), AT(502, P), AT(503, R),
+    };
+    static ButtonEvent const want[] = {
+        { BUTTON_PRESS, 100 }, { BUTTON_RELEASE, 500 },
+    };
+    Model m;
+
+    replay(&m, trace, LEN(trace), 0u);
+    check_events(&m, want, LEN(want));
+    CHECK(m.isrs == 2u);
+}
+
+static void glitch(void) {
+    static Change const trace[] = { AT(100, P), AT(105, R) };
+    Model m;
+
+    replay(&m, trace, LEN(trace), 0u);
+    check_events(&m, NULL, 0);
+    CHECK(m.isrs == 1u);
+}
+
+// bouncing past the debounce time: the pin reads released at 120, and
+// the press is only seen from the edge at 121
+static void long_bounce(void) {
+    static Change const trace[] = {
+        AT(100, P), AT(119, R), AT(121, P), AT(125, R), AT(131, P),
+    };
+    static ButtonEvent const want[] = { { BUTTON_PRESS, 121 } };
+    Model m;
+
+    replay(&m, trace, LEN(trace), 0u);
+    check_events(&m, want, LEN(want));
+    CHECK(m.isrs == 2u);
+}
+
+// a release between the read and the unmask leaves no pending bit,
+// but is not lost
+static void unmask_race(void) {
+    static Change const trace[] = { AT(100, P), LATE(120, R) };
+    static ButtonEvent const want[] = {
+        { BUTTON_PRESS, 100 }, { BUTTON_RELEASE, 120 },
+    };
+    Model m;
+
+    replay(&m, trace, LEN(trace), 0u);
+    check_events(&m, want, LEN(want));
+    CHECK(m.isrs == 1u);
+}
+
+// with the timer queue full the line stays unmasked, and the next
+// edge starts the timer for the burst
+static void timer_queue_full(void) {
+    static Change const bounce[] = { AT(100, P), AT(102, R), AT(104, P) };
+    static ButtonEvent const bounce_want[] = { { BUTTON_PRESS, 100 } };
+    Model m;
+
+    replay(&m, bounce, LEN(bounce), 1u << 0);
+    check_events(&m, bounce_want, LEN(bounce_want));
+    CHECK(m.isrs == 2u);
+
+    // a clean press is missed until the release, which confirms no
+    // change; the next press has a burst of its own
+    static Change const clean[] = { AT(100, P), AT(600, R), AT(800, P) };
+    static ButtonEvent const clean_want[] = { { BUTTON_PRESS, 800 } };
+
+    replay(&m, clean, LEN(clean), 1u << 0);
+    check_events(&m, clean_want, LEN(clean_want));
+
+    // the timer callback cannot restart the timer either
+    static Change const race[] = {
+        AT(100, P), LATE(120, R), AT(130, P), AT(135, R),
+    };
+    static ButtonEvent const race_want[] = {
+        { BUTTON_PRESS, 100 }, { BUTTON_RELEASE, 120 },
+    };
+
+    replay(&m, race, LEN(race), 1u << 1);
+    check_events(&m, race_want, LEN(race_want));
+}
+
+int main(void) {
+    clean();
+    bouncy();
+    glitch();
+    long_bounce();
+    unmask_race();
+    timer_queue_full();
+    printf("test-debounce: ok\n");
+    return 0;
+}
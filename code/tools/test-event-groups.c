@@ -0,0 +1,276 @@
+/**
+   test-event-groups: event group waits against a reference model, and
+   the cost of setting bits as waiters are added, on the host simulation
+   (tools/sim)
+
+       make check
+
+   Built once for each of 1, 8 and 24 waiter lists
+   (configEVENT_GROUP_WAITER_LISTS; 24 is one list per event bit).
+
+   Sixteen waiter tasks, above the control task's priority so that
+   every wait and wakeup happens inside the call that causes it, are
+   given random any/all waits, with and without clear-on-exit and
+   timeouts, on 1..3 of the 24 bits.  The control task sets and clears
+   random bits and lets time pass, and checks after each step which
+   tasks returned, and with what, against a model that holds the
+   waiters in a plain array.  Deleting the group releases the rest.
+
+   Then it prints the time for xEventGroupSetBits() of one bit, with
+   1..64 tasks blocked, waiter i on bit i % 24, with the scheduler
+   suspended so that only the search of the waiter lists is timed.
+   The figures are host ns, the best of three runs, and only compare
+   the builds.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "event_groups.h"
+
+enum { CONTROL = 1, WAITER = 2 };
+
+#define BITS 24u
+#define ALL_BITS ((1u << BITS) - 1u)
+#define WAITERS 16u
+
+static uint32_t gl_random = 1u;
+
+static unsigned random_below(unsigned n) {
+    gl_random = gl_random * 1103515245u + 12345u;
+    return (gl_random >> 16) % n;
+}
+
+static EventGroupHandle_t gl_group;
+
+typedef struct {
+    TaskHandle_t task;
+    EventBits_t mask;
+    BaseType_t clear, all;
+    TickType_t ticks;
+    EventBits_t volatile result;
+    bool volatile returned;
+    // the model's view
+    bool blocked;
+    TickType_t deadline;
+    EventBits_t expect;
+    bool expect_return;
+} Waiter;
+
+static Waiter gl_w[WAITERS];
+static EventBits_t gl_bits;             // the model's bits
+
+static void waiter(void * arg) {
+    Waiter * w = arg;
+
+    for (;;) {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        w->result = xEventGroupWaitBits(gl_group, w->mask, w->clear, w->all,
+                                        w->ticks);
+        w->returned = true;
+    }
+}
+
+static bool satisfied(Waiter const * w, EventBits_t bits) {
+    EventBits_t hit = bits & w->mask;
+    return w->all ? hit == w->mask : hit != 0u;
+}
+
+static void expect(Waiter * w, EventBits_t result) {
+    w->blocked = false;
+    w->expect_return = true;
+    w->expect = result;
+}
+
+// every waiter has done what the model says
+static void check_waiters(void) {
+    for (unsigned i = 0; i < WAITERS; ++i) {
+        Waiter * w = &gl_w[i];
+
+        CHECK(w->returned == w->expect_return);
+        if (w->returned)
+            CHECK(w->result == w->expect);
+        w->returned = w->expect_return = false;
+    }
+    CHECK(xEventGroupGetBits(gl_group) == gl_bits);
+}
+
+static void arm(Waiter * w) {
+    EventBits_t mask = 0u;
+
+    for (unsigned n = 1u + random_below(3); n != 0u; --n)
+        mask |= 1u << random_below(BITS);
+    w->mask = mask;
+    w->all = random_below(2) ? pdTRUE : pdFALSE;
+    w->clear = random_below(2) ? pdTRUE : pdFALSE;
+    w->ticks = random_below(2) ? portMAX_DELAY : 1u + random_below(20);
+    if (w->ticks == portMAX_DELAY)
+        w->deadline = 0u;
+    else
+        w->deadline = xTaskGetTickCount() + w->ticks;
+
+    // satisfied already: returns the bits, before any clear
+    if (satisfied(w, gl_bits)) {
+        expect(w, gl_bits);
+        if (w->clear)
+            gl_bits &= ~w->mask;
+    } else {
+        w->blocked = true;
+    }
+    xTaskNotifyGive(w->task);           // runs it, to its return or block
+}
+
+static void set(EventBits_t bits) {
+    EventBits_t to_clear = 0u;
+
+    gl_bits |= bits;
+    for (unsigned i = 0; i < WAITERS; ++i) {
+        Waiter * w = &gl_w[i];
+
+        if (w->blocked && satisfied(w, gl_bits)) {
+            expect(w, gl_bits);
+            if (w->clear)
+                to_clear |= w->mask;
+        }
+    }
+    gl_bits &= ~to_clear;
+    CHECK(xEventGroupSetBits(gl_group, bits) == gl_bits);
+}
+
+static void tick(void) {
+    TickType_t now = xTaskGetTickCount() + 1u;
+
+    // a timeout returns the bits then; the wait cannot be satisfied, or
+    // the waiter would have returned when the bits were set
+    for (unsigned i = 0; i < WAITERS; ++i) {
+        Waiter * w = &gl_w[i];
+
+        if (w->blocked && w->ticks != portMAX_DELAY && w->deadline == now)
+            expect(w, gl_bits);
+    }
+    vTaskDelay(1);
+}
+
+static void random_waits(void) {
+    gl_group = xEventGroupCreate();
+    CHECK(gl_group != NULL);
+    gl_bits = 0u;
+    memset(gl_w, 0, sizeof gl_w);
+    for (unsigned i = 0; i < WAITERS; ++i)
+        CHECK(xTaskCreate(waiter, "waiter", configMINIMAL_STACK_SIZE, &gl_w[i],
+                          WAITER, &gl_w[i].task) == pdPASS);
+
+    for (unsigned step = 0; step < 40000u; ++step) {
+        unsigned what = random_below(20);
+
+        if (what < 10u) {
+            Waiter * w = &gl_w[random_below(WAITERS)];
+
+            if (!w->blocked)
+                arm(w);
+        } else if (what < 16u) {
+            EventBits_t bits = 1u << random_below(BITS);
+
+            if (random_below(4) == 0u)
+                bits |= 1u << random_below(BITS);
+            set(bits);
+        } else if (what < 18u) {
+            EventBits_t bits = random_below(4) ? 1u << random_below(BITS)
+                                               : ALL_BITS;
+
+            CHECK(xEventGroupClearBits(gl_group, bits) == gl_bits);
+            gl_bits &= ~bits;
+        } else {
+            tick();
+        }
+        check_waiters();
+    }
+
+    // deleting the group releases every waiter with no bits
+    for (unsigned i = 0; i < WAITERS; ++i)
+        if (gl_w[i].blocked)
+            expect(&gl_w[i], 0u);
+    gl_bits = 0u;
+    vEventGroupDelete(gl_group);
+    for (unsigned i = 0; i < WAITERS; ++i) {
+        CHECK(gl_w[i].returned == gl_w[i].expect_return);
+        if (gl_w[i].returned)
+            CHECK(gl_w[i].result == 0u);
+        vTaskDelete(gl_w[i].task);
+    }
+}
+
+// benchmark
+
+#define REPS 1000u
+#define MAX_WAITERS 64u
+
+static void bench_waiter(void * arg) {
+    EventBits_t bit = (EventBits_t)(uintptr_t)arg;
+
+    for (;;)
+        (void) xEventGroupWaitBits(gl_group, bit, pdTRUE, pdFALSE,
+                                   portMAX_DELAY);
+}
+
+static void bench(unsigned waiters, SimTiming * t) {
+    TaskHandle_t h[MAX_WAITERS];
+    unsigned used = waiters < BITS ? waiters : BITS;
+
+    gl_group = xEventGroupCreate();
+    CHECK(gl_group != NULL);
+    for (unsigned i = 0; i < waiters; ++i)
+        CHECK(xTaskCreate(bench_waiter, "waiter", configMINIMAL_STACK_SIZE,
+                          (void *)(uintptr_t)(1u << (i % BITS)), WAITER,
+                          &h[i]) == pdPASS);
+
+    for (unsigned r = 0; r < REPS; ++r) {
+        vTaskSuspendAll();
+        uint64_t start = sim_host_ns();
+        (void) xEventGroupSetBits(gl_group, 1u << (r % used));
+        sim_timed(t, start);
+        (void) xTaskResumeAll();        // the woken wait again
+        CHECK(xEventGroupGetBits(gl_group) == 0u);
+    }
+
+    for (unsigned i = 0; i < waiters; ++i)
+        vTaskDelete(h[i]);
+    vEventGroupDelete(gl_group);
+    vTaskDelay(1);                      // the idle task frees them
+}
+
+static void scaling(void) {
+    printf("test-event-groups: %u waiter list(s), ns per "
+           "xEventGroupSetBits() of one bit\n",
+           (unsigned)configEVENT_GROUP_WAITER_LISTS);
+    for (unsigned n = 1; n <= MAX_WAITERS; n *= 2u) {
+        SimTiming best = { 0 };
+
+        for (unsigned i = 0; i < 3u; ++i) {
+            SimTiming t = { 0 };
+
+            bench(n, &t);
+            sim_keep_best(&best, &t);
+        }
+        char what[32];
+        snprintf(what, sizeof what, "%2u waiters", n);
+        sim_report(what, &best);
+    }
+}
+
+static void control(void * arg) {
+    (void) arg;
+    random_waits();
+    scaling();
+    printf("test-event-groups: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+   test-event-list-buckets: queue waiters whose priority changes while
+   they block, on the host simulation (tools/sim)
+
+       make check
+
+   A blocked task's event list item value follows vTaskPrioritySet()
+   and priority inheritance, but the task does not move in the list,
+   so the buckets indexing the list must not be judged from the value.
+
+   It then prints how placing a waiter scales with 1..64 waiters
+   already in the list: vListInsert(), which walks the sorted list,
+   against uxListInsertBucketed().  The waiter placed has the lowest
+   priority, the longest walk; the others spread over all priorities.
+   The figures are host nanoseconds per insert and removal, the best
+   of three runs, and only compare the two.
+ */
+
+#include <stdbool.h>
+
+#include "sim.h"
+#include "task.h"
+#include "queue.h"
+#include "list.h"
+
+enum { CONTROL = 4, HIGH = 3, LOW = 2 };
+
+static QueueHandle_t gl_queue;
+
+typedef struct {
+    TickType_t wait;
+    BaseType_t got;
+    uint32_t item;
+} Waiter;
+
+static void receiver(void * arg) {
+    Waiter * w = arg;
+
+    w->got = xQueueReceive(gl_queue, &w->item, w->wait);
+    vTaskDelete(NULL);
+}
+
+static void start(Waiter * w, TickType_t wait, UBaseType_t priority,
+                  TaskHandle_t * handle) {
+    w->wait = wait;
+    w->got = -1;
+    CHECK(xTaskCreate(receiver, "rx", configMINIMAL_STACK_SIZE, w,
+                      priority, handle) == pdPASS);
+}
+
+// P blocks at a higher priority than Q, then drops to Q's; Q times
+// out, P receives, and a new waiter at Q's priority must still find
+// a consistent index
+static void priority_lowered_while_blocked(void) {
+    Waiter p, q, r;
+    TaskHandle_t hp;
+    uint32_t item;
+
+    start(&p, portMAX_DELAY, HIGH, &hp);
+    start(&q, 10, LOW, NULL);
+    vTaskDelay(1);
+    CHECK(p.got == -1 && q.got == -1);
+
+    vTaskPrioritySet(hp, LOW);
+    vTaskDelay(20);
+    CHECK(q.got == pdFALSE);
+
+    item = 1u;
+    CHECK(xQueueSend(gl_queue, &item, 0) == pdTRUE);
+    vTaskDelay(1);
+    CHECK(p.got == pdTRUE && p.item == 1u);
+
+    start(&r, portMAX_DELAY, LOW, NULL);
+    vTaskDelay(1);
+    item = 2u;
+    CHECK(xQueueSend(gl_queue, &item, 0) == pdTRUE);
+    vTaskDelay(1);
+    CHECK(r.got == pdTRUE && r.item == 2u);
+}
+
+// a waiter raised above the others stays where it blocked: the
+// others are still served in their order, and removing any of them
+// keeps the index usable
+static void priority_raised_while_blocked(void) {
+    Waiter w[4];
+    TaskHandle_t h[4];
+    uint32_t item;
+
+    for (unsigned i = 0; i < 4; ++i)
+        start(&w[i], (i == 1) ? 10 : portMAX_DELAY, (i < 2) ? LOW : 1, &h[i]);
+    vTaskDelay(1);
+
+    vTaskPrioritySet(h[3], HIGH);
+    vTaskDelay(20);
+    CHECK(w[1].got == pdFALSE);
+
+    // w[0] blocked first at the highest priority, then w[2], w[3]
+    for (uint32_t n = 0; n < 3; ++n) {
+        item = 10u + n;
+        CHECK(xQueueSend(gl_queue, &item, 0) == pdTRUE);
+        vTaskDelay(1);
+    }
+    CHECK(w[0].got == pdTRUE && w[0].item == 10u);
+    CHECK(w[2].got == pdTRUE && w[2].item == 11u);
+    CHECK(w[3].got == pdTRUE && w[3].item == 12u);
+
+    start(&w[0], portMAX_DELAY, LOW, NULL);
+    start(&w[1], portMAX_DELAY, HIGH, NULL);
+    vTaskDelay(1);
+    for (uint32_t n = 0; n < 2; ++n) {
+        item = 20u + n;
+        CHECK(xQueueSend(gl_queue, &item, 0) == pdTRUE);
+        vTaskDelay(1);
+    }
+    CHECK(w[1].item == 20u && w[0].item == 21u);
+}
+
+// scaling benchmark
+
+#define MAX_WAITERS 64u
+#define REPS 2000u
+
+static List_t gl_list;
+static EventListBuckets_t gl_buckets;
+static ListItem_t gl_waiting[MAX_WAITERS], gl_placed;
+
+// n waiters, spread over every priority
+static void fill(unsigned n, bool bucketed) {
+    vListInitialise(&gl_list);
+    vListInitialiseBuckets(&gl_buckets);
+    for (unsigned i = 0; i < n; ++i) {
+        vListInitialiseItem(&gl_waiting[i]);
+        listSET_LIST_ITEM_VALUE(&gl_waiting[i], 1u + i % configMAX_PRIORITIES);
+        if (bucketed)
+            (void) uxListInsertBucketed(&gl_list, &gl_buckets, &gl_waiting[i]);
+        else
+            vListInsert(&gl_list, &gl_waiting[i]);
+    }
+    vListInitialiseItem(&gl_placed);
+    listSET_LIST_ITEM_VALUE(&gl_placed, configMAX_PRIORITIES);
+}
+
+// ns per placement and removal of the lowest priority waiter
+static double place(unsigned n, bool bucketed) {
+    SimTiming best = { 0 };
+
+    fill(n, bucketed);
+    for (unsigned run = 0; run < 3u; ++run) {
+        SimTiming t = { 0 };
+        uint64_t start = sim_host_ns();
+
+        for (unsigned i = 0; i < REPS; ++i) {
+            if (bucketed) {
+                UBaseType_t b = uxListInsertBucketed(&gl_list, &gl_buckets,
+                                                     &gl_placed);
+                vListRemoveFromBuckets(&gl_buckets, b, &gl_placed);
+            } else {
+                vListInsert(&gl_list, &gl_placed);
+            }
+            (void) uxListRemove(&gl_placed);
+        }
+        sim_timed(&t, start);
+        sim_keep_best(&best, &t);
+    }
+    CHECK(listCURRENT_LIST_LENGTH(&gl_list) == n);
+    return (double)best.total / REPS;
+}
+
+static void scaling(void) {
+    printf("test-event-list-buckets: placing a waiter, ns\n"
+           "  waiters  vListInsert  bucketed\n");
+    for (unsigned n = 1; n <= MAX_WAITERS; n *= 2u)
+        printf("  %7u  %11.1f  %8.1f\n", n, place(n, false), place(n, true));
+}
+
+static void control(void * arg) {
+    (void) arg;
+    gl_queue = xQueueCreate(4, sizeof(uint32_t));
+    CHECK(gl_queue != NULL);
+
+    priority_lowered_while_blocked();
+    priority_raised_while_blocked();
+    scaling();
+
+    printf("test-event-list-buckets: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,368 @@
+/**
+   test-isr-events: event flags set from an ISR (app/isr-events.c) on
+   the host simulation (tools/sim)
+
+       make check
+
+   Checks which slots waiters arm and free, any/all and clear-on-exit
+   waits, timeouts, stray notifications on the waiters' index (which
+   must neither end a wait nor stretch its timeout) and the task's own
+   on index 0 (which the wait must leave alone), and the wakeup from
+   an ISR.
+
+   Then prints the ISR-to-waiter latency: host time from the call in
+   the "ISR" until the waiting task runs, for a bare task notification,
+   for isr_events_set_from_isr() with one and with every slot armed,
+   and for an event group set the way xEventGroupSetBitsFromISR() does
+   it, through a queue to a task at the timer daemon's priority.  The
+   figures are each the best of three runs, and only compare the ways.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "queue.h"
+#include "event_groups.h"
+#include "isr-events.h"
+
+enum { CONTROL = 4, DAEMON = 4, WAITER = 3, BYSTANDER = 2, BENCH = 1 };
+
+static IsrEvents gl_e;
+
+static unsigned popcount(uint32_t x) {
+    return (unsigned)__builtin_popcount(x);
+}
+
+typedef struct {
+    uint32_t mask;
+    unsigned flags;
+    TickType_t ticks;
+    uint32_t volatile result;
+    TickType_t volatile ended;
+    uint32_t volatile kept;     // index 0 notifications after the wait
+    bool volatile done;
+} Wait;
+
+static void waiter(void * arg) {
+    Wait * w = arg;
+
+    w->result = isr_events_wait(&gl_e, w->mask, w->flags, w->ticks);
+    w->ended = xTaskGetTickCount();
+    w->kept = ulTaskNotifyTake(pdTRUE, 0);
+    w->done = true;
+    vTaskDelete(NULL);
+}
+
+static TaskHandle_t start(Wait * w, uint32_t mask, unsigned flags,
+                          TickType_t ticks) {
+    TaskHandle_t h;
+
+    memset(w, 0, sizeof *w);
+    w->mask = mask;
+    w->flags = flags;
+    w->ticks = ticks;
+    CHECK(xTaskCreate(waiter, "waiter", configMINIMAL_STACK_SIZE, w,
+                      WAITER, &h) == pdPASS);
+    return h;
+}
+
+static void no_wait(void) {
+    isr_events_init(&gl_e);
+    CHECK(isr_events_set(&gl_e, 0x5u) == 0x5u);
+
+    // satisfied at once, or not waiting: no slot is taken
+    CHECK(isr_events_wait(&gl_e, 0x1u, 0, portMAX_DELAY) == 0x5u);
+    CHECK(isr_events_wait(&gl_e, 0x3u, ISR_EVENTS_ALL, 0) == 0x5u);
+    CHECK(isr_events_wait(&gl_e, 0x4u, ISR_EVENTS_CLEAR, 10) == 0x5u);
+    CHECK(isr_events_get(&gl_e) == 0x1u);
+    CHECK(gl_e.claimed == 0u && gl_e.pending == 0u);
+    CHECK(isr_events_clear(&gl_e, 0x1u) == 0x1u);
+    CHECK(isr_events_get(&gl_e) == 0u);
+}
+
+static void arming(void) {
+    Wait any, all, clear;
+
+    isr_events_init(&gl_e);
+    start(&any, 0x1u, 0, portMAX_DELAY);
+    start(&all, 0x6u, ISR_EVENTS_ALL, portMAX_DELAY);
+    start(&clear, 0x8u, ISR_EVENTS_CLEAR, portMAX_DELAY);
+    vTaskDelay(1);
+    CHECK(popcount(gl_e.claimed) == 3u && gl_e.pending == gl_e.claimed);
+
+    // half of an all-wait
+    CHECK(isr_events_set(&gl_e, 0x2u) == 0x2u);
+    vTaskDelay(1);
+    CHECK(!any.done && !all.done && !clear.done);
+    CHECK(popcount(gl_e.pending) == 3u);
+
+    // the other half; its slot leaves `pending` at once, `claimed` once
+    // the waiter has run
+    CHECK(isr_events_set(&gl_e, 0x4u) == 0x6u);
+    CHECK(popcount(gl_e.pending) == 2u && popcount(gl_e.claimed) == 3u);
+    vTaskDelay(1);
+    CHECK(all.done && all.result == 0x6u);
+    CHECK(popcount(gl_e.claimed) == 2u);
+
+    // two at once: both see 0x8, cleared only after both saw it
+    CHECK(isr_events_set(&gl_e, 0x9u) == 0x7u);
+    vTaskDelay(1);
+    CHECK(any.done && any.result == 0xfu);
+    CHECK(clear.done && clear.result == 0xfu);
+    CHECK(gl_e.claimed == 0u && gl_e.pending == 0u);
+    CHECK(isr_events_get(&gl_e) == 0x7u);
+}
+
+static void every_slot(void) {
+    Wait w[ISR_EVENTS_MAX_WAITERS];
+
+    isr_events_init(&gl_e);
+    for (unsigned i = 0; i < ISR_EVENTS_MAX_WAITERS; ++i)
+        start(&w[i], 1u << i, ISR_EVENTS_CLEAR, portMAX_DELAY);
+    vTaskDelay(1);
+    CHECK(popcount(gl_e.claimed) == ISR_EVENTS_MAX_WAITERS);
+
+    // freed slots are taken again
+    CHECK(isr_events_set(&gl_e, 0x1u) == 0u);
+    vTaskDelay(1);
+    CHECK(w[0].done && popcount(gl_e.claimed) == ISR_EVENTS_MAX_WAITERS - 1u);
+    start(&w[0], 0x1u, ISR_EVENTS_CLEAR, portMAX_DELAY);
+    vTaskDelay(1);
+    CHECK(popcount(gl_e.claimed) == ISR_EVENTS_MAX_WAITERS);
+
+    CHECK(isr_events_set(&gl_e, ~0u)
+          == (~0u & ~((1u << ISR_EVENTS_MAX_WAITERS) - 1u)));
+    vTaskDelay(1);
+    for (unsigned i = 0; i < ISR_EVENTS_MAX_WAITERS; ++i)
+        CHECK(w[i].done && (w[i].result & w[i].mask) != 0u);
+    CHECK(gl_e.claimed == 0u);
+}
+
+static void timeouts(void) {
+    Wait w;
+
+    isr_events_init(&gl_e);
+    (void) isr_events_set(&gl_e, 0x10u);
+    TickType_t t0 = xTaskGetTickCount();
+    start(&w, 0x1u, 0, 5);
+    vTaskDelay(4);
+    CHECK(!w.done);
+    vTaskDelay(2);
+    CHECK(w.done && w.ended == t0 + 5u);
+    CHECK(w.result == 0x10u);            // the bits, without the mask
+    CHECK(gl_e.claimed == 0u && gl_e.pending == 0u);
+
+    // bits set after the timeout are not taken by the gone waiter
+    CHECK(isr_events_set(&gl_e, 0x1u) == 0x11u);
+}
+
+static void stray_notifications(void) {
+    Wait w;
+
+    isr_events_init(&gl_e);
+    TickType_t t0 = xTaskGetTickCount();
+    TaskHandle_t h = start(&w, 0x1u, 0, 10);
+    vTaskDelay(3);
+    xTaskNotifyGiveIndexed(h, ISR_EVENTS_NOTIFY_INDEX);
+    vTaskDelay(1);
+    CHECK(!w.done && gl_e.pending != 0u);
+    xTaskNotifyGiveIndexed(h, ISR_EVENTS_NOTIFY_INDEX);
+    xTaskNotifyGive(h);                 // the task's own, on index 0
+    xTaskNotifyGive(h);
+    vTaskDelay(1);
+    CHECK(!w.done);
+    vTaskDelay(10);
+    CHECK(w.done && w.ended == t0 + 10u);
+    CHECK((w.result & 0x1u) == 0u);
+    CHECK(w.kept == 2u);
+
+    // and a real wakeup after a stray one
+    h = start(&w, 0x1u, 0, portMAX_DELAY);
+    vTaskDelay(1);
+    xTaskNotifyGiveIndexed(h, ISR_EVENTS_NOTIFY_INDEX);
+    vTaskDelay(1);
+    CHECK(!w.done);
+    (void) isr_events_set(&gl_e, 0x1u);
+    vTaskDelay(1);
+    CHECK(w.done && w.result == 0x1u);
+}
+
+static void from_isr(void) {
+    Wait w;
+    BaseType_t woken = pdFALSE;
+
+    isr_events_init(&gl_e);
+    vTaskPrioritySet(NULL, BENCH);
+    start(&w, 0x3u, ISR_EVENTS_ALL | ISR_EVENTS_CLEAR, portMAX_DELAY);
+    CHECK(gl_e.pending != 0u);           // it ran, at the higher priority
+
+    CHECK(isr_events_set_from_isr(&gl_e, 0x1u, &woken) == 0x1u);
+    CHECK(woken == pdFALSE);
+    CHECK(isr_events_set_from_isr(&gl_e, 0x2u, &woken) == 0u);
+    CHECK(woken == pdTRUE && !w.done);
+    portYIELD_FROM_ISR(woken);
+    CHECK(w.done && w.result == 0x3u);   // before the "ISR" returned
+    vTaskPrioritySet(NULL, CONTROL);
+}
+
+// latency benchmark
+
+#define REPS 2000u
+
+enum Path { NOTIFY, ISR_EVENTS, ISR_EVENTS_FULL, EVENT_GROUP };
+
+static enum Path gl_path;
+static SimTiming * gl_timing;
+static uint64_t gl_start;
+static bool volatile gl_stop;
+static unsigned volatile gl_wakeups;
+static TaskHandle_t gl_waiter;
+static EventGroupHandle_t gl_group;
+static QueueHandle_t gl_daemon_queue;
+
+static void bench_waiter(void * arg) {
+    (void) arg;
+    for (;;) {
+        switch (gl_path) {
+        case NOTIFY:
+            (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            break;
+        case ISR_EVENTS:
+        case ISR_EVENTS_FULL:
+            (void) isr_events_wait(&gl_e, 0x1u, ISR_EVENTS_CLEAR,
+                                   portMAX_DELAY);
+            break;
+        case EVENT_GROUP:
+            (void) xEventGroupWaitBits(gl_group, 0x1u, pdTRUE, pdFALSE,
+                                       portMAX_DELAY);
+            break;
+        }
+        if (gl_stop)
+            break;
+        sim_timed(gl_timing, gl_start);
+        gl_wakeups++;
+    }
+    vTaskDelete(NULL);
+}
+
+// waits on a bit of its own, and makes the ISR visit its slot
+static void bystander(void * arg) {
+    (void) isr_events_wait(&gl_e, (uint32_t)(uintptr_t)arg, 0, portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+// as the timer daemon runs vEventGroupSetBitsCallback()
+static void daemon(void * arg) {
+    uint32_t bits;
+
+    (void) arg;
+    for (;;) {
+        (void) xQueueReceive(gl_daemon_queue, &bits, portMAX_DELAY);
+        (void) xEventGroupSetBits(gl_group, bits);
+    }
+}
+
+static void trigger(void) {
+    BaseType_t woken = pdFALSE;
+    uint32_t bits = 0x1u;
+
+    switch (gl_path) {
+    case NOTIFY:
+        vTaskNotifyGiveFromISR(gl_waiter, &woken);
+        break;
+    case ISR_EVENTS:
+    case ISR_EVENTS_FULL:
+        (void) isr_events_set_from_isr(&gl_e, 0x1u, &woken);
+        break;
+    case EVENT_GROUP:
+        (void) xQueueSendFromISR(gl_daemon_queue, &bits, &woken);
+        break;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void run(enum Path path, SimTiming * t) {
+    isr_events_init(&gl_e);
+    gl_path = path;
+    gl_timing = t;
+    gl_stop = false;
+    gl_wakeups = 0;
+    if (path == ISR_EVENTS_FULL)
+        for (unsigned i = 1; i < ISR_EVENTS_MAX_WAITERS; ++i)
+            CHECK(xTaskCreate(bystander, "bystander", configMINIMAL_STACK_SIZE,
+                              (void *)(uintptr_t)(1u << i), BYSTANDER,
+                              NULL) == pdPASS);
+    CHECK(xTaskCreate(bench_waiter, "waiter", configMINIMAL_STACK_SIZE, NULL,
+                      WAITER, &gl_waiter) == pdPASS);
+    if (path == ISR_EVENTS_FULL) {
+        vTaskDelay(1);                   // let the bystanders arm
+        CHECK(popcount(gl_e.claimed) == ISR_EVENTS_MAX_WAITERS);
+    }
+
+    for (unsigned i = 0; i < REPS; ++i) {
+        gl_start = sim_host_ns();
+        trigger();
+        CHECK(gl_wakeups == i + 1u);     // the waiter ran in between
+    }
+    gl_stop = true;
+    trigger();
+    if (path == ISR_EVENTS_FULL)
+        (void) isr_events_set(&gl_e, ~0x1u);
+    vTaskDelay(1);                       // the idle task frees them
+}
+
+static void latency(void) {
+    static char const * const name[] = {
+        "task notification", "isr_events, 1 slot armed",
+        "isr_events, 8 slots armed", "event group, deferred",
+    };
+    SimTiming best[4] = { { 0 } };
+    TaskHandle_t d;
+
+    gl_group = xEventGroupCreate();
+    gl_daemon_queue = xQueueCreate(5, sizeof(uint32_t));  // the board's
+                                                          // timer queue
+    CHECK(gl_group != NULL && gl_daemon_queue != NULL);
+    CHECK(xTaskCreate(daemon, "daemon", configMINIMAL_STACK_SIZE, NULL, DAEMON,
+                      &d) == pdPASS);
+
+    vTaskPrioritySet(NULL, BENCH);
+    for (unsigned i = 0; i < 3u; ++i)
+        for (enum Path p = NOTIFY; p <= EVENT_GROUP; ++p) {
+            SimTiming t = { 0 };
+
+            run(p, &t);
+            sim_keep_best(&best[p], &t);
+        }
+    vTaskPrioritySet(NULL, CONTROL);
+
+    printf("test-isr-events: from the ISR's call to the waiter running, ns\n");
+    for (enum Path p = NOTIFY; p <= EVENT_GROUP; ++p)
+        sim_report(name[p], &best[p]);
+
+    vTaskDelete(d);
+    vQueueDelete(gl_daemon_queue);
+    vEventGroupDelete(gl_group);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    no_wait();
+    arming();
+    every_slot();
+    timeouts();
+    stray_notifications();
+    from_isr();
+    latency();
+    printf("test-isr-events: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
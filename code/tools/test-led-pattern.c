@@ -0,0 +1,343 @@
+/**
+   test-led-pattern: LED pattern step tables and their timing
+   (app/led-pattern-table.c), and their playback by TIM3 and DMA
+   (app/led-pattern.c), on the host simulation (tools/sim)
+
+       make check
+
+   The widget's cycle is built here as configureWidget() builds it,
+   with the breadboard LEDs of bsp.h, and every step's BSRR words and
+   write times are checked.
+
+   Then patterns are played on a model of the hardware, over the
+   device's registers mapped by sim_map_device(): TIM3 counts from
+   its prescaler and auto-reload, its update event has DMA1 channel 3
+   copy the next word to GPIOA->BSRR and its compare 1 event has
+   channel 6 copy one to GPIOB->BSRR, and channel 3's transfer
+   complete calls DMA1_Channel3_IRQHandler().  Each BSRR write is
+   recorded with its time, which must be the step times of the
+   pattern; nothing here uses led_pattern_edge().
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "semphr.h"
+#include "led-pattern.h"
+
+#define A LED_PATTERN_PORT_A
+#define B LED_PATTERN_PORT_B
+
+// the breadboard LEDs, see bsp.h
+#define RED     B, 10u
+#define YELLOW  A, 8u
+#define GREEN   A, 9u
+#define BLUE    B, 6u
+
+#define SET(pin)    (1u << (pin))
+#define RESET(pin)  (1u << ((pin) + 16u))
+
+static void widget_cycle(void) {
+    LedPattern p;
+
+    led_pattern_init(&p, 500);
+    led_pattern_set_pin(&p, RED, true);
+    CHECK(led_pattern_add_step(&p));
+    led_pattern_set_pin(&p, RED, false);
+    CHECK(led_pattern_add_step(&p));
+    led_pattern_set_pin(&p, YELLOW, true);
+    CHECK(led_pattern_add_step(&p));
+    led_pattern_set_pin(&p, YELLOW, false);
+    CHECK(led_pattern_add_step(&p));
+    led_pattern_set_pin(&p, GREEN, true);
+    CHECK(led_pattern_add_step(&p));
+    led_pattern_set_pin(&p, GREEN, false);
+    CHECK(led_pattern_add_step(&p));
+    led_pattern_set_pin(&p, BLUE, true);
+    CHECK(led_pattern_add_step(&p));
+    led_pattern_set_pin(&p, BLUE, false);
+    CHECK(led_pattern_add_step(&p));
+
+    static uint32_t const bsrr_a[9] = {
+        0u, 0u, SET(8), RESET(8), SET(9), RESET(9), 0u, 0u, 0u,
+    };
+    static uint32_t const bsrr_b[9] = {
+        SET(10), RESET(10), 0u, 0u, 0u, 0u, SET(6), RESET(6), 0u,
+    };
+
+    CHECK(p.steps == 9u);
+    for (unsigned i = 0; i < 9u; ++i) {
+        CHECK(p.bsrr_a[i] == bsrr_a[i]);
+        CHECK(p.bsrr_b[i] == bsrr_b[i]);
+    }
+
+    // 500 ms is 5000 counts: TIM3's ARR 4999 and CCR1 4999
+    CHECK(led_pattern_period_counts(&p) == 5000u);
+    CHECK(led_pattern_compare_count(&p) == 4999u);
+
+    // step i at i x 500 ms, GPIOB one count (100 us) ahead of GPIOA
+    CHECK(led_pattern_edge(&p, 0, A) == 0u);
+    CHECK(led_pattern_edge(&p, 0, B) == 0u);
+    for (unsigned i = 1; i < 9u; ++i) {
+        CHECK(led_pattern_edge(&p, i, A) == i * 5000u);
+        CHECK(led_pattern_edge(&p, i, B) == i * 5000u - 1u);
+    }
+}
+
+// within a step the last change of a pin wins, and BSRR never gets
+// both its set and reset bit
+static void latest_change_wins(void) {
+    LedPattern p;
+
+    led_pattern_init(&p, 1);
+    led_pattern_set_pin(&p, A, 3, true);
+    led_pattern_set_pin(&p, A, 3, false);
+    CHECK(p.bsrr_a[0] == RESET(3));
+    led_pattern_set_pin(&p, A, 3, true);
+    CHECK(p.bsrr_a[0] == SET(3));
+
+    led_pattern_set_pin(&p, A, 15, false);
+    led_pattern_set_pin(&p, B, 0, true);
+    CHECK(p.bsrr_a[0] == (SET(3) | RESET(15)));
+    CHECK(p.bsrr_b[0] == SET(0));
+}
+
+static void limits(void) {
+    LedPattern p;
+
+    // the shortest period, and the longest TIM3's 16 bits allow
+    led_pattern_init(&p, 1);
+    CHECK(led_pattern_period_counts(&p) == 10u);
+    CHECK(led_pattern_compare_count(&p) == 9u);
+    led_pattern_init(&p, 6553);
+    CHECK(led_pattern_period_counts(&p) - 1u <= 0xffffu);
+
+    // a full table, whose last step's time still fits 32 bits
+    for (unsigned i = 1; i < LED_PATTERN_MAX_STEPS; ++i)
+        CHECK(led_pattern_add_step(&p));
+    CHECK(!led_pattern_add_step(&p));
+    CHECK(p.steps == LED_PATTERN_MAX_STEPS);
+    CHECK(led_pattern_edge(&p, LED_PATTERN_MAX_STEPS - 1u, A)
+          == (LED_PATTERN_MAX_STEPS - 1u) * 65530u);
+
+    // a new step changes no pins
+    led_pattern_init(&p, 10);
+    led_pattern_set_pin(&p, B, 6, true);
+    CHECK(led_pattern_add_step(&p));
+    CHECK(p.bsrr_a[1] == 0u && p.bsrr_b[1] == 0u);
+}
+
+// playback
+
+void DMA1_Channel3_IRQHandler(void);
+
+// register bits led_pattern_play() is expected to set
+#define CEN         (1u << 0)       // TIM3 CR1
+#define UG          (1u << 0)       // TIM3 EGR
+#define UDE         (1u << 8)       // TIM3 DIER
+#define CC1DE       (1u << 9)
+#define CCR_EN      (1u << 0)       // DMA channel CCR
+#define CCR_TCIE    (1u << 1)
+#define CCR_DIR     (1u << 4)       // memory to peripheral
+#define CCR_MINC    (1u << 7)
+#define CCR_32BIT   ((2u << 8) | (2u << 10))
+
+typedef struct {
+    DMA_Channel_TypeDef * regs;
+    unsigned n;                 // channel number, 1..7
+    void (* isr)(void);         // its handler, if the model has one
+    uint32_t mem;               // current memory address
+} Channel;
+
+typedef struct {
+    uint32_t us;                // since playback started
+    uint32_t port;              // GPIOA_BASE or GPIOB_BASE
+    uint32_t word;
+} Write;
+
+static Write gl_writes[2u * LED_PATTERN_MAX_STEPS];
+static unsigned gl_nwrites;
+
+// one transfer, requested by a timer event at `us`
+static void transfer(Channel * c, uint32_t us) {
+    uint32_t word;
+
+    if ((c->regs->CCR & CCR_EN) == 0u || c->regs->CNDTR == 0u)
+        return;
+    word = *(uint32_t volatile *)(uintptr_t)c->mem;
+    *(uint32_t volatile *)(uintptr_t)c->regs->CPAR = word;
+    CHECK(gl_nwrites < 2u * LED_PATTERN_MAX_STEPS);
+    gl_writes[gl_nwrites++] = (Write){
+        us, c->regs->CPAR - (uint32_t)offsetof(GPIO_TypeDef, BSRR), word };
+    c->mem += 4u;
+
+    if (--c->regs->CNDTR == 0u) {
+        DMA1->ISR |= 0x3u << (4u * (c->n - 1u));       // TCIF, GIF
+        if (c->regs->CCR & CCR_TCIE) {
+            CHECK(c->isr != NULL);
+            CHECK(NVIC->ISER[0] & (1u << (DMA1_Channel1_IRQn + c->n - 1u)));
+            c->isr();
+        }
+    }
+}
+
+/* Run TIM3 and the two channels, from the state led_pattern_play()
+   left them in, until TIM3 is stopped. */
+static void run_hardware(void) {
+    Channel a = { DMA1_Channel3, 3, DMA1_Channel3_IRQHandler, 0 };
+    Channel b = { DMA1_Channel6, 6, NULL, 0 };
+    uint32_t const us_per_count = (TIM3->PSC + 1u) / (configCPU_CLOCK_HZ
+                                                      / 1000000u);
+
+    // enabling a channel loads its memory address, UG clears the counter
+    a.mem = a.regs->CMAR;
+    b.mem = b.regs->CMAR;
+    CHECK(TIM3->EGR & UG);
+    TIM3->CNT = 0u;
+
+    for (uint32_t count = 1; TIM3->CR1 & CEN; ++count) {
+        CHECK(count <= (LED_PATTERN_MAX_STEPS + 1u) * 0x10000u);
+        TIM3->CNT = (TIM3->CNT == TIM3->ARR) ? 0u : TIM3->CNT + 1u;
+        if (TIM3->CNT == 0u && (TIM3->DIER & UDE))
+            transfer(&a, count * us_per_count);
+        if (TIM3->CNT == TIM3->CCR1 && (TIM3->DIER & CC1DE))
+            transfer(&b, count * us_per_count);
+    }
+}
+
+static void check_setup(LedPattern const * p) {
+    uint32_t const ccr = CCR_32BIT | CCR_MINC | CCR_DIR | CCR_EN;
+
+    CHECK(DMA1_Channel3->CPAR == (uint32_t)(uintptr_t)&GPIOA->BSRR);
+    CHECK(DMA1_Channel3->CMAR == (uint32_t)(uintptr_t)&p->bsrr_a[1]);
+    CHECK(DMA1_Channel3->CNDTR == p->steps - 1u);
+    CHECK((DMA1_Channel3->CCR & ~(3u << 12)) == (ccr | CCR_TCIE));
+    CHECK(DMA1_Channel6->CPAR == (uint32_t)(uintptr_t)&GPIOB->BSRR);
+    CHECK(DMA1_Channel6->CMAR == (uint32_t)(uintptr_t)&p->bsrr_b[1]);
+    CHECK(DMA1_Channel6->CNDTR == p->steps - 1u);
+    CHECK((DMA1_Channel6->CCR & ~(3u << 12)) == ccr);
+
+    // 10 kHz counts; the period's last count is the compare
+    CHECK(TIM3->PSC == 7199u);
+    CHECK(TIM3->ARR == p->period_ms * 10u - 1u);
+    CHECK(TIM3->CCR1 == TIM3->ARR);
+    CHECK(TIM3->DIER == (UDE | CC1DE));
+    CHECK(TIM3->CR1 == CEN);
+}
+
+/* Play `p`, which lies in the device's SRAM: step i must reach GPIOA
+   at i periods and GPIOB 100 us (one count) earlier, each once, and
+   the engine be idle after the last. */
+static void play(LedPattern const * p) {
+    uint32_t const period_us = p->period_ms * 1000u;
+
+    memset((void *)(uintptr_t)GPIOA_BASE, 0, sizeof(GPIO_TypeDef));
+    memset((void *)(uintptr_t)GPIOB_BASE, 0, sizeof(GPIO_TypeDef));
+    gl_nwrites = 0;
+
+    CHECK(led_pattern_play(p));
+    CHECK(GPIOA->BSRR == p->bsrr_a[0] && GPIOB->BSRR == p->bsrr_b[0]);
+    CHECK(!led_pattern_wait(0));
+    CHECK(!led_pattern_play(p));
+    check_setup(p);
+
+    run_hardware();
+
+    CHECK(gl_nwrites == 2u * (p->steps - 1u));
+    for (unsigned i = 1; i < p->steps; ++i) {
+        Write const * b = &gl_writes[2u * (i - 1u)];
+        Write const * a = b + 1;
+
+        CHECK(b->port == GPIOB_BASE && b->word == p->bsrr_b[i]);
+        CHECK(b->us == i * period_us - 100u);
+        CHECK(a->port == GPIOA_BASE && a->word == p->bsrr_a[i]);
+        CHECK(a->us == i * period_us);
+    }
+    CHECK(GPIOA->BSRR == p->bsrr_a[p->steps - 1u]);
+    CHECK(GPIOB->BSRR == p->bsrr_b[p->steps - 1u]);
+
+    // the handler stopped everything, and playback is over
+    CHECK(TIM3->CR1 == 0u && TIM3->DIER == 0u);
+    CHECK(DMA1_Channel3->CCR == 0u && DMA1_Channel6->CCR == 0u);
+    CHECK(DMA1->IFCR == 0xfu << 8);
+    CHECK(led_pattern_wait(0));
+}
+
+static void playback(void) {
+    // in SRAM, as the DMA channels only take 32-bit addresses
+    LedPattern * p = (LedPattern *)(uintptr_t)SRAM_BASE;
+
+    led_pattern_engine_init();
+    CHECK(BITBAND(RCC->AHBENR, 0) == 1u && BITBAND(RCC->APB1ENR, 1) == 1u);
+    CHECK(NVIC->ISER[0] == 1u << DMA1_Channel3_IRQn);
+    CHECK(NVIC->IP[DMA1_Channel3_IRQn] == 0xf0u);
+    CHECK(led_pattern_wait(0));
+
+    // the widget's cycle
+    led_pattern_init(p, 500);
+    led_pattern_set(p, LED_RED, true);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_RED, false);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_YELLOW, true);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_YELLOW, false);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_GREEN, true);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_GREEN, false);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_BLUE, true);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_BLUE, false);
+    CHECK(led_pattern_add_step(p));
+    play(p);
+    play(p);                    // again, from where the last left things
+
+    // a full table at the shortest and the longest period
+    for (unsigned ms = 1; ms <= 6553u; ms += 6552u) {
+        led_pattern_init(p, ms);
+        for (unsigned i = 1; i < LED_PATTERN_MAX_STEPS; ++i) {
+            CHECK(led_pattern_add_step(p));
+            led_pattern_set_pin(p, A, i, true);
+            led_pattern_set_pin(p, B, i, (i & 1u) != 0u);
+        }
+        play(p);
+    }
+
+    // two steps: one transfer per channel, the last at once
+    led_pattern_init(p, 20);
+    led_pattern_set(p, LED_USER, true);
+    CHECK(led_pattern_add_step(p));
+    led_pattern_set(p, LED_USER, false);
+    play(p);
+
+    // one step: written at once, and nothing started
+    DMA1_Channel3->CNDTR = 7u;
+    led_pattern_init(p, 500);
+    led_pattern_set(p, LED_BLUE, true);
+    CHECK(led_pattern_play(p));
+    CHECK(GPIOB->BSRR == SET(6));
+    CHECK(led_pattern_wait(0));
+    CHECK(TIM3->CR1 == 0u && DMA1_Channel3->CCR == 0u);
+    CHECK(DMA1_Channel3->CNDTR == 7u);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    widget_cycle();
+    latest_change_wins();
+    limits();
+    playback();
+    printf("test-led-pattern: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    sim_map_device();
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      1, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
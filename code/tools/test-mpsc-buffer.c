@@ -0,0 +1,350 @@
+/**
+   test-mpsc-buffer: the many-writer stream buffer (app/mpsc-buffer.c)
+   on the host simulation (tools/sim)
+
+       make check
+
+   The simulation never preempts a task, so a writer caught between
+   reserving its space and publishing it is played out with the
+   file's own reserve() and publish(), with other tasks running in
+   between.  Four producers of mixed priorities then write numbered
+   records with random yields, ticks and such pauses, and the reader
+   checks every record arrives whole and in each producer's order.
+
+   Last, a contention benchmark: 1..8 writers send 16-byte records,
+   one in four pausing mid-write as if preempted, through the buffer
+   and through a kernel stream buffer guarded by a mutex.  It prints
+   host nanoseconds per record and how often a writer had to block on
+   the mutex; the figures only compare the two.
+ */
+
+#include "sim.h"
+#include "task.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "mpsc-buffer.c"
+
+enum { CONTROL = 4, READER = 3, HIGH = 2, LOW = 1 };
+
+static uint8_t gl_storage[512] __attribute__((aligned(4)));
+static MpscBuffer gl_b;
+
+static uint32_t gl_random = 1u;
+
+static unsigned random_below(unsigned n) {
+    gl_random = gl_random * 1103515245u + 12345u;
+    return (gl_random >> 16) % n;
+}
+
+// what mpsc_receive() returns with nothing to wait for
+static size_t drain(void * out, size_t max) {
+    return mpsc_receive(&gl_b, out, max, 0);
+}
+
+// records of 1..13 bytes, read back a few bytes at a time, wrapping
+// the 64-byte storage many times over
+static void order_and_wrap(void) {
+    uint8_t sent = 0u, expect = 0u;
+
+    mpsc_init(&gl_b, gl_storage, 64);
+    for (unsigned round = 0; round < 200u; ++round) {
+        uint8_t msg[13];
+        size_t n = 1u + round % 13u;
+
+        for (size_t i = 0; i < n; ++i)
+            msg[i] = sent++;
+        CHECK(mpsc_send(&gl_b, msg, n) == n);
+
+        uint8_t got[5];
+        size_t k;
+        while ((k = drain(got, 1u + round % 5u)) != 0u)
+            for (size_t i = 0; i < k; ++i)
+                CHECK(got[i] == expect++);
+        CHECK(expect == sent);
+    }
+    CHECK(gl_b.reserve > 10u * 64u);
+}
+
+static void full(void) {
+    uint8_t msg[28] = { 0 }, got[28];
+
+    mpsc_init(&gl_b, gl_storage, 32);
+    CHECK(mpsc_send(&gl_b, msg, 0) == 0u);
+    CHECK(mpsc_send(&gl_b, msg, 29) == 0u);
+    CHECK(mpsc_send(&gl_b, msg, 28) == 28u);
+    CHECK(mpsc_send(&gl_b, msg, 1) == 0u);
+
+    // space comes back only once the whole record is read
+    CHECK(drain(got, 10) == 10u);
+    CHECK(mpsc_send(&gl_b, msg, 1) == 0u);
+    CHECK(drain(got, sizeof got) == 18u);
+    CHECK(mpsc_send(&gl_b, msg, 1) == 1u);
+    CHECK(drain(got, sizeof got) == 1u);
+    CHECK(drain(got, sizeof got) == 0u);
+}
+
+// a later writer publishes first: the reader waits for the earlier
+static void unfinished_writer(void) {
+    uint32_t pos;
+    char got[16];
+
+    mpsc_init(&gl_b, gl_storage, 64);
+    CHECK(reserve(&gl_b, 5, &pos));
+    CHECK(mpsc_send(&gl_b, "later", 5) == 5u);
+    CHECK(drain(got, sizeof got) == 0u);
+
+    publish(&gl_b, pos, "first", 5);
+    CHECK(drain(got, sizeof got) == 10u);
+    CHECK(memcmp(got, "firstlater", 10) == 0);
+}
+
+typedef struct {
+    TickType_t wait;
+    size_t got;
+    char data[8];
+} Reader;
+
+static void reader(void * arg) {
+    Reader * r = arg;
+
+    r->got = mpsc_receive(&gl_b, r->data, sizeof r->data, r->wait);
+    vTaskDelete(NULL);
+}
+
+static void reader_wakes(void) {
+    Reader r = { portMAX_DELAY, 99u, { 0 } };
+
+    mpsc_init(&gl_b, gl_storage, 64);
+    CHECK(xTaskCreate(reader, "reader", configMINIMAL_STACK_SIZE, &r,
+                      READER, NULL) == pdPASS);
+    vTaskDelay(5);
+    CHECK(r.got == 99u && gl_b.reader != NULL);
+
+    // the send readies the reader, which then reads it all
+    CHECK(mpsc_send(&gl_b, "abc", 3) == 3u);
+    vTaskDelay(1);
+    CHECK(r.got == 3u && memcmp(r.data, "abc", 3) == 0);
+    CHECK(gl_b.reader == NULL);
+
+    Reader t = { 10, 99u, { 0 } };
+    CHECK(xTaskCreate(reader, "reader", configMINIMAL_STACK_SIZE, &t,
+                      READER, NULL) == pdPASS);
+    vTaskDelay(9);
+    CHECK(t.got == 99u);
+    vTaskDelay(2);
+    CHECK(t.got == 0u && gl_b.reader == NULL);
+}
+
+// four producers
+
+#define PRODUCERS 4u
+#define RECORDS 300u            // per producer
+
+typedef struct {
+    uint8_t id;
+    uint8_t len;                // of the filler that follows
+    uint16_t seq;
+} Record;
+
+static TaskHandle_t gl_control;
+static unsigned gl_done;
+
+// send a record of `n` bytes, pausing between reserve and publish if
+// `preempted`, and retrying while the buffer is full
+static void send_record(void const * data, size_t n, bool preempted) {
+    uint32_t pos;
+
+    while (!reserve(&gl_b, n, &pos))
+        vTaskDelay(1);
+    if (preempted) {
+        if (random_below(2) == 0u)
+            taskYIELD();
+        else
+            vTaskDelay(1);
+    }
+    publish(&gl_b, pos, data, n);
+    if (gl_b.reader != NULL)
+        xTaskNotifyGive(gl_b.reader);
+}
+
+static void producer(void * arg) {
+    uint8_t id = (uint8_t)(uintptr_t)arg;
+    uint8_t msg[sizeof(Record) + 24u];
+
+    for (uint16_t seq = 0; seq < RECORDS; ++seq) {
+        Record r = { id, (uint8_t)random_below(25), seq };
+
+        memcpy(msg, &r, sizeof r);
+        for (unsigned i = 0; i < r.len; ++i)
+            msg[sizeof r + i] = (uint8_t)(id + seq + i);
+
+        // a quarter pause mid-write, the rest send whole
+        size_t n = sizeof r + r.len;
+        if (random_below(4) == 0u)
+            send_record(msg, n, true);
+        else if (mpsc_send(&gl_b, msg, n) == 0u)
+            send_record(msg, n, false);     // full: wait for room
+
+        switch (random_below(5)) {
+        case 0: taskYIELD(); break;
+        case 1: vTaskDelay(1); break;
+        case 2: sim_tick(1); break;
+        default: break;
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+// read exactly n bytes of the stream
+static void read_exactly(uint8_t * out, size_t n) {
+    while (n != 0u) {
+        size_t got = mpsc_receive(&gl_b, out, n, portMAX_DELAY);
+
+        out += got;
+        n -= got;
+    }
+}
+
+static void consumer(void * arg) {
+    uint16_t next[PRODUCERS] = { 0 };
+
+    (void) arg;
+    for (unsigned i = 0; i < PRODUCERS * RECORDS; ++i) {
+        Record r;
+        uint8_t filler[24];
+
+        read_exactly((uint8_t *)&r, sizeof r);
+        CHECK(r.id < PRODUCERS && r.len <= sizeof filler);
+        CHECK(r.seq == next[r.id]++);
+        read_exactly(filler, r.len);
+        for (unsigned k = 0; k < r.len; ++k)
+            CHECK(filler[k] == (uint8_t)(r.id + r.seq + k));
+    }
+    CHECK(gl_b.tail == gl_b.reserve);
+    gl_done = 1u;
+    xTaskNotifyGive(gl_control);
+    vTaskDelete(NULL);
+}
+
+static void four_producers(void) {
+    mpsc_init(&gl_b, gl_storage, 128);
+    gl_done = 0u;
+    CHECK(xTaskCreate(consumer, "consumer", configMINIMAL_STACK_SIZE, NULL,
+                      LOW, NULL) == pdPASS);
+    for (unsigned i = 0; i < PRODUCERS; ++i)
+        CHECK(xTaskCreate(producer, "producer", configMINIMAL_STACK_SIZE,
+                          (void *)(uintptr_t)i, (i % 2u) ? HIGH : LOW,
+                          NULL) == pdPASS);
+    (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    CHECK(gl_done == 1u);
+}
+
+// contention benchmark
+
+#define BENCH_RECORDS 2000u     // per run, shared among the writers
+#define BENCH_BYTES 16u
+
+static StreamBufferHandle_t gl_stream;
+static SemaphoreHandle_t gl_lock;
+static bool gl_locked;          // writers use gl_stream and gl_lock
+static unsigned gl_writers, gl_blocked;
+
+static void bench_writer(void * arg) {
+    uint8_t msg[BENCH_BYTES] = { 0 };
+    unsigned count = BENCH_RECORDS / gl_writers;
+
+    (void) arg;
+    for (unsigned i = 0; i < count; ++i) {
+        bool preempted = (i % 4u) == 3u;
+
+        if (!gl_locked) {
+            send_record(msg, sizeof msg, preempted);
+            continue;
+        }
+        if (xSemaphoreGetMutexHolder(gl_lock) != NULL)
+            gl_blocked++;
+        CHECK(xSemaphoreTake(gl_lock, portMAX_DELAY) == pdTRUE);
+        if (preempted)
+            taskYIELD();
+        while (xStreamBufferSend(gl_stream, msg, sizeof msg, 0) == 0u)
+            vTaskDelay(1);
+        xSemaphoreGive(gl_lock);
+    }
+    vTaskDelete(NULL);
+}
+
+static void bench_reader(void * arg) {
+    uint8_t buf[64];
+    unsigned left = (BENCH_RECORDS / gl_writers) * gl_writers * BENCH_BYTES;
+
+    (void) arg;
+    while (left != 0u)
+        left -= gl_locked
+            ? xStreamBufferReceive(gl_stream, buf, sizeof buf, portMAX_DELAY)
+            : mpsc_receive(&gl_b, buf, sizeof buf, portMAX_DELAY);
+    xTaskNotifyGive(gl_control);
+    vTaskDelete(NULL);
+}
+
+// host ns per record with `writers` writers
+static double bench(unsigned writers, bool locked) {
+    SimTiming best = { 0 };
+
+    gl_writers = writers;
+    gl_locked = locked;
+    gl_blocked = 0u;
+    for (unsigned run = 0; run < 3u; ++run) {
+        SimTiming t = { 0 };
+
+        mpsc_init(&gl_b, gl_storage, sizeof gl_storage);
+        xStreamBufferReset(gl_stream);
+        uint64_t start = sim_host_ns();
+        CHECK(xTaskCreate(bench_reader, "reader", configMINIMAL_STACK_SIZE,
+                          NULL, READER, NULL) == pdPASS);
+        for (unsigned i = 0; i < writers; ++i)
+            CHECK(xTaskCreate(bench_writer, "writer",
+                              configMINIMAL_STACK_SIZE, NULL, HIGH,
+                              NULL) == pdPASS);
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        sim_timed(&t, start);
+        sim_keep_best(&best, &t);
+        vTaskDelay(1);          // let the idle task free the tasks
+    }
+    return (double)best.total / (BENCH_RECORDS / writers * writers);
+}
+
+static void contention(void) {
+    gl_stream = xStreamBufferCreate(sizeof gl_storage, 1);
+    gl_lock = xSemaphoreCreateMutex();
+    CHECK(gl_stream != NULL && gl_lock != NULL);
+
+    printf("test-mpsc-buffer: %u-byte records, ns per record\n"
+           "  writers  mpsc  mutex+stream  blocked on mutex\n", BENCH_BYTES);
+    for (unsigned n = 1; n <= 8u; n *= 2u) {
+        double lock_free = bench(n, false);
+        double locked = bench(n, true);
+
+        printf("  %7u  %4.0f  %12.0f  %16u\n", n, lock_free, locked,
+               gl_blocked / 3u);
+    }
+}
+
+static void control(void * arg) {
+    (void) arg;
+    gl_control = xTaskGetCurrentTaskHandle();
+    order_and_wrap();
+    full();
+    unfinished_writer();
+    reader_wakes();
+    four_producers();
+    contention();
+    printf("test-mpsc-buffer: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+   test-pbuf: buffer chain splitting, sharing and pool accounting
+   (app/pbuf.c) on the host
+
+       make check
+
+   Every chain is compared byte for byte with a flat copy of what it
+   should hold, and the pool count is checked after each free.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "pbuf.h"
+
+#define SEG PBUF_SEGMENT_SIZE
+
+// fill the chain with 0, 1, 2, ... from `first`
+static void fill(Pbuf * p, uint8_t first) {
+    for (; p != NULL; p = p->next)
+        for (unsigned i = 0; i < p->len; ++i)
+            p->payload[i] = first++;
+}
+
+// the chain's tot_len fields are consistent, and it holds `len`
+// bytes counting up from `first`
+static void check_chain(Pbuf const * p, size_t len, uint8_t first) {
+    uint8_t flat[PBUF_POOL_SIZE * SEG];
+    size_t left = len;
+
+    CHECK(p->tot_len == len);
+    for (Pbuf const * q = p; q != NULL; q = q->next) {
+        CHECK(q->tot_len == left);
+        left -= q->len;
+    }
+    CHECK(left == 0u);
+
+    CHECK(pbuf_copy_out(p, 0, flat, sizeof flat) == len);
+    for (size_t i = 0; i < len; ++i)
+        CHECK(flat[i] == (uint8_t)(first + i));
+}
+
+static unsigned segments(Pbuf const * p) {
+    unsigned n = 0u;
+    for (; p != NULL; p = p->next)
+        n++;
+    return n;
+}
+
+static void split_at_boundary(void) {
+    Pbuf * p = pbuf_alloc(3 * SEG, 0);
+
+    CHECK(p != NULL && segments(p) == 3u);
+    fill(p, 0);
+
+    // no reference segment is needed: the pool is untouched
+    Pbuf * rest = pbuf_split(p, SEG);
+    CHECK(rest != NULL);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE - 3u);
+    CHECK(segments(p) == 1u && segments(rest) == 2u);
+    CHECK(rest->owner == NULL);
+    check_chain(p, SEG, 0);
+    check_chain(rest, 2 * SEG, SEG);
+
+    pbuf_free(p);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE - 2u);
+    pbuf_free(rest);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE);
+}
+
+static void split_inside_segment(void) {
+    Pbuf * p = pbuf_alloc(2 * SEG, 0);
+    size_t cut = SEG + 10u;
+
+    CHECK(p != NULL);
+    fill(p, 0);
+
+    Pbuf * rest = pbuf_split(p, cut);
+    CHECK(rest != NULL);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE - 3u);
+    check_chain(p, cut, 0);
+    check_chain(rest, 2 * SEG - cut, (uint8_t)cut);
+
+    // the reference segment shares the second segment's storage
+    Pbuf * second = p->next;
+    CHECK(rest->owner == second && second->refs == 2u);
+    CHECK(rest->payload == second->payload + 10u);
+
+    // a cut inside the reference segment points at the same owner
+    Pbuf * last = pbuf_split(rest, 5);
+    CHECK(last != NULL && last->owner == second && second->refs == 3u);
+    check_chain(rest, 5, (uint8_t)cut);
+    check_chain(last, 2 * SEG - cut - 5u, (uint8_t)(cut + 5u));
+
+    // the owner outlives the chain it came from
+    pbuf_free(p);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE - 3u);
+    check_chain(last, 2 * SEG - cut - 5u, (uint8_t)(cut + 5u));
+    pbuf_free(rest);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE - 2u);
+    pbuf_free(last);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE);
+}
+
+// a segment referenced from elsewhere keeps the rest of the chain
+// alive until that reference is dropped
+static void free_with_shared_middle(void) {
+    Pbuf * p = pbuf_alloc(3 * SEG, 0);
+
+    CHECK(p != NULL);
+    fill(p, 0);
+    Pbuf * middle = p->next;
+    pbuf_ref(middle);
+
+    pbuf_free(p);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE - 2u);
+    CHECK(middle->refs == 1u);
+    check_chain(middle, 2 * SEG, SEG);
+
+    pbuf_free(middle);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE);
+}
+
+static void cat_and_header(void) {
+    Pbuf * head = pbuf_alloc(10, 4);
+    Pbuf * tail = pbuf_alloc(SEG, 0);
+
+    CHECK(head != NULL && tail != NULL);
+    fill(head, 4);
+    fill(tail, 14);
+    pbuf_cat(head, tail);
+    check_chain(head, 10 + SEG, 4);
+
+    uint8_t * h = pbuf_push_header(head, 4);
+    CHECK(h != NULL && pbuf_push_header(head, 1) == NULL);
+    for (uint8_t i = 0; i < 4; ++i)
+        h[i] = i;
+    check_chain(head, 14 + SEG, 0);
+
+    PbufIov iov[2];
+    CHECK(pbuf_gather(head, iov, 2) == 2u);
+    CHECK(iov[0].addr == h && iov[0].len == 14u && iov[1].len == SEG);
+    CHECK(pbuf_gather(head, iov, 1) == 0u);
+
+    CHECK(pbuf_pull_header(head, 4));
+    check_chain(head, 10 + SEG, 4);
+
+    pbuf_free(head);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE);
+}
+
+static void pool_exhaustion(void) {
+    Pbuf * all = pbuf_alloc(PBUF_POOL_SIZE * SEG, 0);
+
+    CHECK(all != NULL && pbuf_pool_free() == 0u);
+    CHECK(pbuf_alloc(1, 0) == NULL);
+
+    // a split needing a reference segment fails and changes nothing
+    fill(all, 0);
+    CHECK(pbuf_split(all, 1) == NULL);
+    check_chain(all, PBUF_POOL_SIZE * SEG, 0);
+    pbuf_free(all);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE);
+
+    // a chain that cannot be completed gives back what it took
+    Pbuf * one = pbuf_alloc(SEG, 0);
+    CHECK(pbuf_alloc(PBUF_POOL_SIZE * SEG, 0) == NULL);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE - 1u);
+    pbuf_free(one);
+    CHECK(pbuf_pool_free() == PBUF_POOL_SIZE);
+}
+
+int main(void) {
+    split_at_boundary();
+    split_inside_segment();
+    free_with_shared_middle();
+    cat_and_header();
+    pool_exhaustion();
+    printf("test-pbuf: ok\n");
+    return 0;
+}
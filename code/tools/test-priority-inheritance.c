@@ -0,0 +1,378 @@
+/**
+   test-priority-inheritance: the priority a task keeps while it holds
+   several locks (xTaskPriorityDisinheritLock() and
+   prvGetHeldLocksPriority() in FreeRTOS-Kernel/tasks.c) on the host
+   simulation (tools/sim)
+
+       make check
+
+   A task holding two mutexes, with a task waiting on each, drops to
+   the priority of the waiter that remains whichever mutex it gives
+   first, and when a waiter times out.  The same holds for a mutex and
+   a reader-writer lock held for writing.  A lock counted with
+   pvTaskIncrementMutexHeldCount() has waiters the kernel cannot see,
+   so while one is held the task keeps what it has inherited, until it
+   holds nothing.
+
+   Then it prints how many ticks a high priority task is blocked, and
+   the critical sections in its way, when the lock it wants is held by
+   a task that itself waits for a lock held by a low priority one, with
+   a busy task between them.  Inheritance goes one level down the
+   chain only, as in upstream FreeRTOS, so a busy task at the middle
+   priority shares the processor with the low one in the meantime.
+ */
+
+#include "sim.h"
+#include "task.h"
+#include "semphr.h"
+#include "rwlock.h"
+
+enum { CONTROL = 2, LOW = 1, MID = 3, HIGH = 4 };
+
+// the locks, and a lock counted as held but not registered
+
+enum Lock { M0, M1, RW, LEGACY };
+
+static SemaphoreHandle_t gl_mutex[2];
+static RWLockHandle_t gl_rwlock;
+
+static void legacy_take(void) {
+    (void) pvTaskIncrementMutexHeldCount();
+}
+
+static void legacy_give(void) {
+    BaseType_t yield;
+
+    taskENTER_CRITICAL();
+    yield = xTaskPriorityDisinherit(xTaskGetCurrentTaskHandle());
+    taskEXIT_CRITICAL();
+    if (yield)
+        taskYIELD();
+}
+
+static BaseType_t take(enum Lock lock, TickType_t ticks) {
+    switch (lock) {
+    case M0:
+    case M1:
+        return xSemaphoreTake(gl_mutex[lock], ticks);
+    case RW:
+        return xRWLockTakeWrite(gl_rwlock, ticks);
+    default:
+        legacy_take();
+        return pdTRUE;
+    }
+}
+
+static void give(enum Lock lock) {
+    switch (lock) {
+    case M0:
+    case M1:
+        CHECK(xSemaphoreGive(gl_mutex[lock]) == pdTRUE);
+        break;
+    case RW:
+        vRWLockGiveWrite(gl_rwlock);
+        break;
+    default:
+        legacy_give();
+        break;
+    }
+}
+
+// a task that takes or gives a lock when told to
+
+enum Op { TAKE, READ, GIVE, GIVE_READ };
+
+typedef struct {
+    TaskHandle_t task;
+    enum Op op;
+    enum Lock lock;
+    TickType_t ticks;
+    BaseType_t volatile result;         // -1 while waiting
+} Actor;
+
+static void actor(void * arg) {
+    Actor * a = arg;
+
+    for (;;) {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        switch (a->op) {
+        case TAKE:
+            a->result = take(a->lock, a->ticks);
+            break;
+        case READ:
+            a->result = xRWLockTakeRead(gl_rwlock, a->ticks);
+            break;
+        case GIVE:
+            give(a->lock);
+            a->result = pdTRUE;
+            break;
+        case GIVE_READ:
+            vRWLockGiveRead(gl_rwlock);
+            a->result = pdTRUE;
+            break;
+        }
+    }
+}
+
+static Actor gl_low, gl_mid, gl_high;
+
+/* Tell `a` what to do, and let it run to its return or block: at once
+   if it is above the control task, or in the tick given to it. */
+static void tell(Actor * a, enum Op op, enum Lock lock, TickType_t ticks) {
+    a->op = op;
+    a->lock = lock;
+    a->ticks = ticks;
+    a->result = -1;
+    xTaskNotifyGive(a->task);
+    vTaskDelay(1);
+}
+
+static UBaseType_t low_priority(void) {
+    return uxTaskPriorityGet(gl_low.task);
+}
+
+// low takes both, high waits on `first` and mid on the other
+static void setup(enum Lock first, enum Lock second, TickType_t high_ticks) {
+    tell(&gl_low, TAKE, first, 0);
+    tell(&gl_low, TAKE, second, 0);
+    CHECK(gl_low.result == pdTRUE && low_priority() == LOW);
+    tell(&gl_high, TAKE, first, high_ticks);
+    CHECK(gl_high.result == -1 && low_priority() == HIGH);
+    tell(&gl_mid, TAKE, second, portMAX_DELAY);
+    CHECK(gl_mid.result == -1 && low_priority() == HIGH);
+}
+
+static void give_order(void) {
+    // the first taken given first: down to mid's priority
+    setup(M0, M1, portMAX_DELAY);
+    tell(&gl_low, GIVE, M0, 0);
+    CHECK(gl_high.result == pdTRUE && low_priority() == MID);
+    tell(&gl_low, GIVE, M1, 0);
+    CHECK(gl_mid.result == pdTRUE && low_priority() == LOW);
+    tell(&gl_high, GIVE, M0, 0);
+    tell(&gl_mid, GIVE, M1, 0);
+
+    // the last taken given first: high still waits
+    setup(M0, M1, portMAX_DELAY);
+    tell(&gl_low, GIVE, M1, 0);
+    CHECK(gl_mid.result == pdTRUE && low_priority() == HIGH);
+    tell(&gl_low, GIVE, M0, 0);
+    CHECK(gl_high.result == pdTRUE && low_priority() == LOW);
+    tell(&gl_high, GIVE, M0, 0);
+    tell(&gl_mid, GIVE, M1, 0);
+}
+
+static void timeouts(void) {
+    // high gives up on one mutex while low still holds the other
+    for (enum Lock first = M0; first <= M1; ++first) {
+        enum Lock second = first == M0 ? M1 : M0;
+
+        setup(first, second, 5);
+        vTaskDelay(5);
+        CHECK(gl_high.result == pdFALSE && low_priority() == MID);
+        tell(&gl_low, GIVE, second, 0);
+        CHECK(gl_mid.result == pdTRUE && low_priority() == LOW);
+        tell(&gl_low, GIVE, first, 0);
+        tell(&gl_mid, GIVE, second, 0);
+    }
+}
+
+static void with_rwlock(void) {
+    // high reads the lock held for writing, and times out
+    tell(&gl_low, TAKE, M0, 0);
+    tell(&gl_low, TAKE, RW, 0);
+    tell(&gl_high, READ, RW, 5);
+    tell(&gl_mid, TAKE, M0, portMAX_DELAY);
+    CHECK(low_priority() == HIGH);
+    vTaskDelay(5);
+    CHECK(gl_high.result == pdFALSE && low_priority() == MID);
+    tell(&gl_low, GIVE, M0, 0);
+    CHECK(gl_mid.result == pdTRUE && low_priority() == LOW);
+    tell(&gl_low, GIVE, RW, 0);
+    tell(&gl_mid, GIVE, M0, 0);
+
+    // high waits to write, mid for the mutex: given in either order
+    tell(&gl_low, TAKE, RW, 0);
+    tell(&gl_low, TAKE, M0, 0);
+    tell(&gl_high, TAKE, RW, portMAX_DELAY);
+    CHECK(gl_high.result == -1 && low_priority() == HIGH);
+    tell(&gl_mid, TAKE, M0, portMAX_DELAY);
+    tell(&gl_low, GIVE, RW, 0);
+    CHECK(gl_high.result == pdTRUE && low_priority() == MID);
+    tell(&gl_low, GIVE, M0, 0);
+    CHECK(gl_mid.result == pdTRUE && low_priority() == LOW);
+    tell(&gl_high, GIVE, RW, 0);
+    tell(&gl_mid, GIVE, M0, 0);
+}
+
+static void unregistered(void) {
+    // the waiters behind an unregistered lock are unknown: the priority
+    // stays up, through a timeout and a give, until nothing is held
+    tell(&gl_low, TAKE, LEGACY, 0);
+    tell(&gl_low, TAKE, M0, 0);
+    tell(&gl_high, TAKE, M0, 5);
+    CHECK(low_priority() == HIGH);
+    vTaskDelay(5);
+    CHECK(gl_high.result == pdFALSE && low_priority() == HIGH);
+    tell(&gl_low, GIVE, M0, 0);
+    CHECK(low_priority() == HIGH);
+    tell(&gl_low, GIVE, LEGACY, 0);
+    CHECK(low_priority() == LOW);
+
+    // given first, it leaves the registered mutex's waiter counted
+    tell(&gl_low, TAKE, M0, 0);
+    tell(&gl_low, TAKE, LEGACY, 0);
+    tell(&gl_mid, TAKE, M0, portMAX_DELAY);
+    CHECK(low_priority() == MID);
+    tell(&gl_low, GIVE, LEGACY, 0);
+    CHECK(low_priority() == MID);
+    tell(&gl_low, GIVE, M0, 0);
+    CHECK(gl_mid.result == pdTRUE && low_priority() == LOW);
+    tell(&gl_mid, GIVE, M0, 0);
+}
+
+// blocking ticks in a chain of locks
+
+#define LOW_WORK 10u
+#define MID_WORK 5u
+#define BUSY_WORK 100u
+
+static enum Lock gl_wanted;             // by high, held by mid or low
+static TickType_t volatile gl_blocked;
+static unsigned volatile gl_done;
+
+// run for n ticks, as code that does not block would
+static void work(unsigned n) {
+    while (n-- != 0u)
+        sim_tick(1);
+}
+
+static void chain_low(void * arg) {
+    (void) arg;
+    CHECK(take(M1, 0) == pdTRUE);
+    work(LOW_WORK);
+    give(M1);
+    gl_done++;
+    vTaskDelete(NULL);
+}
+
+static void chain_mid(void * arg) {
+    (void) arg;
+    CHECK(take(gl_wanted, 0) == pdTRUE);
+    CHECK(take(M1, portMAX_DELAY) == pdTRUE);
+    work(MID_WORK);
+    give(M1);
+    give(gl_wanted);
+    gl_done++;
+    vTaskDelete(NULL);
+}
+
+static void chain_high(void * arg) {
+    (void) arg;
+    TickType_t start = xTaskGetTickCount();
+    if (gl_wanted == RW) {
+        CHECK(xRWLockTakeRead(gl_rwlock, portMAX_DELAY) == pdTRUE);
+        gl_blocked = xTaskGetTickCount() - start;
+        vRWLockGiveRead(gl_rwlock);
+    } else {
+        CHECK(take(gl_wanted, portMAX_DELAY) == pdTRUE);
+        gl_blocked = xTaskGetTickCount() - start;
+        give(gl_wanted);
+    }
+    gl_done++;
+    vTaskDelete(NULL);
+}
+
+static void busy(void * arg) {
+    (void) arg;
+    work(BUSY_WORK);
+    gl_done++;
+    vTaskDelete(NULL);
+}
+
+// returns the ticks high was blocked
+static TickType_t chain(enum Lock wanted, BaseType_t through_mid,
+                        UBaseType_t busy_priority) {
+    unsigned tasks = through_mid ? 4u : 3u;
+
+    gl_wanted = through_mid ? wanted : M1;
+    gl_done = 0u;
+
+    // the chain is built above them all: low holds M1 and has worked
+    // two ticks, and mid, if there, holds the wanted lock and waits
+    vTaskPrioritySet(NULL, HIGH);
+    CHECK(xTaskCreate(chain_low, "low", configMINIMAL_STACK_SIZE, NULL, LOW,
+                      NULL) == pdPASS);
+    vTaskDelay(1);
+    if (through_mid)
+        CHECK(xTaskCreate(chain_mid, "mid", configMINIMAL_STACK_SIZE, NULL,
+                          MID, NULL) == pdPASS);
+    vTaskDelay(1);
+    CHECK(xTaskCreate(chain_high, "high", configMINIMAL_STACK_SIZE, NULL,
+                      HIGH, NULL) == pdPASS);
+    CHECK(xTaskCreate(busy, "busy", configMINIMAL_STACK_SIZE, NULL,
+                      busy_priority, NULL) == pdPASS);
+    vTaskPrioritySet(NULL, CONTROL);    // high runs, and blocks
+    while (gl_done != tasks)
+        vTaskDelay(1);
+    return gl_blocked;
+}
+
+static void blocking_ticks(void) {
+    static struct {
+        char const * what;
+        enum Lock wanted;
+        BaseType_t through_mid;
+    } const cases[] = {
+        { "mutex held by low", M1, pdFALSE },
+        { "mutex, mid waits on low", M0, pdTRUE },
+        { "rwlock, mid waits on low", RW, pdTRUE },
+    };
+
+    printf("test-priority-inheritance: ticks high is blocked, low holding "
+           "its lock %u ticks more, mid %u\n"
+           "  %-26s  in the way  busy at %u  busy at %u\n", LOW_WORK - 2u,
+           MID_WORK, "", CONTROL, MID);
+    for (unsigned i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+        unsigned in_way = LOW_WORK - 2u + (cases[i].through_mid ? MID_WORK : 0u);
+        TickType_t below = chain(cases[i].wanted, cases[i].through_mid, CONTROL);
+        TickType_t at_mid = chain(cases[i].wanted, cases[i].through_mid, MID);
+
+        CHECK(below == in_way && at_mid >= below);
+        printf("  %-26s  %10u  %10lu  %9lu\n", cases[i].what, in_way,
+               (unsigned long)below, (unsigned long)at_mid);
+    }
+}
+
+static void control(void * arg) {
+    (void) arg;
+    gl_mutex[0] = xSemaphoreCreateMutex();
+    gl_mutex[1] = xSemaphoreCreateMutex();
+    gl_rwlock = xRWLockCreate();
+    CHECK(gl_mutex[0] != NULL && gl_mutex[1] != NULL && gl_rwlock != NULL);
+    CHECK(xTaskCreate(actor, "low", configMINIMAL_STACK_SIZE, &gl_low, LOW,
+                      &gl_low.task) == pdPASS);
+    CHECK(xTaskCreate(actor, "mid", configMINIMAL_STACK_SIZE, &gl_mid, MID,
+                      &gl_mid.task) == pdPASS);
+    CHECK(xTaskCreate(actor, "high", configMINIMAL_STACK_SIZE, &gl_high, HIGH,
+                      &gl_high.task) == pdPASS);
+
+    give_order();
+    timeouts();
+    with_rwlock();
+    unregistered();
+    vTaskDelete(gl_low.task);
+    vTaskDelete(gl_mid.task);
+    vTaskDelete(gl_high.task);
+
+    blocking_ticks();
+    printf("test-priority-inheritance: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,276 @@
+/**
+   test-priority-queue: queues received in order of message priority,
+   xQueueCreatePriority() and xQueueCreatePriorityStatic()
+   (FreeRTOS-Kernel/queue.c), on the host simulation (tools/sim)
+
+       make check
+
+   Random sends at random priorities, to the back and to the front,
+   from tasks and ISRs, and random receives and peeks, are compared
+   with a reference list kept sorted by priority and then by sending
+   order, on queues of every length up to the limit, dynamic and
+   static.  A full queue blocks a sender until a receive makes room,
+   and an empty one a receiver until a send.
+
+   Then it prints the send latency, which is the time spent with
+   interrupts masked: a FIFO send, a priority send that moves nothing,
+   and one that moves every waiting item, at lengths 2..16.  The
+   figures are host ns, the best of three runs, and only compare.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "queue.h"
+
+enum { CONTROL = 4, OTHER = 3 };
+
+typedef struct {
+    uint32_t seq;
+    uint8_t priority;
+} Item;
+
+static uint32_t gl_random = 1u;
+
+static unsigned random_below(unsigned n) {
+    gl_random = gl_random * 1103515245u + 12345u;
+    return (gl_random >> 16) % n;
+}
+
+// the reference: highest priority first, then in sending order
+static Item gl_ref[configPRIORITY_QUEUE_MAX_LENGTH];
+static unsigned gl_count;
+
+static void ref_insert(Item item) {
+    unsigned i = gl_count++;
+
+    for (; i > 0u && gl_ref[i - 1u].priority < item.priority; --i)
+        gl_ref[i] = gl_ref[i - 1u];
+    gl_ref[i] = item;
+}
+
+static Item ref_remove(void) {
+    Item head = gl_ref[0];
+
+    memmove(&gl_ref[0], &gl_ref[1], --gl_count * sizeof gl_ref[0]);
+    return head;
+}
+
+static void check_item(Item const * got, Item const * want) {
+    CHECK(got->seq == want->seq && got->priority == want->priority);
+}
+
+static void random_ops(QueueHandle_t q, unsigned length) {
+    uint32_t seq = 0;
+
+    gl_count = 0;
+    for (unsigned op = 0; op < 20000u; ++op) {
+        unsigned what = random_below(10);
+        Item item = { 0 };
+        BaseType_t r, woken = pdFALSE;
+
+        if (what < 5u) {
+            item.seq = seq++;
+            // few priorities, so that equal ones meet often
+            item.priority = (uint8_t)(random_below(4) * 85u);
+            switch (random_below(8)) {
+            case 0:
+                item.priority = 0u;
+                r = xQueueSendToBack(q, &item, 0);
+                break;
+            case 1:
+                item.priority = 255u;
+                r = xQueueSendToFront(q, &item, 0);
+                break;
+            case 2:
+                r = xQueueSendWithPriorityFromISR(q, &item, item.priority,
+                                                  &woken);
+                break;
+            default:
+                r = xQueueSendWithPriority(q, &item, item.priority, 0);
+                break;
+            }
+            if (gl_count == length) {
+                CHECK(r == errQUEUE_FULL);
+            } else {
+                CHECK(r == pdPASS);
+                ref_insert(item);
+            }
+        } else if (what < 9u) {
+            r = xQueueReceive(q, &item, 0);
+            if (gl_count == 0u) {
+                CHECK(r == pdFAIL);
+            } else {
+                Item want = ref_remove();
+                CHECK(r == pdPASS);
+                check_item(&item, &want);
+            }
+        } else {
+            r = xQueuePeek(q, &item, 0);
+            CHECK(r == (gl_count != 0u ? pdPASS : pdFAIL));
+            if (r == pdPASS)
+                check_item(&item, &gl_ref[0]);
+        }
+        CHECK(uxQueueMessagesWaiting(q) == gl_count);
+    }
+}
+
+static void against_reference(void) {
+    static uint8_t storage[configPRIORITY_QUEUE_MAX_LENGTH * (sizeof(Item) + 1u)];
+    static StaticQueue_t control;
+
+    for (unsigned length = 1; length <= configPRIORITY_QUEUE_MAX_LENGTH;
+         ++length) {
+        QueueHandle_t q = xQueueCreatePriority(length, sizeof(Item));
+        CHECK(q != NULL);
+        random_ops(q, length);
+        vQueueDelete(q);
+
+        // the priorities follow the items in the caller's storage
+        memset(storage, 0xAA, sizeof storage);
+        q = xQueueCreatePriorityStatic(length, sizeof(Item), storage, &control);
+        CHECK(q != NULL);
+        random_ops(q, length);
+        vQueueDelete(q);
+        for (size_t i = length * (sizeof(Item) + 1u); i < sizeof storage; ++i)
+            CHECK(storage[i] == 0xAAu);
+    }
+}
+
+// blocking
+
+static QueueHandle_t gl_q;
+static Item volatile gl_got;
+static BaseType_t volatile gl_result;
+
+static void receiver(void * arg) {
+    Item item;
+
+    (void) arg;
+    gl_result = xQueueReceive(gl_q, &item, portMAX_DELAY);
+    gl_got = item;
+    vTaskDelete(NULL);
+}
+
+static void sender(void * arg) {
+    Item item = { 99, 200 };
+
+    (void) arg;
+    gl_result = xQueueSendWithPriority(gl_q, &item, item.priority,
+                                       portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+static void blocking(void) {
+    Item item = { 1, 10 };
+
+    gl_q = xQueueCreatePriority(2, sizeof(Item));
+    CHECK(gl_q != NULL);
+
+    // an empty queue: the send wakes the receiver
+    gl_result = 99;
+    CHECK(xTaskCreate(receiver, "receiver", configMINIMAL_STACK_SIZE, NULL,
+                      OTHER, NULL) == pdPASS);
+    vTaskDelay(2);
+    CHECK(gl_result == 99);
+    CHECK(xQueueSendWithPriority(gl_q, &item, item.priority, 0) == pdPASS);
+    vTaskDelay(1);
+    CHECK(gl_result == pdPASS && gl_got.seq == 1u);
+
+    // a full queue: the waiting send goes in by priority once there is room
+    Item low = { 2, 5 }, mid = { 3, 50 };
+    CHECK(xQueueSendWithPriority(gl_q, &low, low.priority, 0) == pdPASS);
+    CHECK(xQueueSendWithPriority(gl_q, &mid, mid.priority, 0) == pdPASS);
+    gl_result = 99;
+    CHECK(xTaskCreate(sender, "sender", configMINIMAL_STACK_SIZE, NULL,
+                      OTHER, NULL) == pdPASS);
+    vTaskDelay(2);
+    CHECK(gl_result == 99);
+    CHECK(xQueueReceive(gl_q, &item, 0) == pdPASS && item.seq == 3u);
+    vTaskDelay(1);
+    CHECK(gl_result == pdPASS);
+    CHECK(xQueueReceive(gl_q, &item, 0) == pdPASS && item.seq == 99u);
+    CHECK(xQueueReceive(gl_q, &item, 0) == pdPASS && item.seq == 2u);
+    vQueueDelete(gl_q);
+}
+
+// latency benchmark
+
+#define REPS 5000u
+
+enum Case { FIFO, NO_MOVE, MOVE_ALL };
+
+// a send into a queue of `length` holding length - 1 items
+static void sends(enum Case c, unsigned length, SimTiming * t) {
+    QueueHandle_t q = c == FIFO ? xQueueCreate(length, sizeof(Item))
+                                : xQueueCreatePriority(length, sizeof(Item));
+    Item item = { 0, 0 };
+
+    CHECK(q != NULL);
+    for (unsigned i = 1; i < length; ++i)
+        CHECK((c == FIFO ? xQueueSend(q, &item, 0)
+                         : xQueueSendWithPriority(q, &item, 1, 0)) == pdPASS);
+    for (unsigned i = 0; i < REPS; ++i) {
+        uint64_t start = sim_host_ns();
+
+        switch (c) {
+        case FIFO:
+            (void) xQueueSend(q, &item, 0);
+            break;
+        case NO_MOVE:                   // behind everything
+            (void) xQueueSendWithPriority(q, &item, 0, 0);
+            break;
+        case MOVE_ALL:                  // ahead of everything
+            (void) xQueueSendWithPriority(q, &item, 2, 0);
+            break;
+        }
+        sim_timed(t, start);
+        CHECK(uxQueueSpacesAvailable(q) == 0u);
+
+        // the head goes: the new item for MOVE_ALL, so that each send
+        // moves as many, and for NO_MOVE an item no new one passes
+        (void) xQueueReceive(q, &item, 0);
+    }
+    vQueueDelete(q);
+}
+
+static void latency(void) {
+    printf("test-priority-queue: ns per send into a queue holding "
+           "length - 1 items\n"
+           "  length      FIFO  priority, moving none  moving all\n");
+    for (unsigned length = 2; length <= configPRIORITY_QUEUE_MAX_LENGTH;
+         length *= 2u) {
+        double avg[3];
+
+        for (enum Case c = FIFO; c <= MOVE_ALL; ++c) {
+            SimTiming best = { 0 };
+
+            for (unsigned i = 0; i < 3u; ++i) {
+                SimTiming t = { 0 };
+
+                sends(c, length, &t);
+                sim_keep_best(&best, &t);
+            }
+            avg[c] = (double)best.total / best.n;
+        }
+        printf("  %6u  %8.1f  %21.1f  %10.1f\n", length, avg[FIFO],
+               avg[NO_MOVE], avg[MOVE_ALL]);
+    }
+}
+
+static void control(void * arg) {
+    (void) arg;
+    against_reference();
+    blocking();
+    latency();
+    printf("test-priority-queue: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,340 @@
+/**
+   test-pubsub: publish/subscribe with pooled buffers (app/pubsub.c) on
+   the host simulation (tools/sim)
+
+       make check
+
+   Checks the pool (every buffer handed out once, aligned, waited for
+   when all are out), each buffer's reference count through publish,
+   receive, retain and release, its return to the pool after the last
+   release, the drop counter for full inboxes, subscribing and
+   unsubscribing, and subscriber tasks seeing every message in order.
+
+   Then it prints a benchmark against fanning the same message out by
+   copy to one queue per subscriber: host ns per message, published and
+   consumed by every subscriber, and the bytes each way copies, for
+   16..256-byte payloads and 1..4 subscribers.  The times are the best
+   of three runs, and only compare the two ways.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "queue.h"
+#include "pubsub.h"
+
+enum { CONTROL = 3, SUBSCRIBER = 4, OTHER = 2 };
+
+#define POOL 4u
+#define PAYLOAD 32u
+
+static unsigned pool_free(PubsubPool const * pool) {
+    return (unsigned)uxQueueMessagesWaiting(pool->free);
+}
+
+static void pool(void) {
+    PubsubPool p;
+    PubsubMsg * msg[POOL];
+
+    CHECK(pubsub_pool_create(&p, PAYLOAD, POOL));
+    CHECK(pool_free(&p) == POOL);
+    for (unsigned i = 0; i < POOL; ++i) {
+        msg[i] = pubsub_alloc(&p, 0);
+        CHECK(msg[i] != NULL && msg[i]->pool == &p);
+        CHECK(msg[i]->refs == 1u && msg[i]->length == 0u);
+        CHECK((uintptr_t)msg[i] % portBYTE_ALIGNMENT == 0u);
+        for (unsigned j = 0; j < i; ++j)
+            CHECK(msg[j] != msg[i]
+                  && (msg[j]->data + PAYLOAD <= (uint8_t *)msg[i]
+                      || msg[i]->data + PAYLOAD <= (uint8_t *)msg[j]));
+        memset(msg[i]->data, 0x55, PAYLOAD);
+    }
+    CHECK(pubsub_alloc(&p, 0) == NULL);
+
+    // a buffer released comes back, and reset
+    msg[0]->length = 7u;
+    pubsub_release(msg[1]);
+    CHECK(pool_free(&p) == 1u);
+    PubsubMsg * again = pubsub_alloc(&p, 0);
+    CHECK(again == msg[1] && again->refs == 1u && again->length == 0u);
+    CHECK(again->topic == NULL);
+
+    // a retained buffer needs one release more
+    pubsub_retain(again);
+    pubsub_release(again);
+    CHECK(pool_free(&p) == 0u);
+    pubsub_release(again);
+    CHECK(pool_free(&p) == 1u);
+    for (unsigned i = 0; i < POOL; ++i)
+        if (i != 1u)
+            pubsub_release(msg[i]);
+    CHECK(pool_free(&p) == POOL);
+}
+
+// an allocation waits for a release
+
+static PubsubPool gl_pool;
+static PubsubMsg * volatile gl_got;
+
+static void allocator(void * arg) {
+    (void) arg;
+    gl_got = pubsub_alloc(&gl_pool, portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+static void alloc_waits(void) {
+    PubsubMsg * msg[POOL];
+
+    CHECK(pubsub_pool_create(&gl_pool, PAYLOAD, POOL));
+    for (unsigned i = 0; i < POOL; ++i)
+        msg[i] = pubsub_alloc(&gl_pool, 0);
+    CHECK(pubsub_alloc(&gl_pool, 5) == NULL);   // times out
+    gl_got = NULL;
+    CHECK(xTaskCreate(allocator, "allocator", configMINIMAL_STACK_SIZE, NULL,
+                      OTHER, NULL) == pdPASS);
+    vTaskDelay(3);
+    CHECK(gl_got == NULL);
+    pubsub_release(msg[2]);
+    vTaskDelay(1);
+    CHECK(gl_got == msg[2]);
+    pubsub_release(msg[2]);
+    pubsub_release(msg[0]);
+    pubsub_release(msg[1]);
+    pubsub_release(msg[3]);
+    CHECK(pool_free(&gl_pool) == POOL);
+}
+
+static void refs_and_drops(void) {
+    PubsubPool p;
+    PubsubTopic topic;
+    QueueHandle_t inbox[3];
+
+    CHECK(pubsub_pool_create(&p, PAYLOAD, POOL));
+    pubsub_topic_init(&topic);
+
+    // no subscribers: straight back to the pool
+    PubsubMsg * msg = pubsub_alloc(&p, 0);
+    CHECK(pubsub_publish(&topic, msg) == 0u);
+    CHECK(pool_free(&p) == POOL && pubsub_drops(&topic) == 0u);
+
+    inbox[0] = xQueueCreate(4, PUBSUB_INBOX_ITEM_SIZE);
+    inbox[1] = xQueueCreate(1, PUBSUB_INBOX_ITEM_SIZE);     // fills up
+    inbox[2] = xQueueCreate(4, PUBSUB_INBOX_ITEM_SIZE);
+    for (unsigned i = 0; i < 3u; ++i)
+        CHECK(pubsub_subscribe(&topic, inbox[i]));
+
+    PubsubMsg * first = pubsub_alloc(&p, 0);
+    first->length = 3u;
+    memcpy(first->data, "abc", 3);
+    CHECK(pubsub_publish(&topic, first) == 3u);
+    CHECK(first->refs == 3u && first->topic == &topic);
+
+    PubsubMsg * second = pubsub_alloc(&p, 0);
+    CHECK(pubsub_publish(&topic, second) == 2u);
+    CHECK(pubsub_drops(&topic) == 1u && second->refs == 2u);
+    CHECK(pool_free(&p) == POOL - 2u);
+
+    // each inbox holds the same buffer, not a copy
+    for (unsigned i = 0; i < 3u; ++i) {
+        PubsubMsg * m = pubsub_receive(inbox[i], 0);
+        CHECK(m == first && m->length == 3u && memcmp(m->data, "abc", 3) == 0);
+        pubsub_release(m);
+        CHECK(first->refs == 2u - i);
+    }
+    CHECK(pool_free(&p) == POOL - 1u);
+    CHECK(pubsub_receive(inbox[1], 0) == NULL);
+    CHECK(pubsub_receive(inbox[0], 0) == second);
+    pubsub_release(second);
+    CHECK(pubsub_receive(inbox[2], 0) == second);
+    pubsub_release(second);
+    CHECK(pool_free(&p) == POOL);
+
+    // the limit, and unsubscribing: what is queued stays
+    QueueHandle_t extra = xQueueCreate(1, PUBSUB_INBOX_ITEM_SIZE);
+    CHECK(pubsub_subscribe(&topic, extra) == (PUBSUB_MAX_SUBSCRIBERS > 3));
+    for (unsigned i = 4; i < PUBSUB_MAX_SUBSCRIBERS; ++i)
+        CHECK(pubsub_subscribe(&topic, extra));
+    CHECK(!pubsub_subscribe(&topic, extra));
+    for (unsigned i = 3; i < PUBSUB_MAX_SUBSCRIBERS; ++i)
+        pubsub_unsubscribe(&topic, extra);
+    msg = pubsub_alloc(&p, 0);
+    CHECK(pubsub_publish(&topic, msg) == 3u);
+    pubsub_unsubscribe(&topic, inbox[0]);
+    CHECK(topic.subscribers == 2u);
+    msg = pubsub_alloc(&p, 0);
+    CHECK(pubsub_publish(&topic, msg) == 1u);     // inbox 1 is still full
+    for (unsigned i = 0; i < 3u; ++i) {
+        PubsubMsg * m;
+        while ((m = pubsub_receive(inbox[i], 0)) != NULL)
+            pubsub_release(m);
+    }
+    CHECK(pool_free(&p) == POOL);
+    CHECK(pubsub_drops(&topic) == 2u);
+}
+
+// subscriber tasks, one inbox on two topics
+
+#define MESSAGES 200u
+
+static PubsubTopic gl_topic[2];
+static unsigned volatile gl_seen[3][2];
+
+static void subscriber(void * arg) {
+    unsigned id = (unsigned)(uintptr_t)arg;
+    QueueHandle_t inbox = xQueueCreate(4, PUBSUB_INBOX_ITEM_SIZE);
+
+    CHECK(pubsub_subscribe(&gl_topic[0], inbox));
+    if (id == 0u)
+        CHECK(pubsub_subscribe(&gl_topic[1], inbox));
+    for (;;) {
+        PubsubMsg * m = pubsub_receive(inbox, portMAX_DELAY);
+        unsigned t = m->topic == &gl_topic[1];
+        uint32_t n;
+
+        CHECK(m->length == sizeof n);
+        memcpy(&n, m->data, sizeof n);
+        CHECK(n == gl_seen[id][t]);      // every one, in order
+        gl_seen[id][t]++;
+        pubsub_release(m);
+    }
+}
+
+static void subscriber_tasks(void) {
+    TaskHandle_t h[3];
+    PubsubPool p;
+
+    CHECK(pubsub_pool_create(&p, sizeof(uint32_t), POOL));
+    pubsub_topic_init(&gl_topic[0]);
+    pubsub_topic_init(&gl_topic[1]);
+    for (unsigned i = 0; i < 3u; ++i)
+        CHECK(xTaskCreate(subscriber, "subscriber", configMINIMAL_STACK_SIZE,
+                          (void *)(uintptr_t)i, SUBSCRIBER, &h[i]) == pdPASS);
+
+    for (uint32_t n = 0; n < MESSAGES; ++n)
+        for (unsigned t = 0; t < 2u; ++t) {
+            PubsubMsg * m = pubsub_alloc(&p, portMAX_DELAY);
+            memcpy(m->data, &n, sizeof n);
+            m->length = sizeof n;
+            CHECK(pubsub_publish(&gl_topic[t], m) == (t == 0u ? 3u : 1u));
+        }
+    CHECK(gl_seen[0][0] == MESSAGES && gl_seen[0][1] == MESSAGES);
+    CHECK(gl_seen[1][0] == MESSAGES && gl_seen[2][0] == MESSAGES);
+    CHECK(gl_seen[1][1] == 0u && gl_seen[2][1] == 0u);
+    CHECK(pool_free(&p) == POOL);
+    CHECK(pubsub_drops(&gl_topic[0]) == 0u);
+    for (unsigned i = 0; i < 3u; ++i)
+        vTaskDelete(h[i]);
+}
+
+// benchmark: one task publishes and then consumes, so that only the
+// data movement is timed, not switching between tasks
+
+#define REPS 2000u
+
+static uint32_t gl_sum;
+
+static void consume(uint8_t const * data, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        gl_sum += data[i];
+}
+
+static void by_pubsub(size_t payload, unsigned subscribers, SimTiming * t) {
+    PubsubPool p;
+    PubsubTopic topic;
+    QueueHandle_t inbox[PUBSUB_MAX_SUBSCRIBERS];
+
+    CHECK(pubsub_pool_create(&p, payload, 2));
+    pubsub_topic_init(&topic);
+    for (unsigned i = 0; i < subscribers; ++i) {
+        inbox[i] = xQueueCreate(2, PUBSUB_INBOX_ITEM_SIZE);
+        CHECK(pubsub_subscribe(&topic, inbox[i]));
+    }
+    for (unsigned r = 0; r < REPS; ++r) {
+        uint64_t start = sim_host_ns();
+        PubsubMsg * m = pubsub_alloc(&p, 0);
+
+        memset(m->data, (int)r, payload);
+        m->length = payload;
+        (void) pubsub_publish(&topic, m);
+        for (unsigned i = 0; i < subscribers; ++i) {
+            m = pubsub_receive(inbox[i], 0);
+            consume(m->data, m->length);
+            pubsub_release(m);
+        }
+        sim_timed(t, start);
+    }
+    for (unsigned i = 0; i < subscribers; ++i)
+        vQueueDelete(inbox[i]);
+    vQueueDelete(p.free);
+    vPortFree(p.blocks);
+}
+
+static void by_copy(size_t payload, unsigned subscribers, SimTiming * t) {
+    static uint8_t out[256], in[256];
+    QueueHandle_t q[PUBSUB_MAX_SUBSCRIBERS];
+
+    for (unsigned i = 0; i < subscribers; ++i)
+        CHECK((q[i] = xQueueCreate(2, payload)) != NULL);
+    for (unsigned r = 0; r < REPS; ++r) {
+        uint64_t start = sim_host_ns();
+
+        memset(out, (int)r, payload);
+        for (unsigned i = 0; i < subscribers; ++i)
+            (void) xQueueSend(q[i], out, 0);
+        for (unsigned i = 0; i < subscribers; ++i) {
+            (void) xQueueReceive(q[i], in, 0);
+            consume(in, payload);
+        }
+        sim_timed(t, start);
+    }
+    for (unsigned i = 0; i < subscribers; ++i)
+        vQueueDelete(q[i]);
+}
+
+static double best_avg(void (*run)(size_t, unsigned, SimTiming *),
+                       size_t payload, unsigned subscribers) {
+    SimTiming best = { 0 };
+
+    for (unsigned i = 0; i < 3u; ++i) {
+        SimTiming t = { 0 };
+
+        run(payload, subscribers, &t);
+        sim_keep_best(&best, &t);
+    }
+    return (double)best.total / best.n;
+}
+
+static void fan_out(void) {
+    printf("test-pubsub: per message, published and consumed by each\n"
+           "  payload  subs   pubsub ns  bytes   fan-out ns  bytes\n");
+    for (size_t payload = 16; payload <= 256u; payload *= 4u)
+        for (unsigned subs = 1; subs <= PUBSUB_MAX_SUBSCRIBERS; subs *= 2u)
+            // bytes copied: pubsub moves a pointer into and out of each
+            // inbox; fan-out moves the payload into and out of each queue
+            printf("  %7u  %4u  %10.1f  %5u  %11.1f  %5u\n",
+                   (unsigned)payload, subs,
+                   best_avg(by_pubsub, payload, subs),
+                   (unsigned)(2u * subs * sizeof(PubsubMsg *)
+                              + 2u * sizeof(PubsubMsg *)),
+                   best_avg(by_copy, payload, subs),
+                   (unsigned)(2u * subs * payload));
+}
+
+static void control(void * arg) {
+    (void) arg;
+    pool();
+    alloc_waits();
+    refs_and_drops();
+    subscriber_tasks();
+    fan_out();
+    printf("test-pubsub: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+   test-pwm-curve: the gamma-corrected fade tables of pwm-led.c
+   (pwm_led_curve in app/pwm-led-curve.c) on the host
+
+       make check
+
+   Each value is compared with (b/255)^2.2 of the brightness b the
+   step should have, in floating point.
+ */
+
+#include <math.h>
+
+#include "sim.h"
+#include "pwm-led.h"
+
+#define PERIOD 5000u                    // as pwm-led.c, 1 MHz / 200 Hz
+
+// compare value for brightness b (0..255, may be fractional)
+static double ideal(double b, unsigned period) {
+    return pow(b / 255.0, 2.2) * period;
+}
+
+// the brightness step i of `steps` should have
+static double brightness(uint8_t from, uint8_t to, unsigned i,
+                         unsigned steps) {
+    return from + ((double)to - from) * i / steps;
+}
+
+static void check_fade(uint8_t from, uint8_t to, unsigned steps,
+                       unsigned period) {
+    uint16_t out[PWM_LED_MAX_STEPS];
+
+    pwm_led_curve(out, 1, steps, from, to, (uint16_t)period);
+    for (unsigned i = 1; i <= steps; ++i) {
+        double want = ideal(brightness(from, to, i, steps), period);
+        if (fabs(out[i - 1u] - want) > 1.5) {
+            fprintf(stderr, "fade %u -> %u in %u, step %u: %u, want %.1f\n",
+                    from, to, steps, i, out[i - 1u], want);
+            exit(1);
+        }
+        // each step moves towards `to`, never back
+        if (i > 1u) {
+            if (to > from)
+                CHECK(out[i - 1u] >= out[i - 2u]);
+            else
+                CHECK(out[i - 1u] <= out[i - 2u]);
+        }
+    }
+
+    // the last value is exactly that of `to`
+    uint16_t last;
+    pwm_led_curve(&last, 1, 1, to, to, (uint16_t)period);
+    CHECK(out[steps - 1u] == last);
+}
+
+static void endpoints(void) {
+    uint16_t out[4];
+
+    pwm_led_curve(out, 1, 4, 255, 0, PERIOD);
+    CHECK(out[3] == 0u);
+    pwm_led_curve(out, 1, 4, 0, 255, PERIOD);
+    CHECK(out[3] == PERIOD);
+
+    // the first value is a step on from `from`, not `from` itself
+    CHECK(out[0] > 0u);
+    CHECK(fabs(out[0] - ideal(255.0 / 4, PERIOD)) <= 1.5);
+
+    // the largest period a 16-bit timer allows does not overflow
+    pwm_led_curve(out, 1, 1, 0, 255, 0xffffu);
+    CHECK(out[0] == 0xffffu);
+}
+
+static void rising_and_falling(void) {
+    static uint8_t const level[] = { 0, 1, 2, 17, 100, 128, 200, 254, 255 };
+    static unsigned const steps[] = { 1, 2, 3, 7, 50, PWM_LED_MAX_STEPS };
+
+    for (unsigned f = 0; f < sizeof level; ++f)
+        for (unsigned t = 0; t < sizeof level; ++t)
+            for (unsigned s = 0; s < sizeof steps / sizeof steps[0]; ++s)
+                check_fade(level[f], level[t], steps[s], PERIOD);
+}
+
+static void every_level(void) {
+    for (unsigned b = 0; b <= 255u; ++b) {
+        check_fade(0, (uint8_t)b, PWM_LED_MAX_STEPS, PERIOD);
+        check_fade(255, (uint8_t)b, PWM_LED_MAX_STEPS, PERIOD);
+    }
+}
+
+// a held LED: every value the same
+static void from_equals_to(void) {
+    uint16_t out[PWM_LED_MAX_STEPS];
+
+    for (unsigned b = 0; b <= 255u; b += 51u) {
+        pwm_led_curve(out, 1, PWM_LED_MAX_STEPS, (uint8_t)b, (uint8_t)b,
+                      PERIOD);
+        for (unsigned i = 1; i < PWM_LED_MAX_STEPS; ++i)
+            CHECK(out[i] == out[0]);
+        CHECK(fabs(out[0] - ideal(b, PERIOD)) <= 1.0);
+    }
+}
+
+// TIM1's table interleaves its two LEDs, a column each
+static void interleaved(void) {
+    uint16_t table[PWM_LED_MAX_STEPS * 2u];
+    uint16_t flat[PWM_LED_MAX_STEPS];
+
+    for (unsigned i = 0; i < PWM_LED_MAX_STEPS * 2u; ++i)
+        table[i] = 0xdeadu;
+
+    pwm_led_curve(&table[0], 2, PWM_LED_MAX_STEPS, 0, 255, PERIOD);
+    for (unsigned i = 0; i < PWM_LED_MAX_STEPS; ++i)
+        CHECK(table[2u * i + 1u] == 0xdeadu);
+
+    pwm_led_curve(&table[1], 2, PWM_LED_MAX_STEPS, 200, 200, PERIOD);
+    pwm_led_curve(flat, 1, PWM_LED_MAX_STEPS, 0, 255, PERIOD);
+    for (unsigned i = 0; i < PWM_LED_MAX_STEPS; ++i) {
+        CHECK(table[2u * i] == flat[i]);
+        CHECK(table[2u * i + 1u] == table[1]);
+    }
+
+    // a short fade leaves the rest of the table alone
+    pwm_led_curve(&table[0], 2, 3, 255, 0, PERIOD);
+    CHECK(table[4] == 0u && table[6] == flat[3]);
+}
+
+int main(void) {
+    endpoints();
+    rising_and_falling();
+    every_level();
+    from_equals_to();
+    interleaved();
+    printf("test-pwm-curve: ok\n");
+    return 0;
+}
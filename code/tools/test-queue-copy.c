@@ -0,0 +1,126 @@
+/**
+   test-queue-copy: the queue item copy (queueCOPY_ITEM in
+   FreeRTOS-Kernel/queue.c) on the host simulation (tools/sim)
+
+       make check
+
+   Built with configUSE_QUEUE_WORD_COPY 0 and 1.  Items of 1..9 bytes,
+   the 4-byte case among them, go through send to back and front,
+   overwrite, peek and receive, and come out intact and in order.
+
+   Then it prints the time for an xQueueSend() and xQueueReceive() pair
+   of a uint32_t, and of an 8-byte item for comparison, the best of
+   three runs in host ns; compare the two builds.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "queue.h"
+
+enum { CONTROL = 4 };
+
+static void fill(uint8_t * item, size_t size, unsigned n) {
+    for (size_t i = 0; i < size; ++i)
+        item[i] = (uint8_t)(n * 16u + i);
+}
+
+static void check_item(uint8_t const * item, size_t size, unsigned n) {
+    for (size_t i = 0; i < size; ++i)
+        CHECK(item[i] == (uint8_t)(n * 16u + i));
+}
+
+static void copies(void) {
+    uint8_t item[16];
+
+    for (size_t size = 1; size <= 9u; ++size) {
+        QueueHandle_t q = xQueueCreate(5, size);
+        CHECK(q != NULL);
+
+        // 1 2 3 to the back, 0 to the front: 0 1 2 3, wrapped
+        for (unsigned n = 1; n <= 3u; ++n) {
+            fill(item, size, n);
+            CHECK(xQueueSendToBack(q, item, 0) == pdPASS);
+        }
+        CHECK(xQueueReceive(q, item, 0) == pdPASS);
+        check_item(item, size, 1);
+        fill(item, size, 1);
+        CHECK(xQueueSendToFront(q, item, 0) == pdPASS);
+        fill(item, size, 0);
+        CHECK(xQueueSendToFront(q, item, 0) == pdPASS);
+        fill(item, size, 4);
+        CHECK(xQueueSendToBack(q, item, 0) == pdPASS);
+
+        memset(item, 0, sizeof item);
+        CHECK(xQueuePeek(q, item, 0) == pdPASS);
+        check_item(item, size, 0);
+        for (unsigned n = 0; n <= 4u; ++n) {
+            memset(item, 0, sizeof item);
+            CHECK(xQueueReceive(q, item, 0) == pdPASS);
+            check_item(item, size, n);
+            CHECK(item[size] == 0u);    // nothing beyond the item
+        }
+        CHECK(xQueueReceive(q, item, 0) == pdFAIL);
+        vQueueDelete(q);
+
+        // a mailbox
+        q = xQueueCreate(1, size);
+        fill(item, size, 7);
+        CHECK(xQueueOverwrite(q, item) == pdPASS);
+        fill(item, size, 8);
+        CHECK(xQueueOverwrite(q, item) == pdPASS);
+        memset(item, 0, sizeof item);
+        CHECK(xQueueReceive(q, item, 0) == pdPASS);
+        check_item(item, size, 8);
+        vQueueDelete(q);
+    }
+}
+
+#define REPS 20000u
+
+static void pairs(size_t size, SimTiming * t) {
+    QueueHandle_t q = xQueueCreate(8, size);
+    uint8_t in[8] = { 1, 2, 3, 4, 5, 6, 7, 8 }, out[8];
+
+    CHECK(q != NULL);
+    for (unsigned i = 0; i < REPS; ++i) {
+        uint64_t start = sim_host_ns();
+        (void) xQueueSend(q, in, 0);
+        (void) xQueueReceive(q, out, 0);
+        sim_timed(t, start);
+    }
+    CHECK(memcmp(in, out, size) == 0);
+    vQueueDelete(q);
+}
+
+static void benchmark(void) {
+    printf("test-queue-copy: configUSE_QUEUE_WORD_COPY %d, ns per "
+           "send and receive\n", configUSE_QUEUE_WORD_COPY);
+    for (size_t size = 4; size <= 8u; size += 4u) {
+        SimTiming best = { 0 };
+
+        for (unsigned i = 0; i < 3u; ++i) {
+            SimTiming t = { 0 };
+
+            pairs(size, &t);
+            sim_keep_best(&best, &t);
+        }
+        sim_report(size == 4u ? "4-byte item" : "8-byte item", &best);
+    }
+}
+
+static void control(void * arg) {
+    (void) arg;
+    copies();
+    benchmark();
+    printf("test-queue-copy: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,244 @@
+/**
+   test-receive-many: batched message receive, uxMessageBufferReceiveMany()
+   (FreeRTOS-Kernel/stream_buffer.c), on the host simulation (tools/sim)
+
+       make check
+
+   A batch stops at the message count, at an empty buffer, or at the
+   first message that does not fit in the space left, which stays for
+   the next call.  Random batches over a small buffer, so that messages
+   and their length prefixes wrap at every offset, are compared with a
+   reference FIFO.  The receive-completed callback counts the
+   notifications: one per batch that took anything, none otherwise.  A
+   writer blocked for space is woken by a batch, and a reader blocked
+   on an empty buffer by a send.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "message_buffer.h"
+
+enum { CONTROL = 4, OTHER = 3 };
+
+#define LENGTH_BYTES sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)
+
+static unsigned gl_completed, gl_completed_in_isr;
+
+static void receive_completed(StreamBufferHandle_t sb, BaseType_t in_isr,
+                              BaseType_t * const woken) {
+    (void) sb;
+    (void) woken;
+    gl_completed++;
+    if (in_isr)
+        gl_completed_in_isr++;
+}
+
+static uint8_t gl_next_byte;
+
+static size_t send(MessageBufferHandle_t mb, size_t n) {
+    uint8_t data[64];
+
+    CHECK(n <= sizeof data);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = (uint8_t)(gl_next_byte + i);
+    n = xMessageBufferSend(mb, data, n, 0);
+    gl_next_byte += (uint8_t)n;
+    return n;
+}
+
+static void stops(void) {
+    static StaticStreamBuffer_t control;
+    static uint8_t storage[128];
+    uint8_t rx[64];
+    size_t len[8];
+
+    MessageBufferHandle_t mb = xMessageBufferCreateStaticWithCallback(
+        sizeof storage, storage, &control, NULL, receive_completed);
+    CHECK(mb != NULL);
+    gl_next_byte = 0;
+    CHECK(send(mb, 3) == 3u && send(mb, 5) == 5u);
+    CHECK(xStreamBufferBytesAvailable(mb) == 8u + 2u * LENGTH_BYTES);
+    CHECK(send(mb, 7) == 7u && send(mb, 20) == 20u);
+
+    // at the count
+    gl_completed = 0;
+    CHECK(uxMessageBufferReceiveMany(mb, rx, sizeof rx, len, 2, 0) == 2u);
+    CHECK(len[0] == 3u && len[1] == 5u);
+    for (uint8_t i = 0; i < 8u; ++i)
+        CHECK(rx[i] == i);
+    CHECK(gl_completed == 1u);
+
+    // at the first message that does not fit: 7 does, 20 does not
+    CHECK(uxMessageBufferReceiveMany(mb, rx, 26, len, 8, 0) == 1u);
+    CHECK(len[0] == 7u && rx[0] == 8u && rx[6] == 14u);
+    CHECK(gl_completed == 2u);
+    CHECK(xStreamBufferNextMessageLengthBytes(mb) == 20u);
+
+    // nothing fits: nothing is taken, and no notification
+    memset(rx, 0xEE, sizeof rx);
+    CHECK(uxMessageBufferReceiveMany(mb, rx, 19, len, 8, 0) == 0u);
+    CHECK(rx[0] == 0xEEu && gl_completed == 2u);
+    CHECK(xStreamBufferNextMessageLengthBytes(mb) == 20u);
+
+    // nor from an empty buffer
+    CHECK(uxMessageBufferReceiveMany(mb, rx, 20, len, 8, 0) == 1u);
+    CHECK(len[0] == 20u && rx[0] == 15u && rx[19] == 34u);
+    CHECK(gl_completed == 3u && xMessageBufferIsEmpty(mb));
+    CHECK(uxMessageBufferReceiveMany(mb, rx, sizeof rx, len, 8, 0) == 0u);
+    CHECK(gl_completed == 3u);
+
+    // the same from an interrupt, notified once
+    BaseType_t woken = pdFALSE;
+    CHECK(send(mb, 2) == 2u && send(mb, 2) == 2u && send(mb, 2) == 2u);
+    CHECK(uxMessageBufferReceiveManyFromISR(mb, rx, sizeof rx, len, 8,
+                                            &woken) == 3u);
+    CHECK(gl_completed == 4u && gl_completed_in_isr == 1u);
+    CHECK(rx[0] == 35u && rx[5] == 40u);
+    vMessageBufferDelete(mb);
+}
+
+// messages in the model, by length, and their bytes, oldest first
+static struct {
+    size_t len[256];
+    unsigned first, count;
+    uint8_t oldest_byte;
+} gl_model;
+
+static void wrapping(void) {
+    static StaticStreamBuffer_t control;
+    static uint8_t storage[61];          // holds 60 bytes
+    uint32_t random = 1u;
+    uint8_t rx[64];
+    size_t len[8];
+
+    MessageBufferHandle_t mb = xMessageBufferCreateStaticWithCallback(
+        sizeof storage, storage, &control, NULL, receive_completed);
+    CHECK(mb != NULL);
+    memset(&gl_model, 0, sizeof gl_model);
+    gl_next_byte = 0;
+    gl_completed = 0;
+
+    unsigned batches = 0;
+
+    for (unsigned round = 0; round < 20000u; ++round) {
+        // top up with messages of 1..20 bytes, until one does not fit
+        for (;;) {
+            random = random * 1103515245u + 12345u;
+            size_t n = 1u + (random >> 16) % 20u;
+
+            if (xStreamBufferSpacesAvailable(mb) < n + LENGTH_BYTES)
+                break;
+            CHECK(send(mb, n) == n);
+            gl_model.len[(gl_model.first + gl_model.count++) % 256u] = n;
+        }
+
+        random = random * 1103515245u + 12345u;
+        size_t room = (random >> 16) % 48u;
+        UBaseType_t max = 1u + (random >> 8) % 8u;
+
+        // what should come out
+        unsigned want = 0;
+        size_t total = 0;
+        while (want < max && want < gl_model.count) {
+            size_t n = gl_model.len[(gl_model.first + want) % 256u];
+            if (total + n > room)
+                break;
+            total += n;
+            want++;
+        }
+
+        unsigned before = gl_completed;
+        UBaseType_t got = uxMessageBufferReceiveMany(mb, rx, room, len, max, 0);
+
+        CHECK(got == want);
+        CHECK(gl_completed == before + (got != 0u ? 1u : 0u));
+        batches += got != 0u;
+        for (size_t i = 0, k = 0; k < got; ++k) {
+            CHECK(len[k] == gl_model.len[gl_model.first]);
+            gl_model.first = (gl_model.first + 1u) % 256u;
+            gl_model.count--;
+            for (size_t j = 0; j < len[k]; ++j, ++i)
+                CHECK(rx[i] == gl_model.oldest_byte++);
+        }
+    }
+    CHECK(gl_completed == batches && batches > 10000u);
+    vMessageBufferDelete(mb);
+}
+
+// blocking
+
+static MessageBufferHandle_t gl_mb;
+static volatile UBaseType_t gl_got;
+static volatile size_t gl_sent;
+
+static void batch_reader(void * arg) {
+    uint8_t rx[32];
+    size_t len[4];
+
+    gl_got = uxMessageBufferReceiveMany(gl_mb, rx, sizeof rx, len, 4,
+                                        (TickType_t)(uintptr_t)arg);
+    vTaskDelete(NULL);
+}
+
+static void writer(void * arg) {
+    uint8_t data[16] = { 0 };
+
+    gl_sent = xMessageBufferSend(gl_mb, data, (size_t)(uintptr_t)arg,
+                                 portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+static void blocking(void) {
+    uint8_t rx[64];
+    size_t len[8];
+
+    // a reader on an empty buffer is woken by a send
+    gl_mb = xMessageBufferCreate(64);
+    CHECK(gl_mb != NULL);
+    gl_got = 99u;
+    CHECK(xTaskCreate(batch_reader, "reader", configMINIMAL_STACK_SIZE,
+                      (void *)(uintptr_t)portMAX_DELAY, OTHER, NULL) == pdPASS);
+    vTaskDelay(2);
+    CHECK(gl_got == 99u);
+    CHECK(send(gl_mb, 4) == 4u);
+    vTaskDelay(1);
+    CHECK(gl_got == 1u);
+
+    // and times out with nothing
+    gl_got = 99u;
+    CHECK(xTaskCreate(batch_reader, "reader", configMINIMAL_STACK_SIZE,
+                      (void *)(uintptr_t)5u, OTHER, NULL) == pdPASS);
+    vTaskDelay(10);
+    CHECK(gl_got == 0u);
+
+    // a writer waiting for space is woken by the batch
+    while (send(gl_mb, 8) == 8u)
+        ;
+    gl_sent = 99u;
+    CHECK(xTaskCreate(writer, "writer", configMINIMAL_STACK_SIZE,
+                      (void *)(uintptr_t)16u, OTHER, NULL) == pdPASS);
+    vTaskDelay(2);
+    CHECK(gl_sent == 99u);
+    CHECK(uxMessageBufferReceiveMany(gl_mb, rx, sizeof rx, len, 2, 0) == 2u);
+    vTaskDelay(1);
+    CHECK(gl_sent == 16u);
+    vMessageBufferDelete(gl_mb);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    stops();
+    wrapping();
+    blocking();
+    printf("test-receive-many: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,429 @@
+/**
+   test-rwlock: reader-writer locks (FreeRTOS-Kernel/rwlock.c) on the
+   host simulation (tools/sim)
+
+       make check
+
+   A waiting task learns whether it was handed the lock or timed out
+   from rwlockUNBLOCKED_BY_GRANT in its event item: the lock granted
+   and then a tick past the block time before the task runs must still
+   count as taken, and a timeout before the release as not taken, with
+   the lock left free for someone else (prvWaitTimedOut).  A waiting
+   writer keeps new readers out; the readers waiting when a writer
+   releases all come in before the next writer; waiting writers go in
+   priority order; the writer inherits the priority of whoever waits,
+   and gives it back as they time out, but readers inherit nothing.
+
+   Then it prints reads per tick for 1..8 reader tasks that each hold
+   the lock for a tick, as a read that waits on a peripheral would,
+   with the rwlock and with a mutex, and the host ns of an uncontended
+   take and give of each.
+ */
+
+#include "sim.h"
+#include "task.h"
+#include "semphr.h"
+#include "rwlock.h"
+
+enum { CONTROL = 2, LOW = 1, MID = 3, HIGH = 4 };
+
+static RWLockHandle_t gl_lock;
+
+// a task that takes or gives the lock when told to
+
+enum Op { READ, WRITE, GIVE_READ, GIVE_WRITE };
+
+typedef struct {
+    TaskHandle_t task;
+    enum Op op;
+    TickType_t ticks;
+    BaseType_t volatile result;         // -1 while waiting
+    unsigned volatile order;            // of return, counting from 1
+} Actor;
+
+static unsigned gl_returned;
+
+static void actor(void * arg) {
+    Actor * a = arg;
+
+    for (;;) {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        switch (a->op) {
+        case READ:
+            a->result = xRWLockTakeRead(gl_lock, a->ticks);
+            break;
+        case WRITE:
+            a->result = xRWLockTakeWrite(gl_lock, a->ticks);
+            break;
+        case GIVE_READ:
+            vRWLockGiveRead(gl_lock);
+            a->result = pdTRUE;
+            break;
+        case GIVE_WRITE:
+            vRWLockGiveWrite(gl_lock);
+            a->result = pdTRUE;
+            break;
+        }
+        a->order = ++gl_returned;
+    }
+}
+
+static void start(Actor * a, UBaseType_t priority) {
+    a->result = -1;
+    a->order = 0u;
+    CHECK(xTaskCreate(actor, "actor", configMINIMAL_STACK_SIZE, a, priority,
+                      &a->task) == pdPASS);
+}
+
+/* Tell `a` what to do, and let it run to its return or block: at once
+   if it is above the control task, or in the tick given to it. */
+static void tell(Actor * a, enum Op op, TickType_t ticks) {
+    a->op = op;
+    a->ticks = ticks;
+    a->result = -1;
+    a->order = 0u;
+    xTaskNotifyGive(a->task);
+    vTaskDelay(1);
+}
+
+static void stop(Actor * a) {
+    vTaskDelete(a->task);
+}
+
+static BaseType_t can_write(void) {
+    if (xRWLockTakeWrite(gl_lock, 0) == pdFALSE)
+        return pdFALSE;
+    vRWLockGiveWrite(gl_lock);
+    return pdTRUE;
+}
+
+static BaseType_t can_read(void) {
+    if (xRWLockTakeRead(gl_lock, 0) == pdFALSE)
+        return pdFALSE;
+    vRWLockGiveRead(gl_lock);
+    return pdTRUE;
+}
+
+// the grant flag against the block time
+
+static void grant_or_timeout(void) {
+    Actor r;
+
+    start(&r, LOW);
+
+    // granted, then past its block time before it runs: still taken
+    CHECK(xRWLockTakeWrite(gl_lock, 0) == pdTRUE);
+    tell(&r, READ, 3);
+    CHECK(r.result == -1);
+    vRWLockGiveWrite(gl_lock);          // r is counted as a reader now
+    sim_tick(10);
+    CHECK(!can_write() && can_read());
+    vTaskDelay(1);
+    CHECK(r.result == pdTRUE);
+    tell(&r, GIVE_READ, 0);
+    CHECK(can_write());
+
+    // timed out, and the lock released before it runs: not taken, and
+    // nothing left counted for it
+    CHECK(xRWLockTakeWrite(gl_lock, 0) == pdTRUE);
+    tell(&r, READ, 3);
+    sim_tick(10);
+    CHECK(r.result == -1);
+    vRWLockGiveWrite(gl_lock);
+    CHECK(can_write());
+    vTaskDelay(1);
+    CHECK(r.result == pdFALSE);
+    CHECK(can_write());
+
+    // the same for a writer, which the release would make the holder
+    CHECK(xRWLockTakeRead(gl_lock, 0) == pdTRUE);
+    tell(&r, WRITE, 3);
+    vRWLockGiveRead(gl_lock);
+    sim_tick(10);
+    CHECK(!can_read());
+    vTaskDelay(1);
+    CHECK(r.result == pdTRUE);
+    tell(&r, GIVE_WRITE, 0);
+
+    CHECK(xRWLockTakeRead(gl_lock, 0) == pdTRUE);
+    tell(&r, WRITE, 3);
+    sim_tick(10);
+    vRWLockGiveRead(gl_lock);
+    CHECK(can_write() && can_read());
+    vTaskDelay(1);
+    CHECK(r.result == pdFALSE);
+
+    // a writer timing out lets in the readers held back for it
+    Actor w;
+    start(&w, HIGH);
+    CHECK(xRWLockTakeRead(gl_lock, 0) == pdTRUE);
+    tell(&w, WRITE, 5);
+    CHECK(w.result == -1 && !can_read());
+    tell(&r, READ, portMAX_DELAY);
+    CHECK(r.result == -1);
+    vTaskDelay(5);
+    CHECK(w.result == pdFALSE && r.result == pdTRUE);
+    tell(&r, GIVE_READ, 0);
+    vRWLockGiveRead(gl_lock);
+    CHECK(can_write());
+
+    stop(&r);
+    stop(&w);
+}
+
+// writers go first, then the readers that waited for them
+
+static void preference(void) {
+    Actor r[3], w[2];
+
+    for (unsigned i = 0; i < 3u; ++i)
+        start(&r[i], MID);
+    start(&w[0], MID);
+    start(&w[1], HIGH);
+
+    // a waiting writer keeps new readers out
+    tell(&r[0], READ, 0);
+    CHECK(r[0].result == pdTRUE);
+    tell(&w[0], WRITE, portMAX_DELAY);
+    CHECK(w[0].result == -1);
+    tell(&r[1], READ, 0);
+    CHECK(r[1].result == pdFALSE);
+    tell(&r[1], READ, portMAX_DELAY);
+    tell(&r[2], READ, portMAX_DELAY);
+    tell(&w[1], WRITE, portMAX_DELAY);
+    CHECK(r[1].result == -1 && r[2].result == -1 && w[1].result == -1);
+
+    // the last reader out hands over to the higher priority writer
+    tell(&r[0], GIVE_READ, 0);
+    CHECK(w[1].result == pdTRUE && w[0].result == -1);
+    CHECK(r[1].result == -1 && r[2].result == -1);
+
+    // its release lets in both waiting readers, ahead of w[0]
+    tell(&w[1], GIVE_WRITE, 0);
+    CHECK(r[1].result == pdTRUE && r[2].result == pdTRUE);
+    CHECK(w[0].result == -1);
+
+    // a reader arriving now waits behind w[0]
+    tell(&r[0], READ, portMAX_DELAY);
+    CHECK(r[0].result == -1);
+    tell(&r[1], GIVE_READ, 0);
+    CHECK(w[0].result == -1);
+    tell(&r[2], GIVE_READ, 0);
+    CHECK(w[0].result == pdTRUE && r[0].result == -1);
+    tell(&w[0], GIVE_WRITE, 0);
+    CHECK(r[0].result == pdTRUE);
+    tell(&r[0], GIVE_READ, 0);
+    CHECK(can_write());
+
+    for (unsigned i = 0; i < 3u; ++i)
+        stop(&r[i]);
+    stop(&w[0]);
+    stop(&w[1]);
+}
+
+// the readers waiting when a writer releases come in as one batch
+
+static void reader_batch(void) {
+    Actor w[2], r[4];
+
+    start(&w[0], LOW);
+    start(&w[1], HIGH);
+    for (unsigned i = 0; i < 4u; ++i)
+        start(&r[i], i < 2u ? LOW : MID);
+
+    tell(&w[0], WRITE, 0);
+    CHECK(w[0].result == pdTRUE);
+    for (unsigned i = 0; i < 4u; ++i)
+        tell(&r[i], READ, portMAX_DELAY);
+    tell(&w[1], WRITE, portMAX_DELAY);
+
+    tell(&w[0], GIVE_WRITE, 0);
+    vTaskDelay(1);                      // the LOW readers run
+    for (unsigned i = 0; i < 4u; ++i)
+        CHECK(r[i].result == pdTRUE);
+    CHECK(w[1].result == -1);
+
+    for (unsigned i = 0; i < 4u; ++i) {
+        CHECK(w[1].result == -1);
+        tell(&r[i], GIVE_READ, 0);
+    }
+    CHECK(w[1].result == pdTRUE);
+    tell(&w[1], GIVE_WRITE, 0);
+    CHECK(can_write());
+
+    stop(&w[0]);
+    stop(&w[1]);
+    for (unsigned i = 0; i < 4u; ++i)
+        stop(&r[i]);
+}
+
+// the writer's priority
+
+static void inheritance(void) {
+    Actor holder, mid, high;
+
+    start(&holder, LOW);
+    start(&mid, MID);
+    start(&high, HIGH);
+
+    tell(&holder, WRITE, 0);
+    CHECK(uxTaskPriorityGet(holder.task) == LOW);
+    tell(&mid, WRITE, 20);
+    CHECK(uxTaskPriorityGet(holder.task) == MID);
+    tell(&high, READ, 10);              // a reader raises it too
+    CHECK(uxTaskPriorityGet(holder.task) == HIGH);
+
+    // back down as the waiters time out
+    vTaskDelay(10);
+    CHECK(high.result == pdFALSE);
+    CHECK(uxTaskPriorityGet(holder.task) == MID);
+    vTaskDelay(10);
+    CHECK(mid.result == pdFALSE);
+    CHECK(uxTaskPriorityGet(holder.task) == LOW);
+
+    // and on release, to the new writer's own
+    tell(&high, WRITE, portMAX_DELAY);
+    CHECK(uxTaskPriorityGet(holder.task) == HIGH);
+    tell(&holder, GIVE_WRITE, 0);
+    CHECK(holder.result == pdTRUE && high.result == pdTRUE);
+    CHECK(uxTaskPriorityGet(holder.task) == LOW);
+    CHECK(uxTaskPriorityGet(high.task) == HIGH);
+    tell(&high, GIVE_WRITE, 0);
+
+    // a writer handed the lock inherits from the readers it holds back
+    CHECK(xRWLockTakeRead(gl_lock, 0) == pdTRUE);
+    tell(&holder, WRITE, portMAX_DELAY);
+    tell(&high, READ, portMAX_DELAY);
+    CHECK(holder.result == -1 && high.result == -1);
+    vRWLockGiveRead(gl_lock);
+    CHECK(holder.result == pdTRUE && high.result == -1);
+    CHECK(uxTaskPriorityGet(holder.task) == HIGH);
+    tell(&holder, GIVE_WRITE, 0);
+    CHECK(high.result == pdTRUE && uxTaskPriorityGet(holder.task) == LOW);
+
+    // readers inherit nothing
+    tell(&holder, READ, 0);
+    tell(&mid, WRITE, 5);
+    CHECK(uxTaskPriorityGet(holder.task) == LOW);
+    vTaskDelay(5);
+    CHECK(mid.result == pdFALSE);
+    tell(&holder, GIVE_READ, 0);
+    tell(&high, GIVE_READ, 0);
+    CHECK(can_write());
+
+    stop(&holder);
+    stop(&mid);
+    stop(&high);
+}
+
+// throughput benchmark
+
+#define MAX_READERS 8u
+#define BENCH_TICKS 200u
+#define REPS 20000u
+
+static SemaphoreHandle_t gl_mutex;
+static BaseType_t volatile gl_use_mutex, gl_stop;
+static unsigned volatile gl_reads;
+
+static void reader(void * arg) {
+    (void) arg;
+    while (!gl_stop) {
+        if (gl_use_mutex)
+            CHECK(xSemaphoreTake(gl_mutex, portMAX_DELAY) == pdTRUE);
+        else
+            CHECK(xRWLockTakeRead(gl_lock, portMAX_DELAY) == pdTRUE);
+        vTaskDelay(1);
+        if (gl_use_mutex)
+            xSemaphoreGive(gl_mutex);
+        else
+            vRWLockGiveRead(gl_lock);
+        gl_reads++;
+    }
+    vTaskDelete(NULL);
+}
+
+static double reads_per_tick(unsigned readers, BaseType_t use_mutex) {
+    gl_use_mutex = use_mutex;
+    gl_stop = pdFALSE;
+    gl_reads = 0u;
+    for (unsigned i = 0; i < readers; ++i)
+        CHECK(xTaskCreate(reader, "reader", configMINIMAL_STACK_SIZE, NULL,
+                          MID, NULL) == pdPASS);
+    vTaskDelay(BENCH_TICKS);
+    unsigned reads = gl_reads;
+    gl_stop = pdTRUE;
+    vTaskDelay(readers + 2u);           // every reader finishes and goes
+    CHECK(can_write());
+    return (double)reads / BENCH_TICKS;
+}
+
+static void uncontended(char const * what, int which) {
+    SimTiming best = { 0 };
+
+    for (unsigned i = 0; i < 3u; ++i) {
+        SimTiming t = { 0 };
+
+        for (unsigned r = 0; r < REPS; ++r) {
+            uint64_t start = sim_host_ns();
+            switch (which) {
+            case 0:
+                (void) xRWLockTakeRead(gl_lock, 0);
+                vRWLockGiveRead(gl_lock);
+                break;
+            case 1:
+                (void) xRWLockTakeWrite(gl_lock, 0);
+                vRWLockGiveWrite(gl_lock);
+                break;
+            default:
+                (void) xSemaphoreTake(gl_mutex, 0);
+                xSemaphoreGive(gl_mutex);
+                break;
+            }
+            sim_timed(&t, start);
+        }
+        sim_keep_best(&best, &t);
+    }
+    sim_report(what, &best);
+}
+
+static void throughput(void) {
+    gl_mutex = xSemaphoreCreateMutex();
+    CHECK(gl_mutex != NULL);
+
+    printf("test-rwlock: reads per tick, each reader holding the lock "
+           "for a tick\n"
+           "  readers   rwlock    mutex\n");
+    for (unsigned n = 1; n <= MAX_READERS; n *= 2u) {
+        double rw = reads_per_tick(n, pdFALSE);
+        double mx = reads_per_tick(n, pdTRUE);
+
+        printf("  %7u  %7.2f  %7.2f\n", n, rw, mx);
+    }
+    printf("test-rwlock: ns per uncontended take and give\n");
+    uncontended("rwlock, read", 0);
+    uncontended("rwlock, write", 1);
+    uncontended("mutex", 2);
+    vSemaphoreDelete(gl_mutex);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    gl_lock = xRWLockCreate();
+    CHECK(gl_lock != NULL);
+    grant_or_timeout();
+    preference();
+    reader_batch();
+    inheritance();
+    throughput();
+    vRWLockDelete(gl_lock);
+    printf("test-rwlock: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
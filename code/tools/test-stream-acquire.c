@@ -0,0 +1,425 @@
+/**
+   test-stream-acquire: in-place acquire, commit and release on stream
+   and message buffers (FreeRTOS-Kernel/stream_buffer.c) on the host
+   simulation (tools/sim)
+
+       make check
+
+   Random sequences mix the acquire calls with xStreamBufferSend() and
+   xStreamBufferReceive(), over buffers small enough to wrap every few
+   operations, and compare every byte read with a reference FIFO.  The
+   segments handed out are checked against the storage area each time.
+   Blocking acquires are then woken by the other side's commit or
+   release.
+
+   Last, it prints the copy cost the acquire calls save: 16..512-byte
+   blocks written and read back through xStreamBufferSend() and
+   xStreamBufferReceive(), against the same blocks produced and
+   consumed in place.  The figures are host bytes per nanosecond, the
+   best of three runs, and only compare the two.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "sim.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+enum { CONTROL = 4, OTHER = 3 };
+
+#define LENGTH_BYTES sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)
+
+static uint32_t gl_random = 1u;
+
+static unsigned random_below(unsigned n) {
+    gl_random = gl_random * 1103515245u + 12345u;
+    return (gl_random >> 16) % n;
+}
+
+// the bytes, or messages, that should be in the buffer
+static struct {
+    uint8_t byte[1024];
+    size_t len;                 // of the message at each byte's start
+    size_t head, count;
+} gl_model;
+
+static uint8_t gl_next_byte;
+
+static void model_push(uint8_t b) {
+    CHECK(gl_model.count < sizeof gl_model.byte);
+    gl_model.byte[(gl_model.head + gl_model.count++) % sizeof gl_model.byte] = b;
+}
+
+static uint8_t model_pop(void) {
+    CHECK(gl_model.count != 0u);
+    uint8_t b = gl_model.byte[gl_model.head];
+    gl_model.head = (gl_model.head + 1u) % sizeof gl_model.byte;
+    gl_model.count--;
+    return b;
+}
+
+// messages in the model, by length, oldest first
+static size_t gl_lengths[256];
+static unsigned gl_first, gl_messages;
+
+static uint8_t * gl_storage;
+static size_t gl_size;          // of the storage area, one more than the capacity
+
+// a region must lie in the storage area, wrapping at most once
+static void check_segments(StreamBufferSegments_t const * s, size_t n) {
+    CHECK(s->xLength[0] + s->xLength[1] == n);
+    if (s->xLength[0] == 0u)
+        CHECK(s->pucData[0] == NULL && s->xLength[1] == 0u);
+    else
+        CHECK(s->pucData[0] >= gl_storage
+              && s->pucData[0] + s->xLength[0] <= gl_storage + gl_size);
+    if (s->xLength[1] == 0u)
+        CHECK(s->pucData[1] == NULL);
+    else
+        CHECK(s->pucData[1] == gl_storage
+              && s->pucData[0] + s->xLength[0] == gl_storage + gl_size);
+}
+
+static void fill(StreamBufferSegments_t const * s, size_t n) {
+    for (unsigned k = 0; k < 2u && n != 0u; ++k)
+        for (size_t i = 0; i < s->xLength[k] && n != 0u; ++i, --n)
+            s->pucData[k][i] = gl_next_byte++;
+}
+
+// n bytes of the region, in order
+static void check_region(StreamBufferSegments_t const * s, size_t n) {
+    for (unsigned k = 0; k < 2u && n != 0u; ++k)
+        for (size_t i = 0; i < s->xLength[k] && n != 0u; ++i, --n)
+            CHECK(s->pucData[k][i] == model_pop());
+}
+
+static void random_stream_ops(StreamBufferHandle_t sb, size_t capacity) {
+    StreamBufferSegments_t s;
+    uint8_t data[64];
+
+    for (unsigned op = 0; op < 20000u; ++op) {
+        size_t want = 1u + random_below(capacity + 4u);
+        size_t n;
+
+        switch (random_below(4)) {
+        case 0:                         // copy in
+            for (size_t i = 0; i < want && i < sizeof data; ++i)
+                data[i] = gl_next_byte + (uint8_t)i;
+            if (want > sizeof data)
+                want = sizeof data;
+            n = xStreamBufferSend(sb, data, want, 0);
+            CHECK(n == ((want < capacity - gl_model.count)
+                        ? want : capacity - gl_model.count));
+            for (size_t i = 0; i < n; ++i)
+                model_push(gl_next_byte++);
+            break;
+        case 1:                         // fill in place, commit some
+            n = xStreamBufferSendAcquire(sb, want, &s, 0);
+            check_segments(&s, n);
+            CHECK(n == ((want < capacity - gl_model.count)
+                        ? want : capacity - gl_model.count));
+            n = random_below(n + 1u);
+            fill(&s, n);
+            for (size_t i = 0; i < n; ++i)
+                model_push((uint8_t)(gl_next_byte - n + i));
+            CHECK(xStreamBufferSendCommit(sb, n) == n);
+            break;
+        case 2:                         // copy out
+            n = xStreamBufferReceive(sb, data,
+                                     want < sizeof data ? want : sizeof data, 0);
+            CHECK(n == ((want < sizeof data ? want : sizeof data)
+                        < gl_model.count
+                        ? (want < sizeof data ? want : sizeof data)
+                        : gl_model.count));
+            for (size_t i = 0; i < n; ++i)
+                CHECK(data[i] == model_pop());
+            break;
+        default:                        // parse in place, release some
+            n = xStreamBufferReceiveAcquire(sb, &s, 0);
+            check_segments(&s, n);
+            CHECK(n == gl_model.count);
+            n = random_below(n + 1u);
+            check_region(&s, n);
+            CHECK(xStreamBufferReceiveRelease(sb, n) == n);
+            break;
+        }
+        CHECK(xStreamBufferBytesAvailable(sb) == gl_model.count);
+    }
+}
+
+static void push_message(size_t n) {
+    gl_lengths[(gl_first + gl_messages++) % 256u] = n;
+}
+
+static size_t pop_message(void) {
+    CHECK(gl_messages != 0u);
+    size_t n = gl_lengths[gl_first];
+    gl_first = (gl_first + 1u) % 256u;
+    gl_messages--;
+    return n;
+}
+
+static void random_message_ops(MessageBufferHandle_t mb, size_t capacity) {
+    StreamBufferSegments_t s;
+    uint8_t data[64];
+
+    for (unsigned op = 0; op < 20000u; ++op) {
+        size_t want = 1u + random_below(capacity - LENGTH_BYTES);
+        size_t free = capacity - gl_model.count - gl_messages * LENGTH_BYTES;
+        bool fits = want + LENGTH_BYTES <= free;
+        size_t n;
+
+        switch (random_below(4)) {
+        case 0:
+            if (want > sizeof data)
+                break;
+            for (size_t i = 0; i < want; ++i)
+                data[i] = gl_next_byte + (uint8_t)i;
+            n = xMessageBufferSend(mb, data, want, 0);
+            CHECK(n == (fits ? want : 0u));
+            for (size_t i = 0; i < n; ++i)
+                model_push(gl_next_byte++);
+            if (n != 0u)
+                push_message(n);
+            break;
+        case 1:                         // a message, maybe shorter
+            n = xMessageBufferSendAcquire(mb, want, &s, 0);
+            check_segments(&s, n);
+            CHECK(n == (fits ? want : 0u));
+            if (n == 0u)
+                break;
+            n = random_below(n + 1u);   // 0 abandons it
+            fill(&s, n);
+            for (size_t i = 0; i < n; ++i)
+                model_push((uint8_t)(gl_next_byte - n + i));
+            CHECK(xMessageBufferSendCommit(mb, n) == n);
+            if (n != 0u)
+                push_message(n);
+            break;
+        case 2:
+            n = xMessageBufferReceive(mb, data, sizeof data, 0);
+            if (gl_messages == 0u) {
+                CHECK(n == 0u);
+                break;
+            }
+            if (gl_lengths[gl_first] > sizeof data) {
+                CHECK(n == 0u);        // too long for data: left in place
+                break;
+            }
+            CHECK(n == pop_message());
+            for (size_t i = 0; i < n; ++i)
+                CHECK(data[i] == model_pop());
+            break;
+        default:
+            n = xMessageBufferReceiveAcquire(mb, &s, 0);
+            check_segments(&s, n);
+            if (gl_messages == 0u) {
+                CHECK(n == 0u);
+                break;
+            }
+            CHECK(n == pop_message());
+            check_region(&s, n);
+            CHECK(xMessageBufferReceiveRelease(mb, n) == n);
+            break;
+        }
+        CHECK(xStreamBufferBytesAvailable(mb)
+              == gl_model.count + gl_messages * LENGTH_BYTES);
+    }
+}
+
+static void reset_model(void) {
+    memset(&gl_model, 0, sizeof gl_model);
+    gl_first = gl_messages = 0u;
+}
+
+static void random_sequences(void) {
+    static StaticStreamBuffer_t control;
+    static uint8_t storage[1024];
+    // a static buffer holds one byte less than its storage, which must
+    // also be longer than a message length, even for a stream buffer
+    static size_t const capacity[] = { 8, 13, 16, 33, 64, 200 };
+
+    for (unsigned i = 0; i < sizeof capacity / sizeof capacity[0]; ++i) {
+        gl_storage = storage;
+        gl_size = capacity[i] + 1u;
+        reset_model();
+        StreamBufferHandle_t sb = xStreamBufferCreateStatic(
+            gl_size, 1, storage, &control);
+        CHECK(sb != NULL);
+        random_stream_ops(sb, capacity[i]);
+        vStreamBufferDelete(sb);
+
+        // a message needs its length in front
+        if (capacity[i] <= LENGTH_BYTES + 1u)
+            continue;
+        reset_model();
+        MessageBufferHandle_t mb = xMessageBufferCreateStatic(
+            gl_size, storage, &control);
+        CHECK(mb != NULL);
+        random_message_ops(mb, capacity[i]);
+        vMessageBufferDelete(mb);
+    }
+}
+
+// blocking acquires
+
+static StreamBufferHandle_t gl_sb;
+static volatile size_t gl_acquired;
+
+static void acquire_space(void * arg) {
+    StreamBufferSegments_t s;
+
+    gl_acquired = xStreamBufferSendAcquire(gl_sb, (size_t)(uintptr_t)arg, &s,
+                                           portMAX_DELAY);
+    fill(&s, gl_acquired);
+    (void) xStreamBufferSendCommit(gl_sb, gl_acquired);
+    vTaskDelete(NULL);
+}
+
+static void acquire_data(void * arg) {
+    StreamBufferSegments_t s;
+
+    gl_acquired = xStreamBufferReceiveAcquire(gl_sb, &s, (TickType_t)(uintptr_t)arg);
+    if (gl_acquired != 0u)
+        (void) xStreamBufferReceiveRelease(gl_sb, gl_acquired);
+    vTaskDelete(NULL);
+}
+
+static void blocking(void) {
+    StreamBufferSegments_t s;
+    uint8_t data[8] = { 0 };
+
+    // a reader waits for the trigger level, reached by a commit
+    gl_sb = xStreamBufferCreate(16, 4);
+    CHECK(gl_sb != NULL);
+    gl_acquired = 99u;
+    CHECK(xTaskCreate(acquire_data, "reader", configMINIMAL_STACK_SIZE,
+                      (void *)(uintptr_t)portMAX_DELAY, OTHER, NULL) == pdPASS);
+    vTaskDelay(2);
+    CHECK(gl_acquired == 99u);
+    CHECK(xStreamBufferSendAcquire(gl_sb, 3, &s, 0) == 3u);
+    CHECK(xStreamBufferSendCommit(gl_sb, 3) == 3u);
+    vTaskDelay(2);
+    CHECK(gl_acquired == 99u);          // below the trigger level
+    CHECK(xStreamBufferSendAcquire(gl_sb, 1, &s, 0) == 1u);
+    CHECK(xStreamBufferSendCommit(gl_sb, 1) == 1u);
+    vTaskDelay(1);
+    CHECK(gl_acquired == 4u && xStreamBufferIsEmpty(gl_sb));
+
+    // and times out with nothing
+    gl_acquired = 99u;
+    CHECK(xTaskCreate(acquire_data, "reader", configMINIMAL_STACK_SIZE,
+                      (void *)(uintptr_t)5u, OTHER, NULL) == pdPASS);
+    vTaskDelay(10);
+    CHECK(gl_acquired == 0u);
+
+    // a writer waits for space, made by a release
+    CHECK(xStreamBufferSend(gl_sb, data, 8, 0) == 8u);
+    CHECK(xStreamBufferSend(gl_sb, data, 8, 0) == 8u);
+    gl_acquired = 99u;
+    CHECK(xTaskCreate(acquire_space, "writer", configMINIMAL_STACK_SIZE,
+                      (void *)(uintptr_t)6u, OTHER, NULL) == pdPASS);
+    vTaskDelay(2);
+    CHECK(gl_acquired == 99u);
+    CHECK(xStreamBufferReceiveAcquire(gl_sb, &s, 0) == 16u);
+    CHECK(xStreamBufferReceiveRelease(gl_sb, 5) == 5u);
+    vTaskDelay(1);
+    CHECK(gl_acquired == 99u);          // 5 free, 6 wanted
+    CHECK(xStreamBufferReceiveRelease(gl_sb, 1) == 1u);
+    vTaskDelay(1);
+    CHECK(gl_acquired == 6u);
+    CHECK(xStreamBufferBytesAvailable(gl_sb) == 16u);
+    vStreamBufferDelete(gl_sb);
+
+    // a message that can never fit does not wait
+    MessageBufferHandle_t mb = xMessageBufferCreate(16);
+    CHECK(xMessageBufferSendAcquire(mb, 16, &s, portMAX_DELAY) == 0u);
+    check_segments(&s, 0);
+    vMessageBufferDelete(mb);
+}
+
+// copy cost benchmark
+
+#define BENCH_BYTES (64u * 1024u)   // per run
+
+static StreamBufferHandle_t gl_bench;
+static uint32_t gl_sum;
+
+static void by_copy(SimTiming * t, size_t block) {
+    uint8_t in[512], out[512];
+    uint64_t start = sim_host_ns();
+
+    for (size_t done = 0; done < BENCH_BYTES; done += block) {
+        for (size_t i = 0; i < block; ++i)
+            in[i] = (uint8_t)(done + i);
+        CHECK(xStreamBufferSend(gl_bench, in, block, 0) == block);
+        CHECK(xStreamBufferReceive(gl_bench, out, block, 0) == block);
+        for (size_t i = 0; i < block; ++i)
+            gl_sum += out[i];
+    }
+    sim_timed(t, start);
+}
+
+static void in_place(SimTiming * t, size_t block) {
+    StreamBufferSegments_t s;
+    uint64_t start = sim_host_ns();
+
+    for (size_t done = 0; done < BENCH_BYTES; done += block) {
+        CHECK(xStreamBufferSendAcquire(gl_bench, block, &s, 0) == block);
+        for (size_t i = 0, k = 0; k < 2u; ++k)
+            for (size_t j = 0; j < s.xLength[k]; ++j, ++i)
+                s.pucData[k][j] = (uint8_t)(done + i);
+        (void) xStreamBufferSendCommit(gl_bench, block);
+
+        CHECK(xStreamBufferReceiveAcquire(gl_bench, &s, 0) == block);
+        for (size_t k = 0; k < 2u; ++k)
+            for (size_t j = 0; j < s.xLength[k]; ++j)
+                gl_sum += s.pucData[k][j];
+        (void) xStreamBufferReceiveRelease(gl_bench, block);
+    }
+    sim_timed(t, start);
+}
+
+// bytes per host ns, the best of three runs
+static double rate(void (*run)(SimTiming *, size_t), size_t block) {
+    SimTiming best = { 0 };
+
+    for (unsigned i = 0; i < 3u; ++i) {
+        SimTiming t = { 0 };
+
+        run(&t, block);
+        sim_keep_best(&best, &t);
+    }
+    return (double)BENCH_BYTES / (double)best.total;
+}
+
+static void copy_cost(void) {
+    // an odd size, so blocks wrap at every offset
+    gl_bench = xStreamBufferCreate(1021, 1);
+    CHECK(gl_bench != NULL);
+
+    printf("test-stream-acquire: bytes per ns, written and read back\n"
+           "  block  send/receive  acquire/commit\n");
+    for (size_t block = 16; block <= 512u; block *= 2u)
+        printf("  %5u  %12.2f  %14.2f\n", (unsigned)block,
+               rate(by_copy, block), rate(in_place, block));
+    vStreamBufferDelete(gl_bench);
+}
+
+static void control(void * arg) {
+    (void) arg;
+    random_sequences();
+    blocking();
+    copy_cost();
+    printf("test-stream-acquire: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", configMINIMAL_STACK_SIZE, NULL,
+                      CONTROL, NULL) == pdPASS);
+    sim_run();
+    return 0;
+}
@@ -0,0 +1,257 @@
+/**
+   test-worker-pool: job order, refusal, waiting and callbacks of the
+   worker pool (app/worker-pool.c) on the host simulation (tools/sim)
+
+       make check
+
+   worker_job_wait() blocks on notification index
+   WORKER_POOL_NOTIFY_INDEX: a notification there that is not the
+   job's must not end the wait early, and one on index 0 must be left
+   for the waiting task.
+
+   Then it prints the host ns from submitting a job that does nothing
+   to worker_job_wait() returning, and how many such jobs 1..4 workers
+   get through per host ms when they are all submitted first.  The
+   figures are the best of three runs, and only compare.
+ */
+
+#include "sim.h"
+#include "task.h"
+#include "worker-pool.h"
+
+enum { CONTROL = 4, WORKER = 1 };
+
+#define STACK configMINIMAL_STACK_SIZE
+
+static int gl_log[16];
+static unsigned gl_logged;
+
+// logs its id and returns it
+static int record(void * arg) {
+    int id = (int)(intptr_t)arg;
+
+    CHECK(gl_logged < sizeof gl_log / sizeof gl_log[0]);
+    gl_log[gl_logged++] = id;
+    return id;
+}
+
+// sleeps for arg ticks
+static int sleep_for(void * arg) {
+    vTaskDelay((TickType_t)(uintptr_t)arg);
+    return 1;
+}
+
+static void priority_order(void) {
+    static WorkerPool pool;
+    static uint8_t const priority[] = { 1, 5, 5, 9, 0, 9 };
+    WorkerJob job[6];
+
+    CHECK(worker_pool_create(&pool, "order", 1, STACK, WORKER, 8));
+
+    // the worker cannot run until this task blocks
+    gl_logged = 0u;
+    for (unsigned i = 0; i < 6; ++i) {
+        worker_job_init(&job[i], record, (void *)(intptr_t)i, STACK, NULL);
+        CHECK(worker_pool_submit(&pool, &job[i], priority[i], 0));
+        CHECK(job[i].state == WORKER_JOB_QUEUED);
+    }
+    CHECK(worker_pool_backlog(&pool) == 6u);
+
+    CHECK(worker_job_wait(&job[4], portMAX_DELAY));
+    static int const expected[] = { 3, 5, 1, 2, 0, 4 };
+    CHECK(gl_logged == 6u);
+    for (unsigned i = 0; i < 6; ++i) {
+        CHECK(gl_log[i] == expected[i]);
+        CHECK(worker_job_done(&job[i]) && job[i].result == (int)i);
+    }
+    CHECK(worker_pool_backlog(&pool) == 0u);
+}
+
+static void refusals(void) {
+    static WorkerPool pool;
+    WorkerJob job[4];
+
+    CHECK(worker_pool_create(&pool, "refuse", 1, STACK, WORKER, 2));
+
+    worker_job_init(&job[0], record, NULL, STACK + 1u, NULL);
+    CHECK(!worker_pool_submit(&pool, &job[0], 0, 0));
+    CHECK(job[0].state == WORKER_JOB_IDLE);
+
+    gl_logged = 0u;
+    for (unsigned i = 0; i < 3; ++i)
+        worker_job_init(&job[i], record, (void *)(intptr_t)i, STACK, NULL);
+    CHECK(worker_pool_submit(&pool, &job[0], 0, 0));
+    CHECK(worker_pool_submit(&pool, &job[1], 0, 0));
+    CHECK(!worker_pool_submit(&pool, &job[2], 0, 0));
+    CHECK(job[2].state == WORKER_JOB_IDLE);
+
+    // blocking lets the worker take a job, which makes room
+    CHECK(worker_pool_submit(&pool, &job[2], 0, 10));
+    CHECK(worker_job_wait(&job[2], portMAX_DELAY));
+    CHECK(gl_logged == 3u);
+}
+
+static BaseType_t gl_running_in_callback;
+
+static void check_running(WorkerJob * job) {
+    gl_running_in_callback = (job->state == WORKER_JOB_RUNNING);
+}
+
+static TaskHandle_t gl_control;
+
+static void nudge(void * arg) {
+    (void) arg;
+    vTaskDelay(3);
+    xTaskNotifyGive(gl_control);
+    xTaskNotifyGiveIndexed(gl_control, WORKER_POOL_NOTIFY_INDEX);
+    vTaskDelete(NULL);
+}
+
+static void waiting(void) {
+    static WorkerPool pool;
+    WorkerJob job;
+    TickType_t start;
+
+    CHECK(worker_pool_create(&pool, "wait", 1, STACK, WORKER, 2));
+
+    worker_job_init(&job, sleep_for, (void *)20u, STACK, check_running);
+    CHECK(worker_pool_submit(&pool, &job, 0, 0));
+
+    // notifications from elsewhere do not end the wait early, and the
+    // one on index 0 is still there after it
+    CHECK(xTaskCreate(nudge, "nudge", STACK, NULL, WORKER, NULL) == pdPASS);
+    start = xTaskGetTickCount();
+    CHECK(!worker_job_wait(&job, 10));
+    CHECK(xTaskGetTickCount() - start == 10u);
+    CHECK(!worker_job_done(&job) && job.waiter == NULL);
+    CHECK(ulTaskNotifyTake(pdTRUE, 0) == 1u);
+
+    CHECK(worker_job_wait(&job, portMAX_DELAY));
+    CHECK(job.result == 1 && gl_running_in_callback);
+
+    // a finished job can be submitted again, and waiting on it once
+    // it is done returns at once
+    CHECK(worker_pool_submit(&pool, &job, 0, 0));
+    vTaskDelay(30);
+    start = xTaskGetTickCount();
+    CHECK(worker_job_wait(&job, 5));
+    CHECK(xTaskGetTickCount() == start);
+}
+
+// several workers run jobs side by side, never more than the pool has
+
+#define JOBS 40u
+#define WORKERS 3u
+
+static unsigned gl_running, gl_most_running;
+
+static int overlap(void * arg) {
+    if (++gl_running > gl_most_running)
+        gl_most_running = gl_running;
+    vTaskDelay(1 + (TickType_t)(uintptr_t)arg % 4u);
+    gl_running--;
+    return (int)(intptr_t)arg;
+}
+
+static void side_by_side(void) {
+    static WorkerPool pool;
+    static WorkerJob job[JOBS];
+
+    CHECK(worker_pool_create(&pool, "side", WORKERS, STACK, WORKER, 8));
+    for (unsigned i = 0; i < JOBS; ++i) {
+        worker_job_init(&job[i], overlap, (void *)(intptr_t)i, STACK, NULL);
+        CHECK(worker_pool_submit(&pool, &job[i], (uint8_t)(i % 3u),
+                                 portMAX_DELAY));
+    }
+    for (unsigned i = 0; i < JOBS; ++i) {
+        CHECK(worker_job_wait(&job[i], portMAX_DELAY));
+        CHECK(job[i].result == (int)i);
+    }
+    CHECK(gl_running == 0u && gl_most_running == WORKERS);
+}
+
+// benchmarks
+
+#define REPS 5000u
+#define BATCH 256u
+
+static int nothing(void * arg) {
+    return (int)(intptr_t)arg;
+}
+
+static void latency(void) {
+    static WorkerPool pool;
+    SimTiming best = { 0 };
+    WorkerJob job;
+
+    CHECK(worker_pool_create(&pool, "latency", 1, STACK, WORKER, 2));
+    worker_job_init(&job, nothing, NULL, STACK, NULL);
+    for (unsigned i = 0; i < 3u; ++i) {
+        SimTiming t = { 0 };
+
+        for (unsigned r = 0; r < REPS; ++r) {
+            uint64_t start = sim_host_ns();
+            CHECK(worker_pool_submit(&pool, &job, 0, 0));
+            CHECK(worker_job_wait(&job, portMAX_DELAY));
+            sim_timed(&t, start);
+        }
+        sim_keep_best(&best, &t);
+    }
+    printf("test-worker-pool: ns from submitting a job to its wait "
+           "returning\n");
+    sim_report("one worker", &best);
+}
+
+static void throughput(void) {
+    static WorkerPool pool[WORKER_POOL_MAX_WORKERS];
+    static WorkerJob job[BATCH];
+
+    printf("test-worker-pool: jobs per host ms, %u submitted and then "
+           "waited for\n", BATCH);
+    for (unsigned n = 1; n <= WORKER_POOL_MAX_WORKERS; ++n) {
+        uint64_t best = 0;
+
+        CHECK(worker_pool_create(&pool[n - 1u], "batch", n, STACK, WORKER,
+                                 16));
+        for (unsigned i = 0; i < 3u; ++i) {
+            uint64_t start = sim_host_ns();
+
+            for (unsigned j = 0; j < BATCH; ++j) {
+                worker_job_init(&job[j], nothing, (void *)(intptr_t)j, STACK,
+                                NULL);
+                CHECK(worker_pool_submit(&pool[n - 1u], &job[j], 0,
+                                         portMAX_DELAY));
+            }
+            for (unsigned j = 0; j < BATCH; ++j)
+                CHECK(worker_job_wait(&job[j], portMAX_DELAY)
+                      && job[j].result == (int)j);
+
+            uint64_t ns = sim_host_ns() - start;
+            if (best == 0u || ns < best)
+                best = ns;
+        }
+        printf("  %u worker(s)  %8.0f\n", n, BATCH * 1e6 / (double)best);
+    }
+}
+
+static void control(void * arg) {
+    (void) arg;
+    gl_control = xTaskGetCurrentTaskHandle();
+
+    priority_order();
+    refusals();
+    waiting();
+    side_by_side();
+    latency();
+    throughput();
+
+    printf("test-worker-pool: ok\n");
+    sim_pass();
+}
+
+int main(void) {
+    CHECK(xTaskCreate(control, "control", STACK, NULL, CONTROL, NULL)
+          == pdPASS);
+    sim_run();
+    return 0;
+}